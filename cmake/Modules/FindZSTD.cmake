@@ -0,0 +1,16 @@
+# - Try to find zstd
+# Once done this will define
+# ZSTD_FOUND - System has zstd
+# ZSTD_INCLUDE_DIRS - The zstd include directories
+# ZSTD_LIBRARIES - The libraries needed to use zstd
+
+find_path ( ZSTD_INCLUDE_DIR zstd.h )
+find_library ( ZSTD_LIBRARY NAMES zstd )
+
+set ( ZSTD_LIBRARIES ${ZSTD_LIBRARY} )
+set ( ZSTD_INCLUDE_DIRS ${ZSTD_INCLUDE_DIR} )
+
+include ( FindPackageHandleStandardArgs )
+# handle the QUIETLY and REQUIRED arguments and set ZSTD_FOUND to TRUE
+# if all listed variables are TRUE
+find_package_handle_standard_args ( ZSTD DEFAULT_MSG ZSTD_LIBRARY ZSTD_INCLUDE_DIR )
@@ -43,6 +43,7 @@
 #include <openssl/sha.h>
 
 #include "batsim.hpp"
+#include "binary_workload.hpp"
 #include "context.hpp"
 #include "export.hpp"
 #include "ipp.hpp"
@@ -51,6 +52,7 @@
 #include "jobs_execution.hpp"
 #include "machines.hpp"
 #include "network.hpp"
+#include "plugin_protocol.hpp"
 #include "profiles.hpp"
 #include "protocol.hpp"
 #include "server.hpp"
@@ -58,6 +60,7 @@
 #include "workflow.hpp"
 
 #include "unittest/test_main.hpp"
+#include "benchmark/benchmark_main.hpp"
 
 #include "docopt/docopt.h"
 
@@ -75,10 +78,24 @@ string default_configuration = R"({
                                },
                                "job_submission": {
                                  "forward_profiles": false,
+                                 "batch_by_timestamp": false,
                                  "from_scheduler": {
                                    "enabled": false,
                                    "acknowledge": true
                                  }
+                               },
+                               "protocol": {
+                                 "format": "json",
+                                 "validation": "audit",
+                                 "decimal_places": -1,
+                                 "deferred_events": [],
+                                 "compact_resources": false,
+                                 "coalesce_calls": false,
+                                 "compression": {
+                                   "enabled": false,
+                                   "threshold": 16384,
+                                   "level": 3
+                                 }
                                }
                              })";
 
@@ -150,7 +167,7 @@ string generate_sha1_string(std::string string_to_hash, int output_length)
 }
 
 void parse_main_args(int argc, char * argv[], MainArguments & main_args, int & return_code,
-                     bool & run_simulation, bool & run_unit_tests)
+                     bool & run_simulation, bool & run_unit_tests, bool & run_benchmarks)
 {
     static const char usage[] =
 R"(A tool to simulate (via SimGrid) the behaviour of scheduling algorithms.
@@ -164,14 +181,21 @@ Usage:
   batsim --version
   batsim --simgrid-version
   batsim --unittest
+  batsim --benchmark
+  batsim --convert-workload <json_workload_file> <binary_workload_file>
 
 Input options:
   -p --platform <platform_file>     The SimGrid platform to simulate.
-  -w --workload <workload_file>     The workload JSON files to simulate.
+  -w --workload <workload_file>     The workload files to simulate, either in
+                                    JSON or in the binary format written by
+                                    --convert-workload.
   -W --workflow <workflow_file>     The workflow XML files to simulate.
   --WS --workflow-start (<cut_workflow_file> <start_time>)... The workflow XML
                                     files to simulate, with the time at which
                                     they should be started.
+  --lazy-workloads                  Only indexes the jobs of the workloads at
+                                    startup. Each job is then read from its
+                                    workload file when it is submitted.
 
 Most common options:
   -m, --master-host <name>          The name of the host in <platform_file>
@@ -185,12 +209,24 @@ Execution context options:
   --config-file <cfg_file>          Configuration file name (optional). [default: None]
   -s, --socket-endpoint <endpoint>  The Decision process socket endpoint
                                     Decision process [default: tcp://localhost:28000].
+                                    shm://<name> endpoints exchange messages
+                                    through shared memory (same host only).
   --redis-hostname <redis_host>     The Redis server hostname. Read from config file by default.
                                     [default: None]
   --redis-port <redis_port>         The Redis server port. Read from config file by default.
                                     [default: -1]
   --redis-prefix <prefix>           The Redis prefix. Read from config file by default.
                                     [default: None]
+  --record <conversation_file>      Records the messages exchanged with the
+                                    scheduler into <conversation_file>
+                                    [default: None].
+  --replay <conversation_file>      Replays a conversation recorded with
+                                    --record instead of connecting to a
+                                    scheduler [default: None].
+  --scheduler-plugin <plugin_file>  Loads the scheduler from the <plugin_file>
+                                    shared library into Batsim's process
+                                    instead of connecting to a scheduler
+                                    [default: None].
 
 Output options:
   -e, --export <prefix>             The export filename prefix used to generate
@@ -198,6 +234,14 @@ Output options:
   --enable-sg-process-tracing       Enables SimGrid process tracing
   --disable-schedule-tracing        Disables the Pajé schedule outputting.
   --disable-machine-state-tracing   Disables the machine state outputting.
+  --telemetry <destination>         Periodically emits the simulation progress
+                                    as JSON lines, either on a ZeroMQ PUB
+                                    socket bound to <destination> if it is an
+                                    endpoint (e.g. tcp://*:28001), or at the
+                                    end of the <destination> file
+                                    [default: None].
+  --telemetry-interval <seconds>    The wall-clock time between two telemetry
+                                    records [default: 10].
 
 
 Platform size limit options:
@@ -239,6 +283,7 @@ Other options:
 
     run_simulation = false,
     run_unit_tests = false;
+    run_benchmarks = false;
     return_code = 1;
     map<string, docopt::value> args = docopt::docopt(usage, { argv + 1, argv + argc },
                                                      true, STR(BATSIM_VERSION));
@@ -262,6 +307,19 @@ Other options:
         return;
     }
 
+    if (args["--benchmark"].asBool())
+    {
+        run_benchmarks = true;
+        return;
+    }
+
+    if (args["--convert-workload"].asBool())
+    {
+        convert_workload_to_binary(args["<json_workload_file>"].asString(),
+                                   args["<binary_workload_file>"].asString());
+        return;
+    }
+
     // Input files
     // ***********
     main_args.platform_filename = args["--platform"].asString();
@@ -294,6 +352,7 @@ Other options:
             main_args.workload_descriptions.push_back(desc);
         }
     }
+    main_args.lazy_workloads = args["--lazy-workloads"].asBool();
 
     // Workflows (without start time)
     vector<string> workflow_files = args["--workflow"].asStringList();
@@ -420,6 +479,22 @@ Other options:
     }
     main_args.redis_prefix = args["--redis-prefix"].asString();
 
+    main_args.record_filename = args["--record"].asString();
+    main_args.replay_filename = args["--replay"].asString();
+    if (main_args.record_filename != "None" && main_args.replay_filename != "None")
+    {
+        XBT_ERROR("--record and --replay cannot be used at the same time.");
+        error = true;
+    }
+
+    main_args.scheduler_plugin_filename = args["--scheduler-plugin"].asString();
+    if (main_args.scheduler_plugin_filename != "None" &&
+        (main_args.record_filename != "None" || main_args.replay_filename != "None"))
+    {
+        XBT_ERROR("--scheduler-plugin cannot be used with --record nor --replay.");
+        error = true;
+    }
+
 
     // Output options
     // **************
@@ -428,6 +503,23 @@ Other options:
     main_args.enable_schedule_tracing = !args["--disable-schedule-tracing"].asBool();
     main_args.enable_machine_state_tracing = !args["--disable-machine-state-tracing"].asBool();
 
+    main_args.telemetry_destination = args["--telemetry"].asString();
+    string telemetry_interval_str = args["--telemetry-interval"].asString();
+    try
+    {
+        main_args.telemetry_interval = std::stod(telemetry_interval_str);
+        if (main_args.telemetry_interval < 0)
+        {
+            XBT_ERROR("Invalid <seconds> '%s': it should be non-negative.", telemetry_interval_str.c_str());
+            error = true;
+        }
+    }
+    catch (const std::exception &)
+    {
+        XBT_ERROR("Cannot read <seconds> '%s' as a number.", telemetry_interval_str.c_str());
+        error = true;
+    }
+
     // Platform size limit options
     // ***************************
     string m_max_str = args["--mmax"].asString();
@@ -501,7 +593,8 @@ void configure_batsim_logging_output(const MainArguments & main_args)
 {
     vector<string> log_categories_to_set = {"workload", "job_submitter", "redis", "jobs", "machines", "pstate",
                                             "workflow", "jobs_execution", "server", "export", "profiles", "machine_range",
-                                            "network", "ipp"};
+                                            "network", "ipp", "compression", "conversation", "plugin",
+                                            "shm_transport"};
     string log_threshold_to_set = "critical";
 
     if (main_args.verbosity == VerbosityLevel::QUIET || main_args.verbosity == VerbosityLevel::NETWORK_ONLY)
@@ -571,7 +664,19 @@ void load_workloads_and_workflows(const MainArguments & main_args, BatsimContext
         Workload * workload = new Workload(desc.name, desc.filename);
 
         int nb_machines_in_workload = -1;
-        workload->load_from_json(desc.filename, nb_machines_in_workload);
+        bool lazy = main_args.lazy_workloads && main_args.program_type == ProgramType::BATSIM;
+        if (BinaryWorkloadFile::is_binary_workload(desc.filename))
+        {
+            workload->load_from_binary(desc.filename, nb_machines_in_workload, lazy);
+        }
+        else if (lazy)
+        {
+            workload->load_lazily_from_json(desc.filename, nb_machines_in_workload);
+        }
+        else
+        {
+            workload->load_from_json(desc.filename, nb_machines_in_workload);
+        }
         max_nb_machines_in_workloads = std::max(max_nb_machines_in_workloads, nb_machines_in_workload);
 
         context->workloads.insert_workload(desc.name, workload);
@@ -677,8 +782,9 @@ int main(int argc, char * argv[])
     int return_code = 1;
     bool run_simulation = false;
     bool run_unittests = false;
+    bool run_benchmarks = false;
 
-    parse_main_args(argc, argv, main_args, return_code, run_simulation, run_unittests);
+    parse_main_args(argc, argv, main_args, return_code, run_simulation, run_unittests, run_benchmarks);
 
     if (run_unittests)
     {
@@ -686,6 +792,12 @@ int main(int argc, char * argv[])
         test_entry_point();
     }
 
+    if (run_benchmarks)
+    {
+        MSG_init(&argc, argv);
+        benchmark_entry_point();
+    }
+
     if (!run_simulation)
     {
         return return_code;
@@ -742,13 +854,70 @@ int main(int argc, char * argv[])
             context.storage.set("nb_res", std::to_string(context.machines.nb_machines()));
         }
 
-        // Let's create the socket
-        context.zmq_socket = new zmq::socket_t(context.zmq_context, ZMQ_REQ);
-        context.zmq_socket->connect(main_args.socket_endpoint);
+        if (main_args.scheduler_plugin_filename != "None")
+        {
+            // The scheduler is loaded into Batsim's process: there is no socket
+            XBT_INFO("Using the scheduler plugin '%s'.", main_args.scheduler_plugin_filename.c_str());
+        }
+        else if (main_args.replay_filename != "None")
+        {
+            // Let's replay a recorded conversation instead of connecting to a scheduler
+            XBT_INFO("Replaying the conversation recorded in '%s'.", main_args.replay_filename.c_str());
+            context.conversation_replayer = new ConversationReplayer(main_args.replay_filename);
+        }
+        else
+        {
+            // Let's create the socket (or the shared memory object if the scheduler runs on the same host)
+            if (SharedMemoryTransport::is_shm_endpoint(main_args.socket_endpoint))
+            {
+                context.shm_transport = new SharedMemoryTransport(SharedMemoryTransport::shm_name(main_args.socket_endpoint));
+            }
+            else
+            {
+                context.zmq_socket = new zmq::socket_t(context.zmq_context, ZMQ_REQ);
+                context.zmq_socket->connect(main_args.socket_endpoint);
+            }
+
+            if (main_args.record_filename != "None")
+            {
+                XBT_INFO("Recording the conversation with the scheduler into '%s'.", main_args.record_filename.c_str());
+                context.conversation_recorder = new ConversationRecorder(main_args.record_filename);
+            }
+        }
+
+        if (main_args.telemetry_destination != "None")
+        {
+            XBT_INFO("Emitting telemetry to '%s' every %g seconds.",
+                     main_args.telemetry_destination.c_str(), main_args.telemetry_interval);
+            context.telemetry = new TelemetryEmitter(main_args.telemetry_destination,
+                                                     main_args.telemetry_interval,
+                                                     context.zmq_context);
+        }
+
+        // Let's create the message compressor (compressed replies are always accepted)
+        context.compressor = new MessageCompressor(context.compression_level);
 
         // Let's create the protocol reader and writer
-        context.proto_reader = new JsonProtocolReader(&context);
-        context.proto_writer = new JsonProtocolWriter(&context);
+        if (main_args.scheduler_plugin_filename != "None")
+        {
+            PluginProtocolReader * plugin_reader = new PluginProtocolReader(&context);
+            PluginProtocolWriter * plugin_writer = new PluginProtocolWriter(&context);
+            context.proto_reader = plugin_reader;
+            context.proto_writer = plugin_writer;
+            context.scheduler_plugin = new PluginScheduler(main_args.scheduler_plugin_filename,
+                                                           context.config_file,
+                                                           plugin_writer, plugin_reader);
+        }
+        else if (context.protocol_format == ProtocolFormat::MSGPACK)
+        {
+            context.proto_reader = new MsgpackProtocolReader(&context);
+            context.proto_writer = new MsgpackProtocolWriter(&context);
+        }
+        else
+        {
+            context.proto_reader = new JsonProtocolReader(&context);
+            context.proto_writer = new JsonProtocolWriter(&context);
+        }
 
         // Let's execute the initial processes
         start_initial_simulation_processes(main_args, &context);
@@ -765,12 +934,41 @@ int main(int argc, char * argv[])
     delete context.zmq_socket;
     context.zmq_socket = nullptr;
 
+    delete context.shm_transport;
+    context.shm_transport = nullptr;
+
+    delete context.scheduler_plugin;
+    context.scheduler_plugin = nullptr;
+
     delete context.proto_reader;
     context.proto_reader = nullptr;
 
     delete context.proto_writer;
     context.proto_writer = nullptr;
 
+    delete context.compressor;
+    context.compressor = nullptr;
+
+    delete context.telemetry;
+    context.telemetry = nullptr;
+
+    if (context.conversation_recorder != nullptr)
+    {
+        context.conversation_recorder->flush();
+        delete context.conversation_recorder;
+        context.conversation_recorder = nullptr;
+    }
+
+    if (context.conversation_replayer != nullptr)
+    {
+        if (!context.conversation_replayer->is_finished())
+        {
+            XBT_WARN("The simulation finished before the whole recorded conversation has been replayed.");
+        }
+        delete context.conversation_replayer;
+        context.conversation_replayer = nullptr;
+    }
+
     // If SMPI had been used, it should be finalized
     if (context.smpi_used)
     {
@@ -809,10 +1007,21 @@ void set_configuration(BatsimContext *context,
     string redis_prefix = default_config_doc["redis"]["prefix"].GetString();
 
     bool submission_forward_profiles = default_config_doc["job_submission"]["forward_profiles"].GetBool();
+    bool submission_batch_by_timestamp = default_config_doc["job_submission"]["batch_by_timestamp"].GetBool();
 
     bool submission_sched_enabled = default_config_doc["job_submission"]["from_scheduler"]["enabled"].GetBool();
     bool submission_sched_ack = default_config_doc["job_submission"]["from_scheduler"]["acknowledge"].GetBool();
 
+    string protocol_format = default_config_doc["protocol"]["format"].GetString();
+    string protocol_validation = default_config_doc["protocol"]["validation"].GetString();
+    int protocol_decimal_places = default_config_doc["protocol"]["decimal_places"].GetInt();
+    vector<string> protocol_deferred_events;
+    bool protocol_compact_resources = default_config_doc["protocol"]["compact_resources"].GetBool();
+    bool protocol_coalesce_calls = default_config_doc["protocol"]["coalesce_calls"].GetBool();
+    bool compression_enabled = default_config_doc["protocol"]["compression"]["enabled"].GetBool();
+    int compression_threshold = default_config_doc["protocol"]["compression"]["threshold"].GetInt();
+    int compression_level = default_config_doc["protocol"]["compression"]["level"].GetInt();
+
     // **********************************
     // Let's parse the configuration file
     // **********************************
@@ -864,6 +1073,13 @@ void set_configuration(BatsimContext *context,
             submission_forward_profiles = forward_profiles_value.GetBool();
         }
 
+        if (job_submission_object.HasMember("batch_by_timestamp"))
+        {
+            const Value & batch_by_timestamp_value = job_submission_object["batch_by_timestamp"];
+            xbt_assert(batch_by_timestamp_value.IsBool(), "Invalid JSON configuration: ['job_submission']['batch_by_timestamp'] should be a boolean.");
+            submission_batch_by_timestamp = batch_by_timestamp_value.GetBool();
+        }
+
         if (job_submission_object.HasMember("from_scheduler"))
         {
             const Value & from_sched_object = job_submission_object["from_scheduler"];
@@ -884,6 +1100,106 @@ void set_configuration(BatsimContext *context,
             }
         }
     }
+    if (main_object.HasMember("protocol"))
+    {
+        const Value & protocol_object = main_object["protocol"];
+        xbt_assert(protocol_object.IsObject(), "Invalid JSON configuration: ['protocol'] should be an object.");
+
+        if (protocol_object.HasMember("format"))
+        {
+            const Value & format_value = protocol_object["format"];
+            xbt_assert(format_value.IsString(), "Invalid JSON configuration: ['protocol']['format'] should be a string.");
+            protocol_format = format_value.GetString();
+            xbt_assert(protocol_format == "json" || protocol_format == "msgpack",
+                       "Invalid JSON configuration: ['protocol']['format'] should be 'json' or 'msgpack' (got '%s').",
+                       protocol_format.c_str());
+        }
+
+        if (protocol_object.HasMember("validation"))
+        {
+            const Value & validation_value = protocol_object["validation"];
+            xbt_assert(validation_value.IsString(), "Invalid JSON configuration: ['protocol']['validation'] should be a string.");
+            protocol_validation = validation_value.GetString();
+            xbt_assert(protocol_validation == "audit" || protocol_validation == "trusted",
+                       "Invalid JSON configuration: ['protocol']['validation'] should be 'audit' or 'trusted' (got '%s').",
+                       protocol_validation.c_str());
+        }
+
+        if (protocol_object.HasMember("decimal_places"))
+        {
+            const Value & decimal_places_value = protocol_object["decimal_places"];
+            xbt_assert(decimal_places_value.IsInt(), "Invalid JSON configuration: ['protocol']['decimal_places'] should be an integer.");
+            protocol_decimal_places = decimal_places_value.GetInt();
+            xbt_assert(protocol_decimal_places >= -1 && protocol_decimal_places <= ::Writer<StringOutputStream>::max_decimal_places,
+                       "Invalid JSON configuration: ['protocol']['decimal_places'] should be -1 or in [0,%d] (got %d).",
+                       ::Writer<StringOutputStream>::max_decimal_places, protocol_decimal_places);
+        }
+
+        if (protocol_object.HasMember("deferred_events"))
+        {
+            const vector<string> deferrable_events = {"JOB_SUBMITTED", "JOB_COMPLETED", "JOB_KILLED",
+                                                      "RESOURCE_STATE_CHANGED", "REQUESTED_CALL",
+                                                      "FROM_JOB_MSG", "ANSWER"};
+            const Value & deferred_events_value = protocol_object["deferred_events"];
+            xbt_assert(deferred_events_value.IsArray(), "Invalid JSON configuration: ['protocol']['deferred_events'] should be an array.");
+            for (SizeType i = 0; i < deferred_events_value.Size(); ++i)
+            {
+                const Value & event_type_value = deferred_events_value[i];
+                xbt_assert(event_type_value.IsString(), "Invalid JSON configuration: ['protocol']['deferred_events'] should only contain strings.");
+                string event_type = event_type_value.GetString();
+                xbt_assert(std::find(deferrable_events.begin(), deferrable_events.end(), event_type) != deferrable_events.end(),
+                           "Invalid JSON configuration: ['protocol']['deferred_events'] contains '%s', which cannot be deferred. "
+                           "Deferrable events are {%s}.", event_type.c_str(),
+                           boost::algorithm::join(deferrable_events, ", ").c_str());
+                protocol_deferred_events.push_back(event_type);
+            }
+        }
+
+        if (protocol_object.HasMember("compact_resources"))
+        {
+            const Value & compact_resources_value = protocol_object["compact_resources"];
+            xbt_assert(compact_resources_value.IsBool(), "Invalid JSON configuration: ['protocol']['compact_resources'] should be a boolean.");
+            protocol_compact_resources = compact_resources_value.GetBool();
+        }
+
+        if (protocol_object.HasMember("coalesce_calls"))
+        {
+            const Value & coalesce_calls_value = protocol_object["coalesce_calls"];
+            xbt_assert(coalesce_calls_value.IsBool(), "Invalid JSON configuration: ['protocol']['coalesce_calls'] should be a boolean.");
+            protocol_coalesce_calls = coalesce_calls_value.GetBool();
+        }
+
+        if (protocol_object.HasMember("compression"))
+        {
+            const Value & compression_object = protocol_object["compression"];
+            xbt_assert(compression_object.IsObject(), "Invalid JSON configuration: ['protocol']['compression'] should be an object.");
+
+            if (compression_object.HasMember("enabled"))
+            {
+                const Value & enabled_value = compression_object["enabled"];
+                xbt_assert(enabled_value.IsBool(), "Invalid JSON configuration: ['protocol']['compression']['enabled'] should be a boolean.");
+                compression_enabled = enabled_value.GetBool();
+            }
+
+            if (compression_object.HasMember("threshold"))
+            {
+                const Value & threshold_value = compression_object["threshold"];
+                xbt_assert(threshold_value.IsInt() && threshold_value.GetInt() >= 0,
+                           "Invalid JSON configuration: ['protocol']['compression']['threshold'] should be a non-negative integer.");
+                compression_threshold = threshold_value.GetInt();
+            }
+
+            if (compression_object.HasMember("level"))
+            {
+                const Value & level_value = compression_object["level"];
+                xbt_assert(level_value.IsInt(), "Invalid JSON configuration: ['protocol']['compression']['level'] should be an integer.");
+                compression_level = level_value.GetInt();
+                xbt_assert(compression_level >= 1 && compression_level <= ZSTD_maxCLevel(),
+                           "Invalid JSON configuration: ['protocol']['compression']['level'] should be in [1,%d] (got %d).",
+                           ZSTD_maxCLevel(), compression_level);
+            }
+        }
+    }
 
     // *****************************************************************
     // Let's override configuration values from main arguments if needed
@@ -906,8 +1222,18 @@ void set_configuration(BatsimContext *context,
     // *************************************
     context->redis_enabled = redis_enabled;
     context->submission_forward_profiles = submission_forward_profiles;
+    context->submission_batch_by_timestamp = submission_batch_by_timestamp;
     context->submission_sched_enabled = submission_sched_enabled;
     context->submission_sched_ack = submission_sched_ack;
+    context->protocol_format = protocol_format_from_string(protocol_format);
+    context->protocol_validation = protocol_validation_from_string(protocol_validation);
+    context->protocol_decimal_places = protocol_decimal_places;
+    context->protocol_deferred_events = protocol_deferred_events;
+    context->protocol_compact_resources = protocol_compact_resources;
+    context->protocol_coalesce_calls = protocol_coalesce_calls;
+    context->compression_enabled = compression_enabled;
+    context->compression_threshold = compression_threshold;
+    context->compression_level = compression_level;
 
     context->platform_filename = main_args.platform_filename;
     context->export_prefix = main_args.export_prefix;
@@ -997,6 +1323,12 @@ void set_configuration(BatsimContext *context,
         mit_job_submission->value.AddMember("forward_profiles", Value().SetBool(submission_forward_profiles), alloc);
     }
 
+    // job_submission->batch_by_timestamp
+    if (mit_job_submission->value.FindMember("batch_by_timestamp") == mit_job_submission->value.MemberEnd())
+    {
+        mit_job_submission->value.AddMember("batch_by_timestamp", Value().SetBool(submission_batch_by_timestamp), alloc);
+    }
+
     // job_submission->from_scheduler
     auto mit_job_submission_from_sched = mit_job_submission->value.FindMember("from_scheduler");
     if (mit_job_submission_from_sched == mit_job_submission->value.MemberEnd())
@@ -1017,4 +1349,79 @@ void set_configuration(BatsimContext *context,
     {
         from_sched_value.AddMember("acknowledge", Value().SetBool(submission_sched_ack), alloc);
     }
+
+    // protocol
+    auto mit_protocol = context->config_file.FindMember("protocol");
+    if (mit_protocol == context->config_file.MemberEnd())
+    {
+        context->config_file.AddMember("protocol", Value().SetObject(), alloc);
+        mit_protocol = context->config_file.FindMember("protocol");
+    }
+
+    // protocol->format
+    if (mit_protocol->value.FindMember("format") == mit_protocol->value.MemberEnd())
+    {
+        mit_protocol->value.AddMember("format", Value().SetString(protocol_format.c_str(), alloc), alloc);
+    }
+
+    // protocol->validation
+    if (mit_protocol->value.FindMember("validation") == mit_protocol->value.MemberEnd())
+    {
+        mit_protocol->value.AddMember("validation", Value().SetString(protocol_validation.c_str(), alloc), alloc);
+    }
+
+    // protocol->decimal_places
+    if (mit_protocol->value.FindMember("decimal_places") == mit_protocol->value.MemberEnd())
+    {
+        mit_protocol->value.AddMember("decimal_places", Value().SetInt(protocol_decimal_places), alloc);
+    }
+
+    // protocol->deferred_events
+    if (mit_protocol->value.FindMember("deferred_events") == mit_protocol->value.MemberEnd())
+    {
+        Value deferred_events_value(kArrayType);
+        for (const string & event_type : protocol_deferred_events)
+        {
+            deferred_events_value.PushBack(Value().SetString(event_type.c_str(), alloc), alloc);
+        }
+        mit_protocol->value.AddMember("deferred_events", deferred_events_value, alloc);
+    }
+
+    // protocol->compact_resources
+    if (mit_protocol->value.FindMember("compact_resources") == mit_protocol->value.MemberEnd())
+    {
+        mit_protocol->value.AddMember("compact_resources", Value().SetBool(protocol_compact_resources), alloc);
+    }
+
+    // protocol->coalesce_calls
+    if (mit_protocol->value.FindMember("coalesce_calls") == mit_protocol->value.MemberEnd())
+    {
+        mit_protocol->value.AddMember("coalesce_calls", Value().SetBool(protocol_coalesce_calls), alloc);
+    }
+
+    // protocol->compression
+    auto mit_compression = mit_protocol->value.FindMember("compression");
+    if (mit_compression == mit_protocol->value.MemberEnd())
+    {
+        mit_protocol->value.AddMember("compression", Value().SetObject(), alloc);
+        mit_compression = mit_protocol->value.FindMember("compression");
+    }
+
+    // protocol->compression->enabled
+    if (mit_compression->value.FindMember("enabled") == mit_compression->value.MemberEnd())
+    {
+        mit_compression->value.AddMember("enabled", Value().SetBool(compression_enabled), alloc);
+    }
+
+    // protocol->compression->threshold
+    if (mit_compression->value.FindMember("threshold") == mit_compression->value.MemberEnd())
+    {
+        mit_compression->value.AddMember("threshold", Value().SetInt(compression_threshold), alloc);
+    }
+
+    // protocol->compression->level
+    if (mit_compression->value.FindMember("level") == mit_compression->value.MemberEnd())
+    {
+        mit_compression->value.AddMember("level", Value().SetInt(compression_level), alloc);
+    }
 }
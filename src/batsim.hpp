@@ -62,6 +62,7 @@ struct MainArguments
     // Input
     std::string platform_filename;                          //!< The SimGrid platform filename
     std::list<WorkloadDescription> workload_descriptions;   //!< The workloads descriptions
+    bool lazy_workloads;                                    //!< If set to true, the jobs of the workloads are read from their files when they are submitted
     std::list<WorkflowDescription> workflow_descriptions;   //!< The workflows descriptions
 
     // Common
@@ -74,12 +75,17 @@ struct MainArguments
     std::string redis_hostname;                             //!< The Redis (data storage) server host name
     int redis_port;                                         //!< The Redis (data storage) server port
     std::string redis_prefix;                               //!< The Redis (data storage) instance prefix
+    std::string record_filename;                            //!< The file in which the conversation with the scheduler is recorded ("None" if disabled)
+    std::string replay_filename;                            //!< The file from which a conversation is replayed instead of using a scheduler ("None" if disabled)
+    std::string scheduler_plugin_filename;                  //!< The shared library from which the scheduler is loaded into Batsim's process ("None" if disabled)
 
     // Output
     std::string export_prefix;                              //!< The filename prefix used to export simulation information
     bool enable_simgrid_process_tracing;                    //!< If set to true, this option enables the tracing of SimGrid processes
     bool enable_schedule_tracing;                           //!< If set to true, the schedule is exported to a Pajé trace file
     bool enable_machine_state_tracing;                      //!< If set to true, this option enables the tracing of the machine states into a CSV time series.
+    std::string telemetry_destination;                      //!< The ZeroMQ endpoint or the file to which the simulation progress is emitted ("None" if disabled)
+    double telemetry_interval;                              //!< The wall-clock time between two telemetry records (in seconds)
 
     // Platform size limit
     int limit_machines_count;                               //!< The number of machines to use to compute jobs. 0 : no limit. > 0 : the number of computation machines
@@ -107,9 +113,11 @@ struct MainArguments
  * @param[out] return_code Batsim's return code (used directly if false is returned)
  * @param[out] run_simulation Whether the simulation should be run afterwards
  * @param[out] run_unit_tests Whether the unit tests should be run afterwards
+ * @param[out] run_benchmarks Whether the benchmarks should be run afterwards
  */
 void parse_main_args(int argc, char * argv[], MainArguments & main_args,
-                     int & return_code, bool & run_simulation, bool & run_unit_tests);
+                     int & return_code, bool & run_simulation, bool & run_unit_tests,
+                     bool & run_benchmarks);
 
 /**
  * @brief Configures how the simulation should be logged
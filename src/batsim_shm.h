@@ -0,0 +1,331 @@
+/**
+ * @file batsim_shm.h
+ * @brief Contains the shared-memory transport between Batsim and a co-located scheduler (C ABI)
+ * @details This header is plain C (gnu99 or later, Linux only) so that
+ *          schedulers written in any language can use it, either by including it or by
+ *          following the layout described below (e.g. with Python's mmap and ctypes modules).
+ *
+ *          Batsim creates a POSIX shared memory object (see shm_open) when its socket endpoint
+ *          is "shm://<name>". The object contains a batsim_shm_header followed by two data areas
+ *          of batsim_shm_header::capacity bytes: the one of the ring from Batsim to the scheduler,
+ *          then the one of the ring from the scheduler to Batsim.
+ *
+ *          Each ring is a single-producer single-consumer byte queue. A message is written as its
+ *          size (64-bit little-endian unsigned integer) followed by its bytes. Messages bigger than
+ *          the ring are streamed through it, so the capacity does not limit the message size.
+ *          Batsim however rejects the messages bigger than BATSIM_SHM_MAX_MESSAGE_SIZE.
+ *          The sides spin for a while when they wait for the other one, then sleep on a futex.
+ *
+ *          Like with the ZeroMQ socket, Batsim sends a message then waits for the reply of the
+ *          scheduler. The scheduler therefore reads from BATSIM_SHM_TO_SCHEDULER and writes into
+ *          BATSIM_SHM_TO_BATSIM. Either side may set batsim_shm_header::closed to leave.
+ */
+
+#ifndef BATSIM_SHM_H
+#define BATSIM_SHM_H
+
+#include <fcntl.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define BATSIM_SHM_MAGIC 0x4d485342u          /**< The first bytes of the shared memory object ("BSHM") */
+#define BATSIM_SHM_VERSION 1u                 /**< The version of the shared memory layout */
+#define BATSIM_SHM_DEFAULT_CAPACITY (1u << 20) /**< The default size of the data area of each ring */
+#define BATSIM_SHM_SPIN_ITERATIONS 4096       /**< How many times a side polls before sleeping on a futex */
+#define BATSIM_SHM_MAX_MESSAGE_SIZE (UINT64_C(1) << 32) /**< The size of the biggest message Batsim accepts */
+
+#define BATSIM_SHM_TO_SCHEDULER 0             /**< The direction of the messages sent by Batsim */
+#define BATSIM_SHM_TO_BATSIM 1                /**< The direction of the messages sent by the scheduler */
+
+/**
+ * @brief The control block of a ring (64 bytes)
+ */
+struct batsim_shm_ring
+{
+    uint64_t write_position;    /**< The number of bytes written into the ring since its creation. Only modified by the writer */
+    uint64_t read_position;     /**< The number of bytes read from the ring since its creation. Only modified by the reader */
+    uint32_t data_sequence;     /**< Futex word, incremented by the writer each time it publishes bytes */
+    uint32_t space_sequence;    /**< Futex word, incremented by the reader each time it consumes bytes */
+    uint32_t data_waiters;      /**< The number of readers sleeping on data_sequence */
+    uint32_t space_waiters;     /**< The number of writers sleeping on space_sequence */
+    uint32_t padding[8];        /**< Unused */
+};
+
+/**
+ * @brief The beginning of the shared memory object (192 bytes)
+ */
+struct batsim_shm_header
+{
+    uint32_t magic;             /**< BATSIM_SHM_MAGIC, written last by Batsim once the object is ready */
+    uint32_t version;           /**< BATSIM_SHM_VERSION */
+    uint64_t capacity;          /**< The size of the data area of each ring, in bytes. A power of two */
+    uint32_t closed;            /**< Set to 1 by the side which leaves */
+    uint32_t padding[11];       /**< Unused */
+    struct batsim_shm_ring rings[2]; /**< The rings, indexed by BATSIM_SHM_TO_SCHEDULER and BATSIM_SHM_TO_BATSIM */
+};
+
+/**
+ * @brief Returns the size of a shared memory object
+ * @param[in] capacity The size of the data area of each ring
+ * @return The size of the shared memory object
+ */
+static inline size_t batsim_shm_size(uint64_t capacity)
+{
+    return sizeof(struct batsim_shm_header) + 2 * capacity;
+}
+
+/**
+ * @brief Returns the data area of a ring
+ * @param[in] header The shared memory object
+ * @param[in] direction BATSIM_SHM_TO_SCHEDULER or BATSIM_SHM_TO_BATSIM
+ * @return The data area of the ring
+ */
+static inline char * batsim_shm_data(struct batsim_shm_header * header, int direction)
+{
+    return (char *) (header + 1) + direction * header->capacity;
+}
+
+/**
+ * @brief Waits until a futex word differs from a previously seen value
+ * @param[in] header The shared memory object
+ * @param[in] sequence The futex word
+ * @param[in] waiters The number of sides sleeping on the futex word
+ * @param[in] seen The previously seen value
+ * @return 0 once the value has changed, -1 if the other side left
+ */
+static inline int batsim_shm_wait(struct batsim_shm_header * header, uint32_t * sequence,
+                                  uint32_t * waiters, uint32_t seen)
+{
+    for (int i = 0; i < BATSIM_SHM_SPIN_ITERATIONS; ++i)
+    {
+        if (__atomic_load_n(sequence, __ATOMIC_ACQUIRE) != seen)
+        {
+            return 0;
+        }
+    }
+
+    __atomic_add_fetch(waiters, 1, __ATOMIC_SEQ_CST);
+    while (__atomic_load_n(sequence, __ATOMIC_SEQ_CST) == seen &&
+           !__atomic_load_n(&header->closed, __ATOMIC_SEQ_CST))
+    {
+        syscall(SYS_futex, sequence, FUTEX_WAIT, seen, NULL, NULL, 0);
+    }
+    __atomic_sub_fetch(waiters, 1, __ATOMIC_SEQ_CST);
+
+    return __atomic_load_n(sequence, __ATOMIC_ACQUIRE) != seen ? 0 : -1;
+}
+
+/**
+ * @brief Increments a futex word and wakes up the side sleeping on it, if any
+ * @param[in] sequence The futex word
+ * @param[in] waiters The number of sides sleeping on the futex word
+ */
+static inline void batsim_shm_notify(uint32_t * sequence, uint32_t * waiters)
+{
+    __atomic_add_fetch(sequence, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(waiters, __ATOMIC_SEQ_CST) > 0)
+    {
+        syscall(SYS_futex, sequence, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+    }
+}
+
+/**
+ * @brief Writes bytes into a ring, waiting for free space when needed
+ * @param[in] header The shared memory object
+ * @param[in] direction BATSIM_SHM_TO_SCHEDULER or BATSIM_SHM_TO_BATSIM
+ * @param[in] bytes The bytes
+ * @param[in] size The number of bytes
+ * @return 0 on success, -1 if the other side left
+ */
+static inline int batsim_shm_write(struct batsim_shm_header * header, int direction,
+                                   const void * bytes, uint64_t size)
+{
+    struct batsim_shm_ring * ring = &header->rings[direction];
+    char * data = batsim_shm_data(header, direction);
+    const char * source = (const char *) bytes;
+
+    while (size > 0)
+    {
+        uint32_t seen = __atomic_load_n(&ring->space_sequence, __ATOMIC_SEQ_CST);
+        uint64_t write_position = ring->write_position;
+        uint64_t free_bytes = header->capacity - (write_position - __atomic_load_n(&ring->read_position, __ATOMIC_ACQUIRE));
+        if (free_bytes == 0)
+        {
+            if (batsim_shm_wait(header, &ring->space_sequence, &ring->space_waiters, seen) != 0)
+            {
+                return -1;
+            }
+            continue;
+        }
+
+        uint64_t chunk = size < free_bytes ? size : free_bytes;
+        uint64_t offset = write_position & (header->capacity - 1);
+        uint64_t first_part = chunk < header->capacity - offset ? chunk : header->capacity - offset;
+        memcpy(data + offset, source, first_part);
+        memcpy(data, source + first_part, chunk - first_part);
+
+        __atomic_store_n(&ring->write_position, write_position + chunk, __ATOMIC_RELEASE);
+        batsim_shm_notify(&ring->data_sequence, &ring->data_waiters);
+
+        source += chunk;
+        size -= chunk;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Reads bytes from a ring, waiting for them when needed
+ * @param[in] header The shared memory object
+ * @param[in] direction BATSIM_SHM_TO_SCHEDULER or BATSIM_SHM_TO_BATSIM
+ * @param[out] bytes The buffer in which the bytes are read
+ * @param[in] size The number of bytes to read
+ * @return 0 on success, -1 if the other side left
+ */
+static inline int batsim_shm_read(struct batsim_shm_header * header, int direction,
+                                  void * bytes, uint64_t size)
+{
+    struct batsim_shm_ring * ring = &header->rings[direction];
+    const char * data = batsim_shm_data(header, direction);
+    char * destination = (char *) bytes;
+
+    while (size > 0)
+    {
+        uint32_t seen = __atomic_load_n(&ring->data_sequence, __ATOMIC_SEQ_CST);
+        uint64_t read_position = ring->read_position;
+        uint64_t available_bytes = __atomic_load_n(&ring->write_position, __ATOMIC_ACQUIRE) - read_position;
+        if (available_bytes == 0)
+        {
+            if (batsim_shm_wait(header, &ring->data_sequence, &ring->data_waiters, seen) != 0)
+            {
+                return -1;
+            }
+            continue;
+        }
+
+        uint64_t chunk = size < available_bytes ? size : available_bytes;
+        uint64_t offset = read_position & (header->capacity - 1);
+        uint64_t first_part = chunk < header->capacity - offset ? chunk : header->capacity - offset;
+        memcpy(destination, data + offset, first_part);
+        memcpy(destination + first_part, data, chunk - first_part);
+
+        __atomic_store_n(&ring->read_position, read_position + chunk, __ATOMIC_RELEASE);
+        batsim_shm_notify(&ring->space_sequence, &ring->space_waiters);
+
+        destination += chunk;
+        size -= chunk;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Sends a message
+ * @param[in] header The shared memory object
+ * @param[in] direction BATSIM_SHM_TO_BATSIM on the scheduler side
+ * @param[in] message The message bytes
+ * @param[in] size The message size
+ * @return 0 on success, -1 if the other side left
+ */
+static inline int batsim_shm_send(struct batsim_shm_header * header, int direction,
+                                  const void * message, uint64_t size)
+{
+    unsigned char size_bytes[8];
+    for (int i = 0; i < 8; ++i)
+    {
+        size_bytes[i] = (unsigned char) ((size >> (8 * i)) & 0xff);
+    }
+
+    if (batsim_shm_write(header, direction, size_bytes, sizeof(size_bytes)) != 0)
+    {
+        return -1;
+    }
+    return batsim_shm_write(header, direction, message, size);
+}
+
+/**
+ * @brief Waits for a message and reads its size. Its bytes must then be read with batsim_shm_read.
+ * @param[in] header The shared memory object
+ * @param[in] direction BATSIM_SHM_TO_SCHEDULER on the scheduler side
+ * @param[out] size The message size
+ * @return 0 on success, -1 if the other side left
+ */
+static inline int batsim_shm_recv_size(struct batsim_shm_header * header, int direction, uint64_t * size)
+{
+    unsigned char size_bytes[8];
+    if (batsim_shm_read(header, direction, size_bytes, sizeof(size_bytes)) != 0)
+    {
+        return -1;
+    }
+
+    *size = 0;
+    for (int i = 0; i < 8; ++i)
+    {
+        *size |= ((uint64_t) size_bytes[i]) << (8 * i);
+    }
+    return 0;
+}
+
+/**
+ * @brief Maps the shared memory object created by Batsim (scheduler side)
+ * @param[in] name The name of the object, as in Batsim's "shm://<name>" endpoint (e.g. "/batsim")
+ * @return The shared memory object, or NULL if it does not exist (yet) or is invalid
+ */
+static inline struct batsim_shm_header * batsim_shm_attach(const char * name)
+{
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+
+    struct stat file_status;
+    if (fstat(fd, &file_status) != 0 || (size_t) file_status.st_size < sizeof(struct batsim_shm_header))
+    {
+        close(fd);
+        return NULL;
+    }
+
+    void * memory = mmap(NULL, file_status.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    struct batsim_shm_header * header = (struct batsim_shm_header *) memory;
+    if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != BATSIM_SHM_MAGIC ||
+        header->version != BATSIM_SHM_VERSION ||
+        batsim_shm_size(header->capacity) != (size_t) file_status.st_size)
+    {
+        munmap(memory, file_status.st_size);
+        return NULL;
+    }
+
+    return header;
+}
+
+/**
+ * @brief Leaves a shared memory object and unmaps it
+ * @param[in] header The shared memory object
+ */
+static inline void batsim_shm_detach(struct batsim_shm_header * header)
+{
+    __atomic_store_n(&header->closed, 1, __ATOMIC_SEQ_CST);
+    for (int direction = 0; direction < 2; ++direction)
+    {
+        batsim_shm_notify(&header->rings[direction].data_sequence, &header->rings[direction].data_waiters);
+        batsim_shm_notify(&header->rings[direction].space_sequence, &header->rings[direction].space_waiters);
+    }
+
+    munmap(header, batsim_shm_size(header->capacity));
+}
+
+#endif
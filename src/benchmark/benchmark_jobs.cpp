@@ -0,0 +1,185 @@
+#include "benchmark_jobs.hpp"
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <deque>
+#include <set>
+#include <string>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include <xbt.h>
+
+#include "../jobs.hpp"
+
+using namespace std;
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(benchmark_jobs, "benchmark_jobs"); //!< Logging
+
+namespace
+{
+    /**
+     * @brief The layout of a Job before its rarely used data was split out and its times became doubles
+     * @details It was allocated by the global operator new, like this struct.
+     */
+    struct LegacyJob
+    {
+        struct Identifier
+        {
+            string workload_name;
+            int job_number;
+        };
+
+        Workload * workload = nullptr;
+        int number;
+        Identifier id;
+        BatTask * task = nullptr;
+        string json_description;
+        set<msg_process_t> execution_processes;
+        deque<string> incoming_message_buffer;
+        MachineRange allocation;
+        vector<int> smpi_ranks_to_hosts_mapping;
+        string metadata;
+        JobState state;
+        Rational starting_time;
+        Rational runtime;
+        string kill_reason;
+        bool kill_requested = false;
+        long double consumed_energy;
+        string profile;
+        Rational submission_time;
+        Rational walltime = -1;
+        int required_nb_res;
+        int return_code = -1;
+    };
+
+    /**
+     * @brief Returns the number of heap bytes in use
+     * @details Big blocks (such as the chunks of the job pool) are mapped by glibc rather than taken
+     *          from the heap arena: they are counted in hblkhd, not in uordblks.
+     */
+    size_t heap_bytes_in_use()
+    {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+        struct mallinfo2 info = mallinfo2();
+        return info.uordblks + info.hblkhd;
+#elif defined(__GLIBC__)
+        // mallinfo2 appeared in glibc 2.33. The int fields of mallinfo wrap around beyond 4 GiB.
+        struct mallinfo info = mallinfo();
+        return (size_t)(unsigned int) info.uordblks + (size_t)(unsigned int) info.hblkhd;
+#else
+        return 0; // The heap usage is unknown
+#endif
+    }
+
+    /**
+     * @brief Builds jobs like the ones of a submitted and executed workload and returns their heap bytes per job
+     * @details The blocks a pool gives back from its free list are not heap growth, they are counted separately.
+     * @param[in] nb_jobs The number of jobs to build
+     * @param[in] set_identifier Sets the identifier of a job from its workload name and number
+     * @param[in] nb_pooled_blocks Returns the number of blocks owned by the pool of JobType (0 if not pooled)
+     */
+    template <typename JobType, typename SetIdentifier, typename NbPooledBlocks>
+    size_t heap_bytes_per_job(int nb_jobs, SetIdentifier set_identifier, NbPooledBlocks nb_pooled_blocks)
+    {
+        vector<JobType *> jobs;
+        jobs.reserve(nb_jobs);
+
+        const int pooled_blocks_before = nb_pooled_blocks();
+        const size_t heap_before = heap_bytes_in_use();
+        for (int i = 0; i < nb_jobs; ++i)
+        {
+            JobType * job = new JobType;
+            job->number = i;
+            set_identifier(job, "w0", i);
+            job->json_description = R"({"id":"w0!)" + to_string(i) + R"(","subtime":)" + to_string(i) +
+                                    R"(,"res":4,"profile":"p1"})";
+            job->profile = "p1";
+            job->required_nb_res = 4;
+            job->submission_time = i;
+            job->walltime = 3600;
+            job->starting_time = i + 1.5;
+            job->runtime = 100.25;
+            job->allocation.insert(MachineRange::ClosedInterval(0, 3));
+            jobs.push_back(job);
+        }
+        size_t heap_bytes = heap_bytes_in_use() - heap_before;
+
+        const int nb_new_blocks = nb_pooled_blocks() - pooled_blocks_before;
+        heap_bytes += max(0, nb_jobs - nb_new_blocks) * sizeof(JobType);
+
+        for (JobType * job : jobs)
+        {
+            delete job;
+        }
+        return heap_bytes / nb_jobs;
+    }
+
+    /**
+     * @brief Runs a measure in a child process, so that the memory it uses is given back to the system
+     * @param[in] measure The measure, which returns a size
+     * @return The size returned by the measure
+     */
+    template <typename Measure>
+    size_t measure_in_child_process(Measure measure)
+    {
+        int fds[2];
+        int ret = pipe(fds);
+        (void) ret; // Avoids a warning if assertions are ignored
+        xbt_assert(ret == 0, "Cannot create a pipe");
+
+        pid_t pid = fork();
+        xbt_assert(pid >= 0, "Cannot fork");
+        if (pid == 0)
+        {
+            close(fds[0]);
+            size_t result = measure();
+            _exit(write(fds[1], &result, sizeof(result)) == (ssize_t) sizeof(result) ? 0 : 1);
+        }
+
+        close(fds[1]);
+        size_t result = 0;
+        ssize_t nb_read = read(fds[0], &result, sizeof(result));
+        (void) nb_read;
+        close(fds[0]);
+
+        int status = 0;
+        waitpid(pid, &status, 0);
+        xbt_assert(nb_read == (ssize_t) sizeof(result) && WIFEXITED(status) && WEXITSTATUS(status) == 0,
+                   "The measure failed in the child process");
+        return result;
+    }
+}
+
+void benchmark_job_memory_footprint()
+{
+    const int nb_jobs = 1000000;
+
+    const size_t legacy_heap = measure_in_child_process([nb_jobs]()
+    {
+        return heap_bytes_per_job<LegacyJob>(nb_jobs,
+            [](LegacyJob * job, const string & workload_name, int number)
+            {
+                job->id = {workload_name, number};
+            },
+            []() { return 0; });
+    });
+    const size_t heap = measure_in_child_process([nb_jobs]()
+    {
+        return heap_bytes_per_job<Job>(nb_jobs,
+            [](Job * job, const string & workload_name, int number)
+            {
+                job->id = JobIdentifier(workload_name, number);
+            },
+            []() { return FreeListPool<Job, 1024>::nb_blocks(); });
+    });
+
+    XBT_INFO("Memory used by %d jobs: sizeof(Job) %zu -> %zu bytes, heap per job %zu -> %zu bytes",
+             nb_jobs, sizeof(LegacyJob), sizeof(Job), legacy_heap, heap);
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+/**
+ * @brief Compares the memory used by the jobs with the one they used before their rarely used data was
+ *        split out and their times became doubles
+ */
+void benchmark_job_memory_footprint();
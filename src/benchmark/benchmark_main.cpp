@@ -0,0 +1,10 @@
+#include "benchmark_main.hpp"
+
+#include "benchmark_jobs.hpp"
+#include "benchmark_server.hpp"
+
+void benchmark_entry_point()
+{
+    benchmark_server_message_dispatch();
+    benchmark_job_memory_footprint();
+}
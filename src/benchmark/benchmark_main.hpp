@@ -0,0 +1,8 @@
+#pragma once
+
+/**
+ * @brief Benchmarks entry point (main function)
+ * @details The benchmarks measure Batsim's internals. They are not part of the unit tests, as they
+ *          take time and memory.
+ */
+void benchmark_entry_point();
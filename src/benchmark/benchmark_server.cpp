@@ -0,0 +1,127 @@
+#include "benchmark_server.hpp"
+
+#include <chrono>
+#include <functional>
+#include <map>
+
+#include <xbt.h>
+
+#include "../ipp.hpp"
+#include "../server.hpp"
+
+using namespace std;
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(benchmark_server, "benchmark_server"); //!< Logging
+XBT_LOG_EXTERNAL_CATEGORY(server);
+
+namespace
+{
+    typedef map<IPMessageType, function<void(ServerData *, IPMessage *)>> LegacyHandlerMap;
+
+    /**
+     * @brief Builds the handlers like the server did before they were stored in a table
+     * @return The handlers
+     */
+    LegacyHandlerMap legacy_server_message_handlers()
+    {
+        LegacyHandlerMap handler_map;
+        handler_map[IPMessageType::JOB_SUBMITTED] = server_on_job_submitted;
+        handler_map[IPMessageType::JOB_SUBMITTED_BY_DP] = server_on_submit_job;
+        handler_map[IPMessageType::PROFILE_SUBMITTED_BY_DP] = server_on_submit_profile;
+        handler_map[IPMessageType::JOB_COMPLETED] = server_on_job_completed;
+        handler_map[IPMessageType::PSTATE_MODIFICATION] = server_on_pstate_modification;
+        handler_map[IPMessageType::SCHED_EXECUTE_JOB] = server_on_execute_job;
+        handler_map[IPMessageType::SCHED_EXECUTE_JOBS] = server_on_execute_jobs;
+        handler_map[IPMessageType::SCHED_CHANGE_JOB_STATE] = server_on_change_job_state;
+        handler_map[IPMessageType::TO_JOB_MSG] = server_on_to_job_msg;
+        handler_map[IPMessageType::FROM_JOB_MSG] = server_on_from_job_msg;
+        handler_map[IPMessageType::SCHED_REJECT_JOB] = server_on_reject_job;
+        handler_map[IPMessageType::SCHED_KILL_JOB] = server_on_kill_jobs;
+        handler_map[IPMessageType::SCHED_CALL_ME_LATER] = server_on_call_me_later;
+        handler_map[IPMessageType::SCHED_TELL_ME_ENERGY] = server_on_sched_tell_me_energy;
+        handler_map[IPMessageType::SCHED_WAIT_ANSWER] = server_on_sched_wait_answer;
+        handler_map[IPMessageType::WAIT_QUERY] = server_on_wait_query;
+        handler_map[IPMessageType::SCHED_READY] = server_on_sched_ready;
+        handler_map[IPMessageType::WAITING_DONE] = server_on_waiting_done;
+        handler_map[IPMessageType::KILLING_DONE] = server_on_killing_done;
+        handler_map[IPMessageType::SUBMITTER_HELLO] = server_on_submitter_hello;
+        handler_map[IPMessageType::SUBMITTER_BYE] = server_on_submitter_bye;
+        handler_map[IPMessageType::SWITCHED_ON] = server_on_switched;
+        handler_map[IPMessageType::SWITCHED_OFF] = server_on_switched;
+        handler_map[IPMessageType::END_DYNAMIC_SUBMIT] = server_on_end_dynamic_submit;
+        handler_map[IPMessageType::CONTINUE_DYNAMIC_SUBMIT] = server_on_continue_dynamic_submit;
+        return handler_map;
+    }
+
+    /**
+     * @brief Handles a message like the server did before its handlers were stored in a table
+     * @details The handlers were stored in a std::map of std::function, searched twice and copied for every message
+     */
+    void legacy_handle_server_message(LegacyHandlerMap & handler_map,
+                                      ServerData * data,
+                                      IPMessage * task_data)
+    {
+        XBT_CINFO(server, "Server received a message of type %s:",
+                  ip_message_type_to_string(task_data->type));
+
+        xbt_assert(handler_map.count(task_data->type) == 1,
+                   "The server does not know how to handle message type %s.",
+                   ip_message_type_to_string(task_data->type));
+        auto handler_function = handler_map[task_data->type];
+        handler_function(data, task_data);
+
+        delete task_data;
+    }
+
+    /**
+     * @brief Returns the time spent per message to handle nb_messages SCHED_READY messages, in nanoseconds
+     * @param[in] nb_messages The number of messages to handle
+     * @param[in,out] data The data associated with the server_process
+     * @param[in] handle The function that handles a message
+     */
+    template <typename HandleFunction>
+    double nanoseconds_per_message(int nb_messages, ServerData * data, HandleFunction handle)
+    {
+        auto begin = chrono::steady_clock::now();
+        for (int i = 0; i < nb_messages; ++i)
+        {
+            data->sched_ready = false;
+
+            IPMessage * message = new IPMessage;
+            message->type = IPMessageType::SCHED_READY;
+            message->data = nullptr;
+            handle(message);
+
+            xbt_assert(data->sched_ready, "The SCHED_READY message has not been handled");
+        }
+        auto end = chrono::steady_clock::now();
+
+        return chrono::duration<double, nano>(end - begin).count() / nb_messages;
+    }
+}
+
+void benchmark_server_message_dispatch()
+{
+    const ServerMessageHandlers & handlers = server_message_handlers();
+    LegacyHandlerMap handler_map = legacy_server_message_handlers();
+
+    // The per-message logging is disabled, as in a simulation run with a quiet verbosity
+    const int previous_threshold = _XBT_LOGV(server).threshold;
+    xbt_log_threshold_set(&_XBT_LOGV(server), xbt_log_priority_warning);
+
+    ServerData data;
+    const int nb_messages = 1000000;
+    double legacy_ns = nanoseconds_per_message(nb_messages, &data, [&](IPMessage * message)
+    {
+        legacy_handle_server_message(handler_map, &data, message);
+    });
+    double table_ns = nanoseconds_per_message(nb_messages, &data, [&](IPMessage * message)
+    {
+        handle_server_message(handlers, &data, message);
+    });
+
+    xbt_log_threshold_set(&_XBT_LOGV(server), (e_xbt_log_priority_t) previous_threshold);
+
+    XBT_INFO("Server message dispatch overhead (%d messages): %.1f ns -> %.1f ns per message",
+             nb_messages, legacy_ns, table_ns);
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+/**
+ * @brief Compares the time the server spends to dispatch a message with a handler table and with the
+ *        std::map of std::function it used before
+ */
+void benchmark_server_message_dispatch();
@@ -0,0 +1,202 @@
+/**
+ * @file binary_workload.cpp
+ * @brief Contains the binary workload format, which is used without being parsed
+ */
+
+#include "binary_workload.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <xbt.h>
+
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include "batsim.hpp"
+#include "jobs.hpp"
+#include "network.hpp"
+#include "profiles.hpp"
+#include "workload.hpp"
+
+using namespace std;
+using namespace rapidjson;
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(binary_workload, "binary_workload"); //!< Logging
+
+BinaryWorkloadFile::BinaryWorkloadFile(const string & filename) :
+    _filename(filename)
+{
+    int fd = open(filename.c_str(), O_RDONLY);
+    xbt_assert(fd != -1, "Cannot read file '%s'", filename.c_str());
+
+    struct stat file_stat;
+    int stat_ret = fstat(fd, &file_stat);
+    (void) stat_ret; // Avoids a warning if assertions are ignored
+    xbt_assert(stat_ret == 0, "Cannot stat file '%s'", filename.c_str());
+    _mapping_size = file_stat.st_size;
+    xbt_assert(_mapping_size >= sizeof(BinaryWorkloadHeader),
+               "Invalid binary workload '%s': the file is too small", filename.c_str());
+
+    _mapping = mmap(nullptr, _mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    xbt_assert(_mapping != MAP_FAILED, "Cannot map file '%s' in memory", filename.c_str());
+
+    const char * base = static_cast<const char *>(_mapping);
+    _header = reinterpret_cast<const BinaryWorkloadHeader *>(base);
+
+    xbt_assert(memcmp(_header->magic, BINARY_WORKLOAD_MAGIC, sizeof(BINARY_WORKLOAD_MAGIC)) == 0,
+               "Invalid binary workload '%s': bad magic", filename.c_str());
+    xbt_assert(_header->byte_order == BINARY_WORKLOAD_BYTE_ORDER,
+               "Invalid binary workload '%s': the file has been written with another byte order. "
+               "Please convert the JSON workload again on this machine.", filename.c_str());
+    xbt_assert(_header->version == BINARY_WORKLOAD_VERSION,
+               "Invalid binary workload '%s': version %u is not supported (expected %u). "
+               "Please convert the JSON workload again.",
+               filename.c_str(), _header->version, BINARY_WORKLOAD_VERSION);
+
+    // Sections are checked once, so that records can then be accessed without bound checks
+    xbt_assert(_header->jobs_offset % alignof(BinaryJobRecord) == 0 &&
+               _header->jobs_offset <= _mapping_size &&
+               _header->nb_jobs <= (_mapping_size - _header->jobs_offset) / sizeof(BinaryJobRecord),
+               "Invalid binary workload '%s': the job records are out of the file", filename.c_str());
+    xbt_assert(_header->profiles_offset % alignof(BinaryProfileRecord) == 0 &&
+               _header->profiles_offset <= _mapping_size &&
+               _header->nb_profiles <= (_mapping_size - _header->profiles_offset) / sizeof(BinaryProfileRecord),
+               "Invalid binary workload '%s': the profile records are out of the file", filename.c_str());
+    xbt_assert(_header->strings_offset <= _mapping_size &&
+               _header->strings_size <= _mapping_size - _header->strings_offset,
+               "Invalid binary workload '%s': the string pool is out of the file", filename.c_str());
+
+    _jobs = reinterpret_cast<const BinaryJobRecord *>(base + _header->jobs_offset);
+    _profiles = reinterpret_cast<const BinaryProfileRecord *>(base + _header->profiles_offset);
+    _strings = base + _header->strings_offset;
+}
+
+BinaryWorkloadFile::~BinaryWorkloadFile()
+{
+    if (_mapping != nullptr)
+    {
+        munmap(_mapping, _mapping_size);
+        _mapping = nullptr;
+    }
+}
+
+bool BinaryWorkloadFile::is_binary_workload(const string & filename)
+{
+    char magic[sizeof(BINARY_WORKLOAD_MAGIC)];
+    ifstream file(filename, ios::binary);
+    file.read(magic, sizeof(magic));
+
+    return file && memcmp(magic, BINARY_WORKLOAD_MAGIC, sizeof(magic)) == 0;
+}
+
+const char * BinaryWorkloadFile::string_at(uint64_t offset, uint64_t size) const
+{
+    xbt_assert(offset <= _header->strings_size && size <= _header->strings_size - offset,
+               "Invalid binary workload '%s': a string is out of the string pool", _filename.c_str());
+    return _strings + offset;
+}
+
+void write_binary_workload(const Workload * workload, int nb_res, const string & filename)
+{
+    string strings;
+
+    // Profiles are written once and referenced by their index in job records
+    vector<BinaryProfileRecord> profile_records;
+    map<string, uint32_t> profile_indexes;
+    for (const auto & mit : workload->profiles->profiles())
+    {
+        const Profile * profile = mit.second;
+        xbt_assert(profile->type != ProfileType::SMPI,
+                   "Cannot convert workload '%s': SMPI profiles (such as '%s') are not supported by binary workloads",
+                   workload->file.c_str(), mit.first.c_str());
+
+        BinaryProfileRecord record;
+        record.name_offset = strings.size();
+        record.name_size = mit.first.size();
+        strings += mit.first;
+        record.description_offset = strings.size();
+        record.description_size = profile->json_description.size();
+        strings += profile->json_description;
+
+        profile_indexes[mit.first] = profile_records.size();
+        profile_records.push_back(record);
+    }
+
+    vector<Job *> jobs = workload->jobs->jobs();
+    sort(jobs.begin(), jobs.end(), job_comparator_subtime_number);
+
+    vector<BinaryJobRecord> job_records;
+    job_records.reserve(jobs.size());
+    for (const Job * job : jobs)
+    {
+        // The id is generated at load time, as it contains the name of the workload
+        Document description;
+        description.Parse(job->json_description.c_str());
+        description.RemoveMember("id");
+
+        StringBuffer buffer;
+        Writer<StringBuffer> writer(buffer);
+        description.Accept(writer);
+        string members(buffer.GetString() + 1, buffer.GetSize() - 2);
+
+        BinaryJobRecord record;
+        record.submission_time = (double) job->submission_time;
+        record.walltime = (double) job->walltime;
+        record.number = job->number;
+        record.required_nb_res = job->required_nb_res;
+        record.profile = profile_indexes.at(job->profile);
+        record.description_offset = strings.size();
+        record.description_size = members.size();
+        strings += members;
+
+        job_records.push_back(record);
+    }
+
+    BinaryWorkloadHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BINARY_WORKLOAD_MAGIC, sizeof(BINARY_WORKLOAD_MAGIC));
+    header.version = BINARY_WORKLOAD_VERSION;
+    header.byte_order = BINARY_WORKLOAD_BYTE_ORDER;
+    header.nb_res = nb_res;
+    header.nb_jobs = job_records.size();
+    header.nb_profiles = profile_records.size();
+    header.jobs_offset = sizeof(header);
+    header.profiles_offset = header.jobs_offset + job_records.size() * sizeof(BinaryJobRecord);
+    header.strings_offset = header.profiles_offset + profile_records.size() * sizeof(BinaryProfileRecord);
+    header.strings_size = strings.size();
+
+    ofstream file(filename, ios::binary | ios::trunc);
+    xbt_assert(file.is_open(), "Cannot write file '%s'", filename.c_str());
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(job_records.data()), job_records.size() * sizeof(BinaryJobRecord));
+    file.write(reinterpret_cast<const char *>(profile_records.data()),
+               profile_records.size() * sizeof(BinaryProfileRecord));
+    file.write(strings.data(), strings.size());
+    file.close();
+    xbt_assert(file, "Cannot write file '%s'", filename.c_str());
+}
+
+void convert_workload_to_binary(const string & json_filename, const string & binary_filename)
+{
+    // The workload is named as if it were simulated, so that string job identifiers are accepted
+    string absolute_json_filename = absolute_filename(json_filename);
+    Workload workload(generate_sha1_string(absolute_json_filename), absolute_json_filename);
+
+    int nb_res = -1;
+    workload.load_from_json(absolute_json_filename, nb_res);
+
+    XBT_INFO("Writing binary workload '%s'...", binary_filename.c_str());
+    write_binary_workload(&workload, nb_res, binary_filename);
+    XBT_INFO("Binary workload written sucessfully.");
+}
@@ -0,0 +1,149 @@
+/**
+ * @file binary_workload.hpp
+ * @brief Contains the binary workload format, which is used without being parsed
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class Workload;
+
+/**
+ * @brief The header of a binary workload file
+ * @details A binary workload file contains, in this order: the header, the job records (sorted by
+ *          submission time then number), the profile records and the string pool.
+ *          Numbers are stored in the byte order of the machine which wrote the file.
+ */
+struct BinaryWorkloadHeader
+{
+    char magic[8]; //!< Identifies binary workload files (see BINARY_WORKLOAD_MAGIC)
+    uint32_t version; //!< The version of the format
+    uint32_t byte_order; //!< BINARY_WORKLOAD_BYTE_ORDER, as written by the machine which wrote the file
+    int32_t nb_res; //!< The 'nb_res' value of the workload
+    uint32_t reserved; //!< Unused (keeps the next fields aligned)
+    uint64_t nb_jobs; //!< The number of job records
+    uint64_t nb_profiles; //!< The number of profile records
+    uint64_t jobs_offset; //!< The position of the job records in the file (in bytes)
+    uint64_t profiles_offset; //!< The position of the profile records in the file (in bytes)
+    uint64_t strings_offset; //!< The position of the string pool in the file (in bytes)
+    uint64_t strings_size; //!< The size of the string pool (in bytes)
+};
+
+/**
+ * @brief A job of a binary workload file
+ */
+struct BinaryJobRecord
+{
+    double submission_time; //!< The job submission time
+    double walltime; //!< The job walltime (-1 if unset)
+    int32_t number; //!< The job number within its workload
+    int32_t required_nb_res; //!< The number of resources the job requests
+    uint32_t profile; //!< The index of the job profile in the profile records
+    uint32_t description_size; //!< The size of the job description in the string pool
+    uint64_t description_offset; //!< The position of the job description in the string pool. The description holds the members of the job JSON object, except 'id'.
+};
+
+/**
+ * @brief A profile of a binary workload file
+ */
+struct BinaryProfileRecord
+{
+    uint64_t name_offset; //!< The position of the profile name in the string pool
+    uint64_t description_offset; //!< The position of the profile JSON description in the string pool
+    uint32_t name_size; //!< The size of the profile name
+    uint32_t description_size; //!< The size of the profile JSON description
+};
+
+static_assert(sizeof(BinaryWorkloadHeader) == 72, "Unexpected BinaryWorkloadHeader padding");
+static_assert(sizeof(BinaryJobRecord) == 40, "Unexpected BinaryJobRecord padding");
+static_assert(sizeof(BinaryProfileRecord) == 24, "Unexpected BinaryProfileRecord padding");
+
+const char BINARY_WORKLOAD_MAGIC[8] = {'B', 'A', 'T', 'W', 'L', 'D', '\0', '\0'}; //!< The magic of binary workload files
+const uint32_t BINARY_WORKLOAD_VERSION = 1; //!< The current version of the binary workload format
+const uint32_t BINARY_WORKLOAD_BYTE_ORDER = 0x01020304; //!< Allows to detect files written with another byte order
+
+/**
+ * @brief A binary workload file mapped in memory (read only)
+ */
+class BinaryWorkloadFile
+{
+public:
+    /**
+     * @brief Maps a binary workload file in memory and checks its layout
+     * @param[in] filename The binary workload file name
+     */
+    explicit BinaryWorkloadFile(const std::string & filename);
+
+    /**
+     * @brief BinaryWorkloadFile cannot be copied.
+     * @param[in] other Another instance
+     */
+    BinaryWorkloadFile(const BinaryWorkloadFile & other) = delete;
+
+    /**
+     * @brief Unmaps the file
+     */
+    ~BinaryWorkloadFile();
+
+    /**
+     * @brief Returns whether a file is a binary workload file, by looking at its first bytes
+     * @param[in] filename The file name
+     * @return Whether the file is a binary workload file
+     */
+    static bool is_binary_workload(const std::string & filename);
+
+    /**
+     * @brief Returns the header of the file
+     * @return The header of the file
+     */
+    const BinaryWorkloadHeader & header() const { return *_header; }
+
+    /**
+     * @brief Returns a job record
+     * @param[in] index The index of the job record, in [0, nb_jobs[
+     * @return The job record
+     */
+    const BinaryJobRecord & job(uint64_t index) const { return _jobs[index]; }
+
+    /**
+     * @brief Returns a profile record
+     * @param[in] index The index of the profile record, in [0, nb_profiles[
+     * @return The profile record
+     */
+    const BinaryProfileRecord & profile(uint64_t index) const { return _profiles[index]; }
+
+    /**
+     * @brief Returns a string of the string pool
+     * @param[in] offset The position of the string in the string pool
+     * @param[in] size The size of the string
+     * @return The first character of the string (which is not null-terminated)
+     */
+    const char * string_at(uint64_t offset, uint64_t size) const;
+
+private:
+    std::string _filename; //!< The file name
+    void * _mapping = nullptr; //!< The memory in which the file is mapped
+    size_t _mapping_size = 0; //!< The size of the mapping
+    const BinaryWorkloadHeader * _header = nullptr; //!< The header of the file
+    const BinaryJobRecord * _jobs = nullptr; //!< The job records of the file
+    const BinaryProfileRecord * _profiles = nullptr; //!< The profile records of the file
+    const char * _strings = nullptr; //!< The string pool of the file
+};
+
+/**
+ * @brief Writes a loaded workload as a binary workload file
+ * @param[in] workload The workload, whose jobs and profiles are loaded
+ * @param[in] nb_res The 'nb_res' value of the workload
+ * @param[in] filename The name of the binary workload file to write
+ */
+void write_binary_workload(const Workload * workload, int nb_res, const std::string & filename);
+
+/**
+ * @brief Converts a JSON workload file into a binary workload file
+ * @param[in] json_filename The name of the JSON workload file
+ * @param[in] binary_filename The name of the binary workload file to write
+ */
+void convert_workload_to_binary(const std::string & json_filename, const std::string & binary_filename);
@@ -0,0 +1,104 @@
+/**
+ * @file compression.cpp
+ * @brief Contains the compression of the messages exchanged with the scheduler
+ */
+
+#include "compression.hpp"
+
+#include <algorithm>
+
+#include <xbt.h>
+
+using namespace std;
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(compression, "compression"); //!< Logging
+
+MessageCompressor::MessageCompressor(int level, uint64_t max_decompressed_size) :
+    _level(level),
+    _max_decompressed_size(max_decompressed_size)
+{
+    _compression_context = ZSTD_createCCtx();
+    _decompression_stream = ZSTD_createDStream();
+    xbt_assert(_compression_context != nullptr && _decompression_stream != nullptr,
+               "Cannot create zstd contexts");
+}
+
+MessageCompressor::~MessageCompressor()
+{
+    ZSTD_freeCCtx(_compression_context);
+    ZSTD_freeDStream(_decompression_stream);
+}
+
+ProtocolMessage MessageCompressor::compress(const ProtocolMessage & message)
+{
+    size_t bound = ZSTD_compressBound(message.size);
+    _compressed.resize(bound);
+
+    size_t compressed_size = ZSTD_compressCCtx(_compression_context, &_compressed[0], bound,
+                                               message.data, message.size, _level);
+    xbt_assert(!ZSTD_isError(compressed_size), "Cannot compress message: %s",
+               ZSTD_getErrorName(compressed_size));
+    _compressed.resize(compressed_size);
+
+    XBT_DEBUG("Message compressed from %zu to %zu bytes", message.size, compressed_size);
+
+    ProtocolMessage compressed;
+    compressed.data = _compressed.data();
+    compressed.size = _compressed.size();
+    return compressed;
+}
+
+const string & MessageCompressor::decompress(const char * data, size_t size)
+{
+    // The decompressed size is known if the frame has been compressed in one go
+    unsigned long long content_size = ZSTD_getFrameContentSize(data, size);
+    xbt_assert(content_size != ZSTD_CONTENTSIZE_ERROR, "Invalid compressed message");
+    xbt_assert(content_size == ZSTD_CONTENTSIZE_UNKNOWN || content_size <= _max_decompressed_size,
+               "Cannot decompress message: its header announces %llu bytes, "
+               "but at most %llu bytes are accepted",
+               content_size, (unsigned long long) _max_decompressed_size);
+
+    _decompressed.clear();
+    if (content_size != ZSTD_CONTENTSIZE_UNKNOWN)
+    {
+        _decompressed.reserve(content_size);
+    }
+
+    size_t ret = ZSTD_initDStream(_decompression_stream);
+    xbt_assert(!ZSTD_isError(ret), "Cannot initialize zstd decompression: %s", ZSTD_getErrorName(ret));
+
+    ZSTD_inBuffer input = {data, size, 0};
+    do
+    {
+        // Let's decompress in the free capacity of the buffer (growing it if needed).
+        // At most one byte more than the maximum size is decompressed, which tells that the message is too big.
+        size_t old_size = _decompressed.size();
+        size_t chunk_size = max(_decompressed.capacity() - old_size, ZSTD_DStreamOutSize());
+        chunk_size = (size_t) min((uint64_t) chunk_size, _max_decompressed_size + 1 - old_size);
+        _decompressed.resize(old_size + chunk_size);
+
+        ZSTD_outBuffer output = {&_decompressed[old_size], chunk_size, 0};
+        ret = ZSTD_decompressStream(_decompression_stream, &output, &input);
+        xbt_assert(!ZSTD_isError(ret), "Cannot decompress message: %s", ZSTD_getErrorName(ret));
+        xbt_assert(ret == 0 || input.pos < input.size || output.pos == output.size,
+                   "Cannot decompress message: it is truncated");
+
+        _decompressed.resize(old_size + output.pos);
+        xbt_assert(_decompressed.size() <= _max_decompressed_size,
+                   "Cannot decompress message: it is bigger than %llu bytes",
+                   (unsigned long long) _max_decompressed_size);
+    } while (ret != 0 || input.pos < input.size);
+
+    XBT_DEBUG("Message decompressed from %zu to %zu bytes", size, _decompressed.size());
+    return _decompressed;
+}
+
+bool MessageCompressor::is_compressed(const char * data, size_t size)
+{
+    const unsigned char magic[4] = {0x28, 0xb5, 0x2f, 0xfd}; // ZSTD_MAGICNUMBER, little-endian
+    return size >= 4 &&
+           (unsigned char) data[0] == magic[0] &&
+           (unsigned char) data[1] == magic[1] &&
+           (unsigned char) data[2] == magic[2] &&
+           (unsigned char) data[3] == magic[3];
+}
@@ -0,0 +1,77 @@
+/**
+ * @file compression.hpp
+ * @brief Contains the compression of the messages exchanged with the scheduler
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+
+#include <zstd.h>
+
+#include "ipp.hpp"
+
+const uint64_t MAX_DECOMPRESSED_MESSAGE_SIZE = UINT64_C(1) << 32; //!< The size of the biggest decompressed message Batsim accepts (like BATSIM_SHM_MAX_MESSAGE_SIZE)
+
+/**
+ * @brief Compresses and decompresses protocol messages with zstd
+ * @details Compressed messages are zstd frames, which can be told apart from JSON and MessagePack
+ *          messages by their magic number. The zstd contexts and the output buffers are kept from
+ *          one message to another.
+ */
+class MessageCompressor
+{
+public:
+    /**
+     * @brief Builds a MessageCompressor
+     * @param[in] level The zstd compression level
+     * @param[in] max_decompressed_size The size of the biggest message decompress accepts
+     */
+    explicit MessageCompressor(int level, uint64_t max_decompressed_size = MAX_DECOMPRESSED_MESSAGE_SIZE);
+
+    /**
+     * @brief MessageCompressor cannot be copied.
+     * @param[in] other Another instance
+     */
+    MessageCompressor(const MessageCompressor & other) = delete;
+
+    /**
+     * @brief Destroys a MessageCompressor
+     */
+    ~MessageCompressor();
+
+    /**
+     * @brief Compresses a message
+     * @param[in] message The message to compress
+     * @return A view on the compressed message. It remains valid until the next call to compress.
+     */
+    ProtocolMessage compress(const ProtocolMessage & message);
+
+    /**
+     * @brief Decompresses a message
+     * @param[in] data The compressed message bytes
+     * @param[in] size The number of bytes of the compressed message
+     * @return The decompressed message. It remains valid until the next call to decompress.
+     * @details Batsim stops if the decompressed message would be bigger than the maximum size
+     *          given to the constructor, instead of trusting the sender with its memory.
+     */
+    const std::string & decompress(const char * data, size_t size);
+
+    /**
+     * @brief Returns whether a message is compressed (whether it starts by the zstd magic number)
+     * @param[in] data The message bytes
+     * @param[in] size The number of bytes of the message
+     * @return Whether the message is compressed
+     */
+    static bool is_compressed(const char * data, size_t size);
+
+private:
+    int _level; //!< The zstd compression level
+    uint64_t _max_decompressed_size; //!< The size of the biggest message decompress accepts
+    ZSTD_CCtx * _compression_context = nullptr; //!< The zstd compression context
+    ZSTD_DStream * _decompression_stream = nullptr; //!< The zstd decompression context
+    std::string _compressed; //!< The buffer in which messages are compressed
+    std::string _decompressed; //!< The buffer in which messages are decompressed
+};
@@ -12,15 +12,20 @@
 
 #include <rapidjson/document.h>
 
+#include "compression.hpp"
+#include "conversation.hpp"
 #include "exact_numbers.hpp"
 #include "export.hpp"
 #include "jobs.hpp"
 #include "machines.hpp"
 #include "network.hpp"
+#include "plugin_protocol.hpp"
 #include "profiles.hpp"
 #include "protocol.hpp"
 #include "pstate.hpp"
+#include "shm_transport.hpp"
 #include "storage.hpp"
+#include "telemetry.hpp"
 #include "workflow.hpp"
 #include "workload.hpp"
 
@@ -36,8 +41,15 @@ struct BatsimContext
 {
     zmq::context_t zmq_context;                     //!< The Zero MQ context
     zmq::socket_t * zmq_socket = nullptr;           //!< The Zero MQ socket (REQ)
+    SharedMemoryTransport * shm_transport = nullptr; //!< The shared-memory transport, used instead of zmq_socket with shm:// endpoints
     AbstractProtocolReader * proto_reader = nullptr;//!< The protocol reader
     AbstractProtocolWriter * proto_writer = nullptr;//!< The protocol writer
+    MessageCompressor * compressor = nullptr;       //!< Compresses and decompresses protocol messages
+    ConversationRecorder * conversation_recorder = nullptr; //!< Records the conversation with the scheduler (if enabled)
+    ConversationReplayer * conversation_replayer = nullptr; //!< Replays a recorded conversation instead of talking to a scheduler (if enabled)
+    PluginScheduler * scheduler_plugin = nullptr;   //!< The scheduler loaded into Batsim's process instead of talking to a scheduler through the socket (if enabled)
+    TelemetryEmitter * telemetry = nullptr;         //!< Periodically emits the simulation progress (if enabled)
+    BackgroundWriter * output_writer = nullptr;     //!< Writes the traces into their files from a background thread
 
     Machines machines;                              //!< The machines
     Workloads workloads;                            //!< The workloads
@@ -53,9 +65,19 @@ struct BatsimContext
     rapidjson::Document config_file;                //!< The configuration file
     bool redis_enabled;                             //!< Stores whether Redis should be used
     bool submission_forward_profiles;               //!< Stores whether the profile information of jobs should be sent to the scheduler
+    bool submission_batch_by_timestamp;             //!< Stores whether the jobs submitted at the same time should be sent in one JOB_SUBMITTED event
     bool submission_sched_enabled;                  //!< Stores whether the scheduler will be able to send jobs along the simulation
     bool submission_sched_finished = false;         //!< Stores whether the scheduler has finished submitting jobs.
     bool submission_sched_ack;                      //!< Stores whether Batsim will acknowledge dynamic job submission (emit JOB_SUBMITTED events)
+    ProtocolFormat protocol_format;                 //!< Stores how protocol messages are encoded
+    ProtocolValidation protocol_validation;         //!< Stores how strictly the messages received from the scheduler are checked
+    int protocol_decimal_places;                    //!< The number of decimal places of doubles in JSON protocol messages (-1 for exact doubles)
+    std::vector<std::string> protocol_deferred_events; //!< The types of the events which do not trigger a call to the scheduler by themselves
+    bool protocol_compact_resources;                //!< Stores whether machines sharing the same properties are sent as groups in SIMULATION_BEGINS
+    bool protocol_coalesce_calls;                   //!< Stores whether the messages already posted at the current date are all handled before calling the scheduler
+    bool compression_enabled;                       //!< Stores whether big messages sent to the scheduler are compressed
+    size_t compression_threshold;                   //!< The size (in bytes) from which messages sent to the scheduler are compressed
+    int compression_level;                          //!< The zstd level used to compress messages
 
     bool terminate_with_last_workflow;              //!< If true, allows to ignore the jobs submitted after the last workflow termination
 
@@ -63,6 +85,7 @@ struct BatsimContext
     Rational energy_last_job_completion = -1;       //!< The amount of consumed energy (J) when the last job is completed
 
     Rational microseconds_used_by_scheduler = 0;    //!< The number of microseconds used by the scheduler
+    SchedulerCallStatistics scheduler_calls;        //!< The per-phase measures of the calls to the scheduler
     my_timestamp simulation_start_time;             //!< The moment in time at which the simulation has started
     my_timestamp simulation_end_time;               //!< The moment in time at which the simulation has ended
 
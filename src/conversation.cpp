@@ -0,0 +1,171 @@
+/**
+ * @file conversation.cpp
+ * @brief Contains the recording and the replay of the conversations between Batsim and the scheduler
+ */
+
+#include "conversation.hpp"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include <xbt.h>
+
+using namespace std;
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(conversation, "conversation"); //!< Logging
+
+static const char conversation_magic[8] = {'B', 'A', 'T', 'S', 'I', 'M', 'C', 'V'}; //!< The first bytes of conversation files
+static const uint32_t conversation_format_version = 1; //!< The version of the conversation file format
+
+/**
+ * @brief Writes an unsigned integer as a LEB128 varint
+ * @param[in,out] file The file in which the integer is written
+ * @param[in] value The integer
+ */
+static void write_varint(ofstream & file, uint64_t value)
+{
+    char buf[10];
+    int nb_bytes = 0;
+    do
+    {
+        buf[nb_bytes] = (char) (value & 0x7f);
+        value >>= 7;
+        if (value != 0)
+        {
+            buf[nb_bytes] |= (char) 0x80;
+        }
+        nb_bytes++;
+    } while (value != 0);
+
+    file.write(buf, nb_bytes);
+}
+
+/**
+ * @brief Reads an unsigned LEB128 varint
+ * @param[in,out] file The file from which the integer is read
+ * @param[out] value The integer
+ * @return Whether the integer could be read
+ */
+static bool read_varint(ifstream & file, uint64_t & value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        int byte = file.get();
+        if (byte == EOF)
+        {
+            return false;
+        }
+
+        value |= ((uint64_t) (byte & 0x7f)) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+ConversationRecorder::ConversationRecorder(const string & filename) :
+    _file(filename, ios::binary | ios::trunc),
+    _filename(filename)
+{
+    xbt_assert(_file.is_open(), "Cannot open conversation file '%s' for writing", filename.c_str());
+
+    char version[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        version[i] = (char) ((conversation_format_version >> (8 * i)) & 0xff);
+    }
+
+    _file.write(conversation_magic, sizeof(conversation_magic));
+    _file.write(version, sizeof(version));
+}
+
+void ConversationRecorder::record_exchange(const ProtocolMessage & sent,
+                                          const string & reply,
+                                          chrono::nanoseconds latency)
+{
+    write_varint(_file, sent.size);
+    _file.write(sent.data, sent.size);
+    write_varint(_file, reply.size());
+    _file.write(reply.data(), reply.size());
+    write_varint(_file, (uint64_t) max(latency.count(), (chrono::nanoseconds::rep) 0));
+
+    xbt_assert(_file.good(), "Cannot write into conversation file '%s'", _filename.c_str());
+    _nb_exchanges++;
+}
+
+void ConversationRecorder::flush()
+{
+    _file.flush();
+    XBT_INFO("%d exchanges have been recorded into '%s'", _nb_exchanges, _filename.c_str());
+}
+
+ConversationReplayer::ConversationReplayer(const string & filename) :
+    _file(filename, ios::binary),
+    _filename(filename)
+{
+    xbt_assert(_file.is_open(), "Cannot open conversation file '%s' for reading", filename.c_str());
+
+    char magic[sizeof(conversation_magic)];
+    unsigned char version[4];
+    _file.read(magic, sizeof(magic));
+    _file.read((char *) version, sizeof(version));
+    xbt_assert(_file.good() && memcmp(magic, conversation_magic, sizeof(magic)) == 0,
+               "Invalid conversation file '%s': bad header", filename.c_str());
+
+    uint32_t file_version = version[0] | (version[1] << 8) | (version[2] << 16) | ((uint32_t) version[3] << 24);
+    xbt_assert(file_version == conversation_format_version,
+               "Invalid conversation file '%s': unsupported version %u (expected %u)",
+               filename.c_str(), file_version, conversation_format_version);
+}
+
+const string & ConversationReplayer::replay_exchange(const ProtocolMessage & sent,
+                                                      chrono::nanoseconds & latency)
+{
+    xbt_assert(!is_finished(), "Cannot replay conversation '%s': Batsim sent a message after "
+               "the %d recorded exchanges", _filename.c_str(), _nb_exchanges);
+
+    read_message(_recorded_sent);
+    read_message(_recorded_reply);
+
+    uint64_t latency_ns = 0;
+    bool read_ok = read_varint(_file, latency_ns);
+    (void) read_ok; // Avoids a warning if assertions are ignored
+    xbt_assert(read_ok, "Invalid conversation file '%s': exchange %d is truncated",
+               _filename.c_str(), _nb_exchanges);
+    latency = chrono::nanoseconds(latency_ns);
+
+    if (!_has_diverged && (_recorded_sent.size() != sent.size ||
+                           memcmp(_recorded_sent.data(), sent.data, sent.size) != 0))
+    {
+        XBT_WARN("The message sent in exchange %d differs from the recorded one: "
+                 "the simulation diverges from the recorded conversation", _nb_exchanges);
+        _has_diverged = true;
+    }
+
+    _nb_exchanges++;
+    return _recorded_reply;
+}
+
+bool ConversationReplayer::is_finished()
+{
+    return _file.peek() == EOF;
+}
+
+void ConversationReplayer::read_message(string & message)
+{
+    uint64_t size = 0;
+    bool read_ok = read_varint(_file, size);
+    (void) read_ok; // Avoids a warning if assertions are ignored
+    xbt_assert(read_ok, "Invalid conversation file '%s': exchange %d is truncated",
+               _filename.c_str(), _nb_exchanges);
+
+    message.resize(size);
+    _file.read(&message[0], size);
+    xbt_assert((uint64_t) _file.gcount() == size, "Invalid conversation file '%s': exchange %d is truncated",
+               _filename.c_str(), _nb_exchanges);
+}
@@ -0,0 +1,107 @@
+/**
+ * @file conversation.hpp
+ * @brief Contains the recording and the replay of the conversations between Batsim and the scheduler
+ */
+
+#pragma once
+
+#include <chrono>
+#include <fstream>
+#include <string>
+
+#include "ipp.hpp"
+
+/**
+ * @brief Records the messages exchanged with the scheduler into a binary file
+ * @details The file starts by a header (the "BATSIMCV" magic string followed by a 32-bit
+ *          little-endian format version). It is followed by one record per exchange, which contains
+ *          the message sent to the scheduler, the reply of the scheduler, and the time the scheduler
+ *          took to reply (in nanoseconds). Sizes and latencies are encoded as unsigned LEB128 varints.
+ *          Messages are stored as they are sent on the socket (compressed or not).
+ */
+class ConversationRecorder
+{
+public:
+    /**
+     * @brief Builds a ConversationRecorder
+     * @param[in] filename The name of the file in which the conversation is recorded
+     */
+    explicit ConversationRecorder(const std::string & filename);
+
+    /**
+     * @brief ConversationRecorder cannot be copied.
+     * @param[in] other Another instance
+     */
+    ConversationRecorder(const ConversationRecorder & other) = delete;
+
+    /**
+     * @brief Records one exchange with the scheduler
+     * @param[in] sent The message sent to the scheduler
+     * @param[in] reply The reply of the scheduler
+     * @param[in] latency The time the scheduler took to reply
+     */
+    void record_exchange(const ProtocolMessage & sent,
+                         const std::string & reply,
+                         std::chrono::nanoseconds latency);
+
+    /**
+     * @brief Writes the buffered exchanges into the file
+     */
+    void flush();
+
+private:
+    std::ofstream _file; //!< The file in which the conversation is recorded
+    std::string _filename; //!< The name of the file in which the conversation is recorded
+    int _nb_exchanges = 0; //!< The number of recorded exchanges
+};
+
+/**
+ * @brief Replays a conversation recorded by a ConversationRecorder
+ */
+class ConversationReplayer
+{
+public:
+    /**
+     * @brief Builds a ConversationReplayer
+     * @param[in] filename The name of the file in which the conversation has been recorded
+     */
+    explicit ConversationReplayer(const std::string & filename);
+
+    /**
+     * @brief ConversationReplayer cannot be copied.
+     * @param[in] other Another instance
+     */
+    ConversationReplayer(const ConversationReplayer & other) = delete;
+
+    /**
+     * @brief Replays the next exchange of the conversation
+     * @details A warning is issued the first time the sent message differs from the recorded one,
+     *          as it means that the simulation diverges from the recorded one.
+     * @param[in] sent The message sent to the (replayed) scheduler
+     * @param[out] latency The time the scheduler took to reply during the recording
+     * @return The recorded reply. It remains valid until the next call to replay_exchange.
+     */
+    const std::string & replay_exchange(const ProtocolMessage & sent,
+                                        std::chrono::nanoseconds & latency);
+
+    /**
+     * @brief Returns whether all the exchanges of the conversation have been replayed
+     * @return Whether all the exchanges of the conversation have been replayed
+     */
+    bool is_finished();
+
+private:
+    /**
+     * @brief Reads a message from the file
+     * @param[out] message The string in which the message is read
+     */
+    void read_message(std::string & message);
+
+private:
+    std::ifstream _file; //!< The file from which the conversation is read
+    std::string _filename; //!< The name of the file from which the conversation is read
+    std::string _recorded_sent; //!< The recorded message sent by Batsim (buffer reused between exchanges)
+    std::string _recorded_reply; //!< The recorded reply of the scheduler (buffer reused between exchanges)
+    int _nb_exchanges = 0; //!< The number of replayed exchanges
+    bool _has_diverged = false; //!< Whether a sent message differed from the recorded one
+};
@@ -26,9 +26,15 @@ XBT_LOG_NEW_DEFAULT_CATEGORY(export, "export"); //!< Logging
 
 void prepare_batsim_outputs(BatsimContext * context)
 {
+    // The traces are written by a background thread, which lets their writing overlap the scheduler decisions
+    if (context->trace_schedule || context->trace_machine_states || context->energy_used)
+    {
+        context->output_writer = new BackgroundWriter;
+    }
+
     if (context->trace_schedule)
     {
-        context->paje_tracer.set_filename(context->export_prefix + "_schedule.trace");
+        context->paje_tracer.set_filename(context->export_prefix + "_schedule.trace", context->output_writer);
         context->machines.set_tracer(&context->paje_tracer);
         context->paje_tracer.initialize(context, MSG_get_clock());
     }
@@ -36,17 +42,17 @@ void prepare_batsim_outputs(BatsimContext * context)
     if (context->trace_machine_states)
     {
         context->machine_state_tracer.set_context(context);
-        context->machine_state_tracer.set_filename(context->export_prefix + "_machine_states.csv");
+        context->machine_state_tracer.set_filename(context->export_prefix + "_machine_states.csv", context->output_writer);
     }
 
     if (context->energy_used)
     {
         // Energy consumption tracing
         context->energy_tracer.set_context(context);
-        context->energy_tracer.set_filename(context->export_prefix + "_consumed_energy.csv");
+        context->energy_tracer.set_filename(context->export_prefix + "_consumed_energy.csv", context->output_writer);
 
         // Power state tracing
-        context->pstate_tracer.setFilename(context->export_prefix + "_pstate_changes.csv");
+        context->pstate_tracer.setFilename(context->export_prefix + "_pstate_changes.csv", context->output_writer);
 
         std::map<int, MachineRange> pstate_to_machine_set;
         for (const Machine * machine : context->machines.machines())
@@ -102,16 +108,126 @@ void finalize_batsim_outputs(BatsimContext * context)
         context->pstate_tracer.close_buffer();
     }
 
+    // All the traces are closed: their pending writings are done
+    delete context->output_writer;
+    context->output_writer = nullptr;
+
     // Schedule-oriented output information
     export_schedule_to_csv(context->export_prefix + "_schedule.csv", context);
 
     // Job-oriented output information
     export_jobs_to_csv(context->export_prefix + "_jobs.csv", context);
+
+    // Scheduler calls
+    context->scheduler_calls.export_to_csv(context->export_prefix + "_scheduler_calls.csv");
+}
+
+
+void flush_batsim_outputs_in_background(BatsimContext * context)
+{
+    if (context->output_writer == nullptr)
+    {
+        return;
+    }
+
+    if (context->trace_schedule)
+    {
+        context->paje_tracer.flush();
+    }
+
+    if (context->trace_machine_states)
+    {
+        context->machine_state_tracer.flush();
+    }
+
+    if (context->energy_used)
+    {
+        context->energy_tracer.flush();
+        context->pstate_tracer.flush();
+    }
+}
+
+
+BackgroundWriter::BackgroundWriter() :
+    _thread(&BackgroundWriter::run, this)
+{
+}
+
+BackgroundWriter::~BackgroundWriter()
+{
+    {
+        unique_lock<mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _request_available.notify_one();
+    _thread.join();
+}
+
+void BackgroundWriter::write(ofstream & file, const char * data, size_t size)
+{
+    {
+        unique_lock<mutex> lock(_mutex);
+        WriteRequest request;
+        request.file = &file;
+        if (!_free_buffers.empty())
+        {
+            request.data.swap(_free_buffers.back());
+            _free_buffers.pop_back();
+        }
+        request.data.assign(data, data + size);
+        _requests.push_back(std::move(request));
+        _nb_pending_bytes += size;
+    }
+    _request_available.notify_one();
+}
+
+void BackgroundWriter::wait_until_idle()
+{
+    unique_lock<mutex> lock(_mutex);
+    _idle.wait(lock, [this]{ return _requests.empty() && !_writing; });
+}
+
+size_t BackgroundWriter::nb_pending_bytes()
+{
+    unique_lock<mutex> lock(_mutex);
+    return _nb_pending_bytes;
+}
+
+void BackgroundWriter::run()
+{
+    unique_lock<mutex> lock(_mutex);
+    while (true)
+    {
+        _request_available.wait(lock, [this]{ return !_requests.empty() || _stopping; });
+        if (_requests.empty())
+        {
+            // Stopping, and all writings are done
+            return;
+        }
+
+        WriteRequest request = std::move(_requests.front());
+        _requests.pop_front();
+        _writing = true;
+
+        // The file is only used by this thread until the writings are done
+        lock.unlock();
+        request.file->write(request.data.data(), request.data.size());
+        lock.lock();
+
+        _writing = false;
+        _nb_pending_bytes -= request.data.size();
+        _free_buffers.push_back(std::move(request.data));
+        if (_requests.empty())
+        {
+            _idle.notify_all();
+        }
+    }
 }
 
 
-WriteBuffer::WriteBuffer(const std::string & filename, int buffer_size)
-    : buffer_size(buffer_size)
+WriteBuffer::WriteBuffer(const std::string & filename, BackgroundWriter * background_writer, int buffer_size)
+    : buffer_size(buffer_size),
+      background_writer(background_writer)
 {
     xbt_assert(buffer_size > 0, "Invalid buffer size (%d)", buffer_size);
     buffer = new char[buffer_size];
@@ -132,6 +248,10 @@ WriteBuffer::~WriteBuffer()
         delete[] buffer;
         buffer = nullptr;
 
+        if (background_writer != nullptr)
+        {
+            background_writer->wait_until_idle();
+        }
         f.close();
     }
 }
@@ -162,14 +282,31 @@ void WriteBuffer::append_text(const char * text)
         else
         {
             // Directly write the text into the file
-            f.write(text, text_length);
+            if (background_writer != nullptr)
+            {
+                background_writer->write(f, text, text_length);
+            }
+            else
+            {
+                f.write(text, text_length);
+            }
         }
     }
 }
 
 void WriteBuffer::flush_buffer()
 {
-    f.write(buffer, buffer_pos);
+    if (background_writer != nullptr)
+    {
+        if (buffer_pos > 0)
+        {
+            background_writer->write(f, buffer, buffer_pos);
+        }
+    }
+    else
+    {
+        f.write(buffer, buffer_pos);
+    }
     buffer_pos = 0;
 }
 
@@ -184,10 +321,23 @@ PajeTracer::PajeTracer(bool log_launchings) :
     shuffle_colors();
 }
 
-void PajeTracer::set_filename(const string &filename)
+void PajeTracer::set_filename(const string &filename, BackgroundWriter * background_writer)
 {
     xbt_assert(_wbuf == nullptr, "Double call of PajeTracer::set_filename");
-    _wbuf = new WriteBuffer(filename);
+    _wbuf = new WriteBuffer(filename, background_writer);
+}
+
+void PajeTracer::flush()
+{
+    if (_wbuf != nullptr)
+    {
+        _wbuf->flush_buffer();
+    }
+}
+
+size_t PajeTracer::nb_buffered_bytes() const
+{
+    return _wbuf != nullptr ? _wbuf->nb_buffered_bytes() : 0;
 }
 
 PajeTracer::~PajeTracer()
@@ -497,8 +647,9 @@ void PajeTracer::add_job_launching(const Job * job,
 
 void PajeTracer::register_new_job(const Job *job)
 {
+    const string job_id = job->id.to_string();
     xbt_assert(_jobs.find(job) == _jobs.end(),
-               "Cannot register new job %s: it already exists", job->id.to_string().c_str());
+               "Cannot register new job %s: it already exists", job_id.c_str());
 
     const int buf_size = 256;
     int nb_printed;
@@ -509,15 +660,15 @@ void PajeTracer::register_new_job(const Job *job)
     // Let's create a state value corresponding to this job
     nb_printed = snprintf(buf, buf_size,
                           "%d %s%s %s \"%s\" %s\n",
-                          DEFINE_ENTITY_VALUE, jobPrefix, job->id.to_string().c_str(),
-                          machineState, job->id.to_string().c_str(),
+                          DEFINE_ENTITY_VALUE, jobPrefix, job_id.c_str(),
+                          machineState, job_id.c_str(),
                           _colors[job->number % (int)_colors.size()].c_str());
     xbt_assert(nb_printed < buf_size - 1,
                "Writing error: buffer has been completely filled, some information might "
                "have been lost. Please increase Batsim's output temporary buffers' size");
     _wbuf->append_text(buf);
 
-    _jobs[job] = jobPrefix + job->id.to_string();
+    _jobs[job] = jobPrefix + job_id;
 
     free(buf);
 }
@@ -578,11 +729,12 @@ void PajeTracer::add_job_kill(const Job *job, const MachineRange & used_machine_
     (void) nb_printed; // Avoids a warning if assertions are ignored
     char * buf = (char*) malloc(sizeof(char) * buf_size);
     xbt_assert(buf != 0, "Couldn't allocate memory");
+    const string job_id = job->id.to_string();
 
     // Let's add a kill event associated with the scheduler
     nb_printed = snprintf(buf, buf_size,
                           "%d %lf %s %s \"%s\"\n",
-                          NEW_EVENT, time, killEventKiller, killer, job->id.to_string().c_str());
+                          NEW_EVENT, time, killEventKiller, killer, job_id.c_str());
     xbt_assert(nb_printed < buf_size - 1,
                "Writing error: buffer has been completely filled, some information might "
                "have been lost. Please increase Batsim's output temporary buffers' size");
@@ -597,7 +749,7 @@ void PajeTracer::add_job_kill(const Job *job, const MachineRange & used_machine_
             nb_printed = snprintf(buf, buf_size,
                                   "%d %lf %s %s%d \"%s\"\n",
                                   NEW_EVENT, time, killEventMachine, machinePrefix, machine_id,
-                                  job->id.to_string().c_str());
+                                  job_id.c_str());
             xbt_assert(nb_printed < buf_size - 1,
                        "Writing error: buffer has been completely filled, some information might "
                        "have been lost. Please increase Batsim's output temporary buffers' size");
@@ -731,15 +883,17 @@ void export_jobs_to_csv(const std::string &filename, const BatsimContext *contex
 
         if(workload->jobs)
         {
-            const auto & jobs = workload->jobs->jobs();
-            for (const auto & mit : jobs)
+            for (Job * job : workload->jobs->jobs())
             {
-                Job * job = mit.second;
 
                 if (job->is_complete())
                 {
                     int success = (job->state == JobState::JOB_STATE_COMPLETED_SUCCESSFULLY);
 
+                    // Derived times are computed exactly
+                    Rational submission_time = job->submission_time;
+                    Rational finish_time = (Rational) job->starting_time + job->runtime;
+
                     // Update all values
                     job_map["job_id"] = to_string(job->number);
                     job_map["workload_name"] = string(workload_name);
@@ -749,13 +903,13 @@ void export_jobs_to_csv(const std::string &filename, const BatsimContext *contex
                     job_map["success"] = to_string(success);
                     job_map["starting_time"] = to_string((double)job->starting_time);
                     job_map["execution_time"] = to_string((double)job->runtime);
-                    job_map["finish_time"] = to_string((double)(job->starting_time + job->runtime));
-                    job_map["waiting_time"] = to_string((double)(job->starting_time - job->submission_time));
-                    job_map["turnaround_time"] = to_string((double)(job->starting_time + job->runtime - job->submission_time));
-                    job_map["stretch"] = to_string((double)((job->starting_time + job->runtime - job->submission_time) / job->runtime));
+                    job_map["finish_time"] = to_string((double)finish_time);
+                    job_map["waiting_time"] = to_string((double)(job->starting_time - submission_time));
+                    job_map["turnaround_time"] = to_string((double)(finish_time - submission_time));
+                    job_map["stretch"] = to_string((double)((finish_time - submission_time) / job->runtime));
                     job_map["consumed_energy"] = to_string(job->consumed_energy);
                     job_map["allocated_processors"] = job->allocation.to_string_hyphen(" ");
-                    job_map["metadata"] = '"' + job->metadata + '"';
+                    job_map["metadata"] = '"' + job->metadata() + '"';
 
                     // Write values to the output file
                     row_content.resize(0);
@@ -814,10 +968,8 @@ void export_schedule_to_csv(const std::string &filename, const BatsimContext *co
 
         if(workload->jobs != nullptr)
         {
-            const auto & jobs = workload->jobs->jobs();
-            for (const auto & mit : jobs)
+            for (Job * job : workload->jobs->jobs())
             {
-                Job * job = mit.second;
                 nb_jobs++;
 
                 if (job->is_complete())
@@ -836,7 +988,7 @@ void export_schedule_to_csv(const std::string &filename, const BatsimContext *co
 
                     Rational starting_time = job->starting_time;
                     Rational waiting_time = starting_time - job->submission_time;
-                    Rational completion_time = job->starting_time + job->runtime;
+                    Rational completion_time = starting_time + job->runtime;
                     Rational turnaround_time = completion_time - job->submission_time;
                     Rational slowdown = turnaround_time / job->runtime;
 
@@ -972,10 +1124,10 @@ PStateChangeTracer::PStateChangeTracer()
     _temporary_buffer = (char*) malloc(512 * sizeof(char));
 }
 
-void PStateChangeTracer::setFilename(const string &filename)
+void PStateChangeTracer::setFilename(const string &filename, BackgroundWriter * background_writer)
 {
     xbt_assert(_wbuf == nullptr, "Double call of PStateChangeTracer::setFilename");
-    _wbuf = new WriteBuffer(filename);
+    _wbuf = new WriteBuffer(filename, background_writer);
 
     _wbuf->append_text("time,machine_id,new_pstate\n");
 }
@@ -1023,6 +1175,11 @@ void PStateChangeTracer::flush()
     _wbuf->flush_buffer();
 }
 
+size_t PStateChangeTracer::nb_buffered_bytes() const
+{
+    return _wbuf != nullptr ? _wbuf->nb_buffered_bytes() : 0;
+}
+
 void PStateChangeTracer::close_buffer()
 {
     xbt_assert(_wbuf != nullptr);
@@ -1048,10 +1205,10 @@ void EnergyConsumptionTracer::set_context(BatsimContext *context)
     _context = context;
 }
 
-void EnergyConsumptionTracer::set_filename(const string &filename)
+void EnergyConsumptionTracer::set_filename(const string &filename, BackgroundWriter * background_writer)
 {
     xbt_assert(_wbuf == nullptr, "Double call of EnergyConsumptionTracer::set_filename");
-    _wbuf = new WriteBuffer(filename);
+    _wbuf = new WriteBuffer(filename, background_writer);
 
     _wbuf->append_text("time,energy,event_type,wattmin,epower\n");
 }
@@ -1082,6 +1239,11 @@ void EnergyConsumptionTracer::flush()
     _wbuf->flush_buffer();
 }
 
+size_t EnergyConsumptionTracer::nb_buffered_bytes() const
+{
+    return _wbuf != nullptr ? _wbuf->nb_buffered_bytes() : 0;
+}
+
 void EnergyConsumptionTracer::close_buffer()
 {
     xbt_assert(_wbuf != nullptr);
@@ -1151,10 +1313,10 @@ void MachineStateTracer::set_context(BatsimContext *context)
     _context = context;
 }
 
-void MachineStateTracer::set_filename(const string &filename)
+void MachineStateTracer::set_filename(const string &filename, BackgroundWriter * background_writer)
 {
     xbt_assert(_wbuf == nullptr, "Double call of MachineStateTracer::set_filename");
-    _wbuf = new WriteBuffer(filename);
+    _wbuf = new WriteBuffer(filename, background_writer);
 
     vector<string> header_substrings;
     const vector<MachineState> machine_states = {MachineState::SLEEPING,
@@ -1209,6 +1371,11 @@ void MachineStateTracer::flush()
     _wbuf->flush_buffer();
 }
 
+size_t MachineStateTracer::nb_buffered_bytes() const
+{
+    return _wbuf != nullptr ? _wbuf->nb_buffered_bytes() : 0;
+}
+
 void MachineStateTracer::close_buffer()
 {
     xbt_assert(_wbuf != nullptr);
@@ -12,6 +12,10 @@
 #include <string>
 #include <fstream>
 #include <map>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
 
 #include <simgrid/msg.h>
 
@@ -32,6 +36,85 @@ void prepare_batsim_outputs(BatsimContext * context);
  */
 void finalize_batsim_outputs(BatsimContext * context);
 
+/**
+ * @brief Hands the content of the tracers' buffers over to the BackgroundWriter
+ * @details This is meant to be called before waiting for the scheduler, so that the outputs are
+ *          written while the scheduler takes its decisions.
+ * @param[in] context The BatsimContext
+ */
+void flush_batsim_outputs_in_background(BatsimContext * context);
+
+/**
+ * @brief Writes data into files from a background thread
+ * @details Writings are done one at a time and in the order they have been requested, so the
+ *          content of each file is the same as if it had been written directly.
+ */
+class BackgroundWriter
+{
+public:
+    /**
+     * @brief Builds a BackgroundWriter and starts its thread
+     */
+    BackgroundWriter();
+
+    /**
+     * @brief BackgroundWriter cannot be copied.
+     * @param[in] other Another instance
+     */
+    BackgroundWriter(const BackgroundWriter & other) = delete;
+
+    /**
+     * @brief Completes the pending writings then stops the thread
+     */
+    ~BackgroundWriter();
+
+    /**
+     * @brief Requests data to be written at the end of a file
+     * @details The data is copied. The file must not be used until wait_until_idle is called.
+     * @param[in] file The file
+     * @param[in] data The data to write
+     * @param[in] size The number of bytes to write
+     */
+    void write(std::ofstream & file, const char * data, size_t size);
+
+    /**
+     * @brief Waits until all the requested writings are done
+     */
+    void wait_until_idle();
+
+    /**
+     * @brief Returns the number of bytes which have been requested to be written but are not written yet
+     * @return The number of pending bytes
+     */
+    size_t nb_pending_bytes();
+
+private:
+    /**
+     * @brief A writing to do
+     */
+    struct WriteRequest
+    {
+        std::ofstream * file; //!< The file
+        std::vector<char> data; //!< The data to write
+    };
+
+    /**
+     * @brief The function run by the thread, which does the writings as they are requested
+     */
+    void run();
+
+private:
+    std::mutex _mutex; //!< Protects the other members (but _thread)
+    std::condition_variable _request_available; //!< Notified when a writing is requested or when the thread should stop
+    std::condition_variable _idle; //!< Notified when all the requested writings are done
+    std::deque<WriteRequest> _requests; //!< The writings to do, in order
+    std::vector<std::vector<char>> _free_buffers; //!< The buffers of the done writings, reused by the next ones
+    size_t _nb_pending_bytes = 0; //!< The number of bytes of the writings which are not done yet
+    bool _writing = false; //!< Whether the thread is doing a writing
+    bool _stopping = false; //!< Whether the thread should stop once all writings are done
+    std::thread _thread; //!< The thread which does the writings
+};
+
 /**
  * @brief Buffered-write output file
  */
@@ -41,9 +124,12 @@ public:
     /**
      * @brief Builds a WriteBuffer
      * @param[in] filename The file that will be written
+     * @param[in] background_writer If set, the buffer content is written into the file by this
+     *            BackgroundWriter instead of being written directly.
      * @param[in] buffer_size The size of the buffer (in bytes).
      */
     explicit WriteBuffer(const std::string & filename,
+                         BackgroundWriter * background_writer = nullptr,
                          int buffer_size = 64*1024);
 
     /**
@@ -69,11 +155,18 @@ public:
      */
     void flush_buffer();
 
+    /**
+     * @brief Returns the number of bytes in the buffer, which have not been flushed yet
+     * @return The number of buffered bytes
+     */
+    size_t nb_buffered_bytes() const { return buffer_pos; }
+
 private:
     std::ofstream f;            //!< The file stream on which the buffer is outputted
     const int buffer_size;      //!< The buffer maximum size
     char * buffer = nullptr;    //!< The buffer
     int buffer_pos = 0;         //!< The current position of the buffer (previous positions are already written)
+    BackgroundWriter * background_writer = nullptr; //!< The BackgroundWriter which writes the buffer content (if any)
 };
 
 /**
@@ -140,8 +233,21 @@ public:
     /**
      * @brief Sets the filename of a PajeTracer
      * @param[in] filename The name of the output file
+     * @param[in] background_writer The BackgroundWriter which writes the output file (if any)
      */
-    void set_filename(const std::string & filename);
+    void set_filename(const std::string & filename,
+                      BackgroundWriter * background_writer = nullptr);
+
+    /**
+     * @brief Forces the flushing of what happened to the output file
+     */
+    void flush();
+
+    /**
+     * @brief Returns the number of bytes which have been traced but not flushed yet
+     * @return The number of buffered bytes
+     */
+    size_t nb_buffered_bytes() const;
 
     /**
      * @brief PajeTracer destructor.
@@ -290,8 +396,10 @@ public:
     /**
      * @brief Sets the output filename of the tracer
      * @param filename The name of the output file of the tracer
+     * @param background_writer The BackgroundWriter which writes the output file (if any)
      */
-    void setFilename(const std::string & filename);
+    void setFilename(const std::string & filename,
+                     BackgroundWriter * background_writer = nullptr);
 
     /**
      * @brief Adds a power state change in the tracer
@@ -306,6 +414,12 @@ public:
      */
     void flush();
 
+    /**
+     * @brief Returns the number of bytes which have been traced but not flushed yet
+     * @return The number of buffered bytes
+     */
+    size_t nb_buffered_bytes() const;
+
     /**
      * @brief Closes the buffer and its associated output file
      */
@@ -348,8 +462,10 @@ public:
     /**
      * @brief Sets the output filename of the tracer
      * @param[in] filename The name of the output file of the tracer
+     * @param[in] background_writer The BackgroundWriter which writes the output file (if any)
      */
-    void set_filename(const std::string & filename);
+    void set_filename(const std::string & filename,
+                      BackgroundWriter * background_writer = nullptr);
 
     /**
      * @brief Adds a job start in the tracer
@@ -378,6 +494,12 @@ public:
      */
     void flush();
 
+    /**
+     * @brief Returns the number of bytes which have been traced but not flushed yet
+     * @return The number of buffered bytes
+     */
+    size_t nb_buffered_bytes() const;
+
     /**
      * @brief Closes the buffer and its associated output file
      */
@@ -431,8 +553,10 @@ public:
     /**
      * @brief Sets the output filename of the tracer
      * @param[in] filename  The name of the output file of the tracer
+     * @param[in] background_writer The BackgroundWriter which writes the output file (if any)
      */
-    void set_filename(const std::string & filename);
+    void set_filename(const std::string & filename,
+                      BackgroundWriter * background_writer = nullptr);
 
     /**
      * @brief Writes a line in the output file, corresponding to the current state, at the given date
@@ -445,6 +569,12 @@ public:
      */
     void flush();
 
+    /**
+     * @brief Returns the number of bytes which have been traced but not flushed yet
+     * @return The number of buffered bytes
+     */
+    size_t nb_buffered_bytes() const;
+
     /**
      * @brief Closes the output buffer
      */
@@ -0,0 +1,104 @@
+/**
+ * @file histogram.cpp
+ * @brief Contains a compact histogram of integer values with a bounded relative error
+ */
+
+#include "histogram.hpp"
+
+#include <math.h>
+
+#include <xbt.h>
+
+using namespace std;
+
+Histogram::Histogram(int precision_bits) :
+    _precision_bits(precision_bits),
+    _half_bucket_count(((uint64_t) 1) << (precision_bits - 1))
+{
+    xbt_assert(precision_bits >= 1 && precision_bits <= 16,
+               "Invalid histogram precision (%d bits): it should be in [1,16]", precision_bits);
+}
+
+int Histogram::bucket_index(uint64_t value) const
+{
+    if (value < 2 * _half_bucket_count)
+    {
+        return (int) value;
+    }
+
+    // The bucket is given by the position of the most significant bit and the next precision_bits-1 bits
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - _precision_bits + 1;
+    return (int) (shift * _half_bucket_count + (value >> shift));
+}
+
+uint64_t Histogram::bucket_lower_bound(int bucket) const
+{
+    if ((uint64_t) bucket < 2 * _half_bucket_count)
+    {
+        return bucket;
+    }
+
+    int shift = (int) (bucket / _half_bucket_count) - 1;
+    uint64_t significand = bucket - shift * _half_bucket_count;
+    return significand << shift;
+}
+
+uint64_t Histogram::bucket_upper_bound(int bucket) const
+{
+    if ((uint64_t) bucket < 2 * _half_bucket_count)
+    {
+        return bucket;
+    }
+
+    int shift = (int) (bucket / _half_bucket_count) - 1;
+    return bucket_lower_bound(bucket) + ((((uint64_t) 1) << shift) - 1);
+}
+
+void Histogram::record(uint64_t value)
+{
+    int bucket = bucket_index(value);
+    if (bucket >= (int) _counts.size())
+    {
+        _counts.resize(bucket + 1, 0);
+    }
+
+    _counts[bucket]++;
+    _count++;
+    _sum += value;
+    if (value < _min)
+    {
+        _min = value;
+    }
+    if (value > _max)
+    {
+        _max = value;
+    }
+}
+
+uint64_t Histogram::value_at_percentile(double percentile) const
+{
+    if (_count == 0)
+    {
+        return 0;
+    }
+
+    uint64_t rank = (uint64_t) ceil(percentile / 100.0 * _count);
+    if (rank < 1)
+    {
+        rank = 1;
+    }
+
+    uint64_t nb_values_below = 0;
+    for (int bucket = 0; bucket < (int) _counts.size(); ++bucket)
+    {
+        nb_values_below += _counts[bucket];
+        if (nb_values_below >= rank)
+        {
+            uint64_t upper_bound = bucket_upper_bound(bucket);
+            return upper_bound < _max ? upper_bound : _max;
+        }
+    }
+
+    return _max;
+}
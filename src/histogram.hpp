@@ -0,0 +1,111 @@
+/**
+ * @file histogram.hpp
+ * @brief Contains a compact histogram of integer values with a bounded relative error
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <vector>
+
+/**
+ * @brief Histogram of unsigned integer values, in the spirit of HdrHistogram
+ * @details Values below 2^precision_bits are counted exactly. Above, each power of two is split
+ *          into 2^(precision_bits-1) buckets of equal width, so the relative error of a value is
+ *          below 2^(1-precision_bits) (about 3% with the default precision).
+ *          Recording a value is constant-time and the memory is bounded (a few kilobytes),
+ *          whatever the number and range of the recorded values.
+ */
+class Histogram
+{
+public:
+    /**
+     * @brief Builds an empty Histogram
+     * @param[in] precision_bits The number of significant bits of the buckets. In [1,16].
+     */
+    explicit Histogram(int precision_bits = 5);
+
+    /**
+     * @brief Records a value
+     * @param[in] value The value
+     */
+    void record(uint64_t value);
+
+    /**
+     * @brief Returns the number of recorded values
+     * @return The number of recorded values
+     */
+    uint64_t count() const { return _count; }
+
+    /**
+     * @brief Returns the smallest recorded value (0 if there is none)
+     * @return The smallest recorded value
+     */
+    uint64_t min() const { return _count > 0 ? _min : 0; }
+
+    /**
+     * @brief Returns the largest recorded value (0 if there is none)
+     * @return The largest recorded value
+     */
+    uint64_t max() const { return _max; }
+
+    /**
+     * @brief Returns the sum of the recorded values
+     * @return The sum of the recorded values
+     */
+    long double sum() const { return _sum; }
+
+    /**
+     * @brief Returns the value under which a given percentage of the recorded values are
+     * @details The returned value is the upper bound of the bucket which contains the percentile
+     *          (capped by the largest recorded value).
+     * @param[in] percentile The percentage, in [0,100]
+     * @return The value at the given percentile (0 if no value has been recorded)
+     */
+    uint64_t value_at_percentile(double percentile) const;
+
+    /**
+     * @brief Returns the number of buckets
+     * @return The number of buckets. Bucket indices are in [0,nb_buckets()[
+     */
+    int nb_buckets() const { return (int) _counts.size(); }
+
+    /**
+     * @brief Returns the number of values recorded in a bucket
+     * @param[in] bucket The bucket index
+     * @return The number of values recorded in the bucket
+     */
+    uint64_t bucket_count(int bucket) const { return _counts[bucket]; }
+
+    /**
+     * @brief Returns the smallest value of a bucket
+     * @param[in] bucket The bucket index
+     * @return The smallest value of the bucket
+     */
+    uint64_t bucket_lower_bound(int bucket) const;
+
+    /**
+     * @brief Returns the largest value of a bucket
+     * @param[in] bucket The bucket index
+     * @return The largest value of the bucket
+     */
+    uint64_t bucket_upper_bound(int bucket) const;
+
+private:
+    /**
+     * @brief Returns the index of the bucket a value belongs to
+     * @param[in] value The value
+     * @return The index of the bucket the value belongs to
+     */
+    int bucket_index(uint64_t value) const;
+
+private:
+    int _precision_bits; //!< The number of significant bits of the buckets
+    uint64_t _half_bucket_count; //!< The number of buckets per power of two (2^(precision_bits-1))
+    std::vector<uint64_t> _counts; //!< The number of values in each bucket (grown on demand)
+    uint64_t _count = 0; //!< The number of recorded values
+    uint64_t _min = UINT64_MAX; //!< The smallest recorded value
+    uint64_t _max = 0; //!< The largest recorded value
+    long double _sum = 0; //!< The sum of the recorded values
+};
@@ -5,6 +5,14 @@
 
 #include "ipp.hpp"
 
+#include <climits>
+#include <cstring>
+#include <deque>
+#include <unordered_map>
+
+#include <boost/functional/hash.hpp>
+#include <boost/utility/string_ref.hpp>
+
 #include <simgrid/msg.h>
 
 using namespace std;
@@ -24,7 +32,7 @@ void generic_send_message(const std::string & destination_mailbox,
 
     XBT_DEBUG("message from '%s' to '%s' of type '%s' with data %p",
               MSG_process_get_name(MSG_process_self()), destination_mailbox.c_str(),
-              ip_message_type_to_string(type).c_str(), data);
+              ip_message_type_to_string(type), data);
 
     if (detached)
     {
@@ -36,12 +44,12 @@ void generic_send_message(const std::string & destination_mailbox,
         xbt_assert(err == MSG_OK,
                    "Sending message from '%s' to '%s' of type '%s' with data %p FAILED!",
                    MSG_process_get_name(MSG_process_self()), destination_mailbox.c_str(),
-                   ip_message_type_to_string(type).c_str(), data);
+                   ip_message_type_to_string(type), data);
     }
 
     XBT_DEBUG("message from '%s' to '%s' of type '%s' with data %p done",
               MSG_process_get_name(MSG_process_self()), destination_mailbox.c_str(),
-              ip_message_type_to_string(type).c_str(), data);
+              ip_message_type_to_string(type), data);
 }
 
 void send_message(const std::string & destination_mailbox, IPMessageType type, void * data)
@@ -54,91 +62,67 @@ void dsend_message(const std::string & destination_mailbox, IPMessageType type,
     generic_send_message(destination_mailbox, type, data, true);
 }
 
-std::string ip_message_type_to_string(IPMessageType type)
+const char * ip_message_type_to_string(IPMessageType type)
 {
-    string s;
-
     // Do not remove the switch. If one adds a new IPMessageType but forgets to handle it in the
     // switch, a compilation warning should help avoiding this bug.
     switch(type)
     {
         case IPMessageType::JOB_SUBMITTED:
-            s = "JOB_SUBMITTED";
-            break;
+            return "JOB_SUBMITTED";
         case IPMessageType::JOB_SUBMITTED_BY_DP:
-            s = "JOB_SUBMITTED_BY_DP";
-            break;
+            return "JOB_SUBMITTED_BY_DP";
         case IPMessageType::PROFILE_SUBMITTED_BY_DP:
-            s = "PROFILE_SUBMITTED_BY_DP";
-            break;
+            return "PROFILE_SUBMITTED_BY_DP";
         case IPMessageType::JOB_COMPLETED:
-            s = "JOB_COMPLETED";
-            break;
+            return "JOB_COMPLETED";
         case IPMessageType::PSTATE_MODIFICATION:
-            s = "PSTATE_MODIFICATION";
-            break;
+            return "PSTATE_MODIFICATION";
         case IPMessageType::SCHED_EXECUTE_JOB:
-            s = "SCHED_EXECUTE_JOB";
-            break;
+            return "SCHED_EXECUTE_JOB";
+        case IPMessageType::SCHED_EXECUTE_JOBS:
+            return "SCHED_EXECUTE_JOBS";
         case IPMessageType::SCHED_CHANGE_JOB_STATE:
-            s = "SCHED_CHANGE_JOB_STATE";
-            break;
+            return "SCHED_CHANGE_JOB_STATE";
         case IPMessageType::SCHED_REJECT_JOB:
-            s = "SCHED_REJECT_JOB";
-            break;
+            return "SCHED_REJECT_JOB";
         case IPMessageType::SCHED_KILL_JOB:
-            s = "SCHED_KILL_JOB";
-            break;
+            return "SCHED_KILL_JOB";
         case IPMessageType::SCHED_CALL_ME_LATER:
-            s = "SCHED_CALL_ME_LATER";
-            break;
+            return "SCHED_CALL_ME_LATER";
         case IPMessageType::SCHED_TELL_ME_ENERGY:
-            s = "SCHED_TELL_ME_ENERGY";
-            break;
+            return "SCHED_TELL_ME_ENERGY";
         case IPMessageType::SCHED_WAIT_ANSWER:
-            s = "SCHED_WAIT_ANSWER";
-            break;
+            return "SCHED_WAIT_ANSWER";
         case IPMessageType::WAIT_QUERY:
-            s = "WAIT_QUERY";
-            break;
+            return "WAIT_QUERY";
         case IPMessageType::SCHED_READY:
-            s = "SCHED_READY";
-            break;
+            return "SCHED_READY";
         case IPMessageType::WAITING_DONE:
-            s = "WAITING_DONE";
-            break;
+            return "WAITING_DONE";
         case IPMessageType::SUBMITTER_HELLO:
-            s = "SUBMITTER_HELLO";
-            break;
+            return "SUBMITTER_HELLO";
         case IPMessageType::SUBMITTER_CALLBACK:
-            s = "SUBMITTER_CALLBACK";
-            break;
+            return "SUBMITTER_CALLBACK";
         case IPMessageType::SUBMITTER_BYE:
-            s = "SUBMITTER_BYE";
-            break;
+            return "SUBMITTER_BYE";
         case IPMessageType::SWITCHED_ON:
-            s = "SWITCHED_ON";
-            break;
+            return "SWITCHED_ON";
         case IPMessageType::SWITCHED_OFF:
-            s = "SWITCHED_OFF";
-            break;
+            return "SWITCHED_OFF";
         case IPMessageType::KILLING_DONE:
-            s = "KILLING_DONE";
-            break;
+            return "KILLING_DONE";
         case IPMessageType::END_DYNAMIC_SUBMIT:
-            s = "END_DYNAMIC_SUBMIT";
-            break;
+            return "END_DYNAMIC_SUBMIT";
         case IPMessageType::CONTINUE_DYNAMIC_SUBMIT:
-            s = "CONTINUE_DYNAMIC_SUBMIT";
-            break;
+            return "CONTINUE_DYNAMIC_SUBMIT";
         case IPMessageType::TO_JOB_MSG:
-            s = "TO_JOB_MSG";
-            break;
+            return "TO_JOB_MSG";
         case IPMessageType::FROM_JOB_MSG:
-            s = "FROM_JOB_MSG";
+            return "FROM_JOB_MSG";
     }
 
-    return s;
+    return "UNKNOWN";
 }
 
 void send_message(const char *destination_mailbox, IPMessageType type, void *data)
@@ -190,6 +174,12 @@ IPMessage::~IPMessage()
             // The Allocations themselves are not memory-deallocated there but at the end of the job execution.
             delete msg;
         } break;
+        case IPMessageType::SCHED_EXECUTE_JOBS:
+        {
+            ExecuteJobsMessage * msg = (ExecuteJobsMessage *) data;
+            // The Allocations themselves are not memory-deallocated there but at the end of the jobs execution.
+            delete msg;
+        } break;
         case IPMessageType::SCHED_CHANGE_JOB_STATE:
         {
             ChangeJobStateMessage * msg = (ChangeJobStateMessage *) data;
@@ -280,19 +270,194 @@ IPMessage::~IPMessage()
     data = nullptr;
 }
 
+/**
+ * @brief Hashes workload names which are not necessarily stored in strings
+ */
+struct StringRefHash
+{
+    /**
+     * @brief Hashes a string
+     * @param[in] str The string
+     * @return The hash of the string
+     */
+    size_t operator()(const boost::string_ref & str) const
+    {
+        return boost::hash_range(str.begin(), str.end());
+    }
+};
+
+/**
+ * @brief The interned workload names
+ */
+struct WorkloadNameTable
+{
+    deque<string> names; //!< The workload names, indexed by their id. A deque keeps the names in place when it grows.
+    unordered_map<boost::string_ref, int, StringRefHash> ids; //!< Maps the workload names (which point into names) to their id
+};
+
+/**
+ * @brief Returns the interned workload names
+ * @return The interned workload names
+ */
+static WorkloadNameTable & workload_name_table()
+{
+    static WorkloadNameTable table;
+    return table;
+}
+
+/**
+ * @brief Interns a workload name, without allocating memory if it is already interned
+ * @param[in] workload_name The workload name
+ * @return The interned workload name
+ */
+static int intern_workload_name_ref(const boost::string_ref & workload_name)
+{
+    WorkloadNameTable & table = workload_name_table();
+
+    auto it = table.ids.find(workload_name);
+    if (it != table.ids.end())
+    {
+        return it->second;
+    }
+
+    int workload_id = (int) table.names.size();
+    table.names.emplace_back(workload_name.data(), workload_name.size());
+    table.ids[boost::string_ref(table.names.back())] = workload_id;
+    return workload_id;
+}
+
+/**
+ * @brief Looks an interned workload name up, without interning it
+ * @param[in] workload_name The workload name
+ * @return The interned workload name, or -1 if it has never been interned
+ */
+static int find_workload_name_ref(const boost::string_ref & workload_name)
+{
+    const WorkloadNameTable & table = workload_name_table();
+
+    auto it = table.ids.find(workload_name);
+    if (it == table.ids.end())
+    {
+        return -1;
+    }
+    return it->second;
+}
+
 JobIdentifier::JobIdentifier(const string &workload_name, int job_number) :
-    workload_name(workload_name),
+    workload_id(intern_workload_name(workload_name)),
     job_number(job_number)
 {
 
 }
 
+JobIdentifier::JobIdentifier(int workload_id, int job_number) :
+    workload_id(workload_id),
+    job_number(job_number)
+{
+
+}
+
+const string & JobIdentifier::workload_name() const
+{
+    static const string no_workload_name;
+    if (workload_id < 0)
+    {
+        return no_workload_name;
+    }
+
+    return workload_name_table().names[workload_id];
+}
+
 string JobIdentifier::to_string() const
 {
-    return workload_name + '!' + std::to_string(job_number);
+    string output;
+    to_string(output);
+    return output;
+}
+
+void JobIdentifier::to_string(string & output) const
+{
+    output.assign(workload_name());
+    output += '!';
+
+    // Digits are written backwards at the end of a local buffer
+    char digits[16];
+    char * digits_end = digits + sizeof(digits);
+    char * digit = digits_end;
+    long long number = job_number;
+    bool negative = number < 0;
+    if (negative)
+    {
+        number = -number;
+    }
+    do
+    {
+        *--digit = '0' + (number % 10);
+        number /= 10;
+    } while (number != 0);
+    if (negative)
+    {
+        *--digit = '-';
+    }
+
+    output.append(digit, digits_end - digit);
+}
+
+bool JobIdentifier::parse(const char * str, size_t length, JobIdentifier & job_id, bool & has_workload_name,
+                          bool intern_workload)
+{
+    const char * end = str + length;
+    const char * separator = static_cast<const char *>(memchr(str, '!', length));
+    const char * number_begin = (separator == nullptr) ? str : separator + 1;
+
+    if (separator != nullptr && memchr(number_begin, '!', end - number_begin) != nullptr)
+    {
+        return false;
+    }
+
+    // The job number must be a base-10 integer that fits in an int
+    const char * c = number_begin;
+    bool negative = (c != end && *c == '-');
+    if (negative)
+    {
+        ++c;
+    }
+    if (c == end)
+    {
+        return false;
+    }
+
+    long long number = 0;
+    for (; c != end; ++c)
+    {
+        if (*c < '0' || *c > '9')
+        {
+            return false;
+        }
+
+        number = number * 10 + (*c - '0');
+        if (number > (long long) INT_MAX + 1)
+        {
+            return false;
+        }
+    }
+    if (negative)
+    {
+        number = -number;
+    }
+    if (number > INT_MAX)
+    {
+        return false;
+    }
+
+    has_workload_name = (separator != nullptr);
+    boost::string_ref workload_name = has_workload_name ? boost::string_ref(str, separator - str) : boost::string_ref("static");
+    job_id.workload_id = intern_workload ? intern_workload_name_ref(workload_name) : find_workload_name_ref(workload_name);
+    job_id.job_number = (int) number;
+    return true;
 }
 
-bool operator<(const JobIdentifier &ji1, const JobIdentifier &ji2)
+int JobIdentifier::intern_workload_name(const string & workload_name)
 {
-    return ji1.to_string() < ji2.to_string();
+    return intern_workload_name_ref(boost::string_ref(workload_name));
 }
@@ -14,8 +14,10 @@
 #include <simgrid/msg.h>
 
 #include "machine_range.hpp"
+#include "pool.hpp"
 
 #include "jobs.hpp"
+#include "scheduler_calls.hpp"
 
 struct BatsimContext;
 
@@ -31,6 +33,7 @@ enum class IPMessageType
     ,JOB_COMPLETED          //!< Launcher -> Server. The job launcher tells the server a job has been completed.
     ,PSTATE_MODIFICATION    //!< Scheduler -> Server. The scheduler tells the server a scheduling event occured (modify the state of some resources).
     ,SCHED_EXECUTE_JOB      //!< Scheduler -> Server. The scheduler tells the server a scheduling event occured (execute a job).
+    ,SCHED_EXECUTE_JOBS     //!< Scheduler -> Server. The scheduler tells the server a scheduling event occured (execute several jobs).
     ,SCHED_CHANGE_JOB_STATE //!< Scheduler -> Server. The scheduler tells the server a scheduling event occured (change the state of a job).
     ,SCHED_REJECT_JOB       //!< Scheduler -> Server. The scheduler tells the server a scheduling event occured (reject a job).
     ,SCHED_KILL_JOB         //!< Scheduler -> Server. The scheduler tells the server a scheduling event occured (kill a job).
@@ -52,10 +55,13 @@ enum class IPMessageType
     ,FROM_JOB_MSG //!< Job -> Server. The job wants to send a message to the scheduler via the server.
 };
 
+//! The number of IPMessageType values, which can be used to index arrays by IPMessageType
+const int NB_IP_MESSAGE_TYPES = static_cast<int>(IPMessageType::FROM_JOB_MSG) + 1;
+
 /**
  * @brief The content of the SUBMITTER_HELLO message
  */
-struct SubmitterHelloMessage
+struct SubmitterHelloMessage : public Pooled<SubmitterHelloMessage>
 {
     std::string submitter_name; //!< The name of the submitter. Must be unique. Is also used as a mailbox.
     bool enable_callback_on_job_completion; //!< If set to true, the submitter should be called back when its jobs complete.
@@ -64,7 +70,7 @@ struct SubmitterHelloMessage
 /**
  * @brief The content of the SUBMITTER_BYE message
  */
-struct SubmitterByeMessage
+struct SubmitterByeMessage : public Pooled<SubmitterByeMessage>
 {
     bool is_workflow_submitter; //!< Stores whether the finished submitter was a Workflow submitter
     std::string submitter_name; //!< The name of the submitter.
@@ -73,7 +79,7 @@ struct SubmitterByeMessage
 /**
  * @brief The content of the SUBMITTER_CALLBACK message
  */
-struct SubmitterJobCompletionCallbackMessage
+struct SubmitterJobCompletionCallbackMessage : public Pooled<SubmitterJobCompletionCallbackMessage>
 {
     JobIdentifier job_id; //!< The JobIdentifier
 };
@@ -81,16 +87,16 @@ struct SubmitterJobCompletionCallbackMessage
 /**
  * @brief The content of the JobSubmitted message
  */
-struct JobSubmittedMessage
+struct JobSubmittedMessage : public Pooled<JobSubmittedMessage>
 {
-    std::string submitter_name; //!< The name of the submitter which submitted the job.
-    JobIdentifier job_id; //!< The JobIdentifier
+    std::string submitter_name; //!< The name of the submitter which submitted the jobs.
+    std::vector<JobIdentifier> job_ids; //!< The JobIdentifiers of the jobs submitted at the current date
 };
 
 /**
  * @brief The content of the JobSubmittedByDP message
  */
-struct JobSubmittedByDPMessage
+struct JobSubmittedByDPMessage : public Pooled<JobSubmittedByDPMessage>
 {
     JobIdentifier job_id; //!< The JobIdentifier of the new job
     std::string job_description; //!< The job description string (empty if redis is enabled)
@@ -100,7 +106,7 @@ struct JobSubmittedByDPMessage
 /**
  * @brief The content of the ProfileSubmittedByDPMessage message
  */
-struct ProfileSubmittedByDPMessage
+struct ProfileSubmittedByDPMessage : public Pooled<ProfileSubmittedByDPMessage>
 {
     std::string workload_name; //!< The workload name
     std::string profile_name; //!< The profile name
@@ -110,7 +116,7 @@ struct ProfileSubmittedByDPMessage
 /**
  * @brief The content of the JobCompleted message
  */
-struct JobCompletedMessage
+struct JobCompletedMessage : public Pooled<JobCompletedMessage>
 {
     JobIdentifier job_id; //!< The JobIdentifier
 };
@@ -118,7 +124,7 @@ struct JobCompletedMessage
 /**
  * @brief The content of the ChangeJobState message
  */
-struct ChangeJobStateMessage
+struct ChangeJobStateMessage : public Pooled<ChangeJobStateMessage>
 {
     JobIdentifier job_id; //!< The JobIdentifier
     std::string job_state; //!< The new job state
@@ -128,7 +134,7 @@ struct ChangeJobStateMessage
 /**
  * @brief The content of the JobRejected message
  */
-struct JobRejectedMessage
+struct JobRejectedMessage : public Pooled<JobRejectedMessage>
 {
     JobIdentifier job_id; //!< The JobIdentifier
 };
@@ -147,15 +153,23 @@ struct SchedulingAllocation
 /**
  * @brief The content of the EXECUTE_JOB message
  */
-struct ExecuteJobMessage
+struct ExecuteJobMessage : public Pooled<ExecuteJobMessage>
 {
     SchedulingAllocation * allocation; //!< The allocation itself
 };
 
+/**
+ * @brief The content of the EXECUTE_JOBS message
+ */
+struct ExecuteJobsMessage : public Pooled<ExecuteJobsMessage>
+{
+    std::vector<SchedulingAllocation *> allocations; //!< The allocations of the jobs to execute, in the order given by the scheduler
+};
+
 /**
  * @brief The content of the KILL_JOB message
  */
-struct KillJobMessage
+struct KillJobMessage : public Pooled<KillJobMessage>
 {
     std::vector<JobIdentifier> jobs_ids; //!< The ids of the jobs to kill
 };
@@ -163,7 +177,7 @@ struct KillJobMessage
 /**
  * @brief The content of the PstateModification message
  */
-struct PStateModificationMessage
+struct PStateModificationMessage : public Pooled<PStateModificationMessage>
 {
     MachineRange machine_ids; //!< The IDs of the machines on which the pstate should be changed
     int new_pstate; //!< The power state into which the machines should be put
@@ -172,7 +186,7 @@ struct PStateModificationMessage
 /**
  * @brief The content of the CallMeLater message
  */
-struct CallMeLaterMessage
+struct CallMeLaterMessage : public Pooled<CallMeLaterMessage>
 {
     double target_time; //!< The time at which Batsim should send a message to the decision real process
 };
@@ -180,7 +194,7 @@ struct CallMeLaterMessage
 /**
  * @brief The content of the WaitQuery message
  */
-struct WaitQueryMessage
+struct WaitQueryMessage : public Pooled<WaitQueryMessage>
 {
     std::string submitter_name; //!< The name of the submitter which submitted the job.
     int nb_resources;    //!< The number of resources for which we would like to know the waiting time
@@ -190,7 +204,7 @@ struct WaitQueryMessage
 /**
  * @brief The content of the SchedWaitAnswer message
  */
-struct SchedWaitAnswerMessage
+struct SchedWaitAnswerMessage : public Pooled<SchedWaitAnswerMessage>
 {
     std::string submitter_name; //!< The name of the submitter which submitted the job.
     int nb_resources;    //!< The number of resources for which we would like to know the waiting time
@@ -201,7 +215,7 @@ struct SchedWaitAnswerMessage
 /**
  * @brief The content of the SwitchON/SwitchOFF message
  */
-struct SwitchMessage
+struct SwitchMessage : public Pooled<SwitchMessage>
 {
     int machine_id; //!< The unique number of the machine which should be switched ON
     int new_pstate; //!< The power state the machine should be put into
@@ -210,7 +224,7 @@ struct SwitchMessage
 /**
  * @brief The content of the KillingDone message
  */
-struct KillingDoneMessage
+struct KillingDoneMessage : public Pooled<KillingDoneMessage>
 {
     std::vector<JobIdentifier> jobs_ids; //!< The IDs of the jobs whose kill has been requested
     std::map<JobIdentifier, BatTask *> jobs_progress; //!< Stores the progress of the jobs that have really been killed.
@@ -219,7 +233,7 @@ struct KillingDoneMessage
 /**
  * @brief The content of the ToJobMessage message
  */
-struct ToJobMessage
+struct ToJobMessage : public Pooled<ToJobMessage>
 {
     JobIdentifier job_id; //!< The JobIdentifier
     std::string message; //!< The message to send to the job
@@ -228,7 +242,7 @@ struct ToJobMessage
 /**
  * @brief The content of the FromJobMessage message
  */
-struct FromJobMessage
+struct FromJobMessage : public Pooled<FromJobMessage>
 {
     JobIdentifier job_id; //!< The JobIdentifier
     rapidjson::Document message; //!< The message to send to the scheduler
@@ -236,8 +250,10 @@ struct FromJobMessage
 
 /**
  * @brief The base struct sent in inter-process messages
+ * @details IPMessage and the message contents are allocated from pools (see Pooled), as a
+ *          simulation sends a lot of them.
  */
-struct IPMessage
+struct IPMessage : public Pooled<IPMessage>
 {
     /**
      * @brief Destroys a IPMessage
@@ -248,13 +264,41 @@ struct IPMessage
     void * data;        //!< The message data (can be NULL if type is in [SCHED_NOP, SUBMITTER_HELLO, SUBMITTER_BYE, SUBMITTER_READY]). Otherwise, it is either a JobSubmittedMessage*, a JobCompletedMessage* or a SchedulingAllocationMessage* according to type.
 };
 
+/**
+ * @brief A read-only view on a protocol message
+ * @details The viewed bytes belong to the AbstractProtocolWriter that generated the message.
+ */
+struct ProtocolMessage
+{
+    /**
+     * @brief Builds an empty ProtocolMessage
+     */
+    ProtocolMessage() = default;
+
+    /**
+     * @brief Builds a ProtocolMessage which views some bytes
+     * @details Without this constructor, ProtocolMessage is not an aggregate in C++11 (because of
+     *          its default member initializers) and could not be built from {data, size}.
+     * @param[in] message_data The message bytes
+     * @param[in] message_size The number of bytes of the message
+     */
+    ProtocolMessage(const char * message_data, size_t message_size) :
+        data(message_data), size(message_size)
+    {
+    }
+
+    const char * data = nullptr; //!< The message bytes
+    size_t size = 0; //!< The number of bytes of the message
+};
+
 /**
  * @brief The arguments of the request_reply_scheduler_process process
  */
 struct RequestReplyProcessArguments
 {
     BatsimContext * context;    //!< The BatsimContext
-    std::string send_buffer;    //!< The message to send to the Decision real process
+    ProtocolMessage send_buffer;    //!< The message to send to the Decision real process
+    SchedulerCallMeasures measures; //!< The measures of the call, filled as it progresses
 };
 
 /**
@@ -374,8 +418,8 @@ void dsend_message(const std::string & destination_mailbox, IPMessageType type,
 void dsend_message(const char * destination_mailbox, IPMessageType type, void * data = nullptr);
 
 /**
- * @brief Transforms a IPMessageType into a std::string
+ * @brief Returns the name of a IPMessageType
  * @param[in] type The IPMessageType
- * @return The std::string corresponding to the type
+ * @return The name of the type, as a static string
  */
-std::string ip_message_type_to_string(IPMessageType type);
+const char * ip_message_type_to_string(IPMessageType type);
@@ -9,6 +9,7 @@
 #include <algorithm>
 #include <boost/bind.hpp>
 
+#include "binary_workload.hpp"
 #include "jobs.hpp"
 #include "jobs_execution.hpp"
 #include "ipp.hpp"
@@ -32,6 +33,48 @@ Task* bottom_level_f (Task *child, Task *parent)
 
 using namespace std;
 
+JobSubmissionSender::JobSubmissionSender(const string & submitter_name,
+                                         bool batch_by_timestamp,
+                                         SendFunction send) :
+    _submitter_name(submitter_name),
+    _batch_by_timestamp(batch_by_timestamp),
+    _send(send)
+{
+
+}
+
+JobSubmissionSender::~JobSubmissionSender()
+{
+    xbt_assert(_message == nullptr, "Internal error: submitted jobs have not been sent to the server");
+}
+
+void JobSubmissionSender::submit(const JobIdentifier & job_id)
+{
+    if (_message == nullptr)
+    {
+        _message = new JobSubmittedMessage;
+        _message->submitter_name = _submitter_name;
+    }
+    _message->job_ids.push_back(job_id);
+
+    if (!_batch_by_timestamp)
+    {
+        flush();
+    }
+}
+
+void JobSubmissionSender::flush()
+{
+    if (_message == nullptr)
+    {
+        return;
+    }
+
+    JobSubmittedMessage * message = _message;
+    _message = nullptr;
+    _send(message);
+}
+
 int static_job_submitter_process(int argc, char *argv[])
 {
     (void) argc;
@@ -77,64 +120,120 @@ int static_job_submitter_process(int argc, char *argv[])
     send_message("server", IPMessageType::SUBMITTER_HELLO, (void*) hello_msg);
 
     Rational previous_submission_date = MSG_get_clock();
+    const int workload_id = JobIdentifier::intern_workload_name(workload->name);
+
+    bool first_submission = true;
+    JobSubmissionSender sender(submitter_name, context->submission_batch_by_timestamp,
+        [&](JobSubmittedMessage * message)
+        {
+            // Let's now continue the simulation
+            send_message("server", IPMessageType::JOB_SUBMITTED, (void*)message);
 
-    vector<const Job *> jobsVector;
+            if (first_submission)
+            {
+                context->energy_first_job_submission = context->machines.total_consumed_energy(context);
+                first_submission = false;
+            }
+        });
 
-    const auto & jobs = workload->jobs->jobs();
-    for (const auto & mit : jobs)
+    // Submits a job at the current simulation time
+    auto submit_job = [&](const Job * job)
     {
-        const Job * job = mit.second;
-        jobsVector.push_back(job);
-    }
+        // Setting the mailbox
+        //job->completion_notification_mailbox = "SOME_MAILBOX";
 
-    sort(jobsVector.begin(), jobsVector.end(), job_comparator_subtime_number);
+        // Let's put the metadata about the job into the data storage
+        JobIdentifier job_id(workload_id, job->number);
+        string job_key = RedisStorage::job_key(job_id);
+        string profile_key = RedisStorage::profile_key(workload->name, job->profile);
+        XBT_INFO("IN STATIC JOB SUBMITTER: '%s'", job->json_description.c_str());
 
-    XBT_INFO("taille vecteur : %d", (int) jobsVector.size() );
+        if (context->redis_enabled)
+        {
+            context->storage.set(job_key, job->json_description);
+            if (context->submission_forward_profiles)
+            {
+                context->storage.set(profile_key, workload->profiles->at(job->profile)->json_description);
+            }
+        }
 
-    if (jobsVector.size() > 0)
+        sender.submit(job_id);
+    };
+
+    if (workload->is_lazy && workload->binary_file() != nullptr)
     {
-        const Job * first_submitted_job = *jobsVector.begin();
+        // Job records are sorted by submission time then number. Each of them is built just before its submission.
+        const BinaryWorkloadFile * binary_file = workload->binary_file();
+        const uint64_t nb_jobs = binary_file->header().nb_jobs;
+        XBT_INFO("Number of job records: %d", (int) nb_jobs);
 
-        for (const Job * job : jobsVector)
+        for (uint64_t i = 0; i < nb_jobs; ++i)
         {
-            if (job->submission_time > previous_submission_date)
+            const double submission_time = binary_file->job(i).submission_time;
+            if (submission_time > (double)(previous_submission_date))
             {
-                MSG_process_sleep((double)(job->submission_time) - (double)(previous_submission_date));
+                sender.flush();
+                MSG_process_sleep(submission_time - (double)(previous_submission_date));
+                previous_submission_date = MSG_get_clock();
             }
-            // Setting the mailbox
-            //job->completion_notification_mailbox = "SOME_MAILBOX";
 
-            // Let's put the metadata about the job into the data storage
-            JobIdentifier job_id(workload->name, job->number);
-            string job_key = RedisStorage::job_key(job_id);
-            string profile_key = RedisStorage::profile_key(workload->name, job->profile);
-            XBT_INFO("IN STATIC JOB SUBMITTER: '%s'", job->json_description.c_str());
+            submit_job(workload->materialize_binary_job(i));
+        }
+    }
+    else if (workload->is_lazy)
+    {
+        // Jobs are already sorted by the index. Each of them is read just before its submission.
+        XBT_INFO("Number of indexed jobs: %d", (int) workload->lazy_jobs.size());
 
-            if (context->redis_enabled)
+        std::vector<LazyJob> & lazy_jobs = workload->lazy_jobs;
+        size_t next_job = 0;
+        while (next_job < lazy_jobs.size())
+        {
+            const LazyJob lazy_job = lazy_jobs[next_job++];
+            if (lazy_job.submission_time > (double)(previous_submission_date))
             {
-                context->storage.set(job_key, job->json_description);
-                if (context->submission_forward_profiles)
-                {
-                    context->storage.set(profile_key, workload->profiles->at(job->profile)->json_description);
-                }
+                sender.flush();
+                MSG_process_sleep(lazy_job.submission_time - (double)(previous_submission_date));
+                previous_submission_date = MSG_get_clock();
             }
 
-            // Let's now continue the simulation
-            JobSubmittedMessage * msg = new JobSubmittedMessage;
-            msg->submitter_name = submitter_name;
-            msg->job_id.workload_name = args->workload_name;
-            msg->job_id.job_number = job->number;
+            submit_job(workload->materialize_job(lazy_job));
 
-            send_message("server", IPMessageType::JOB_SUBMITTED, (void*)msg);
-            previous_submission_date = MSG_get_clock();
+            // The index entries of the submitted jobs are dropped once they are the bigger half of it
+            if (next_job > lazy_jobs.size() / 2 && next_job >= 1024)
+            {
+                lazy_jobs.erase(lazy_jobs.begin(), lazy_jobs.begin() + next_job);
+                lazy_jobs.shrink_to_fit();
+                next_job = 0;
+            }
+        }
+
+        workload->lazy_jobs.clear();
+        workload->lazy_jobs.shrink_to_fit();
+    }
+    else
+    {
+        vector<Job *> jobsVector = workload->jobs->jobs();
+
+        sort(jobsVector.begin(), jobsVector.end(), job_comparator_subtime_number);
 
-            if (job == first_submitted_job)
+        XBT_INFO("taille vecteur : %d", (int) jobsVector.size() );
+
+        for (const Job * job : jobsVector)
+        {
+            if (job->submission_time > (double)(previous_submission_date))
             {
-                context->energy_first_job_submission = context->machines.total_consumed_energy(context);
+                sender.flush();
+                MSG_process_sleep((double)(job->submission_time) - (double)(previous_submission_date));
+                previous_submission_date = MSG_get_clock();
             }
+
+            submit_job(job);
         }
     }
 
+    sender.flush();
+
     SubmitterByeMessage * bye_msg = new SubmitterByeMessage;
     bye_msg->is_workflow_submitter = false;
     bye_msg->submitter_name = submitter_name;
@@ -329,8 +428,7 @@ static string submit_workflow_task_as_job(BatsimContext *context, string workflo
     // Submit the job
     JobSubmittedMessage * msg = new JobSubmittedMessage;
     msg->submitter_name = submitter_name;
-    msg->job_id.workload_name = workload_name;
-    msg->job_id.job_number = job_number;
+    msg->job_ids.push_back(JobIdentifier(workload_name, job_number));
     send_message("server", IPMessageType::JOB_SUBMITTED, (void*)msg);
 
     // HOWTO Test Wait Query
@@ -367,8 +465,7 @@ static string wait_for_job_completion(string submitter_name)
     SubmitterJobCompletionCallbackMessage *notification_data =
         (SubmitterJobCompletionCallbackMessage *) task_notification_data->data;
 
-    return  notification_data->job_id.workload_name + "!" +
-            std::to_string(notification_data->job_id.job_number);
+    return notification_data->job_id.to_string();
 }
 
 /**
@@ -400,18 +497,15 @@ int batexec_job_launcher_process(int argc, char *argv[])
     BatsimContext * context = args->context;
     Workload * workload = context->workloads.at(args->workload_name);
 
-    auto & jobs = workload->jobs->jobs();
-    for (auto & mit : jobs)
+    for (Job * job : workload->jobs->jobs())
     {
-        Job * job = mit.second;
         job->id = JobIdentifier(workload->name, job->number);
 
         int nb_res = job->required_nb_res;
 
         SchedulingAllocation * alloc = new SchedulingAllocation;
 
-        alloc->job_id.workload_name = args->workload_name;
-        alloc->job_id.job_number = job->number;
+        alloc->job_id = job->id;
         alloc->hosts.clear();
         alloc->hosts.reserve(nb_res);
         alloc->machine_ids.clear();
@@ -5,6 +5,61 @@
 
 #pragma once
 
+#include <functional>
+#include <string>
+
+struct JobIdentifier;
+struct JobSubmittedMessage;
+
+/**
+ * @brief Sends the jobs submitted by a static submitter to the server
+ * @details Each job is sent in its own message as soon as it is submitted, so that the scheduler
+ *          may be called before the next job of the same date is submitted. If the jobs submitted
+ *          at the same date are batched (see BatsimContext::submission_batch_by_timestamp), they
+ *          are gathered into one message, which is sent by flush once the submitter moves to a
+ *          later date.
+ */
+class JobSubmissionSender
+{
+public:
+    /**
+     * @brief The functions which send a JobSubmittedMessage to the server
+     */
+    typedef std::function<void(JobSubmittedMessage * message)> SendFunction;
+
+    /**
+     * @brief Creates a JobSubmissionSender
+     * @param[in] submitter_name The name of the submitter
+     * @param[in] batch_by_timestamp Whether the jobs submitted at the same date are sent in one message
+     * @param[in] send The function which sends a message to the server
+     */
+    JobSubmissionSender(const std::string & submitter_name,
+                        bool batch_by_timestamp,
+                        SendFunction send);
+
+    /**
+     * @brief Destroys a JobSubmissionSender. Its jobs must have been flushed.
+     */
+    ~JobSubmissionSender();
+
+    /**
+     * @brief Submits a job at the current simulation time
+     * @param[in] job_id The job identifier
+     */
+    void submit(const JobIdentifier & job_id);
+
+    /**
+     * @brief Sends the jobs gathered at the current simulation time, if any
+     */
+    void flush();
+
+private:
+    std::string _submitter_name; //!< The name of the submitter
+    bool _batch_by_timestamp; //!< Whether the jobs submitted at the same date are sent in one message
+    SendFunction _send; //!< The function which sends a message to the server
+    JobSubmittedMessage * _message = nullptr; //!< The message being gathered
+};
+
 /**
  * @brief The process in charge of submitting static jobs (those described before running the simulations)
  * @param argc The number of arguments
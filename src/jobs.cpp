@@ -91,6 +91,29 @@ void BatTask::compute_tasks_progress()
     }
 }
 
+void Job::release_completed_job_data()
+{
+    std::string().swap(json_description);
+
+    delete task;
+    task = nullptr;
+
+    if (cold != nullptr)
+    {
+        if (cold->metadata.empty())
+        {
+            delete cold;
+            cold = nullptr;
+        }
+        else
+        {
+            std::deque<std::string>().swap(cold->incoming_message_buffer);
+            std::vector<int>().swap(cold->smpi_ranks_to_hosts_mapping);
+            std::string().swap(cold->kill_reason);
+        }
+    }
+}
+
 BatTask* Job::compute_job_progress()
 {
     xbt_assert(task != nullptr, "Internal error");
@@ -103,7 +126,11 @@ BatTask* Job::compute_job_progress()
 
 Jobs::~Jobs()
 {
-    for (auto mit : _jobs)
+    for (Job * job : _dense_jobs)
+    {
+        delete job;
+    }
+    for (auto mit : _sparse_jobs)
     {
         delete mit.second;
     }
@@ -136,22 +163,22 @@ void Jobs::load_from_json(const Document &doc, const string &filename)
 
         xbt_assert(!exists(j->number), "%s: duplication of job id %d",
                    error_prefix.c_str(), j->number);
-        _jobs[j->number] = j;
+        add_job(j);
     }
 }
 
 Job *Jobs::operator[](int job_number)
 {
-    auto it = _jobs.find(job_number);
-    xbt_assert(it != _jobs.end(), "Cannot get job %d: it does not exist", job_number);
-    return it->second;
+    Job * job = find(job_number);
+    xbt_assert(job != nullptr, "Cannot get job %d: it does not exist", job_number);
+    return job;
 }
 
 const Job *Jobs::operator[](int job_number) const
 {
-    auto it = _jobs.find(job_number);
-    xbt_assert(it != _jobs.end(), "Cannot get job %d: it does not exist", job_number);
-    return it->second;
+    const Job * job = find(job_number);
+    xbt_assert(job != nullptr, "Cannot get job %d: it does not exist", job_number);
+    return job;
 }
 
 Job *Jobs::at(int job_number)
@@ -170,21 +197,54 @@ void Jobs::add_job(Job *job)
                "Bad Jobs::add_job call: A job with number=%d already exists.",
                job->number);
 
-    _jobs[job->number] = job;
+    int number = job->number;
+    int dense_size = (int) _dense_jobs.size();
+    if (number >= 0 && number < dense_size)
+    {
+        _dense_jobs[number] = job;
+    }
+    else if (number >= 0 && number - dense_size < 2 * _nb_jobs + dense_slack)
+    {
+        // resize grows the capacity geometrically, which keeps additions by increasing number cheap
+        _dense_jobs.resize(number + 1, nullptr);
+        _dense_jobs[number] = job;
+    }
+    else
+    {
+        _sparse_jobs[number] = job;
+    }
+    ++_nb_jobs;
 }
 
 bool Jobs::exists(int job_number) const
 {
-    auto it = _jobs.find(job_number);
-    return it != _jobs.end();
+    return find(job_number) != nullptr;
+}
+
+Job *Jobs::find(int job_number) const
+{
+    if (job_number >= 0 && job_number < (int) _dense_jobs.size() && _dense_jobs[job_number] != nullptr)
+    {
+        return _dense_jobs[job_number];
+    }
+
+    // A sparse job may be in the range of the dense jobs if the latter grew after its addition
+    if (!_sparse_jobs.empty())
+    {
+        auto it = _sparse_jobs.find(job_number);
+        if (it != _sparse_jobs.end())
+        {
+            return it->second;
+        }
+    }
+    return nullptr;
 }
 
 bool Jobs::contains_smpi_job() const
 {
     xbt_assert(_profiles != nullptr, "Invalid Jobs::containsSMPIJob call: setProfiles had not been called yet");
-    for (auto & mit : _jobs)
+    for (const Job * job : jobs())
     {
-        Job * job = mit.second;
         if ((*_profiles)[job->profile]->type == ProfileType::SMPI)
         {
             return true;
@@ -197,34 +257,50 @@ void Jobs::displayDebug() const
 {
     // Let us traverse jobs to display some information about them
     vector<string> jobsVector;
-    for (auto & mit : _jobs)
+    for (const Job * job : jobs())
     {
-        jobsVector.push_back(std::to_string(mit.second->number));
+        jobsVector.push_back(std::to_string(job->number));
     }
 
     // Let us create the string that will be sent to XBT_INFO
     string s = "Jobs debug information:\n";
 
-    s += "There are " + to_string(_jobs.size()) + " jobs.\n";
+    s += "There are " + to_string(_nb_jobs) + " jobs.\n";
     s += "Jobs : [" + boost::algorithm::join(jobsVector, ", ") + "]";
 
     // Let us display the string which has been built
     XBT_INFO("%s", s.c_str());
 }
 
-const std::map<int, Job* > &Jobs::jobs() const
+std::vector<Job *> Jobs::jobs() const
 {
-    return _jobs;
-}
+    vector<Job *> sorted_jobs;
+    sorted_jobs.reserve(_nb_jobs);
 
-std::map<int, Job *> &Jobs::jobs()
-{
-    return _jobs;
+    for (Job * job : _dense_jobs)
+    {
+        if (job != nullptr)
+        {
+            sorted_jobs.push_back(job);
+        }
+    }
+
+    if (!_sparse_jobs.empty())
+    {
+        for (auto mit : _sparse_jobs)
+        {
+            sorted_jobs.push_back(mit.second);
+        }
+        sort(sorted_jobs.begin(), sorted_jobs.end(),
+             [](const Job * a, const Job * b) { return a->number < b->number; });
+    }
+
+    return sorted_jobs;
 }
 
 int Jobs::nb_jobs() const
 {
-    return _jobs.size();
+    return _nb_jobs;
 }
 
 bool job_comparator_subtime_number(const Job *a, const Job *b)
@@ -247,6 +323,30 @@ Job::~Job()
         delete task;
         task = nullptr;
     }
+
+    delete cold;
+    cold = nullptr;
+}
+
+JobColdData & Job::cold_data()
+{
+    if (cold == nullptr)
+    {
+        cold = new JobColdData;
+    }
+    return *cold;
+}
+
+const std::string & Job::kill_reason() const
+{
+    static const string no_kill_reason;
+    return cold != nullptr ? cold->kill_reason : no_kill_reason;
+}
+
+const std::string & Job::metadata() const
+{
+    static const string no_metadata;
+    return cold != nullptr ? cold->metadata : no_metadata;
 }
 
 bool Job::is_complete() const
@@ -388,7 +488,8 @@ Job * Job::from_json(const rapidjson::Value & json_desc,
                 error_prefix.c_str(), j->number);
 
         const auto & mapping_array = json_desc["smpi_ranks_to_hosts_mapping"];
-        j->smpi_ranks_to_hosts_mapping.resize(mapping_array.Size());
+        vector<int> & smpi_ranks_to_hosts_mapping = j->cold_data().smpi_ranks_to_hosts_mapping;
+        smpi_ranks_to_hosts_mapping.resize(mapping_array.Size());
 
         for (unsigned int i = 0; i < mapping_array.Size(); ++i)
         {
@@ -402,7 +503,7 @@ Job * Job::from_json(const rapidjson::Value & json_desc,
                        "%d has an invalid value %d : should be in [0,%d[",
                        error_prefix.c_str(), j->number, i, host_number, j->required_nb_res);
 
-            j->smpi_ranks_to_hosts_mapping[i] = host_number;
+            smpi_ranks_to_hosts_mapping[i] = host_number;
         }
     }
 
@@ -5,7 +5,9 @@
 
 #pragma once
 
+#include <cstdint>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <deque>
 
@@ -15,6 +17,7 @@
 
 #include "exact_numbers.hpp"
 #include "machine_range.hpp"
+#include "pool.hpp"
 
 using namespace std;
 
@@ -25,19 +28,51 @@ struct Job;
 
 /**
  * @brief A simple structure used to identify one job
+ * @details Workload names are interned into small integers (see intern_workload_name), so that
+ *          job identifiers are packed into 64-bit keys which can be compared and hashed without
+ *          touching strings.
  */
 struct JobIdentifier
 {
+    /**
+     * @brief Creates an invalid JobIdentifier
+     */
+    JobIdentifier() = default;
+
     /**
      * @brief Creates a JobIdentifier
      * @param[in] workload_name The workload name
      * @param[in] job_number The job number
      */
-    explicit JobIdentifier(const std::string & workload_name = "",
-                           int job_number = -1);
+    JobIdentifier(const std::string & workload_name,
+                  int job_number);
+
+    /**
+     * @brief Creates a JobIdentifier from an interned workload name
+     * @param[in] workload_id The interned workload name, as returned by intern_workload_name
+     * @param[in] job_number The job number
+     */
+    JobIdentifier(int workload_id,
+                  int job_number);
+
+    int workload_id = -1; //!< The interned name of the workload the job belongs to
+    int job_number = -1; //!< The job unique number inside its workload
+
+    /**
+     * @brief Returns the name of the workload the job belongs to
+     * @return The name of the workload the job belongs to (empty for an invalid JobIdentifier)
+     */
+    const std::string & workload_name() const;
 
-    std::string workload_name; //!< The name of the workload the job belongs to
-    int job_number; //!< The job unique number inside its workload
+    /**
+     * @brief Returns the JobIdentifier packed into a 64-bit integer
+     * @return The workload id in the upper 32 bits and the job number in the lower 32 bits
+     */
+    uint64_t key() const
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(workload_id)) << 32) |
+               static_cast<uint32_t>(job_number);
+    }
 
     /**
      * @brief Returns a string representation of the JobIdentifier.
@@ -45,15 +80,97 @@ struct JobIdentifier
      * @return A string representation of the JobIdentifier.
      */
     std::string to_string() const;
+
+    /**
+     * @brief Writes the string representation of the JobIdentifier into a string
+     * @details Output format is WORKLOAD_NAME!JOB_NUMBER. The previous content of output is
+     *          replaced, but its memory is reused: nothing is allocated once it is large enough.
+     * @param[out] output The string in which the representation is written
+     */
+    void to_string(std::string & output) const;
+
+    /**
+     * @brief Parses a job identifier of the form [WORKLOAD_NAME!]JOB_NUMBER without allocating memory
+     * @details If WORKLOAD_NAME! is omitted, WORKLOAD_NAME='static' is used.
+     *          Unless intern_workload is set, a workload name which has never been interned is not
+     *          interned (the names received from the scheduler would otherwise be kept forever):
+     *          the parsed JobIdentifier then has a workload_id of -1 and identifies no job.
+     * @param[in] str The job identifier string (not necessarily null-terminated)
+     * @param[in] length The length of str
+     * @param[out] job_id The parsed JobIdentifier (left unchanged if the string is invalid)
+     * @param[out] has_workload_name Whether the string contained a workload name
+     * @param[in] intern_workload Whether an unknown workload name should be interned (e.g. for a new dynamic job)
+     * @return Whether the string is a valid job identifier
+     */
+    static bool parse(const char * str,
+                      size_t length,
+                      JobIdentifier & job_id,
+                      bool & has_workload_name,
+                      bool intern_workload = false);
+
+    /**
+     * @brief Interns a workload name
+     * @details Names are never released. The same name always gets the same id.
+     * @param[in] workload_name The workload name
+     * @return The interned workload name, which is a small non-negative integer
+     */
+    static int intern_workload_name(const std::string & workload_name);
 };
 
 /**
- * @brief Compares two JobIdentifier thanks to their string representations
+ * @brief Returns whether two JobIdentifier are the same
  * @param[in] ji1 The first JobIdentifier
  * @param[in] ji2 The second JobIdentifier
- * @return ji1.to_string() < ji2.to_string()
+ * @return ji1.key() == ji2.key()
  */
-bool operator<(const JobIdentifier & ji1, const JobIdentifier & ji2);
+inline bool operator==(const JobIdentifier & ji1, const JobIdentifier & ji2)
+{
+    return ji1.key() == ji2.key();
+}
+
+/**
+ * @brief Returns whether two JobIdentifier are different
+ * @param[in] ji1 The first JobIdentifier
+ * @param[in] ji2 The second JobIdentifier
+ * @return ji1.key() != ji2.key()
+ */
+inline bool operator!=(const JobIdentifier & ji1, const JobIdentifier & ji2)
+{
+    return ji1.key() != ji2.key();
+}
+
+/**
+ * @brief Compares two JobIdentifier thanks to their packed keys
+ * @details Jobs are ordered by workload (in order of interning, not by name) then by number
+ *          (negative numbers last).
+ * @param[in] ji1 The first JobIdentifier
+ * @param[in] ji2 The second JobIdentifier
+ * @return ji1.key() < ji2.key()
+ */
+inline bool operator<(const JobIdentifier & ji1, const JobIdentifier & ji2)
+{
+    return ji1.key() < ji2.key();
+}
+
+namespace std
+{
+/**
+ * @brief Hashes JobIdentifier thanks to their packed keys
+ */
+template <>
+struct hash<JobIdentifier>
+{
+    /**
+     * @brief Hashes a JobIdentifier
+     * @param[in] job_id The JobIdentifier
+     * @return The hash of the JobIdentifier
+     */
+    size_t operator()(const JobIdentifier & job_id) const
+    {
+        return hash<uint64_t>()(job_id.key());
+    }
+};
+}
 
 
 /**
@@ -128,10 +245,25 @@ public:
 };
 
 
+/**
+ * @brief The data of a job which most jobs never use
+ * @details It is allocated by Job::cold_data the first time one of its fields is needed.
+ */
+struct JobColdData
+{
+    std::deque<std::string> incoming_message_buffer; //!< The buffer for incoming messages from the scheduler.
+    std::vector<int> smpi_ranks_to_hosts_mapping; //!< If the job uses a SMPI profile, stores which host number each MPI rank should use. These numbers must be in [0,required_nb_res[.
+    std::string metadata; //!< Metadata that the scheduler can set on the job
+    std::string kill_reason; //!< If the job has been killed, the kill reason is stored in this variable
+};
+
 /**
  * @brief Represents a job
+ * @details Jobs are allocated by chunks of 1024, so that the jobs of a workload are mostly contiguous in memory.
+ *          Times are stored as doubles (they come from the workload and from SimGrid's clock, which are doubles)
+ *          and the rarely used data lives in a separately allocated JobColdData.
  */
-struct Job
+struct Job : public Pooled<Job, 1024>
 {
     Job() = default;
 
@@ -142,34 +274,57 @@ struct Job
 
     // Batsim internals
     Workload * workload = nullptr; //!< The workload the job belongs to
-    int number; //!< The job unique number within its workload
-    JobIdentifier id; //!< The job unique identifier
     BatTask * task = nullptr; //!< The root task be executed by this job (profile instantiation).
-    std::string json_description; //!< The JSON description of the job
+    JobColdData * cold = nullptr; //!< The rarely used data of the job (nullptr until cold_data is called)
+    JobIdentifier id; //!< The job unique identifier
+    std::string json_description; //!< The JSON description of the job (compact and valid, emitted as is in JOB_SUBMITTED events)
     std::set<msg_process_t> execution_processes; //!< The processes involved in running the job
-    std::deque<std::string> incoming_message_buffer; //!< The buffer for incoming messages from the scheduler.
 
-    // Scheduler allocation and metadata
+    // Scheduler allocation
     MachineRange allocation; //!< The machines on which the job has been executed.
-    std::vector<int> smpi_ranks_to_hosts_mapping; //!< If the job uses a SMPI profile, stores which host number each MPI rank should use. These numbers must be in [0,required_nb_res[.
-    std::string metadata; //!< Metadata that the scheduler can set on the job
 
     // Current state
+    long double consumed_energy; //!< The sum, for each machine on which the job has been allocated, of the consumed energy (in Joules) during the job execution time (consumed_energy_after_job_completion - consumed_energy_before_job_start)
+    double starting_time; //!< The time at which the job starts to be executed.
+    double runtime; //!< The amount of time during which the job has been executed.
     JobState state; //!< The current state of the job
-    Rational starting_time; //!< The time at which the job starts to be executed.
-    Rational runtime; //!< The amount of time during which the job has been executed.
-    std::string kill_reason; //!< If the job has been killed, the kill reason is stored in this variable
+    int return_code = -1; //!< The return code of the job
     bool kill_requested = false; //!< Whether the job kill has been requested
-    long double consumed_energy; //!< The sum, for each machine on which the job has been allocated, of the consumed energy (in Joules) during the job execution time (consumed_energy_after_job_completion - consumed_energy_before_job_start)
 
     // User inputs
     std::string profile; //!< The job profile name. The corresponding profile tells how the job should be computed
-    Rational submission_time; //!< The job submission time: The time at which the becomes available
-    Rational walltime = -1; //!< The job walltime: if the job is executed for more than this amount of time, it will be killed. Set at -1 to disable this behavior
+    double submission_time; //!< The job submission time: The time at which the becomes available
+    double walltime = -1; //!< The job walltime: if the job is executed for more than this amount of time, it will be killed. Set at -1 to disable this behavior
+    int number; //!< The job unique number within its workload
     int required_nb_res; //!< The number of resources the job is requested to be executed on
-    int return_code = -1; //!< The return code of the job
 
 public:
+    /**
+     * @brief Returns the rarely used data of the job, allocating it if needed
+     * @return The rarely used data of the job
+     */
+    JobColdData & cold_data();
+
+    /**
+     * @brief Returns the kill reason of the job, without allocating its rarely used data
+     * @return The kill reason of the job (empty if the job has not been killed)
+     */
+    const std::string & kill_reason() const;
+
+    /**
+     * @brief Returns the metadata of the job, without allocating its rarely used data
+     * @return The metadata of the job (empty if the scheduler has not set any)
+     */
+    const std::string & metadata() const;
+
+    /**
+     * @brief Releases the heap data of a completed job which the output files do not need
+     * @details The JSON description, the task tree and the rarely used data are freed.
+     *          Only the metadata is kept, as it is written into the jobs output file.
+     * @pre The job has completed and its JOB_COMPLETED event has been written
+     */
+    void release_completed_job_data();
+
     /**
      * @brief Computes the task progression of this job
      * @return The task progress tree with filled-up associated values
@@ -217,6 +372,9 @@ bool job_comparator_subtime_number(const Job * a, const Job * b);
 
 /**
  * @brief Stores all the jobs of a workload
+ * @details Jobs are stored in a vector indexed by their number, so that they can be accessed in
+ *          constant time. Jobs whose number would leave the vector mostly empty (negative numbers
+ *          or numbers far beyond the others) are stored in a hash table instead.
  */
 class Jobs
 {
@@ -299,6 +457,13 @@ public:
      */
     bool exists(int job_number) const;
 
+    /**
+     * @brief Accesses one job thanks to its unique number, if it exists
+     * @param[in] job_number The job unique number
+     * @return A pointer to the job associated to the given job number, or nullptr if there is no such job
+     */
+    Job * find(int job_number) const;
+
     /**
      * @brief Allows to know whether the Jobs contains any SMPI job
      * @return True if the number of SMPI jobs in the Jobs is greater than 0.
@@ -311,16 +476,10 @@ public:
     void displayDebug() const;
 
     /**
-     * @brief Returns a copy of the std::map which contains the jobs
-     * @return A copy of the std::map which contains the jobs
+     * @brief Returns the jobs, sorted by number
+     * @return The jobs, sorted by number
      */
-    const std::map<int, Job*> & jobs() const;
-
-    /**
-     * @brief Returns a reference to the std::map which contains the jobs
-     * @return A reference to the std::map which contains the jobs
-     */
-    std::map<int, Job*> & jobs();
+    std::vector<Job*> jobs() const;
 
     /**
      * @brief Returns the number of jobs of the Jobs instance
@@ -329,7 +488,11 @@ public:
     int nb_jobs() const;
 
 private:
-    std::map<int, Job*> _jobs; //!< The std::map which contains the jobs
+    static const int dense_slack = 1024; //!< How far beyond the dense jobs a number can be to be stored densely, besides twice the number of jobs
+
+    std::vector<Job*> _dense_jobs; //!< The jobs indexed by their number (nullptr for numbers without job)
+    std::unordered_map<int, Job*> _sparse_jobs; //!< The jobs whose number does not fit in _dense_jobs
+    int _nb_jobs = 0; //!< The number of jobs
     Profiles * _profiles = nullptr; //!< The profiles associated with the jobs
     Workload * _workload = nullptr; //!< The Workload the jobs belong to
 };
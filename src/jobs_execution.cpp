@@ -124,7 +124,8 @@ int execute_task(BatTask * btask,
         bool has_messages = false;
 
         XBT_INFO("Trying to receive message from scheduler");
-        if (job->incoming_message_buffer.empty())
+        deque<string> & incoming_message_buffer = job->cold_data().incoming_message_buffer;
+        if (incoming_message_buffer.empty())
         {
             if (data->on_timeout == "")
             {
@@ -136,7 +137,7 @@ int execute_task(BatTask * btask,
                         return -1;
                     }
 
-                    if (!job->incoming_message_buffer.empty())
+                    if (!incoming_message_buffer.empty())
                     {
                         XBT_INFO("Finally got message from scheduler");
                         has_messages = true;
@@ -157,8 +158,8 @@ int execute_task(BatTask * btask,
 
         if (has_messages)
         {
-            string first_message = job->incoming_message_buffer.front();
-            job->incoming_message_buffer.pop_front();
+            string first_message = incoming_message_buffer.front();
+            incoming_message_buffer.pop_front();
 
             regex msg_regex(data->regex);
             if (regex_match(first_message, msg_regex))
@@ -217,21 +218,22 @@ int execute_task(BatTask * btask,
 
         // Let's use the default mapping is none is provided (round-robin on hosts, as we do not
         // know the number of cores on each host)
-        if (job->smpi_ranks_to_hosts_mapping.empty())
+        vector<int> & smpi_ranks_to_hosts_mapping = job->cold_data().smpi_ranks_to_hosts_mapping;
+        if (smpi_ranks_to_hosts_mapping.empty())
         {
-            job->smpi_ranks_to_hosts_mapping.resize(nb_ranks);
+            smpi_ranks_to_hosts_mapping.resize(nb_ranks);
             int host_to_use = 0;
             for (int i = 0; i < nb_ranks; ++i)
             {
-                job->smpi_ranks_to_hosts_mapping[i] = host_to_use;
+                smpi_ranks_to_hosts_mapping[i] = host_to_use;
                 ++host_to_use %= job->required_nb_res; // ++ is done first
             }
         }
 
-        xbt_assert(nb_ranks == (int) job->smpi_ranks_to_hosts_mapping.size(),
+        xbt_assert(nb_ranks == (int) smpi_ranks_to_hosts_mapping.size(),
                    "Invalid job %s: SMPI ranks_to_host mapping has an invalid size, as it should "
                    "use %d MPI ranks but the ranking states that there are %d ranks.",
-                   job->id.to_string().c_str(), nb_ranks, (int) job->smpi_ranks_to_hosts_mapping.size());
+                   job->id.to_string().c_str(), nb_ranks, (int) smpi_ranks_to_hosts_mapping.size());
 
         for (int i = 0; i < nb_ranks; ++i)
         {
@@ -255,7 +257,7 @@ int execute_task(BatTask * btask,
             argv[3] = xbt_strdup((char*) data->trace_filenames[i].c_str());
             argv[4] = xbt_strdup("0"); //
 
-            msg_host_t host_to_use = allocation->hosts[job->smpi_ranks_to_hosts_mapping[i]];
+            msg_host_t host_to_use = allocation->hosts[smpi_ranks_to_hosts_mapping[i]];
             SMPIReplayProcessArguments * message = new SMPIReplayProcessArguments;
             message->semaphore = NULL;
             message->job = job;
@@ -358,8 +360,7 @@ int execute_job_process(int argc, char *argv[])
     // Retrieving input parameters
     ExecuteJobProcessArguments * args = (ExecuteJobProcessArguments *) MSG_process_get_data(MSG_process_self());
 
-    Workload * workload = args->context->workloads.at(args->allocation->job_id.workload_name);
-    Job * job = workload->jobs->at(args->allocation->job_id.job_number);
+    Job * job = args->context->workloads.job_at(args->allocation->job_id);
     job->starting_time = MSG_get_clock();
     job->allocation = args->allocation->machine_ids;
     double remaining_time = (double)job->walltime;
@@ -382,7 +383,7 @@ int execute_job_process(int argc, char *argv[])
     SIMIX_process_on_exit(MSG_process_self(), execute_task_cleanup, cleanup_data);
 
     // Create root task
-    job->task = new BatTask(job, workload->profiles->at(job->profile));
+    job->task = new BatTask(job, job->workload->profiles->at(job->profile));
 
     // Execute the process
     job->return_code = execute_task(job->task, args->context, args->allocation,
@@ -403,7 +404,7 @@ int execute_job_process(int argc, char *argv[])
         XBT_INFO("Job %s had been killed (walltime %g reached)",
                  job->id.to_string().c_str(), (double) job->walltime);
         job->state = JobState::JOB_STATE_COMPLETED_WALLTIME_REACHED;
-        job->kill_reason = "Walltime reached";
+        job->cold_data().kill_reason = "Walltime reached";
         if (args->context->trace_schedule)
         {
             args->context->paje_tracer.add_job_kill(job, args->allocation->machine_ids,
@@ -417,7 +418,7 @@ int execute_job_process(int argc, char *argv[])
     if (job->runtime == 0)
     {
         XBT_WARN("Job '%s' computed in null time. Putting epsilon instead.", job->id.to_string().c_str());
-        job->runtime = Rational(1e-5);
+        job->runtime = 1e-5;
     }
 
     // If energy is enabled, let us compute the energy used by the machines after running the job
@@ -493,7 +494,7 @@ int killer_process(int argc, char *argv[])
     for (const JobIdentifier & job_id : args->jobs_ids)
     {
         Job * job = args->context->workloads.job_at(job_id);
-        Profile * profile = args->context->workloads.at(job_id.workload_name)->profiles->at(job->profile);
+        Profile * profile = job->workload->profiles->at(job->profile);
         (void) profile;
 
         xbt_assert(! (job->state == JobState::JOB_STATE_REJECTED ||
@@ -527,12 +528,12 @@ int killer_process(int argc, char *argv[])
 
             // Let's update the job information
             job->state = JobState::JOB_STATE_COMPLETED_KILLED;
-            job->kill_reason = "Killed from killer_process (probably requested by the decision process)";
+            job->cold_data().kill_reason = "Killed from killer_process (probably requested by the decision process)";
 
             args->context->machines.update_machines_on_job_end(job,
                                                                job->allocation,
                                                                args->context);
-            job->runtime = (Rational)MSG_get_clock() - job->starting_time;
+            job->runtime = MSG_get_clock() - job->starting_time;
 
             xbt_assert(job->runtime >= 0, "Negative runtime of killed job '%s' (%g)!",
                        job->id.to_string().c_str(), (double)job->runtime);
@@ -540,7 +541,7 @@ int killer_process(int argc, char *argv[])
             {
                 XBT_WARN("Killed job '%s' has a null runtime. Putting epsilon instead.",
                          job->id.to_string().c_str());
-                job->runtime = Rational(1e-5);
+                job->runtime = 1e-5;
             }
 
             // If energy is enabled, let us compute the energy used by the machines after running the job
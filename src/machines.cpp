@@ -6,6 +6,7 @@
 #include "machines.hpp"
 
 #include <algorithm>
+#include <tuple>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/join.hpp>
@@ -420,6 +421,69 @@ const std::map<MachineState, int> &Machines::nb_machines_in_each_state() const
     return _nb_machines_in_each_state;
 }
 
+vector<MachineGroup> Machines::group_machines() const
+{
+    // Machines are grouped by (state, properties, whether the name is a pattern, name pattern, name offset)
+    typedef std::tuple<MachineState, const map<string, string> *, bool, string, int> GroupKey;
+    struct GroupKeyComparator
+    {
+        bool operator()(const GroupKey & k1, const GroupKey & k2) const
+        {
+            const map<string, string> & properties1 = *std::get<1>(k1);
+            const map<string, string> & properties2 = *std::get<1>(k2);
+            return std::tie(std::get<0>(k1), properties1, std::get<2>(k1), std::get<3>(k1), std::get<4>(k1)) <
+                   std::tie(std::get<0>(k2), properties2, std::get<2>(k2), std::get<3>(k2), std::get<4>(k2));
+        }
+    };
+
+    vector<MachineGroup> groups;
+    map<GroupKey, size_t, GroupKeyComparator> group_index;
+
+    for (const Machine * machine : _machines)
+    {
+        MachineGroup group;
+        group.has_name_pattern = false;
+        group.name_pattern = machine->name;
+        group.name_offset = 0;
+        group.state = machine->state;
+        group.properties = &machine->properties;
+
+        // Let's find the number at the end of the machine name (if any), ignoring non-digit suffixes
+        const string & name = machine->name;
+        size_t number_end = name.find_last_of("0123456789");
+        if (number_end != string::npos && name.find("{}") == string::npos)
+        {
+            size_t number_begin = name.find_last_not_of("0123456789", number_end);
+            number_begin = (number_begin == string::npos) ? 0 : number_begin + 1;
+            size_t number_length = number_end - number_begin + 1;
+
+            // Numbers with leading zeros or which could overflow are not considered as patterns
+            if (number_length <= 9 && (number_length == 1 || name[number_begin] != '0'))
+            {
+                int number = std::stoi(name.substr(number_begin, number_length));
+                group.has_name_pattern = true;
+                group.name_pattern = name.substr(0, number_begin) + "{}" + name.substr(number_end + 1);
+                group.name_offset = number - machine->id;
+            }
+        }
+
+        GroupKey key(group.state, group.properties, group.has_name_pattern, group.name_pattern, group.name_offset);
+        auto group_it = group_index.find(key);
+        if (group_it == group_index.end())
+        {
+            group.machine_ids.insert(machine->id);
+            group_index[key] = groups.size();
+            groups.push_back(group);
+        }
+        else
+        {
+            groups[group_it->second].machine_ids.insert(machine->id);
+        }
+    }
+
+    return groups;
+}
+
 void Machines::update_machines_on_job_run(const Job * job,
                                           const MachineRange & used_machines,
                                           BatsimContext * context)
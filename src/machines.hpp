@@ -108,6 +108,22 @@ int string_numeric_comparator(const std::string & s1, const std::string & s2);
  */
 bool machine_comparator_name(const Machine * m1, const Machine * m2);
 
+/**
+ * @brief A group of machines which share the same state and properties, and whose names follow the same pattern
+ * @details The name of the machine whose id is i is name_pattern, in which "{}" is replaced by i + name_offset.
+ *          Machines whose name does not end by a number (or which contains "{}") are put in groups of their own,
+ *          in which name_pattern is the machine name.
+ */
+struct MachineGroup
+{
+    MachineRange machine_ids; //!< The machines of the group
+    std::string name_pattern; //!< The name pattern of the machines, or the machine name if has_name_pattern is false
+    bool has_name_pattern; //!< Whether name_pattern is a pattern or the name of the only machine of the group
+    int name_offset; //!< The difference between the number in a machine name and the machine id
+    MachineState state; //!< The state of the machines
+    const std::map<std::string, std::string> * properties; //!< The properties of the machines
+};
+
 /**
  * @brief Handles all the machines used in the simulation
  */
@@ -276,6 +292,13 @@ public:
      */
     const std::map<MachineState, int> & nb_machines_in_each_state() const;
 
+    /**
+     * @brief Groups the computing machines which share the same state, properties and name pattern
+     * @details Groups are sorted by the id of their first machine.
+     * @return The groups of machines
+     */
+    std::vector<MachineGroup> group_machines() const;
+
 private:
     std::vector<Machine *> _machines; //!< The vector of computing machines
     Machine * _master_machine = nullptr; //!< The master machine
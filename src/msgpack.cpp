@@ -0,0 +1,264 @@
+/**
+ * @file msgpack.cpp
+ * @brief Contains MessagePack encoding and decoding classes
+ */
+
+#include "msgpack.hpp"
+
+#include <stdlib.h>
+
+#include <xbt.h>
+
+using namespace std;
+
+MsgpackWriter::MsgpackWriter(string & output) :
+    _output(&output)
+{
+}
+
+bool MsgpackWriter::Null()
+{
+    prefix();
+    _output->push_back((char) 0xc0);
+    return true;
+}
+
+bool MsgpackWriter::Bool(bool b)
+{
+    prefix();
+    _output->push_back((char) (b ? 0xc3 : 0xc2));
+    return true;
+}
+
+bool MsgpackWriter::Int(int i)
+{
+    return Int64(i);
+}
+
+bool MsgpackWriter::Uint(unsigned u)
+{
+    return Uint64(u);
+}
+
+bool MsgpackWriter::Int64(int64_t i)
+{
+    if (i >= 0)
+    {
+        return Uint64((uint64_t) i);
+    }
+
+    prefix();
+    if (i >= -32)
+    {
+        _output->push_back((char) (int8_t) i); // negative fixint
+    }
+    else if (i >= INT8_MIN)
+    {
+        write_typed_uint(0xd0, (uint8_t) (int8_t) i, 1);
+    }
+    else if (i >= INT16_MIN)
+    {
+        write_typed_uint(0xd1, (uint16_t) (int16_t) i, 2);
+    }
+    else if (i >= INT32_MIN)
+    {
+        write_typed_uint(0xd2, (uint32_t) (int32_t) i, 4);
+    }
+    else
+    {
+        write_typed_uint(0xd3, (uint64_t) i, 8);
+    }
+    return true;
+}
+
+bool MsgpackWriter::Uint64(uint64_t u)
+{
+    prefix();
+    if (u <= 0x7f)
+    {
+        _output->push_back((char) u); // positive fixint
+    }
+    else if (u <= UINT8_MAX)
+    {
+        write_typed_uint(0xcc, u, 1);
+    }
+    else if (u <= UINT16_MAX)
+    {
+        write_typed_uint(0xcd, u, 2);
+    }
+    else if (u <= UINT32_MAX)
+    {
+        write_typed_uint(0xce, u, 4);
+    }
+    else
+    {
+        write_typed_uint(0xcf, u, 8);
+    }
+    return true;
+}
+
+bool MsgpackWriter::Double(double d)
+{
+    prefix();
+
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(double));
+    write_typed_uint(0xcb, bits, 8);
+    return true;
+}
+
+bool MsgpackWriter::RawNumber(const char * str, rapidjson::SizeType length, bool copy)
+{
+    (void) copy;
+
+    string number(str, length);
+    char * end = nullptr;
+    double d = strtod(number.c_str(), &end);
+    if (end != number.c_str() + number.size())
+    {
+        return false;
+    }
+
+    return Double(d);
+}
+
+bool MsgpackWriter::String(const char * str, rapidjson::SizeType length, bool copy)
+{
+    (void) copy;
+
+    prefix();
+    write_string(str, length);
+    return true;
+}
+
+bool MsgpackWriter::Key(const char * str, rapidjson::SizeType length, bool copy)
+{
+    return String(str, length, copy);
+}
+
+bool MsgpackWriter::StartObject()
+{
+    prefix();
+
+    OpenedContainer container;
+    container.header_offset = _output->size();
+    container.nb_values = 0;
+    container.is_object = true;
+    _containers.push_back(container);
+
+    write_typed_uint(0xdf, 0, 4); // map 32, size patched in EndObject
+    return true;
+}
+
+bool MsgpackWriter::EndObject(rapidjson::SizeType member_count)
+{
+    (void) member_count;
+    return end_container(true);
+}
+
+bool MsgpackWriter::StartArray()
+{
+    prefix();
+
+    OpenedContainer container;
+    container.header_offset = _output->size();
+    container.nb_values = 0;
+    container.is_object = false;
+    _containers.push_back(container);
+
+    write_typed_uint(0xdd, 0, 4); // array 32, size patched in EndArray
+    return true;
+}
+
+bool MsgpackWriter::EndArray(rapidjson::SizeType element_count)
+{
+    (void) element_count;
+    return end_container(false);
+}
+
+bool MsgpackWriter::IsComplete() const
+{
+    return _has_root && _containers.empty();
+}
+
+void MsgpackWriter::Reset(string & output)
+{
+    _output = &output;
+    _containers.clear();
+    _has_root = false;
+}
+
+void MsgpackWriter::prefix()
+{
+    if (_containers.empty())
+    {
+        xbt_assert(!_has_root, "Cannot write several root values in a MsgpackWriter");
+        _has_root = true;
+    }
+    else
+    {
+        _containers.back().nb_values++;
+    }
+}
+
+void MsgpackWriter::write_typed_uint(uint8_t type, uint64_t value, int nb_bytes)
+{
+    char buf[9];
+    buf[0] = (char) type;
+    for (int i = 0; i < nb_bytes; ++i)
+    {
+        buf[nb_bytes - i] = (char) ((value >> (8 * i)) & 0xff);
+    }
+    _output->append(buf, nb_bytes + 1);
+}
+
+void MsgpackWriter::write_string(const char * str, rapidjson::SizeType length)
+{
+    if (length < 32)
+    {
+        _output->push_back((char) (0xa0 | length)); // fixstr
+    }
+    else if (length <= UINT8_MAX)
+    {
+        write_typed_uint(0xd9, length, 1);
+    }
+    else if (length <= UINT16_MAX)
+    {
+        write_typed_uint(0xda, length, 2);
+    }
+    else
+    {
+        write_typed_uint(0xdb, length, 4);
+    }
+
+    _output->append(str, length);
+}
+
+bool MsgpackWriter::end_container(bool is_object)
+{
+    if (_containers.empty() || _containers.back().is_object != is_object)
+    {
+        return false;
+    }
+
+    const OpenedContainer & container = _containers.back();
+    uint32_t size = container.nb_values;
+    if (is_object)
+    {
+        if (size % 2 != 0)
+        {
+            return false; // A key has no value
+        }
+        size /= 2;
+    }
+
+    // Let's patch the 32-bit size of the container header
+    char * header = &(*_output)[container.header_offset];
+    for (int i = 0; i < 4; ++i)
+    {
+        header[4 - i] = (char) ((size >> (8 * i)) & 0xff);
+    }
+
+    _containers.pop_back();
+    return true;
+}
@@ -0,0 +1,562 @@
+/**
+ * @file msgpack.hpp
+ * @brief Contains MessagePack encoding and decoding classes
+ * @details Both classes speak the rapidjson SAX Handler concept, so MessagePack data can be
+ *          produced from any rapidjson::Value (via Accept) and decoded into any rapidjson Handler
+ *          (e.g., a rapidjson::Document via Populate).
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include <rapidjson/document.h>
+
+/**
+ * @brief Encodes SAX events into MessagePack
+ * @details Containers are written with 32-bit size headers (map 32 and array 32), whose values are
+ *          patched when the container is closed. This allows to write containers whose sizes are
+ *          unknown when they are opened (which is the case of rapidjson's SAX events).
+ */
+class MsgpackWriter
+{
+public:
+    /**
+     * @brief Builds a MsgpackWriter
+     * @param[in,out] output The string in which the encoded data is appended
+     */
+    explicit MsgpackWriter(std::string & output);
+
+    /**
+     * @brief Writes a null value
+     * @return true
+     */
+    bool Null();
+
+    /**
+     * @brief Writes a boolean value
+     * @param[in] b The value
+     * @return true
+     */
+    bool Bool(bool b);
+
+    /**
+     * @brief Writes an integer value
+     * @param[in] i The value
+     * @return true
+     */
+    bool Int(int i);
+
+    /**
+     * @brief Writes an unsigned integer value
+     * @param[in] u The value
+     * @return true
+     */
+    bool Uint(unsigned u);
+
+    /**
+     * @brief Writes a 64-bit integer value
+     * @param[in] i The value
+     * @return true
+     */
+    bool Int64(int64_t i);
+
+    /**
+     * @brief Writes a 64-bit unsigned integer value
+     * @param[in] u The value
+     * @return true
+     */
+    bool Uint64(uint64_t u);
+
+    /**
+     * @brief Writes a double value (as a MessagePack float 64, without any precision loss)
+     * @param[in] d The value
+     * @return true
+     */
+    bool Double(double d);
+
+    /**
+     * @brief Writes a number given as a string (as a MessagePack float 64)
+     * @param[in] str The number string
+     * @param[in] length The number of characters of str
+     * @param[in] copy Unused
+     * @return true on success, false otherwise
+     */
+    bool RawNumber(const char * str, rapidjson::SizeType length, bool copy = false);
+
+    /**
+     * @brief Writes a string value
+     * @param[in] str The string
+     * @param[in] length The number of bytes of str
+     * @param[in] copy Unused
+     * @return true
+     */
+    bool String(const char * str, rapidjson::SizeType length, bool copy = false);
+
+    /**
+     * @brief Writes an object key
+     * @param[in] str The key
+     * @param[in] length The number of bytes of str
+     * @param[in] copy Unused
+     * @return true
+     */
+    bool Key(const char * str, rapidjson::SizeType length, bool copy = false);
+
+    /**
+     * @brief Opens an object (a MessagePack map)
+     * @return true
+     */
+    bool StartObject();
+
+    /**
+     * @brief Closes the last opened object
+     * @param[in] member_count Unused (members are counted by the MsgpackWriter)
+     * @return true on success, false otherwise
+     */
+    bool EndObject(rapidjson::SizeType member_count = 0);
+
+    /**
+     * @brief Opens an array
+     * @return true
+     */
+    bool StartArray();
+
+    /**
+     * @brief Closes the last opened array
+     * @param[in] element_count Unused (elements are counted by the MsgpackWriter)
+     * @return true on success, false otherwise
+     */
+    bool EndArray(rapidjson::SizeType element_count = 0);
+
+    /**
+     * @brief Returns whether a complete value has been written
+     * @return Whether a complete value has been written
+     */
+    bool IsComplete() const;
+
+    /**
+     * @brief Resets the MsgpackWriter, so that a new value can be written
+     * @details The memory used to track opened containers is kept.
+     * @param[in,out] output The string in which the encoded data is appended from now on
+     */
+    void Reset(std::string & output);
+
+private:
+    /**
+     * @brief Must be called before writing any value. Counts the value in the enclosing container.
+     */
+    void prefix();
+
+    /**
+     * @brief Writes a type byte followed by a big-endian unsigned integer
+     * @param[in] type The MessagePack type byte
+     * @param[in] value The integer to write
+     * @param[in] nb_bytes The number of bytes the integer should be written on
+     */
+    void write_typed_uint(uint8_t type, uint64_t value, int nb_bytes);
+
+    /**
+     * @brief Writes a string header and the string bytes
+     * @param[in] str The string
+     * @param[in] length The number of bytes of str
+     */
+    void write_string(const char * str, rapidjson::SizeType length);
+
+    /**
+     * @brief Closes the last opened container
+     * @param[in] is_object Whether the container is an object (or an array)
+     * @return true on success, false otherwise
+     */
+    bool end_container(bool is_object);
+
+private:
+    /**
+     * @brief An opened container
+     */
+    struct OpenedContainer
+    {
+        size_t header_offset; //!< The offset of the container header in the output
+        uint32_t nb_values; //!< The number of values (keys included) written in the container
+        bool is_object; //!< Whether the container is an object (or an array)
+    };
+
+    std::string * _output; //!< The output in which encoded data is appended
+    std::vector<OpenedContainer> _containers; //!< The stack of opened containers
+    bool _has_root = false; //!< Whether a root value has been started
+};
+
+/**
+ * @brief Decodes MessagePack data and forwards its content to a rapidjson SAX handler
+ * @details MessagePack maps are forwarded as objects. Integer map keys are forwarded as strings
+ *          since JSON objects only support string keys. Binary values are forwarded as strings.
+ *          Extension types are not supported.
+ */
+class MsgpackReader
+{
+public:
+    /**
+     * @brief Builds a MsgpackReader
+     * @param[in] data The MessagePack data
+     * @param[in] size The number of bytes of data
+     */
+    MsgpackReader(const char * data, size_t size) :
+        _data(reinterpret_cast<const uint8_t *>(data)), _size(size)
+    {
+    }
+
+    /**
+     * @brief Parses exactly one MessagePack value and forwards it to a handler
+     * @param[in,out] handler The rapidjson SAX handler
+     * @return true on success, false otherwise
+     */
+    template <typename Handler>
+    bool parse(Handler & handler)
+    {
+        _offset = 0;
+        _error.clear();
+
+        if (!parse_value(handler, 0))
+        {
+            return false;
+        }
+
+        if (_offset != _size)
+        {
+            return fail("trailing bytes after the root value");
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Parses the data and forwards it to a handler. Allows to be used by rapidjson::Document::Populate.
+     * @param[in,out] handler The rapidjson SAX handler
+     * @return true on success, false otherwise
+     */
+    template <typename Handler>
+    bool operator()(Handler & handler)
+    {
+        return parse(handler);
+    }
+
+    /**
+     * @brief Returns whether the last parsing failed
+     * @return Whether the last parsing failed
+     */
+    bool has_parse_error() const { return !_error.empty(); }
+
+    /**
+     * @brief Returns a description of the last parsing error
+     * @return A description of the last parsing error (empty if there is no error)
+     */
+    const std::string & parse_error() const { return _error; }
+
+    /**
+     * @brief Returns the offset at which the last parsing stopped
+     * @return The offset at which the last parsing stopped
+     */
+    size_t offset() const { return _offset; }
+
+private:
+    /**
+     * @brief Parses one value (recursively)
+     * @param[in,out] handler The rapidjson SAX handler
+     * @param[in] depth The depth of the value
+     * @return true on success, false otherwise
+     */
+    template <typename Handler>
+    bool parse_value(Handler & handler, int depth)
+    {
+        if (depth > max_depth)
+        {
+            return fail("maximum nesting depth reached");
+        }
+
+        uint8_t type = 0;
+        if (!read_byte(type))
+        {
+            return false;
+        }
+
+        // Fixed-size types
+        if (type <= 0x7f) // positive fixint
+        {
+            return handler.Uint(type) || fail("rejected by handler");
+        }
+        else if (type >= 0xe0) // negative fixint
+        {
+            return handler.Int((int)(int8_t)type) || fail("rejected by handler");
+        }
+        else if ((type & 0xf0) == 0x80) // fixmap
+        {
+            return parse_map(handler, type & 0x0f, depth);
+        }
+        else if ((type & 0xf0) == 0x90) // fixarray
+        {
+            return parse_array(handler, type & 0x0f, depth);
+        }
+        else if ((type & 0xe0) == 0xa0) // fixstr
+        {
+            return parse_string(handler, type & 0x1f, false);
+        }
+
+        uint64_t u = 0;
+        switch (type)
+        {
+        case 0xc0: return handler.Null() || fail("rejected by handler");
+        case 0xc2: return handler.Bool(false) || fail("rejected by handler");
+        case 0xc3: return handler.Bool(true) || fail("rejected by handler");
+
+        // bin 8/16/32 and str 8/16/32
+        case 0xc4: case 0xd9: return read_uint(u, 1) && parse_string(handler, u, false);
+        case 0xc5: case 0xda: return read_uint(u, 2) && parse_string(handler, u, false);
+        case 0xc6: case 0xdb: return read_uint(u, 4) && parse_string(handler, u, false);
+
+        // float 32/64
+        case 0xca:
+        {
+            uint32_t bits;
+            if (!read_uint(u, 4))
+            {
+                return false;
+            }
+            bits = (uint32_t) u;
+            float f;
+            memcpy(&f, &bits, sizeof(float));
+            return handler.Double((double)f) || fail("rejected by handler");
+        }
+        case 0xcb:
+        {
+            if (!read_uint(u, 8))
+            {
+                return false;
+            }
+            double d;
+            memcpy(&d, &u, sizeof(double));
+            return handler.Double(d) || fail("rejected by handler");
+        }
+
+        // uint 8/16/32/64
+        case 0xcc: return read_uint(u, 1) && (handler.Uint((unsigned)u) || fail("rejected by handler"));
+        case 0xcd: return read_uint(u, 2) && (handler.Uint((unsigned)u) || fail("rejected by handler"));
+        case 0xce: return read_uint(u, 4) && (handler.Uint((unsigned)u) || fail("rejected by handler"));
+        case 0xcf: return read_uint(u, 8) && (handler.Uint64(u) || fail("rejected by handler"));
+
+        // int 8/16/32/64
+        case 0xd0: return read_uint(u, 1) && (handler.Int((int)(int8_t)u) || fail("rejected by handler"));
+        case 0xd1: return read_uint(u, 2) && (handler.Int((int)(int16_t)u) || fail("rejected by handler"));
+        case 0xd2: return read_uint(u, 4) && (handler.Int((int)(int32_t)u) || fail("rejected by handler"));
+        case 0xd3: return read_uint(u, 8) && (handler.Int64((int64_t)u) || fail("rejected by handler"));
+
+        // array 16/32, map 16/32
+        case 0xdc: return read_uint(u, 2) && parse_array(handler, u, depth);
+        case 0xdd: return read_uint(u, 4) && parse_array(handler, u, depth);
+        case 0xde: return read_uint(u, 2) && parse_map(handler, u, depth);
+        case 0xdf: return read_uint(u, 4) && parse_map(handler, u, depth);
+
+        default:
+            return fail("unsupported type byte");
+        }
+    }
+
+    /**
+     * @brief Parses the content of a map
+     * @param[in,out] handler The rapidjson SAX handler
+     * @param[in] nb_members The number of key-value pairs of the map
+     * @param[in] depth The depth of the map
+     * @return true on success, false otherwise
+     */
+    template <typename Handler>
+    bool parse_map(Handler & handler, uint64_t nb_members, int depth)
+    {
+        if (!handler.StartObject())
+        {
+            return fail("rejected by handler");
+        }
+
+        for (uint64_t i = 0; i < nb_members; ++i)
+        {
+            if (!parse_key(handler) || !parse_value(handler, depth + 1))
+            {
+                return false;
+            }
+        }
+
+        return handler.EndObject((rapidjson::SizeType) nb_members) || fail("rejected by handler");
+    }
+
+    /**
+     * @brief Parses the content of an array
+     * @param[in,out] handler The rapidjson SAX handler
+     * @param[in] nb_elements The number of elements of the array
+     * @param[in] depth The depth of the array
+     * @return true on success, false otherwise
+     */
+    template <typename Handler>
+    bool parse_array(Handler & handler, uint64_t nb_elements, int depth)
+    {
+        if (!handler.StartArray())
+        {
+            return fail("rejected by handler");
+        }
+
+        for (uint64_t i = 0; i < nb_elements; ++i)
+        {
+            if (!parse_value(handler, depth + 1))
+            {
+                return false;
+            }
+        }
+
+        return handler.EndArray((rapidjson::SizeType) nb_elements) || fail("rejected by handler");
+    }
+
+    /**
+     * @brief Parses a map key. String keys are forwarded as-is, integer keys are converted to strings.
+     * @param[in,out] handler The rapidjson SAX handler
+     * @return true on success, false otherwise
+     */
+    template <typename Handler>
+    bool parse_key(Handler & handler)
+    {
+        uint8_t type = 0;
+        if (!read_byte(type))
+        {
+            return false;
+        }
+
+        uint64_t u = 0;
+        if ((type & 0xe0) == 0xa0)
+        {
+            return parse_string(handler, type & 0x1f, true);
+        }
+        else if (type == 0xd9 || type == 0xda || type == 0xdb)
+        {
+            int nb_bytes = (type == 0xd9) ? 1 : ((type == 0xda) ? 2 : 4);
+            return read_uint(u, nb_bytes) && parse_string(handler, u, true);
+        }
+
+        // Integer keys
+        char buf[24];
+        int len;
+        if (type <= 0x7f)
+        {
+            len = snprintf(buf, sizeof(buf), "%u", (unsigned) type);
+        }
+        else if (type >= 0xe0)
+        {
+            len = snprintf(buf, sizeof(buf), "%d", (int)(int8_t)type);
+        }
+        else if (type >= 0xcc && type <= 0xcf)
+        {
+            if (!read_uint(u, 1 << (type - 0xcc)))
+            {
+                return false;
+            }
+            len = snprintf(buf, sizeof(buf), "%llu", (unsigned long long) u);
+        }
+        else if (type >= 0xd0 && type <= 0xd3)
+        {
+            int nb_bytes = 1 << (type - 0xd0);
+            if (!read_uint(u, nb_bytes))
+            {
+                return false;
+            }
+            long long i = (nb_bytes == 1) ? (int8_t)u : ((nb_bytes == 2) ? (int16_t)u :
+                          ((nb_bytes == 4) ? (int32_t)u : (int64_t)u));
+            len = snprintf(buf, sizeof(buf), "%lld", i);
+        }
+        else
+        {
+            return fail("map keys must be strings or integers");
+        }
+
+        return handler.Key(buf, (rapidjson::SizeType) len, true) || fail("rejected by handler");
+    }
+
+    /**
+     * @brief Forwards the string which starts at the current offset
+     * @param[in,out] handler The rapidjson SAX handler
+     * @param[in] length The number of bytes of the string
+     * @param[in] is_key Whether the string is a map key
+     * @return true on success, false otherwise
+     */
+    template <typename Handler>
+    bool parse_string(Handler & handler, uint64_t length, bool is_key)
+    {
+        if (length > _size - _offset)
+        {
+            return fail("truncated string");
+        }
+
+        const char * str = reinterpret_cast<const char *>(_data + _offset);
+        _offset += length;
+
+        bool ret = is_key ? handler.Key(str, (rapidjson::SizeType) length, true)
+                          : handler.String(str, (rapidjson::SizeType) length, true);
+        return ret || fail("rejected by handler");
+    }
+
+    /**
+     * @brief Reads one byte
+     * @param[out] byte The byte read
+     * @return true on success, false otherwise
+     */
+    bool read_byte(uint8_t & byte)
+    {
+        if (_offset >= _size)
+        {
+            return fail("unexpected end of data");
+        }
+
+        byte = _data[_offset++];
+        return true;
+    }
+
+    /**
+     * @brief Reads a big-endian unsigned integer
+     * @param[out] value The integer read
+     * @param[in] nb_bytes The number of bytes of the integer
+     * @return true on success, false otherwise
+     */
+    bool read_uint(uint64_t & value, int nb_bytes)
+    {
+        if ((size_t) nb_bytes > _size - _offset)
+        {
+            return fail("unexpected end of data");
+        }
+
+        value = 0;
+        for (int i = 0; i < nb_bytes; ++i)
+        {
+            value = (value << 8) | _data[_offset++];
+        }
+        return true;
+    }
+
+    /**
+     * @brief Stores an error
+     * @param[in] reason The reason of the error
+     * @return false
+     */
+    bool fail(const char * reason)
+    {
+        if (_error.empty())
+        {
+            _error = std::string(reason) + " (at byte " + std::to_string(_offset) + ")";
+        }
+        return false;
+    }
+
+private:
+    static const int max_depth = 256; //!< The maximum nesting depth of the parsed values
+    const uint8_t * _data; //!< The MessagePack data
+    size_t _size; //!< The number of bytes of _data
+    size_t _offset = 0; //!< The current parsing offset
+    std::string _error; //!< The last parsing error
+};
@@ -12,9 +12,6 @@
 #include <chrono>
 #include <stdexcept>
 
-#include <boost/algorithm/string.hpp>
-#include <boost/algorithm/string/join.hpp>
-
 #include <boost/locale.hpp>
 
 #include <simgrid/msg.h>
@@ -33,45 +30,149 @@ int request_reply_scheduler_process(int argc, char *argv[])
 
     RequestReplyProcessArguments * args = (RequestReplyProcessArguments *) MSG_process_get_data(MSG_process_self());
     BatsimContext * context = args->context;
+    SchedulerCallMeasures & measures = args->measures;
 
-    XBT_DEBUG("Buffer received in REQ-REP: '%s'", args->send_buffer.c_str());
+    if (context->scheduler_plugin != nullptr)
+    {
+        // The scheduler lives in Batsim's process: events and decisions are exchanged without serialization nor socket
+        chrono::nanoseconds scheduler_latency;
+        flush_batsim_outputs_in_background(context);
+        auto call_start = chrono::steady_clock::now();
+        context->scheduler_plugin->call(scheduler_latency);
+        auto call_end = chrono::steady_clock::now();
+
+        Rational elapsed_microseconds = (double) chrono::duration <long double, micro> (scheduler_latency).count();
+        context->microseconds_used_by_scheduler += elapsed_microseconds;
+
+        measures.waiting = scheduler_latency;
+        measures.decoding = chrono::duration_cast<chrono::nanoseconds>(call_end - call_start) - scheduler_latency;
+        context->scheduler_calls.record_call(measures);
+
+        delete args;
+        return 0;
+    }
 
-    // Let's make sure the message is sent as UTF-8
-    string message_to_send = args->send_buffer;
+    const ProtocolMessage & message_to_send = args->send_buffer;
+    XBT_DEBUG("Buffer received in REQ-REP: '%.*s'", (int) message_to_send.size, message_to_send.data);
 
     // Send the message
-    XBT_INFO("Sending '%s'", message_to_send.c_str());
-    context->zmq_socket->send(message_to_send.data(), message_to_send.size());
-
-    auto start = chrono::steady_clock::now();
-    string message_received;
+    if (XBT_LOG_ISENABLED(network, xbt_log_priority_info))
+    {
+        if (is_json_message(message_to_send.data, message_to_send.size))
+        {
+            XBT_INFO("Sending '%.*s'", (int) message_to_send.size, message_to_send.data);
+        }
+        else
+        {
+            XBT_INFO("Sending a binary message (%zu bytes)", message_to_send.size);
+        }
+    }
 
-    try
+    // Big messages are compressed if compression is enabled
+    ProtocolMessage frame_to_send = message_to_send;
+    if (context->compression_enabled && message_to_send.size >= context->compression_threshold)
     {
-        // Get the reply
-        zmq::message_t reply;
-        context->zmq_socket->recv(&reply);
+        auto compression_start = chrono::steady_clock::now();
+        frame_to_send = context->compressor->compress(message_to_send);
+        measures.compression = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - compression_start);
+    }
+    measures.sent_bytes = frame_to_send.size;
+
+    string frame_received;
+    const string * frame = &frame_received;
+    chrono::nanoseconds scheduler_latency;
 
-        string raw_message_received((char *)reply.data(), reply.size());
-        message_received = raw_message_received;
-        XBT_INFO("Received '%s'", message_received.c_str());
+    if (context->conversation_replayer != nullptr)
+    {
+        // There is no scheduler: the reply and the time taken to send it come from a recorded conversation
+        frame = &context->conversation_replayer->replay_exchange(frame_to_send, scheduler_latency);
     }
-    catch(const std::runtime_error & error)
+    else
     {
-        XBT_INFO("Runtime error received: %s", error.what());
-        XBT_INFO("Flushing output files...");
+        auto sending_start = chrono::steady_clock::now();
+        if (context->shm_transport != nullptr)
+        {
+            context->shm_transport->send(frame_to_send.data, frame_to_send.size);
+        }
+        else
+        {
+            context->zmq_socket->send(frame_to_send.data, frame_to_send.size);
+        }
+
+        auto start = chrono::steady_clock::now();
+        measures.sending = chrono::duration_cast<chrono::nanoseconds>(start - sending_start);
+
+        // The traces are written while the scheduler takes its decisions
+        flush_batsim_outputs_in_background(context);
+
+        try
+        {
+            // Get the reply
+            if (context->shm_transport != nullptr)
+            {
+                context->shm_transport->recv(frame_received);
+            }
+            else
+            {
+                zmq::message_t reply;
+                context->zmq_socket->recv(&reply);
+                frame_received.assign((char *)reply.data(), reply.size());
+            }
+        }
+        catch(const std::runtime_error & error)
+        {
+            XBT_INFO("Runtime error received: %s", error.what());
+            XBT_INFO("Flushing output files...");
+
+            finalize_batsim_outputs(context);
+            if (context->conversation_recorder != nullptr)
+            {
+                context->conversation_recorder->flush();
+            }
+
+            XBT_INFO("Output files flushed. Aborting execution now.");
+            throw runtime_error("Execution aborted (connection broken)");
+        }
+
+        auto end = chrono::steady_clock::now();
+        scheduler_latency = chrono::duration_cast<chrono::nanoseconds>(end - start);
+
+        if (context->conversation_recorder != nullptr)
+        {
+            context->conversation_recorder->record_exchange(frame_to_send, frame_received, scheduler_latency);
+        }
+    }
 
-        finalize_batsim_outputs(context);
+    Rational elapsed_microseconds = (double) chrono::duration <long double, micro> (scheduler_latency).count();
+    context->microseconds_used_by_scheduler += elapsed_microseconds;
+    measures.waiting = scheduler_latency;
+    measures.received_bytes = frame->size();
 
-        XBT_INFO("Output files flushed. Aborting execution now.");
-        throw runtime_error("Execution aborted (connection broken)");
+    // Compressed replies are accepted whether compression is enabled or not
+    const string * message_received = frame;
+    if (MessageCompressor::is_compressed(frame->data(), frame->size()))
+    {
+        auto decompression_start = chrono::steady_clock::now();
+        message_received = &context->compressor->decompress(frame->data(), frame->size());
+        measures.decompression = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - decompression_start);
     }
 
-    auto end = chrono::steady_clock::now();
-    Rational elapsed_microseconds = (double) chrono::duration <long double, micro> (end - start).count();
-    context->microseconds_used_by_scheduler += elapsed_microseconds;
+    if (XBT_LOG_ISENABLED(network, xbt_log_priority_info))
+    {
+        if (is_json_message(message_received->data(), message_received->size()))
+        {
+            XBT_INFO("Received '%s'", message_received->c_str());
+        }
+        else
+        {
+            XBT_INFO("Received a binary message (%zu bytes)", message_received->size());
+        }
+    }
 
-    context->proto_reader->parse_and_apply_message(message_received);
+    auto decoding_start = chrono::steady_clock::now();
+    context->proto_reader->parse_and_apply_message(*message_received);
+    measures.decoding = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - decoding_start);
+    context->scheduler_calls.record_call(measures);
 
     delete args;
     return 0;
@@ -99,24 +200,28 @@ bool identify_job_from_string(BatsimContext * context,
                               JobIdentifier & job_id,
                               IdentifyJobReturnCondition return_condition)
 {
-    // Let's split the job_identifier by '!'
-    vector<string> job_identifier_parts;
-    boost::split(job_identifier_parts, job_identifier_string, boost::is_any_of("!"), boost::token_compress_on);
+    return identify_job_from_string(context, job_identifier_string.data(), job_identifier_string.size(),
+                                    job_id, return_condition);
+}
 
-    if (job_identifier_parts.size() == 1)
-    {
-        XBT_WARN("Job ID is not of format WORKLOAD!NUMBER... assuming static!");
-        job_id.workload_name = "static";
-        job_id.job_number = std::stoi(job_identifier_parts[0]);
-    }
-    else if (job_identifier_parts.size() == 2)
+bool identify_job_from_string(BatsimContext * context,
+                              const char * job_identifier_string,
+                              size_t length,
+                              JobIdentifier & job_id,
+                              IdentifyJobReturnCondition return_condition)
+{
+    // Only a job which does not exist yet (a dynamic submission) may belong to a workload Batsim does not know.
+    // Other unknown workload names are not interned: they identify no job.
+    bool has_workload_name = false;
+    const bool intern_workload = (return_condition == IdentifyJobReturnCondition::STRING_VALID__JOB_DOES_NOT_EXISTS);
+    if (!JobIdentifier::parse(job_identifier_string, length, job_id, has_workload_name, intern_workload))
     {
-        job_id.workload_name = job_identifier_parts[0];
-        job_id.job_number = std::stoi(job_identifier_parts[1]);
+        return false;
     }
-    else
+
+    if (!has_workload_name)
     {
-        return false;
+        XBT_WARN("Job ID is not of format WORKLOAD!NUMBER... assuming static!");
     }
 
     if (return_condition == IdentifyJobReturnCondition::STRING_VALID)
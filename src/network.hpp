@@ -69,3 +69,19 @@ bool identify_job_from_string(BatsimContext * context,
                               JobIdentifier & job_id,
                               IdentifyJobReturnCondition return_condition = IdentifyJobReturnCondition::STRING_VALID__JOB_EXISTS);
 
+/**
+ * @brief Retrieves the workload_name and the job_id from a job_identifier, without allocating memory
+ * @details Job identifiers are in the form [WORKLOAD_NAME!]JOB_ID
+ * @param[in] context The BatsimContext
+ * @param[in] job_identifier_string The input job identifier string (not necessarily null-terminated)
+ * @param[in] length The length of job_identifier_string
+ * @param[out] job_id The output JobIdentifier
+ * @param[in] return_condition Specifies what the function should return
+ * @return Depends on return_condition
+ */
+bool identify_job_from_string(BatsimContext * context,
+                              const char * job_identifier_string,
+                              size_t length,
+                              JobIdentifier & job_id,
+                              IdentifyJobReturnCondition return_condition = IdentifyJobReturnCondition::STRING_VALID__JOB_EXISTS);
+
@@ -0,0 +1,463 @@
+/**
+ * @file plugin_protocol.cpp
+ * @brief Contains the classes which let Batsim use a scheduler loaded as a plugin into its process
+ */
+
+#include "plugin_protocol.hpp"
+
+#include <dlfcn.h>
+
+#include <algorithm>
+
+#include <simgrid/msg.h>
+#include <xbt.h>
+
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include "context.hpp"
+#include "jobs.hpp"
+#include "network.hpp"
+
+using namespace std;
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(plugin, "plugin"); //!< Logging
+
+/**
+ * @brief Converts a MachineRange into the intervals given to scheduler plugins
+ * @param[in] range The MachineRange
+ * @param[out] intervals The intervals
+ */
+static void machine_range_to_intervals(const MachineRange & range, PluginResourceIntervals & intervals)
+{
+    intervals.clear();
+    for (auto it = range.intervals_begin(); it != range.intervals_end(); ++it)
+    {
+        intervals.push_back(std::make_pair(it->lower(), it->upper()));
+    }
+}
+
+/**
+ * @brief Converts the intervals given by scheduler plugins into a MachineRange
+ * @param[in] intervals The intervals
+ * @return The MachineRange
+ */
+static MachineRange intervals_to_machine_range(const PluginResourceIntervals & intervals)
+{
+    MachineRange range;
+    for (const auto & interval : intervals)
+    {
+        xbt_assert(interval.first <= interval.second,
+                   "Invalid decision from the scheduler plugin: invalid resource interval [%d,%d]",
+                   interval.first, interval.second);
+        range.insert(MachineRange::ClosedInterval(interval.first, interval.second));
+    }
+    return range;
+}
+
+/**
+ * @brief Serializes a rapidjson value into JSON text
+ * @param[in] value The value
+ * @return The JSON text
+ */
+static string json_to_string(const rapidjson::Value & value)
+{
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    value.Accept(writer);
+    return string(buffer.GetString(), buffer.GetSize());
+}
+
+
+
+PluginProtocolWriter::PluginProtocolWriter(BatsimContext * context) :
+    _context(context)
+{
+}
+
+PluginProtocolWriter::~PluginProtocolWriter()
+{
+}
+
+PluginEvent & PluginProtocolWriter::append_event(PluginEventType type, const char * protocol_type, double date)
+{
+    xbt_assert(date >= _last_date, "Date inconsistency");
+    _last_date = date;
+
+    if (!_has_triggering_events)
+    {
+        const std::vector<std::string> & deferred_types = _context->protocol_deferred_events;
+        _has_triggering_events = std::find(deferred_types.begin(), deferred_types.end(), protocol_type) == deferred_types.end();
+    }
+
+    _events.emplace_back();
+    PluginEvent & event = _events.back();
+    event.type = type;
+    event.timestamp = date;
+    return event;
+}
+
+void PluginProtocolWriter::append_simulation_begins(Machines & machines,
+                                                    Workloads & workloads,
+                                                    const rapidjson::Document & configuration,
+                                                    bool allow_time_sharing,
+                                                    double date)
+{
+    (void) workloads;
+
+    PluginEvent & event = append_event(PluginEventType::SIMULATION_BEGINS, "SIMULATION_BEGINS", date);
+    event.nb_resources = machines.nb_machines();
+    event.allow_time_sharing = allow_time_sharing;
+    event.json = json_to_string(configuration);
+}
+
+void PluginProtocolWriter::append_simulation_ends(double date)
+{
+    append_event(PluginEventType::SIMULATION_ENDS, "SIMULATION_ENDS", date);
+}
+
+void PluginProtocolWriter::append_job_submitted(const JobIdentifier & job_id,
+                                                const string & profile_name,
+                                                const string & job_json_description,
+                                                const string & profile_json_description,
+                                                double date)
+{
+    (void) profile_json_description;
+
+    PluginEvent & event = append_event(PluginEventType::JOB_SUBMITTED, "JOB_SUBMITTED", date);
+    job_id.to_string(event.job_id);
+    event.profile = profile_name;
+    event.json = job_json_description;
+
+    const Job * job = _context->workloads.job_at(job_id);
+    event.nb_requested_resources = job->required_nb_res;
+    event.walltime = (double) job->walltime;
+}
+
+void PluginProtocolWriter::append_job_completed(const JobIdentifier & job_id,
+                                                const string & job_status,
+                                                const string & job_state,
+                                                const string & kill_reason,
+                                                const string & job_alloc,
+                                                int return_code,
+                                                double date)
+{
+    PluginEvent & event = append_event(PluginEventType::JOB_COMPLETED, "JOB_COMPLETED", date);
+    job_id.to_string(event.job_id);
+    event.job_status = job_status;
+    event.job_state = job_state;
+    event.kill_reason = kill_reason;
+    event.return_code = return_code;
+    machine_range_to_intervals(MachineRange::from_string_hyphen(job_alloc, " ", "-"), event.resources);
+}
+
+void PluginProtocolWriter::append_job_killed(const vector<JobIdentifier> & job_ids,
+                                             const map<JobIdentifier, BatTask *> & job_progress,
+                                             double date)
+{
+    (void) job_progress;
+
+    PluginEvent & event = append_event(PluginEventType::JOB_KILLED, "JOB_KILLED", date);
+    event.job_ids.resize(job_ids.size());
+    for (size_t i = 0; i < job_ids.size(); ++i)
+    {
+        job_ids[i].to_string(event.job_ids[i]);
+    }
+}
+
+void PluginProtocolWriter::append_from_job_message(const JobIdentifier & job_id,
+                                                   const rapidjson::Document & message,
+                                                   double date)
+{
+    PluginEvent & event = append_event(PluginEventType::FROM_JOB_MSG, "FROM_JOB_MSG", date);
+    job_id.to_string(event.job_id);
+    event.json = json_to_string(message);
+}
+
+void PluginProtocolWriter::append_resource_state_changed(const MachineRange & resources,
+                                                         const string & new_state,
+                                                         double date)
+{
+    PluginEvent & event = append_event(PluginEventType::RESOURCE_STATE_CHANGED, "RESOURCE_STATE_CHANGED", date);
+    machine_range_to_intervals(resources, event.resources);
+    event.state = new_state;
+}
+
+void PluginProtocolWriter::append_query_estimate_waiting_time(const string & job_id,
+                                                              const string & job_json_description,
+                                                              double date)
+{
+    (void) job_id;
+    (void) job_json_description;
+    (void) date;
+    xbt_die("QUERY events are not supported by scheduler plugins");
+}
+
+void PluginProtocolWriter::append_answer_energy(double consumed_energy,
+                                                double date)
+{
+    (void) consumed_energy;
+    (void) date;
+    xbt_die("ANSWER events are not supported by scheduler plugins");
+}
+
+void PluginProtocolWriter::append_requested_call(double date)
+{
+    append_event(PluginEventType::REQUESTED_CALL, "REQUESTED_CALL", date);
+}
+
+void PluginProtocolWriter::clear()
+{
+    _events.clear();
+    _has_triggering_events = false;
+}
+
+ProtocolMessage PluginProtocolWriter::generate_current_message(double date)
+{
+    xbt_assert(date >= _last_date, "Date inconsistency");
+
+    // The events are handed over to the scheduler, the previous ones are recycled by clear
+    std::swap(_events, _sent_events);
+    _sent_date = date;
+
+    return ProtocolMessage{nullptr, 0};
+}
+
+
+
+PluginProtocolReader::PluginProtocolReader(BatsimContext * context) :
+    _context(context)
+{
+}
+
+void PluginProtocolReader::parse_and_apply_message(const string & message)
+{
+    (void) message;
+    xbt_die("Scheduler plugins do not send protocol messages");
+}
+
+JobIdentifier PluginProtocolReader::identify_job(const string & job_id,
+                                                 int decision_number,
+                                                 const char * decision_type)
+{
+    (void) decision_number; // Avoids a warning if assertions are ignored
+    (void) decision_type;
+
+    JobIdentifier job_identifier;
+    if (!identify_job_from_string(_context, job_id, job_identifier))
+    {
+        xbt_assert(false, "Invalid decision from the scheduler plugin: in decision %d (%s): "
+                          "The job identifier '%s' is not valid. "
+                          "Job identifiers must be of the form [WORKLOAD_NAME!]JOB_ID. "
+                          "If WORKLOAD_NAME! is omitted, WORKLOAD_NAME='static' is used. "
+                          "Furthermore, the corresponding job must exist.",
+                   decision_number, decision_type, job_id.c_str());
+    }
+
+    return job_identifier;
+}
+
+SchedulingAllocation * PluginProtocolReader::build_allocation(const PluginDecision & decision,
+                                                              int decision_number)
+{
+    SchedulingAllocation * allocation = new SchedulingAllocation;
+    allocation->job_id = identify_job(decision.job_id, decision_number, "EXECUTE_JOB");
+    allocation->machine_ids = intervals_to_machine_range(decision.resources);
+
+    int nb_allocated_resources = allocation->machine_ids.size();
+    xbt_assert(nb_allocated_resources > 0, "Invalid decision from the scheduler plugin: in decision %d (EXECUTE_JOB): "
+               "the number of allocated resources should be strictly positive (got %d).",
+               decision_number, nb_allocated_resources);
+
+    if (decision.mapping.empty())
+    {
+        // Default mapping
+        allocation->mapping.resize(nb_allocated_resources);
+        for (int i = 0; i < nb_allocated_resources; ++i)
+        {
+            allocation->mapping[i] = i;
+        }
+    }
+    else
+    {
+        for (unsigned int executor = 0; executor < decision.mapping.size(); ++executor)
+        {
+            xbt_assert(decision.mapping[executor] >= 0 && decision.mapping[executor] < nb_allocated_resources,
+                       "Invalid decision from the scheduler plugin: in decision %d (EXECUTE_JOB): executor %u "
+                       "should use the %d-th resource within the allocation, but there are only %d allocated resources.",
+                       decision_number, executor, decision.mapping[executor], nb_allocated_resources);
+        }
+        allocation->mapping = decision.mapping;
+    }
+
+    return allocation;
+}
+
+void PluginProtocolReader::apply_decisions(const vector<PluginDecision> & decisions, double now)
+{
+    double previous_date = MSG_get_clock();
+    ExecuteJobsMessage * execute_message = nullptr;
+    double execute_date = 0;
+
+    for (unsigned int i = 0; i < decisions.size(); ++i)
+    {
+        const PluginDecision & decision = decisions[i];
+        xbt_assert(decision.timestamp >= previous_date,
+                   "Invalid decision from the scheduler plugin: decision %u is dated %g, "
+                   "which is before the previous decision or the current time (%g)",
+                   i, decision.timestamp, previous_date);
+        xbt_assert(decision.timestamp <= now,
+                   "Invalid decision from the scheduler plugin: decision %u is dated %g, "
+                   "which is after the date returned by the scheduler (%g)",
+                   i, decision.timestamp, now);
+        previous_date = decision.timestamp;
+
+        // Consecutive EXECUTE_JOB decisions taken at the same date are injected as one message
+        if (execute_message != nullptr &&
+            (decision.type != PluginDecisionType::EXECUTE_JOB || decision.timestamp != execute_date))
+        {
+            send_message(execute_date, "server", IPMessageType::SCHED_EXECUTE_JOBS, (void*) execute_message);
+            execute_message = nullptr;
+        }
+
+        switch (decision.type)
+        {
+        case PluginDecisionType::EXECUTE_JOB:
+        {
+            if (execute_message == nullptr)
+            {
+                execute_message = new ExecuteJobsMessage;
+                execute_date = decision.timestamp;
+            }
+            execute_message->allocations.push_back(build_allocation(decision, i));
+        } break;
+        case PluginDecisionType::REJECT_JOB:
+        {
+            JobRejectedMessage * message = new JobRejectedMessage;
+            message->job_id = identify_job(decision.job_id, i, "REJECT_JOB");
+
+            Job * job = _context->workloads.job_at(message->job_id);
+            (void) job; // Avoids a warning if assertions are ignored
+            xbt_assert(job->state == JobState::JOB_STATE_SUBMITTED,
+                       "Invalid decision from the scheduler plugin: "
+                       "job %s cannot be rejected at the present time. "
+                       "For being rejected, a job must be submitted and not allocated yet.",
+                       job->id.to_string().c_str());
+
+            send_message(decision.timestamp, "server", IPMessageType::SCHED_REJECT_JOB, (void*) message);
+        } break;
+        case PluginDecisionType::KILL_JOBS:
+        {
+            xbt_assert(!decision.job_ids.empty(), "Invalid decision from the scheduler plugin: "
+                       "decision %u (KILL_JOBS) should contain at least one job", i);
+
+            KillJobMessage * message = new KillJobMessage;
+            message->jobs_ids.reserve(decision.job_ids.size());
+            for (const string & job_id : decision.job_ids)
+            {
+                message->jobs_ids.push_back(identify_job(job_id, i, "KILL_JOBS"));
+            }
+
+            send_message(decision.timestamp, "server", IPMessageType::SCHED_KILL_JOB, (void*) message);
+        } break;
+        case PluginDecisionType::CALL_ME_LATER:
+        {
+            CallMeLaterMessage * message = new CallMeLaterMessage;
+            message->target_time = decision.call_date;
+
+            if (message->target_time < MSG_get_clock())
+            {
+                XBT_WARN("Decision %u (CALL_ME_LATER) asks to be called at time %g but it is already reached", i, message->target_time);
+            }
+
+            send_message(decision.timestamp, "server", IPMessageType::SCHED_CALL_ME_LATER, (void*) message);
+        } break;
+        case PluginDecisionType::SET_RESOURCE_STATE:
+        {
+            PStateModificationMessage * message = new PStateModificationMessage;
+            message->machine_ids = intervals_to_machine_range(decision.resources);
+            message->new_pstate = decision.pstate;
+            xbt_assert(message->machine_ids.size() > 0, "Invalid decision from the scheduler plugin: "
+                       "decision %u (SET_RESOURCE_STATE) should contain at least one resource", i);
+
+            send_message(decision.timestamp, "server", IPMessageType::PSTATE_MODIFICATION, (void*) message);
+        } break;
+        case PluginDecisionType::SUBMISSION_FINISHED:
+        {
+            send_message(decision.timestamp, "server", IPMessageType::END_DYNAMIC_SUBMIT);
+        } break;
+        case PluginDecisionType::CONTINUE_SUBMISSION:
+        {
+            send_message(decision.timestamp, "server", IPMessageType::CONTINUE_DYNAMIC_SUBMIT);
+        } break;
+        default:
+            xbt_assert(false, "Invalid decision from the scheduler plugin: decision %u has an unknown type (%d)",
+                       i, (int) decision.type);
+        }
+    }
+
+    if (execute_message != nullptr)
+    {
+        send_message(execute_date, "server", IPMessageType::SCHED_EXECUTE_JOBS, (void*) execute_message);
+    }
+
+    send_message(now, "server", IPMessageType::SCHED_READY);
+}
+
+
+
+PluginScheduler::PluginScheduler(const string & filename,
+                                 const rapidjson::Document & configuration,
+                                 PluginProtocolWriter * writer,
+                                 PluginProtocolReader * reader) :
+    _writer(writer),
+    _reader(reader)
+{
+    _library = dlopen(filename.c_str(), RTLD_NOW | RTLD_LOCAL);
+    xbt_assert(_library != nullptr, "Cannot load scheduler plugin '%s': %s", filename.c_str(), dlerror());
+
+    typedef SchedulerPlugin * (*CreateFunction)(int, const char *);
+    typedef void (*DestroyFunction)(SchedulerPlugin *);
+
+    CreateFunction create_scheduler = (CreateFunction) dlsym(_library, "batsim_create_scheduler");
+    xbt_assert(create_scheduler != nullptr, "Invalid scheduler plugin '%s': it does not define "
+               "the batsim_create_scheduler function", filename.c_str());
+
+    _destroy_scheduler = (DestroyFunction) dlsym(_library, "batsim_destroy_scheduler");
+    xbt_assert(_destroy_scheduler != nullptr, "Invalid scheduler plugin '%s': it does not define "
+               "the batsim_destroy_scheduler function", filename.c_str());
+
+    _scheduler = create_scheduler(BATSIM_SCHEDULER_PLUGIN_API_VERSION, json_to_string(configuration).c_str());
+    xbt_assert(_scheduler != nullptr, "Scheduler plugin '%s' could not create its scheduler "
+               "(Batsim's plugin interface version is %d)", filename.c_str(), BATSIM_SCHEDULER_PLUGIN_API_VERSION);
+
+    XBT_INFO("Scheduler plugin '%s' has been loaded", filename.c_str());
+}
+
+PluginScheduler::~PluginScheduler()
+{
+    _destroy_scheduler(_scheduler);
+    _scheduler = nullptr;
+
+    dlclose(_library);
+    _library = nullptr;
+}
+
+void PluginScheduler::call(chrono::nanoseconds & latency)
+{
+    const vector<PluginEvent> & events = _writer->sent_events();
+    double now = _writer->sent_date();
+    XBT_INFO("Calling the scheduler plugin with %zu events", events.size());
+
+    _decisions.clear();
+    auto start = chrono::steady_clock::now();
+    double reply_now = _scheduler->take_decisions(now, events, _decisions);
+    auto end = chrono::steady_clock::now();
+    latency = chrono::duration_cast<chrono::nanoseconds>(end - start);
+
+    XBT_INFO("The scheduler plugin took %zu decisions", _decisions.size());
+    xbt_assert(reply_now >= now, "Invalid reply from the scheduler plugin: it is done at %g, "
+               "which is before the date at which it has been called (%g)", reply_now, now);
+
+    _reader->apply_decisions(_decisions, reply_now);
+}
@@ -0,0 +1,310 @@
+/**
+ * @file plugin_protocol.hpp
+ * @brief Contains the classes which let Batsim use a scheduler loaded as a plugin into its process
+ */
+
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <rapidjson/document.h>
+
+#include "protocol.hpp"
+#include "scheduler_plugin.hpp"
+
+struct BatsimContext;
+
+/**
+ * @brief The AbstractProtocolWriter which stores events as PluginEvent for a scheduler plugin
+ * @details Events are stored in two buffers: the one being filled and the one last given to the
+ *          scheduler. They are swapped by generate_current_message, so their memory is reused
+ *          from one call to the scheduler to the next.
+ */
+class PluginProtocolWriter : public AbstractProtocolWriter
+{
+public:
+    /**
+     * @brief Creates a PluginProtocolWriter
+     * @param[in] context The BatsimContext
+     */
+    explicit PluginProtocolWriter(BatsimContext * context);
+
+    /**
+     * @brief PluginProtocolWriter cannot be copied.
+     * @param[in] other Another instance
+     */
+    PluginProtocolWriter(const PluginProtocolWriter & other) = delete;
+
+    /**
+     * @brief Destroys a PluginProtocolWriter
+     */
+    ~PluginProtocolWriter();
+
+    // Messages from Batsim to the Scheduler
+    /**
+     * @brief Appends a SIMULATION_BEGINS event.
+     * @param[in] machines The machines usable to compute jobs
+     * @param[in] workloads The workloads given to batsim
+     * @param[in] configuration The simulation configuration
+     * @param[in] allow_time_sharing Whether time sharing is enabled
+     * @param[in] date The event date. Must be greater than or equal to the previous event.
+     */
+    void append_simulation_begins(Machines & machines,
+                                  Workloads & workloads,
+                                  const rapidjson::Document & configuration,
+                                  bool allow_time_sharing,
+                                  double date);
+
+    /**
+     * @brief Appends a SIMULATION_ENDS event.
+     * @param[in] date The event date. Must be greater than or equal to the previous event.
+     */
+    void append_simulation_ends(double date);
+
+    /**
+     * @brief Appends a JOB_SUBMITTED event.
+     * @param[in] job_id The identifier of the submitted job.
+     * @param[in] profile_name The name of the job profile
+     * @param[in] job_json_description The job JSON description
+     * @param[in] profile_json_description The profile JSON description (not given to plugins)
+     * @param[in] date The event date. Must be greater than or equal to the previous event.
+     */
+    void append_job_submitted(const JobIdentifier & job_id,
+                              const std::string & profile_name,
+                              const std::string & job_json_description,
+                              const std::string & profile_json_description,
+                              double date);
+
+    /**
+     * @brief Appends a JOB_COMPLETED event.
+     * @param[in] job_id The identifier of the job that has completed.
+     * @param[in] job_status The job status
+     * @param[in] job_state The job state
+     * @param[in] kill_reason The kill reason (if any)
+     * @param[in] job_alloc last allocation of the job
+     * @param[in] return_code The job return code
+     * @param[in] date The event date. Must be greater than or equal to the previous event.
+     */
+    void append_job_completed(const JobIdentifier & job_id,
+                              const std::string & job_status,
+                              const std::string & job_state,
+                              const std::string & kill_reason,
+                              const std::string & job_alloc,
+                              int return_code,
+                              double date);
+
+    /**
+     * @brief Appends a JOB_KILLED event.
+     * @param[in] job_ids The identifiers of the jobs that have been killed.
+     * @param[in] job_progress Contains the progress of each job that has really been killed (not given to plugins).
+     * @param[in] date The event date. Must be greater than or equal to the previous event.
+     */
+    void append_job_killed(const std::vector<JobIdentifier> & job_ids,
+                           const std::map<JobIdentifier, BatTask *> & job_progress,
+                           double date);
+
+    /**
+     * @brief Appends a FROM_JOB_MSG event.
+     * @param[in] job_id The identifier of the job which sends the message.
+     * @param[in] message The message to be sent to the scheduler.
+     * @param[in] date The event date. Must be greater than or equal to the previous event.
+     */
+    void append_from_job_message(const JobIdentifier & job_id,
+                                 const rapidjson::Document & message,
+                                 double date);
+
+    /**
+     * @brief Appends a RESOURCE_STATE_CHANGED event.
+     * @param[in] resources The resources whose state has changed.
+     * @param[in] new_state The state the machines are now in.
+     * @param[in] date The event date. Must be greater than or equal to the previous event.
+     */
+    void append_resource_state_changed(const MachineRange & resources,
+                                       const std::string & new_state,
+                                       double date);
+
+    /**
+     * @brief Appends a QUERY event. Not supported by scheduler plugins.
+     * @param[in] job_id The identifier of the potential job
+     * @param[in] job_json_description The job JSON description of the potential job
+     * @param[in] date The event date. Must be greater than or equal to the previous event.
+     */
+    void append_query_estimate_waiting_time(const std::string & job_id,
+                                            const std::string & job_json_description,
+                                            double date);
+
+    /**
+     * @brief Appends an ANSWER (energy) event. Not supported by scheduler plugins.
+     * @param[in] consumed_energy The total consumed energy in joules
+     * @param[in] date The event date. Must be greater than or equal to the previous event.
+     */
+    void append_answer_energy(double consumed_energy,
+                              double date);
+
+    /**
+     * @brief Appends a REQUESTED_CALL event.
+     * @param[in] date The event date. Must be greater than or equal to the previous event.
+     */
+    void append_requested_call(double date);
+
+    // Management functions
+    /**
+     * @brief Clears the events being filled. Should called directly after generate_current_message.
+     */
+    void clear();
+
+    /**
+     * @brief Hands the current events over to the scheduler (see sent_events)
+     * @param[in] date The call date. Must be greater than or equal to the inner events dates.
+     * @return An empty message, as there is nothing to send on a socket
+     */
+    ProtocolMessage generate_current_message(double date);
+
+    /**
+     * @brief Returns whether the Writer has content
+     * @return Whether the Writer has content
+     */
+    bool is_empty() { return _events.empty(); }
+
+    /**
+     * @brief Returns whether the Writer contains events which should trigger a call to the scheduler
+     * @return Whether the Writer contains non-deferred events
+     */
+    bool has_triggering_events() { return _has_triggering_events; }
+
+    /**
+     * @brief Returns the number of events pushed into the Writer since last clear
+     * @return The number of events pushed into the Writer since last clear
+     */
+    int nb_events() { return (int) _events.size(); }
+
+    /**
+     * @brief Returns the events handed over by the last generate_current_message call
+     * @return The events handed over by the last generate_current_message call
+     */
+    const std::vector<PluginEvent> & sent_events() const { return _sent_events; }
+
+    /**
+     * @brief Returns the date given to the last generate_current_message call
+     * @return The date given to the last generate_current_message call
+     */
+    double sent_date() const { return _sent_date; }
+
+private:
+    /**
+     * @brief Appends an event to the current events
+     * @param[in] type The event type
+     * @param[in] protocol_type The name of the event type in the protocol (used to know whether it is deferred)
+     * @param[in] date The event date. Must be greater than or equal to the previous event.
+     * @return The appended event, whose type-specific fields are to be set
+     */
+    PluginEvent & append_event(PluginEventType type, const char * protocol_type, double date);
+
+private:
+    BatsimContext * _context = nullptr; //!< The BatsimContext
+    std::vector<PluginEvent> _events; //!< The events being filled
+    std::vector<PluginEvent> _sent_events; //!< The events handed over by the last generate_current_message call
+    double _sent_date = 0; //!< The date given to the last generate_current_message call
+    double _last_date = -1; //!< The date of the latest appended event until now
+    bool _has_triggering_events = false; //!< Whether the current events contain non-deferred events
+};
+
+/**
+ * @brief The AbstractProtocolReader which injects the decisions of a scheduler plugin into the simulation
+ */
+class PluginProtocolReader : public AbstractProtocolReader
+{
+public:
+    /**
+     * @brief Creates a PluginProtocolReader
+     * @param[in] context The BatsimContext
+     */
+    explicit PluginProtocolReader(BatsimContext * context);
+
+    /**
+     * @brief PluginProtocolReader cannot be copied.
+     * @param[in] other Another instance
+     */
+    PluginProtocolReader(const PluginProtocolReader & other) = delete;
+
+    /**
+     * @brief Scheduler plugins do not send messages: this function must not be called
+     * @param[in] message The protocol message
+     */
+    void parse_and_apply_message(const std::string & message);
+
+    /**
+     * @brief Checks the decisions of a scheduler plugin and injects them in the simulation
+     * @details Consecutive EXECUTE_JOB decisions taken at the same date are injected as one message.
+     * @param[in] decisions The decisions, ordered by date
+     * @param[in] now The date at which the scheduler is done taking decisions
+     */
+    void apply_decisions(const std::vector<PluginDecision> & decisions, double now);
+
+private:
+    /**
+     * @brief Builds the allocation of an EXECUTE_JOB decision
+     * @param[in] decision The decision
+     * @param[in] decision_number The decision number in [0,nb_decisions[
+     * @return The allocation
+     */
+    SchedulingAllocation * build_allocation(const PluginDecision & decision, int decision_number);
+
+    /**
+     * @brief Retrieves a job identifier from a decision
+     * @param[in] job_id The job identifier string
+     * @param[in] decision_number The decision number in [0,nb_decisions[
+     * @param[in] decision_type The decision type name
+     * @return The job identifier
+     */
+    JobIdentifier identify_job(const std::string & job_id, int decision_number, const char * decision_type);
+
+private:
+    BatsimContext * _context = nullptr; //!< The BatsimContext
+};
+
+/**
+ * @brief A scheduler loaded from a plugin (shared library) into Batsim's process
+ */
+class PluginScheduler
+{
+public:
+    /**
+     * @brief Loads a scheduler plugin and creates its scheduler
+     * @param[in] filename The plugin (shared library) file name
+     * @param[in] configuration The Batsim configuration, given to the plugin
+     * @param[in] writer The writer which stores the events given to the scheduler
+     * @param[in] reader The reader which injects the decisions of the scheduler
+     */
+    PluginScheduler(const std::string & filename,
+                    const rapidjson::Document & configuration,
+                    PluginProtocolWriter * writer,
+                    PluginProtocolReader * reader);
+
+    /**
+     * @brief PluginScheduler cannot be copied.
+     * @param[in] other Another instance
+     */
+    PluginScheduler(const PluginScheduler & other) = delete;
+
+    /**
+     * @brief Destroys the scheduler and unloads the plugin
+     */
+    ~PluginScheduler();
+
+    /**
+     * @brief Calls the scheduler with the events handed over by the writer, then injects its decisions
+     * @param[out] latency The time the scheduler took to take its decisions
+     */
+    void call(std::chrono::nanoseconds & latency);
+
+private:
+    void * _library = nullptr; //!< The plugin handle, as returned by dlopen
+    SchedulerPlugin * _scheduler = nullptr; //!< The scheduler created by the plugin
+    void (*_destroy_scheduler)(SchedulerPlugin *) = nullptr; //!< The plugin function which destroys the scheduler
+    PluginProtocolWriter * _writer = nullptr; //!< The writer which stores the events given to the scheduler
+    PluginProtocolReader * _reader = nullptr; //!< The reader which injects the decisions of the scheduler
+    std::vector<PluginDecision> _decisions; //!< The decisions of the scheduler (buffer reused between calls)
+};
@@ -0,0 +1,135 @@
+/**
+ * @file pool.hpp
+ * @brief Contains free-list pools which recycle the memory of frequently allocated objects
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+/**
+ * @brief A pool of memory blocks which can each hold a T
+ * @details Blocks are allocated by chunks of blocks_per_chunk and are never given back to the
+ *          system: released blocks are put into a free list and reused by later allocations.
+ *          The pool is not thread-safe, which is fine as SimGrid runs one process at a time.
+ */
+template <typename T, int blocks_per_chunk = 64>
+class FreeListPool
+{
+public:
+    /**
+     * @brief Returns an uninitialized block which can hold a T
+     * @return The block
+     */
+    static void * allocate()
+    {
+        if (_free_blocks == nullptr)
+        {
+            Chunk * chunk = static_cast<Chunk *>(::operator new(sizeof(Chunk)));
+            chunk->next = _chunks;
+            _chunks = chunk;
+
+            for (int i = 0; i < blocks_per_chunk; ++i)
+            {
+                chunk->blocks[i].next = _free_blocks;
+                _free_blocks = &chunk->blocks[i];
+            }
+            _nb_blocks += blocks_per_chunk;
+        }
+
+        Block * block = _free_blocks;
+        _free_blocks = block->next;
+        return block;
+    }
+
+    /**
+     * @brief Gives a block returned by allocate back to the pool
+     * @param[in] block The block. Nothing is done if it is nullptr.
+     */
+    static void release(void * block)
+    {
+        if (block != nullptr)
+        {
+            Block * released = static_cast<Block *>(block);
+            released->next = _free_blocks;
+            _free_blocks = released;
+        }
+    }
+
+    /**
+     * @brief Returns the number of blocks owned by the pool, whether they are in use or not
+     * @return The number of blocks owned by the pool
+     */
+    static int nb_blocks() { return _nb_blocks; }
+
+private:
+    /**
+     * @brief A block, which either holds a T or is in the free list
+     */
+    union Block
+    {
+        Block * next; //!< The next free block, while the block is in the free list
+        alignas(T) unsigned char storage[sizeof(T)]; //!< The memory of the T, while the block is in use
+    };
+
+    /**
+     * @brief A group of blocks allocated at once
+     */
+    struct Chunk
+    {
+        Chunk * next; //!< The previously allocated chunk
+        Block blocks[blocks_per_chunk]; //!< The blocks of the chunk
+    };
+
+    static Block * _free_blocks; //!< The free list
+    static Chunk * _chunks; //!< The allocated chunks
+    static int _nb_blocks; //!< The number of blocks owned by the pool
+};
+
+template <typename T, int blocks_per_chunk>
+typename FreeListPool<T, blocks_per_chunk>::Block * FreeListPool<T, blocks_per_chunk>::_free_blocks = nullptr;
+
+template <typename T, int blocks_per_chunk>
+typename FreeListPool<T, blocks_per_chunk>::Chunk * FreeListPool<T, blocks_per_chunk>::_chunks = nullptr;
+
+template <typename T, int blocks_per_chunk>
+int FreeListPool<T, blocks_per_chunk>::_nb_blocks = 0;
+
+/**
+ * @brief Makes new and delete of T use a FreeListPool, when inherited by T
+ * @details Objects whose size differs from sizeof(T) (i.e. of a class derived from T) are allocated
+ *          by the global operators.
+ */
+template <typename T, int blocks_per_chunk = 64>
+struct Pooled
+{
+    /**
+     * @brief Allocates the memory of a T
+     * @param[in] size The size of the object
+     * @return The memory of the object
+     */
+    static void * operator new(std::size_t size)
+    {
+        if (size != sizeof(T))
+        {
+            return ::operator new(size);
+        }
+        return FreeListPool<T, blocks_per_chunk>::allocate();
+    }
+
+    /**
+     * @brief Deallocates the memory of a T
+     * @param[in] block The memory of the object
+     * @param[in] size The size of the object
+     */
+    static void operator delete(void * block, std::size_t size)
+    {
+        if (size != sizeof(T))
+        {
+            ::operator delete(block);
+            return;
+        }
+        FreeListPool<T, blocks_per_chunk>::release(block);
+    }
+};
@@ -1,14 +1,22 @@
 #include "protocol.hpp"
 
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+
 #include <boost/algorithm/string/join.hpp>
-#include <boost/regex.hpp>
 
 #include <xbt.h>
 
+#include <rapidjson/error/en.h>
+#include <rapidjson/memorystream.h>
+#include <rapidjson/reader.h>
 #include <rapidjson/stringbuffer.h>
 
 #include "context.hpp"
 #include "jobs.hpp"
+#include "msgpack.hpp"
 #include "network.hpp"
 
 using namespace rapidjson;
@@ -16,10 +24,386 @@ using namespace std;
 
 XBT_LOG_NEW_DEFAULT_CATEGORY(protocol, "protocol"); //!< Logging
 
+/**
+ * @brief Checks the format of a message received from the scheduler, unless the scheduler is trusted
+ * @details Only usable in JsonProtocolReader member functions. The condition is not evaluated in
+ *          ProtocolValidation::TRUSTED mode.
+ */
+#define protocol_assert(...) do { if (_validation == ProtocolValidation::AUDIT) { xbt_assert(__VA_ARGS__); } } while (0)
+
+string protocol_format_to_string(ProtocolFormat format)
+{
+    switch (format)
+    {
+    case ProtocolFormat::JSON:
+        return "json";
+    case ProtocolFormat::MSGPACK:
+        return "msgpack";
+    }
+
+    xbt_assert(false, "Unhandled ProtocolFormat");
+    return "unknown";
+}
+
+ProtocolFormat protocol_format_from_string(const string & str)
+{
+    if (str == "json")
+    {
+        return ProtocolFormat::JSON;
+    }
+    else if (str == "msgpack")
+    {
+        return ProtocolFormat::MSGPACK;
+    }
+
+    xbt_assert(false, "Invalid protocol format '%s': must be 'json' or 'msgpack'", str.c_str());
+    return ProtocolFormat::JSON;
+}
+
+string protocol_validation_to_string(ProtocolValidation validation)
+{
+    switch (validation)
+    {
+    case ProtocolValidation::AUDIT:
+        return "audit";
+    case ProtocolValidation::TRUSTED:
+        return "trusted";
+    }
+
+    xbt_assert(false, "Unhandled ProtocolValidation");
+    return "unknown";
+}
+
+ProtocolValidation protocol_validation_from_string(const string & str)
+{
+    if (str == "audit")
+    {
+        return ProtocolValidation::AUDIT;
+    }
+    else if (str == "trusted")
+    {
+        return ProtocolValidation::TRUSTED;
+    }
+
+    xbt_assert(false, "Invalid protocol validation mode '%s': must be 'audit' or 'trusted'", str.c_str());
+    return ProtocolValidation::AUDIT;
+}
+
+bool is_json_message(const char * data, size_t size)
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        switch (data[i])
+        {
+        case ' ':
+        case '\t':
+        case '\n':
+        case '\r':
+            continue;
+        default:
+            return data[i] == '{';
+        }
+    }
+
+    return false;
+}
+
+JsonMessageEncoder::JsonMessageEncoder(int decimal_places) :
+    _buffer_stream(_buffers[0]),
+    _header_stream(_header),
+    _writer(_buffer_stream)
+{
+    _writer.SetDecimalPlaces(decimal_places);
+    clear();
+}
+
+void JsonMessageEncoder::start_event()
+{
+    xbt_assert(!_is_finished, "Cannot write events in a finished message");
+    xbt_assert(_nb_events == 0 || _writer.IsComplete(), "The previous event has not been completely written");
+
+    if (_nb_events > 0)
+    {
+        _buffers[_current_buffer].push_back(',');
+    }
+    _writer.Reset(_buffer_stream);
+    ++_nb_events;
+}
+
+ProtocolMessage JsonMessageEncoder::finish_message(double now)
+{
+    xbt_assert(!_is_finished,
+               "Successive calls to JsonProtocolWriter::generate_current_message without calling "
+               "the clear() method is not supported");
+    xbt_assert(_nb_events == 0 || _writer.IsComplete(), "The last event has not been completely written");
+    _is_finished = true;
+
+    std::string & buffer = _buffers[_current_buffer];
+    buffer.append("]}");
+
+    // The header is written just before the events, at the end of the reserved room
+    _header.clear();
+    _writer.Reset(_header_stream);
+    _writer.StartObject();
+    _writer.Key("now");
+    _writer.Double(now);
+    _writer.Key("events");
+    _writer.StartArray();
+
+    xbt_assert(_header.size() <= header_slot_size, "Message header is too big (%zu bytes)", _header.size());
+    size_t header_offset = header_slot_size - _header.size();
+    memcpy(&buffer[header_offset], _header.data(), _header.size());
+
+    ProtocolMessage message;
+    message.data = buffer.data() + header_offset;
+    message.size = buffer.size() - header_offset;
+    return message;
+}
+
+void JsonMessageEncoder::clear()
+{
+    // The other buffer is used, so that the last generated message remains valid
+    _current_buffer = 1 - _current_buffer;
+    _buffer_stream = StringOutputStream(_buffers[_current_buffer]);
+
+    _buffers[_current_buffer].assign(header_slot_size, ' ');
+    _nb_events = 0;
+    _is_finished = false;
+}
+
+bool JsonMessageEncoder::Null()
+{
+    return _writer.Null();
+}
+
+bool JsonMessageEncoder::Bool(bool b)
+{
+    return _writer.Bool(b);
+}
+
+bool JsonMessageEncoder::Int(int i)
+{
+    return _writer.Int(i);
+}
+
+bool JsonMessageEncoder::Uint(unsigned u)
+{
+    return _writer.Uint(u);
+}
+
+bool JsonMessageEncoder::Int64(int64_t i)
+{
+    return _writer.Int64(i);
+}
+
+bool JsonMessageEncoder::Uint64(uint64_t u)
+{
+    return _writer.Uint64(u);
+}
+
+bool JsonMessageEncoder::Double(double d)
+{
+    return _writer.Double(d);
+}
+
+bool JsonMessageEncoder::RawNumber(const char * str, SizeType length, bool copy)
+{
+    return _writer.RawNumber(str, length, copy);
+}
+
+bool JsonMessageEncoder::String(const char * str, SizeType length, bool copy)
+{
+    return _writer.String(str, length, copy);
+}
+
+bool JsonMessageEncoder::Key(const char * str, SizeType length, bool copy)
+{
+    return _writer.Key(str, length, copy);
+}
+
+bool JsonMessageEncoder::StartObject()
+{
+    return _writer.StartObject();
+}
+
+bool JsonMessageEncoder::EndObject(SizeType member_count)
+{
+    return _writer.EndObject(member_count);
+}
+
+bool JsonMessageEncoder::StartArray()
+{
+    return _writer.StartArray();
+}
+
+bool JsonMessageEncoder::EndArray(SizeType element_count)
+{
+    return _writer.EndArray(element_count);
+}
+
+bool JsonMessageEncoder::RawValue(const char * json, size_t length, Type type)
+{
+    return _writer.RawValue(json, length, type);
+}
+
+
+
+MsgpackMessageEncoder::MsgpackMessageEncoder() :
+    _writer(_buffers[0])
+{
+    clear();
+}
+
+void MsgpackMessageEncoder::start_event()
+{
+    xbt_assert(!_is_finished, "Cannot write events in a finished message");
+    xbt_assert(_nb_events == 0 || _writer.IsComplete(), "The previous event has not been completely written");
+
+    _writer.Reset(_buffers[_current_buffer]);
+    ++_nb_events;
+}
+
+/**
+ * @brief Writes a big-endian unsigned integer
+ * @param[out] dest Where the integer should be written
+ * @param[in] value The integer
+ * @param[in] nb_bytes The number of bytes the integer should be written on
+ */
+static void write_big_endian(char * dest, uint64_t value, int nb_bytes)
+{
+    for (int i = 0; i < nb_bytes; ++i)
+    {
+        dest[nb_bytes - 1 - i] = (char) ((value >> (8 * i)) & 0xff);
+    }
+}
+
+ProtocolMessage MsgpackMessageEncoder::finish_message(double now)
+{
+    xbt_assert(!_is_finished,
+               "Successive calls to JsonProtocolWriter::generate_current_message without calling "
+               "the clear() method is not supported");
+    xbt_assert(_nb_events == 0 || _writer.IsComplete(), "The last event has not been completely written");
+    _is_finished = true;
+
+    // {"now": <float 64>, "events": <array 32 header>
+    std::string & buffer = _buffers[_current_buffer];
+    char * header = &buffer[0];
+    uint64_t now_bits;
+    memcpy(&now_bits, &now, sizeof(double));
+
+    header[0] = (char) 0x82; // fixmap of 2 elements
+    memcpy(header + 1, "\xa3" "now", 4);
+    header[5] = (char) 0xcb; // float 64
+    write_big_endian(header + 6, now_bits, 8);
+    memcpy(header + 14, "\xa6" "events", 7);
+    header[21] = (char) 0xdd; // array 32
+    write_big_endian(header + 22, _nb_events, 4);
+
+    ProtocolMessage message;
+    message.data = buffer.data();
+    message.size = buffer.size();
+    return message;
+}
+
+void MsgpackMessageEncoder::clear()
+{
+    // The other buffer is used, so that the last generated message remains valid
+    _current_buffer = 1 - _current_buffer;
+
+    _buffers[_current_buffer].assign(header_size, '\0');
+    _nb_events = 0;
+    _is_finished = false;
+}
+
+bool MsgpackMessageEncoder::Null()
+{
+    return _writer.Null();
+}
+
+bool MsgpackMessageEncoder::Bool(bool b)
+{
+    return _writer.Bool(b);
+}
+
+bool MsgpackMessageEncoder::Int(int i)
+{
+    return _writer.Int(i);
+}
+
+bool MsgpackMessageEncoder::Uint(unsigned u)
+{
+    return _writer.Uint(u);
+}
+
+bool MsgpackMessageEncoder::Int64(int64_t i)
+{
+    return _writer.Int64(i);
+}
+
+bool MsgpackMessageEncoder::Uint64(uint64_t u)
+{
+    return _writer.Uint64(u);
+}
+
+bool MsgpackMessageEncoder::Double(double d)
+{
+    return _writer.Double(d);
+}
+
+bool MsgpackMessageEncoder::RawNumber(const char * str, SizeType length, bool copy)
+{
+    return _writer.RawNumber(str, length, copy);
+}
+
+bool MsgpackMessageEncoder::String(const char * str, SizeType length, bool copy)
+{
+    return _writer.String(str, length, copy);
+}
+
+bool MsgpackMessageEncoder::Key(const char * str, SizeType length, bool copy)
+{
+    return _writer.Key(str, length, copy);
+}
+
+bool MsgpackMessageEncoder::StartObject()
+{
+    return _writer.StartObject();
+}
+
+bool MsgpackMessageEncoder::EndObject(SizeType member_count)
+{
+    return _writer.EndObject(member_count);
+}
+
+bool MsgpackMessageEncoder::StartArray()
+{
+    return _writer.StartArray();
+}
+
+bool MsgpackMessageEncoder::EndArray(SizeType element_count)
+{
+    return _writer.EndArray(element_count);
+}
+
+bool MsgpackMessageEncoder::RawValue(const char * json, size_t length, Type type)
+{
+    (void) type;
+
+    MemoryStream stream(json, length);
+    _json_reader.Parse(stream, _writer);
+    return !_json_reader.HasParseError();
+}
+
+
+
 JsonProtocolWriter::JsonProtocolWriter(BatsimContext * context) :
-    _context(context), _alloc(_doc.GetAllocator())
+    JsonProtocolWriter(context, new JsonMessageEncoder(context->protocol_decimal_places))
+{
+}
+
+JsonProtocolWriter::JsonProtocolWriter(BatsimContext * context, ProtocolMessageEncoder * encoder) :
+    _context(context), _encoder(encoder)
 {
-    _doc.SetObject();
 }
 
 JsonProtocolWriter::~JsonProtocolWriter()
@@ -27,6 +411,48 @@ JsonProtocolWriter::~JsonProtocolWriter()
 
 }
 
+void JsonProtocolWriter::start_event(const char * type, double date)
+{
+    xbt_assert(date >= _last_date, "Date inconsistency");
+    end_job_submission_batch();
+
+    _last_date = date;
+    _is_empty = false;
+    _nb_events++;
+
+    if (!_has_triggering_events)
+    {
+        const std::vector<std::string> & deferred_types = _context->protocol_deferred_events;
+        _has_triggering_events = std::find(deferred_types.begin(), deferred_types.end(), type) == deferred_types.end();
+    }
+
+    _encoder->start_event();
+    _encoder->StartObject();
+    _encoder->Key("timestamp");
+    _encoder->Double(date);
+    _encoder->Key("type");
+    _encoder->String(type);
+    _encoder->Key("data");
+}
+
+void JsonProtocolWriter::end_event()
+{
+    _encoder->EndObject();
+}
+
+void JsonProtocolWriter::write_json_text(const string & json_text)
+{
+    StringStream stream(json_text.c_str());
+    _json_text_reader.Parse(stream, *_encoder);
+    xbt_assert(!_json_text_reader.HasParseError(), "Invalid JSON text: %s", json_text.c_str());
+}
+
+void JsonProtocolWriter::write_job_id(const JobIdentifier & job_id)
+{
+    job_id.to_string(_job_id_buffer);
+    _encoder->String(_job_id_buffer);
+}
+
 void JsonProtocolWriter::append_requested_call(double date)
 {
     /* {
@@ -35,16 +461,10 @@ void JsonProtocolWriter::append_requested_call(double date)
       "data": {}
     } */
 
-    xbt_assert(date >= _last_date, "Date inconsistency");
-    _last_date = date;
-    _is_empty = false;
-
-    Value event(rapidjson::kObjectType);
-    event.AddMember("timestamp", Value().SetDouble(date), _alloc);
-    event.AddMember("type", Value().SetString("REQUESTED_CALL"), _alloc);
-    event.AddMember("data", Value().SetObject(), _alloc);
-
-    _events.PushBack(event, _alloc);
+    start_event("REQUESTED_CALL", date);
+    _encoder->StartObject();
+    _encoder->EndObject();
+    end_event();
 }
 
 void JsonProtocolWriter::append_simulation_begins(Machines & machines,
@@ -75,71 +495,114 @@ void JsonProtocolWriter::append_simulation_begins(Machines & machines,
       }
     } */
 
-    xbt_assert(date >= _last_date, "Date inconsistency");
-    _last_date = date;
-    _is_empty = false;
+    start_event("SIMULATION_BEGINS", date);
+    _encoder->StartObject();
 
-    Value config(rapidjson::kObjectType);
-    config.CopyFrom(configuration, _alloc);
+    _encoder->Key("nb_resources");
+    _encoder->Int(machines.nb_machines());
+    _encoder->Key("allow_time_sharing");
+    _encoder->Bool(allow_time_sharing);
+    _encoder->Key("config");
+    configuration.Accept(*_encoder);
 
-    Value data(rapidjson::kObjectType);
-    data.AddMember("nb_resources", Value().SetInt(machines.nb_machines()), _alloc);
-    data.AddMember("allow_time_sharing", Value().SetBool(allow_time_sharing), _alloc);
-    data.AddMember("config", config, _alloc);
-
-    Value resources(rapidjson::kArrayType);
-    resources.Reserve(machines.nb_machines(), _alloc);
-    for (const Machine * machine : machines.machines())
+    if (_context->protocol_compact_resources)
+    {
+        _encoder->Key("resources_groups");
+        _encoder->StartArray();
+        for (const MachineGroup & group : machines.group_machines())
+        {
+            write_machine_group(group);
+        }
+        _encoder->EndArray();
+    }
+    else
     {
-        resources.PushBack(machine_to_json_value(*machine), _alloc);
+        _encoder->Key("resources_data");
+        _encoder->StartArray();
+        for (const Machine * machine : machines.machines())
+        {
+            write_machine(*machine);
+        }
+        _encoder->EndArray();
     }
-    data.AddMember("resources_data", Value().CopyFrom(resources, _alloc), _alloc);
 
     if (machines.has_hpst_machine())
     {
-        data.AddMember("hpst_host", machine_to_json_value(*machines.hpst_machine()), _alloc);
+        _encoder->Key("hpst_host");
+        write_machine(*machines.hpst_machine());
     }
 
     if (machines.has_pfs_machine())
     {
-        data.AddMember("lcst_host", machine_to_json_value(*machines.pfs_machine()), _alloc);
+        _encoder->Key("lcst_host");
+        write_machine(*machines.pfs_machine());
     }
 
-    Value workloads_dict(rapidjson::kObjectType);
+    _encoder->Key("workloads");
+    _encoder->StartObject();
     for (const auto & workload : workloads.workloads())
     {
-        workloads_dict.AddMember(
-            Value().SetString(workload.first.c_str(), _alloc),
-            Value().SetString(workload.second->file.c_str(), _alloc),
-            _alloc);
+        _encoder->Key(workload.first.c_str());
+        _encoder->String(workload.second->file);
     }
-    data.AddMember("workloads", workloads_dict, _alloc);
+    _encoder->EndObject();
+
+    _encoder->EndObject();
+    end_event();
+}
 
-    Value event(rapidjson::kObjectType);
-    event.AddMember("timestamp", Value().SetDouble(date), _alloc);
-    event.AddMember("type", Value().SetString("SIMULATION_BEGINS"), _alloc);
-    event.AddMember("data", data, _alloc);
+void JsonProtocolWriter::write_machine(const Machine & machine)
+{
+    _encoder->StartObject();
+    _encoder->Key("id");
+    _encoder->Int(machine.id);
+    _encoder->Key("name");
+    _encoder->String(machine.name);
+    _encoder->Key("state");
+    _encoder->String(machine_state_to_string(machine.state));
+
+    _encoder->Key("properties");
+    _encoder->StartObject();
+    for(auto const &entry : machine.properties)
+    {
+        _encoder->Key(entry.first.c_str());
+        _encoder->String(entry.second);
+    }
+    _encoder->EndObject();
 
-    _events.PushBack(event, _alloc);
+    _encoder->EndObject();
 }
 
-Value JsonProtocolWriter::machine_to_json_value(const Machine & machine)
+void JsonProtocolWriter::write_machine_group(const MachineGroup & group)
 {
-    Value machine_doc(rapidjson::kObjectType);
-    machine_doc.AddMember("id", Value().SetInt(machine.id), _alloc);
-    machine_doc.AddMember("name", Value().SetString(machine.name.c_str(), _alloc), _alloc);
-    machine_doc.AddMember("state", Value().SetString(machine_state_to_string(machine.state).c_str(), _alloc), _alloc);
+    _encoder->StartObject();
+    _encoder->Key("ids");
+    _encoder->String(group.machine_ids.to_string_hyphen(",", "-"));
+    if (group.has_name_pattern)
+    {
+        _encoder->Key("name_pattern");
+        _encoder->String(group.name_pattern);
+        _encoder->Key("name_offset");
+        _encoder->Int(group.name_offset);
+    }
+    else
+    {
+        _encoder->Key("name");
+        _encoder->String(group.name_pattern);
+    }
+    _encoder->Key("state");
+    _encoder->String(machine_state_to_string(group.state));
 
-    Value properties(rapidjson::kObjectType);
-    for(auto const &entry : machine.properties)
+    _encoder->Key("properties");
+    _encoder->StartObject();
+    for(auto const &entry : *group.properties)
     {
-        rapidjson::Value key(entry.first.c_str(), _alloc);
-        rapidjson::Value value(entry.second.c_str(), _alloc);
-        properties.AddMember(key, value, _alloc);
+        _encoder->Key(entry.first.c_str());
+        _encoder->String(entry.second);
     }
-    machine_doc.AddMember("properties", properties, _alloc);
+    _encoder->EndObject();
 
-    return machine_doc;
+    _encoder->EndObject();
 }
 
 void JsonProtocolWriter::append_simulation_ends(double date)
@@ -150,19 +613,14 @@ void JsonProtocolWriter::append_simulation_ends(double date)
       "data": {}
     } */
 
-    xbt_assert(date >= _last_date, "Date inconsistency");
-    _last_date = date;
-    _is_empty = false;
-
-    Value event(rapidjson::kObjectType);
-    event.AddMember("timestamp", Value().SetDouble(date), _alloc);
-    event.AddMember("type", Value().SetString("SIMULATION_ENDS"), _alloc);
-    event.AddMember("data", Value().SetObject(), _alloc);
-
-    _events.PushBack(event, _alloc);
+    start_event("SIMULATION_ENDS", date);
+    _encoder->StartObject();
+    _encoder->EndObject();
+    end_event();
 }
 
-void JsonProtocolWriter::append_job_submitted(const string & job_id,
+void JsonProtocolWriter::append_job_submitted(const JobIdentifier & job_id,
+                                              const string & profile_name,
                                               const string & job_json_description,
                                               const string & profile_json_description,
                                               double date)
@@ -189,42 +647,137 @@ void JsonProtocolWriter::append_job_submitted(const string & job_id,
           "type": "delay",
           "delay": 10
         }
+    },
+    "batched_without_redis": {
+      "timestamp": 10.0,
+      "type": "JOB_SUBMITTED",
+      "data": {
+        "jobs": [
+          {"profile": "delay_10s", "res": 1, "id": "w0!1", "walltime": 12.0},
+          {"profile": "delay_10s", "res": 4, "id": "w0!2", "walltime": 12.0}
+        ],
+        "job_ids": ["w0!1", "w0!2"],
+        "profiles": {
+          "w0!delay_10s": {"type": "delay", "delay": 10}
+        }
+      }
     } */
 
-    xbt_assert(date >= _last_date, "Date inconsistency");
-    _last_date = date;
-    _is_empty = false;
+    const bool forward_job = !_context->redis_enabled;
+    const bool forward_profile = forward_job && _context->submission_forward_profiles;
+
+    if (_context->submission_batch_by_timestamp)
+    {
+        // The job is added to the batch of the jobs submitted at the same date.
+        // Job descriptions are directly written into the event, while job identifiers and profiles
+        // are written when the batch is finished.
+        if (!_is_job_submission_batch_open || date != _last_date)
+        {
+            start_event("JOB_SUBMITTED", date);
+            _encoder->StartObject();
+            if (forward_job)
+            {
+                _encoder->Key("jobs");
+                _encoder->StartArray();
+            }
+            _is_job_submission_batch_open = true;
+        }
 
-    Value data(rapidjson::kObjectType);
-    data.AddMember("job_id", Value().SetString(job_id.c_str(), _alloc), _alloc);
+        if (forward_job)
+        {
+            bool written = _encoder->RawValue(job_json_description.data(), job_json_description.size(), kObjectType);
+            xbt_assert(written, "Invalid job description: %s", job_json_description.c_str());
+            (void) written; // Avoids a warning if assertions are ignored
+        }
+
+        _batch_job_ids.push_back(job_id);
+
+        if (forward_profile)
+        {
+            // Profiles are identified by WORKLOAD!PROFILE_NAME, as profile names are local to workloads
+            _batch_profile_key.assign(job_id.workload_name());
+            _batch_profile_key += '!';
+            _batch_profile_key += profile_name;
+
+            if (_batch_profiles.find(_batch_profile_key) == _batch_profiles.end())
+            {
+                _batch_profiles[_batch_profile_key] = profile_json_description;
+            }
+        }
+
+        return;
+    }
+
+    (void) profile_name;
+
+    start_event("JOB_SUBMITTED", date);
+    _encoder->StartObject();
+    _encoder->Key("job_id");
+    write_job_id(job_id);
+
+    if (forward_job)
+    {
+        // Descriptions are kept serialised in the Job and Profile instances, they can be emitted as is
+        _encoder->Key("job");
+        bool written = _encoder->RawValue(job_json_description.data(), job_json_description.size(), kObjectType);
+        xbt_assert(written, "Invalid job description: %s", job_json_description.c_str());
+
+        if (forward_profile)
+        {
+            _encoder->Key("profile");
+            written = _encoder->RawValue(profile_json_description.data(), profile_json_description.size(), kObjectType);
+            xbt_assert(written, "Invalid profile description: %s", profile_json_description.c_str());
+        }
+        (void) written; // Avoids a warning if assertions are ignored
+    }
+
+    _encoder->EndObject();
+    end_event();
+}
+
+void JsonProtocolWriter::end_job_submission_batch()
+{
+    if (!_is_job_submission_batch_open)
+    {
+        return;
+    }
+    _is_job_submission_batch_open = false;
 
     if (!_context->redis_enabled)
     {
-        Document job_description_doc;
-        job_description_doc.Parse(job_json_description.c_str());
-        xbt_assert(!job_description_doc.HasParseError());
+        _encoder->EndArray(); // jobs
+    }
 
-        data.AddMember("job", Value().CopyFrom(job_description_doc, _alloc), _alloc);
+    _encoder->Key("job_ids");
+    _encoder->StartArray();
+    for (const JobIdentifier & job_id : _batch_job_ids)
+    {
+        write_job_id(job_id);
+    }
+    _encoder->EndArray();
 
-        if (_context->submission_forward_profiles)
+    if (!_context->redis_enabled && _context->submission_forward_profiles)
+    {
+        _encoder->Key("profiles");
+        _encoder->StartObject();
+        for (const auto & profile : _batch_profiles)
         {
-            Document profile_description_doc;
-            profile_description_doc.Parse(profile_json_description.c_str());
-            xbt_assert(!profile_description_doc.HasParseError());
-
-            data.AddMember("profile", Value().CopyFrom(profile_description_doc, _alloc), _alloc);
+            _encoder->Key(profile.first.c_str());
+            bool written = _encoder->RawValue(profile.second.data(), profile.second.size(), kObjectType);
+            xbt_assert(written, "Invalid profile description: %s", profile.second.c_str());
+            (void) written; // Avoids a warning if assertions are ignored
         }
+        _encoder->EndObject();
     }
 
-    Value event(rapidjson::kObjectType);
-    event.AddMember("timestamp", Value().SetDouble(date), _alloc);
-    event.AddMember("type", Value().SetString("JOB_SUBMITTED"), _alloc);
-    event.AddMember("data", data, _alloc);
+    _encoder->EndObject();
+    end_event();
 
-    _events.PushBack(event, _alloc);
+    _batch_job_ids.clear();
+    _batch_profiles.clear();
 }
 
-void JsonProtocolWriter::append_job_completed(const string & job_id,
+void JsonProtocolWriter::append_job_completed(const JobIdentifier & job_id,
                                               const string & job_status,
                                               const string & job_state,
                                               const string & kill_reason,
@@ -244,53 +797,59 @@ void JsonProtocolWriter::append_job_completed(const string & job_id,
       }
     } */
 
-    xbt_assert(date >= _last_date, "Date inconsistency");
     xbt_assert(std::find(accepted_completion_statuses.begin(), accepted_completion_statuses.end(), job_status) != accepted_completion_statuses.end(),
                "Unsupported job status '%s'!", job_status.c_str());
-    _last_date = date;
-    _is_empty = false;
-
-    Value data(rapidjson::kObjectType);
-    data.AddMember("job_id", Value().SetString(job_id.c_str(), _alloc), _alloc);
-    data.AddMember("status", Value().SetString(job_status.c_str(), _alloc), _alloc);
-    data.AddMember("job_state", Value().SetString(job_state.c_str(), _alloc), _alloc);
-    data.AddMember("return_code", Value().SetInt(return_code), _alloc);
-    data.AddMember("kill_reason", Value().SetString(kill_reason.c_str(), _alloc), _alloc);
-    data.AddMember("alloc", Value().SetString(job_alloc.c_str(), _alloc), _alloc);
 
-    Value event(rapidjson::kObjectType);
-    event.AddMember("timestamp", Value().SetDouble(date), _alloc);
-    event.AddMember("type", Value().SetString("JOB_COMPLETED"), _alloc);
-    event.AddMember("data", data, _alloc);
-
-    _events.PushBack(event, _alloc);
+    start_event("JOB_COMPLETED", date);
+    _encoder->StartObject();
+    _encoder->Key("job_id");
+    write_job_id(job_id);
+    _encoder->Key("status");
+    _encoder->String(job_status);
+    _encoder->Key("job_state");
+    _encoder->String(job_state);
+    _encoder->Key("return_code");
+    _encoder->Int(return_code);
+    _encoder->Key("kill_reason");
+    _encoder->String(kill_reason);
+    _encoder->Key("alloc");
+    _encoder->String(job_alloc);
+    _encoder->EndObject();
+    end_event();
 }
 
 /**
- * @brief Create task tree with progress in Json and add it to _alloc
+ * @brief Writes the task tree of a job with its progress
+ * @param[in] task_tree The task tree
+ * @param[in,out] encoder The encoder in which the tree is written
  */
-Value generate_task_tree(BatTask* task_tree, rapidjson::Document::AllocatorType & _alloc)
+void write_task_tree(BatTask* task_tree, ProtocolMessageEncoder & encoder)
 {
-    Value task(rapidjson::kObjectType);
+    encoder.StartObject();
     // add final task (leaf) progress
     if (task_tree->ptask != nullptr || task_tree->delay_task_start != -1)
     {
-        task.AddMember("profile", Value().SetString(task_tree->profile->name.c_str(), _alloc), _alloc);
-        task.AddMember("progress", Value().SetDouble(task_tree->current_task_progress_ratio), _alloc);
+        encoder.Key("profile");
+        encoder.String(task_tree->profile->name);
+        encoder.Key("progress");
+        encoder.Double(task_tree->current_task_progress_ratio);
     }
     else
     {
-        task.AddMember("profile", Value().SetString(task_tree->profile->name.c_str(), _alloc), _alloc);
-        task.AddMember("current_task_index", Value().SetInt(task_tree->current_task_index), _alloc);
+        encoder.Key("profile");
+        encoder.String(task_tree->profile->name);
+        encoder.Key("current_task_index");
+        encoder.Int(task_tree->current_task_index);
 
         BatTask * btask = task_tree->sub_tasks[task_tree->current_task_index];
-        task.AddMember("current_task", generate_task_tree(btask, _alloc), _alloc);
+        encoder.Key("current_task");
+        write_task_tree(btask, encoder);
     }
-    return task;
+    encoder.EndObject();
 }
 
-void JsonProtocolWriter::append_job_killed(const vector<string> & job_ids,
-                                           const std::map<string, BatTask *> & job_progress,
+void JsonProtocolWriter::append_job_killed(const vector<JobIdentifier> & job_ids,
+                                           const std::map<JobIdentifier, BatTask *> & job_progress,
                                            double date)
 {
     /*
@@ -335,38 +894,37 @@ void JsonProtocolWriter::append_job_killed(const vector<string> & job_ids,
     }
     */
 
-    xbt_assert(date >= _last_date, "Date inconsistency");
-    _last_date = date;
-    _is_empty = false;
-
-    Value event(rapidjson::kObjectType);
-    event.AddMember("timestamp", Value().SetDouble(date), _alloc);
-    event.AddMember("type", Value().SetString("JOB_KILLED"), _alloc);
+    start_event("JOB_KILLED", date);
+    _encoder->StartObject();
 
-    Value jobs(rapidjson::kArrayType);
-    jobs.Reserve(job_ids.size(), _alloc);
-
-    Value progress(rapidjson::kObjectType);
+    _encoder->Key("job_ids");
+    _encoder->StartArray();
+    for (const JobIdentifier & job_id : job_ids)
+    {
+        write_job_id(job_id);
+    }
+    _encoder->EndArray();
 
-    for (const string& job_id : job_ids)
+    _encoder->Key("job_progress");
+    _encoder->StartObject();
+    for (const JobIdentifier & job_id : job_ids)
     {
-        jobs.PushBack(Value().SetString(job_id.c_str(), _alloc), _alloc);
-        // compute task progress tree
-        if (job_progress.at(job_id) != nullptr) {
-            progress.AddMember(Value().SetString(job_id.c_str(), _alloc),
-                generate_task_tree(job_progress.at(job_id), _alloc), _alloc);
+        // Only the jobs that have really been killed have a progress
+        auto progress = job_progress.find(job_id);
+        if (progress != job_progress.end() && progress->second != nullptr)
+        {
+            job_id.to_string(_job_id_buffer);
+            _encoder->Key(_job_id_buffer.c_str(), (SizeType) _job_id_buffer.size(), false);
+            write_task_tree(progress->second, *_encoder);
         }
     }
+    _encoder->EndObject();
 
-    Value data(rapidjson::kObjectType);
-    data.AddMember("job_ids", jobs, _alloc);
-    data.AddMember("job_progress", progress, _alloc);
-    event.AddMember("data", data, _alloc);
-
-    _events.PushBack(event, _alloc);
+    _encoder->EndObject();
+    end_event();
 }
 
-void JsonProtocolWriter::append_from_job_message(const string & job_id,
+void JsonProtocolWriter::append_from_job_message(const JobIdentifier & job_id,
                                                  const Document & message,
                                                  double date)
 {
@@ -379,21 +937,14 @@ void JsonProtocolWriter::append_from_job_message(const string & job_id,
       }
     } */
 
-    xbt_assert(date >= _last_date, "Date inconsistency");
-    _last_date = date;
-    _is_empty = false;
-
-    Value data(rapidjson::kObjectType);
-    data.AddMember("job_id",
-                   Value().SetString(job_id.c_str(), _alloc), _alloc);
-    data.AddMember("msg", Value().CopyFrom(message, _alloc), _alloc);
-
-    Value event(rapidjson::kObjectType);
-    event.AddMember("timestamp", Value().SetDouble(date), _alloc);
-    event.AddMember("type", Value().SetString("FROM_JOB_MSG"), _alloc);
-    event.AddMember("data", data, _alloc);
-
-    _events.PushBack(event, _alloc);
+    start_event("FROM_JOB_MSG", date);
+    _encoder->StartObject();
+    _encoder->Key("job_id");
+    write_job_id(job_id);
+    _encoder->Key("msg");
+    message.Accept(*_encoder);
+    _encoder->EndObject();
+    end_event();
 }
 
 void JsonProtocolWriter::append_resource_state_changed(const MachineRange & resources,
@@ -406,21 +957,14 @@ void JsonProtocolWriter::append_resource_state_changed(const MachineRange & reso
       "data": {"resources": "1 2 3-5", "state": "42"}
     } */
 
-    xbt_assert(date >= _last_date, "Date inconsistency");
-    _last_date = date;
-    _is_empty = false;
-
-    Value data(rapidjson::kObjectType);
-    data.AddMember("resources",
-                   Value().SetString(resources.to_string_hyphen(" ", "-").c_str(), _alloc), _alloc);
-    data.AddMember("state", Value().SetString(new_state.c_str(), _alloc), _alloc);
-
-    Value event(rapidjson::kObjectType);
-    event.AddMember("timestamp", Value().SetDouble(date), _alloc);
-    event.AddMember("type", Value().SetString("RESOURCE_STATE_CHANGED"), _alloc);
-    event.AddMember("data", data, _alloc);
-
-    _events.PushBack(event, _alloc);
+    start_event("RESOURCE_STATE_CHANGED", date);
+    _encoder->StartObject();
+    _encoder->Key("resources");
+    _encoder->String(resources.to_string_hyphen(" ", "-"));
+    _encoder->Key("state");
+    _encoder->String(new_state);
+    _encoder->EndObject();
+    end_event();
 }
 
 void JsonProtocolWriter::append_query_estimate_waiting_time(const string &job_id,
@@ -443,30 +987,20 @@ void JsonProtocolWriter::append_query_estimate_waiting_time(const string &job_id
       }
     } */
 
-    xbt_assert(date >= _last_date, "Date inconsistency");
-    _last_date = date;
-    _is_empty = false;
-
-    Value estimate_object(rapidjson::kObjectType);
-
-    Document job_description_doc;
-    job_description_doc.Parse(job_json_description.c_str());
-    xbt_assert(!job_description_doc.HasParseError());
-    estimate_object.AddMember("job_id", Value().SetString(job_id.c_str(), _alloc), _alloc);
-    estimate_object.AddMember("job", Value().CopyFrom(job_description_doc, _alloc), _alloc);
-
-    Value requests_object(rapidjson::kObjectType);
-    requests_object.AddMember("estimate_waiting_time", estimate_object, _alloc);
-
-    Value data(rapidjson::kObjectType);
-    data.AddMember("requests", requests_object, _alloc);
-
-    Value event(rapidjson::kObjectType);
-    event.AddMember("timestamp", Value().SetDouble(date), _alloc);
-    event.AddMember("type", Value().SetString("QUERY"), _alloc);
-    event.AddMember("data", data, _alloc);
-
-    _events.PushBack(event, _alloc);
+    start_event("QUERY", date);
+    _encoder->StartObject();
+    _encoder->Key("requests");
+    _encoder->StartObject();
+    _encoder->Key("estimate_waiting_time");
+    _encoder->StartObject();
+    _encoder->Key("job_id");
+    _encoder->String(job_id);
+    _encoder->Key("job");
+    write_json_text(job_json_description);
+    _encoder->EndObject();
+    _encoder->EndObject();
+    _encoder->EndObject();
+    end_event();
 }
 
 void JsonProtocolWriter::append_answer_energy(double consumed_energy,
@@ -478,55 +1012,67 @@ void JsonProtocolWriter::append_answer_energy(double consumed_energy,
       "data": {"consumed_energy": 12500.0}
     } */
 
+    start_event("ANSWER", date);
+    _encoder->StartObject();
+    _encoder->Key("consumed_energy");
+    _encoder->Double(consumed_energy);
+    _encoder->EndObject();
+    end_event();
+}
+
+void JsonProtocolWriter::clear()
+{
+    _is_empty = true;
+    _has_triggering_events = false;
+    _nb_events = 0;
+    _is_job_submission_batch_open = false;
+    _batch_job_ids.clear();
+    _batch_profiles.clear();
+    _encoder->clear();
+}
+
+ProtocolMessage JsonProtocolWriter::generate_current_message(double date)
+{
     xbt_assert(date >= _last_date, "Date inconsistency");
-    _last_date = date;
-    _is_empty = false;
+    end_job_submission_batch();
+    return _encoder->finish_message(date);
+}
 
-    Value event(rapidjson::kObjectType);
-    event.AddMember("timestamp", Value().SetDouble(date), _alloc);
-    event.AddMember("type", Value().SetString("ANSWER"), _alloc);
-    event.AddMember("data", Value().SetObject().AddMember("consumed_energy", Value().SetDouble(consumed_energy), _alloc), _alloc);
 
-    _events.PushBack(event, _alloc);
-}
 
-void JsonProtocolWriter::clear()
+MsgpackProtocolWriter::MsgpackProtocolWriter(BatsimContext * context) :
+    JsonProtocolWriter(context)
 {
-    _is_empty = true;
-
-    _doc.RemoveAllMembers();
-    _events.SetArray();
 }
 
-string JsonProtocolWriter::generate_current_message(double date)
+MsgpackProtocolWriter::~MsgpackProtocolWriter()
 {
-    xbt_assert(date >= _last_date, "Date inconsistency");
-    xbt_assert(_events.IsArray(),
-               "Successive calls to JsonProtocolWriter::generate_current_message without calling "
-               "the clear() method is not supported");
-
-    // Generating the content
-    _doc.AddMember("now", Value().SetDouble(date), _alloc);
-    _doc.AddMember("events", _events, _alloc);
+}
 
-    // Dumping the content to a buffer
-    StringBuffer buffer;
-    ::Writer<rapidjson::StringBuffer> writer(buffer);
-    _doc.Accept(writer);
+void MsgpackProtocolWriter::clear()
+{
+    // The first message is JSON-encoded, so that any scheduler can read which format is used.
+    // Its encoder is kept alive since the message may still be in use.
+    if (_first_message_encoder == nullptr)
+    {
+        _first_message_encoder = std::move(_encoder);
+        _encoder.reset(new MsgpackMessageEncoder);
+    }
 
-    // Returning the buffer as a string
-    return string(buffer.GetString(), buffer.GetSize());
+    JsonProtocolWriter::clear();
 }
 
 
 
 JsonProtocolReader::JsonProtocolReader(BatsimContext *context) :
-    context(context)
+    context(context),
+    _validation(context->protocol_validation)
 {
     _type_to_handler_map["QUERY"] = &JsonProtocolReader::handle_query;
     _type_to_handler_map["ANSWER"] = &JsonProtocolReader::handle_answer;
     _type_to_handler_map["REJECT_JOB"] = &JsonProtocolReader::handle_reject_job;
     _type_to_handler_map["EXECUTE_JOB"] = &JsonProtocolReader::handle_execute_job;
+    _type_to_handler_map["EXECUTE_JOBS"] = &JsonProtocolReader::handle_execute_jobs;
     _type_to_handler_map["CHANGE_JOB_STATE"] = &JsonProtocolReader::handle_change_job_state;
     _type_to_handler_map["CALL_ME_LATER"] = &JsonProtocolReader::handle_call_me_later;
     _type_to_handler_map["KILL_JOB"] = &JsonProtocolReader::handle_kill_job;
@@ -544,25 +1090,15 @@ JsonProtocolReader::~JsonProtocolReader()
 
 void JsonProtocolReader::parse_and_apply_message(const string &message)
 {
-    rapidjson::Document doc;
-    doc.Parse(message.c_str());
-
-    xbt_assert(!doc.HasParseError(), "Invalid JSON message: could not be parsed");
-    xbt_assert(doc.IsObject(), "Invalid JSON message: not a JSON object");
-
-    xbt_assert(doc.HasMember("now"), "Invalid JSON message: no 'now' key");
-    xbt_assert(doc["now"].IsNumber(), "Invalid JSON message: 'now' value should be a number.");
-    double now = doc["now"].GetDouble();
+    // Events are decoded and applied one by one while the message is being parsed
+    ProtocolMessageStreamHandler handler(this);
+    rapidjson::Reader reader;
+    StringStream stream(message.c_str());
+    reader.Parse(stream, handler);
 
-    xbt_assert(doc.HasMember("events"), "Invalid JSON message: no 'events' key");
-    const auto & events_array = doc["events"];
-    xbt_assert(events_array.IsArray(), "Invalid JSON message: 'events' value should be an array.");
-
-    for (unsigned int i = 0; i < events_array.Size(); ++i)
-    {
-        const auto & event_object = events_array[i];
-        parse_and_apply_event(event_object, i, now);
-    }
+    xbt_assert(!reader.HasParseError(), "Invalid JSON message: could not be parsed: %s (at byte %zu)",
+               GetParseError_En(reader.GetParseErrorCode()), reader.GetErrorOffset());
+    double now = handler.finish();
 
     send_message(now, "server", IPMessageType::SCHED_READY);
 }
@@ -571,20 +1107,20 @@ void JsonProtocolReader::parse_and_apply_event(const Value & event_object,
                                                int event_number,
                                                double now)
 {
-    xbt_assert(event_object.IsObject(), "Invalid JSON message: event %d should be an object.", event_number);
+    protocol_assert(event_object.IsObject(), "Invalid JSON message: event %d should be an object.", event_number);
 
-    xbt_assert(event_object.HasMember("timestamp"), "Invalid JSON message: event %d should have a 'timestamp' key.", event_number);
-    xbt_assert(event_object["timestamp"].IsNumber(), "Invalid JSON message: timestamp of event %d should be a number", event_number);
+    protocol_assert(event_object.HasMember("timestamp"), "Invalid JSON message: event %d should have a 'timestamp' key.", event_number);
+    protocol_assert(event_object["timestamp"].IsNumber(), "Invalid JSON message: timestamp of event %d should be a number", event_number);
     double timestamp = event_object["timestamp"].GetDouble();
     xbt_assert(timestamp <= now, "Invalid JSON message: timestamp %g of event %d should be lower than or equal to now=%g.", timestamp, event_number, now);
     (void) now; // Avoids a warning if assertions are ignored
 
-    xbt_assert(event_object.HasMember("type"), "Invalid JSON message: event %d should have a 'type' key.", event_number);
-    xbt_assert(event_object["type"].IsString(), "Invalid JSON message: event %d 'type' value should be a String", event_number);
+    protocol_assert(event_object.HasMember("type"), "Invalid JSON message: event %d should have a 'type' key.", event_number);
+    protocol_assert(event_object["type"].IsString(), "Invalid JSON message: event %d 'type' value should be a String", event_number);
     string type = event_object["type"].GetString();
     xbt_assert(_type_to_handler_map.find(type) != _type_to_handler_map.end(), "Invalid JSON message: event %d has an unknown 'type' value '%s'", event_number, type.c_str());
 
-    xbt_assert(event_object.HasMember("data"), "Invalid JSON message: event %d should have a 'data' key.", event_number);
+    protocol_assert(event_object.HasMember("data"), "Invalid JSON message: event %d should have a 'data' key.", event_number);
     const Value & data_object = event_object["data"];
 
     auto handler_function = _type_to_handler_map[type];
@@ -602,13 +1138,13 @@ void JsonProtocolReader::handle_query(int event_number, double timestamp, const
       }
     } */
 
-    xbt_assert(data_object.IsObject(), "Invalid JSON message: the 'data' value of event %d (QUERY) should be an object", event_number);
-    xbt_assert(data_object.MemberCount() == 1, "Invalid JSON message: the 'data' value of event %d (QUERY) must be of size 1 (size=%d)", event_number, (int)data_object.MemberCount());
-    xbt_assert(data_object.HasMember("requests"), "Invalid JSON message: the 'data' value of event %d (QUERY) must have a 'requests' member", event_number);
+    protocol_assert(data_object.IsObject(), "Invalid JSON message: the 'data' value of event %d (QUERY) should be an object", event_number);
+    protocol_assert(data_object.MemberCount() == 1, "Invalid JSON message: the 'data' value of event %d (QUERY) must be of size 1 (size=%d)", event_number, (int)data_object.MemberCount());
+    protocol_assert(data_object.HasMember("requests"), "Invalid JSON message: the 'data' value of event %d (QUERY) must have a 'requests' member", event_number);
 
     const Value & requests = data_object["requests"];
-    xbt_assert(requests.IsObject(), "Invalid JSON message: the 'requests' member of the 'data' object  of event %d (QUERY) must be an object", event_number);
-    xbt_assert(requests.MemberCount() > 0, "Invalid JSON message: the 'requests' object of the 'data' object of event %d (QUERY) must be non-empty", event_number);
+    protocol_assert(requests.IsObject(), "Invalid JSON message: the 'requests' member of the 'data' object  of event %d (QUERY) must be an object", event_number);
+    protocol_assert(requests.MemberCount() > 0, "Invalid JSON message: the 'requests' object of the 'data' object of event %d (QUERY) must be non-empty", event_number);
 
     for (auto it = requests.MemberBegin(); it != requests.MemberEnd(); ++it)
     {
@@ -616,15 +1152,15 @@ void JsonProtocolReader::handle_query(int event_number, double timestamp, const
         const Value & value_object = it->value;
         (void) value_object; // Avoids a warning if assertions are ignored
 
-        xbt_assert(key_value.IsString(), "Invalid JSON message: a key within the 'data' object of event %d (QUERY) is not a string", event_number);
+        protocol_assert(key_value.IsString(), "Invalid JSON message: a key within the 'data' object of event %d (QUERY) is not a string", event_number);
         string key = key_value.GetString();
         xbt_assert(std::find(accepted_requests.begin(), accepted_requests.end(), key) != accepted_requests.end(), "Invalid JSON message: Unknown QUERY '%s' of event %d", key.c_str(), event_number);
 
-        xbt_assert(value_object.IsObject(), "Invalid JSON message: the value of '%s' inside the 'requests' object of the 'data' object of event %d (QUERY) is not an object", key.c_str(), event_number);
+        protocol_assert(value_object.IsObject(), "Invalid JSON message: the value of '%s' inside the 'requests' object of the 'data' object of event %d (QUERY) is not an object", key.c_str(), event_number);
 
         if (key == "consumed_energy")
         {
-            xbt_assert(value_object.ObjectEmpty(), "Invalid JSON message: the value of '%s' inside the 'requests' object of the 'data' object of event %d (QUERY) should be empty", key.c_str(), event_number);
+            protocol_assert(value_object.ObjectEmpty(), "Invalid JSON message: the value of '%s' inside the 'requests' object of the 'data' object of event %d (QUERY) should be empty", key.c_str(), event_number);
             send_message(timestamp, "server", IPMessageType::SCHED_TELL_ME_ENERGY);
         }
         else
@@ -650,8 +1186,8 @@ void JsonProtocolReader::handle_answer(int event_number,
       }
     } */
 
-    xbt_assert(data_object.IsObject(), "Invalid JSON message: the 'data' value of event %d (ANSWER) should be an object", event_number);
-    xbt_assert(data_object.MemberCount() > 0, "Invalid JSON message: the 'data' object of event %d (ANSWER) must be non-empty (size=%d)", event_number, (int)data_object.MemberCount());
+    protocol_assert(data_object.IsObject(), "Invalid JSON message: the 'data' value of event %d (ANSWER) should be an object", event_number);
+    protocol_assert(data_object.MemberCount() > 0, "Invalid JSON message: the 'data' object of event %d (ANSWER) must be non-empty (size=%d)", event_number, (int)data_object.MemberCount());
 
     for (auto it = data_object.MemberBegin(); it != data_object.MemberEnd(); ++it)
     {
@@ -660,16 +1196,16 @@ void JsonProtocolReader::handle_answer(int event_number,
 
         if (key_value == "estimate_waiting_time")
         {
-            xbt_assert(value_object.IsObject(), "Invalid JSON message: the value of the '%s' key of event %d (ANSWER) should be an object", key_value.c_str(), event_number);
+            protocol_assert(value_object.IsObject(), "Invalid JSON message: the value of the '%s' key of event %d (ANSWER) should be an object", key_value.c_str(), event_number);
 
-            xbt_assert(value_object.HasMember("job_id"), "Invalid JSON message: the object of '%s' key of event %d (ANSWER) should have a 'job_id' field", key_value.c_str(), event_number);
+            protocol_assert(value_object.HasMember("job_id"), "Invalid JSON message: the object of '%s' key of event %d (ANSWER) should have a 'job_id' field", key_value.c_str(), event_number);
             const Value & job_id_value = value_object["job_id"];
-            xbt_assert(job_id_value.IsString(), "Invalid JSON message: the value of the 'job_id' field (on the '%s' key) of event %d should be a string", key_value.c_str(), event_number);
+            protocol_assert(job_id_value.IsString(), "Invalid JSON message: the value of the 'job_id' field (on the '%s' key) of event %d should be a string", key_value.c_str(), event_number);
             string job_id = job_id_value.GetString();
 
-            xbt_assert(value_object.HasMember("estimated_waiting_time"), "Invalid JSON message: the object of '%s' key of event %d (ANSWER) should have a 'estimated_waiting_time' field", key_value.c_str(), event_number);
+            protocol_assert(value_object.HasMember("estimated_waiting_time"), "Invalid JSON message: the object of '%s' key of event %d (ANSWER) should have a 'estimated_waiting_time' field", key_value.c_str(), event_number);
             const Value & estimated_waiting_time_value = value_object["estimated_waiting_time"];
-            xbt_assert(estimated_waiting_time_value.IsNumber(), "Invalid JSON message: the value of the 'estimated_waiting_time' field (on the '%s' key) of event %d should be a number", key_value.c_str(), event_number);
+            protocol_assert(estimated_waiting_time_value.IsNumber(), "Invalid JSON message: the value of the 'estimated_waiting_time' field (on the '%s' key) of event %d should be a number", key_value.c_str(), event_number);
             double estimated_waiting_time = estimated_waiting_time_value.GetDouble();
 
             XBT_WARN("Received an ANSWER of type 'estimate_waiting_time' with job_id='%s' and 'estimated_waiting_time'=%g. "
@@ -695,22 +1231,22 @@ void JsonProtocolReader::handle_reject_job(int event_number,
       "data": { "job_id": "w12!45" }
     } */
 
-    xbt_assert(data_object.IsObject(), "Invalid JSON message: the 'data' value of event %d (REJECT_JOB) should be an object", event_number);
-    xbt_assert(data_object.MemberCount() == 1, "Invalid JSON message: the 'data' value of event %d (REJECT_JOB) should be of size 1 (size=%d)", event_number, (int)data_object.MemberCount());
+    protocol_assert(data_object.IsObject(), "Invalid JSON message: the 'data' value of event %d (REJECT_JOB) should be an object", event_number);
+    protocol_assert(data_object.MemberCount() == 1, "Invalid JSON message: the 'data' value of event %d (REJECT_JOB) should be of size 1 (size=%d)", event_number, (int)data_object.MemberCount());
 
-    xbt_assert(data_object.HasMember("job_id"), "Invalid JSON message: the 'data' value of event %d (REJECT_JOB) should contain a 'job_id' key.", event_number);
+    protocol_assert(data_object.HasMember("job_id"), "Invalid JSON message: the 'data' value of event %d (REJECT_JOB) should contain a 'job_id' key.", event_number);
     const Value & job_id_value = data_object["job_id"];
-    xbt_assert(job_id_value.IsString(), "Invalid JSON message: the 'job_id' value in the 'data' value of event %d (REJECT_JOB) should be a string.", event_number);
-    string job_id = job_id_value.GetString();
+    protocol_assert(job_id_value.IsString(), "Invalid JSON message: the 'job_id' value in the 'data' value of event %d (REJECT_JOB) should be a string.", event_number);
+    const char * job_id = job_id_value.GetString();
 
     JobRejectedMessage * message = new JobRejectedMessage;
-    if (!identify_job_from_string(context, job_id, message->job_id))
+    if (!identify_job_from_string(context, job_id, job_id_value.GetStringLength(), message->job_id))
     {
         xbt_assert(false, "Invalid JSON message: "
                           "Invalid job rejection received: The job identifier '%s' is not valid. "
                           "Job identifiers must be of the form [WORKLOAD_NAME!]JOB_ID. "
                           "If WORKLOAD_NAME! is omitted, WORKLOAD_NAME='static' is used. "
-                          "Furthermore, the corresponding job must exist.", job_id.c_str());
+                          "Furthermore, the corresponding job must exist.", job_id);
     }
 
     Job * job = context->workloads.job_at(message->job_id);
@@ -724,145 +1260,239 @@ void JsonProtocolReader::handle_reject_job(int event_number,
     send_message(timestamp, "server", IPMessageType::SCHED_REJECT_JOB, (void*) message);
 }
 
-void JsonProtocolReader::handle_execute_job(int event_number,
-                                            double timestamp,
-                                            const Value &data_object)
+/**
+ * @brief Parses a non-negative integer of a mapping (an executor or a resource index) without throwing
+ * @param[in] str The string to parse
+ * @param[out] index The parsed integer. Only set on success.
+ * @return Whether str represents a non-negative integer which fits in an int
+ */
+static bool parse_mapping_index(const char * str, int & index)
 {
-    (void) event_number; // Avoids a warning if assertions are ignored
-    /* {
-      "timestamp": 10.0,
-      "type": "EXECUTE_JOB",
-      "data": {
-        "job_id": "w12!45",
-        "alloc": "2-3",
-        "mapping": {"0": "0", "1": "0", "2": "1", "3": "1"}
-      }
-    } */
+    char * end = nullptr;
+    errno = 0;
+    long value = strtol(str, &end, 10);
+    if (end == str || *end != '\0' || errno != 0 || value < 0 || value > INT_MAX)
+    {
+        return false;
+    }
 
-    ExecuteJobMessage * message = new ExecuteJobMessage;
-    message->allocation = new SchedulingAllocation;
+    index = (int) value;
+    return true;
+}
+
+SchedulingAllocation * JsonProtocolReader::parse_job_allocation(int event_number,
+                                                              const char * event_type,
+                                                              const Value & job_object)
+{
+    (void) event_number; // Avoids a warning if assertions are ignored
+    (void) event_type;
+    SchedulingAllocation * allocation = new SchedulingAllocation;
 
-    xbt_assert(data_object.IsObject(), "Invalid JSON message: the 'data' value of event %d (EXECUTE_JOB) should be an object", event_number);
-    xbt_assert(data_object.MemberCount() == 2 || data_object.MemberCount() == 3, "Invalid JSON message: the 'data' value of event %d (EXECUTE_JOB) should be of size in {2,3} (size=%d)", event_number, (int)data_object.MemberCount());
+    protocol_assert(job_object.IsObject(), "Invalid JSON message: the allocation object of event %d (%s) should be an object", event_number, event_type);
+    protocol_assert(job_object.MemberCount() == 2 || job_object.MemberCount() == 3, "Invalid JSON message: the allocation object of event %d (%s) should be of size in {2,3} (size=%d)", event_number, event_type, (int)job_object.MemberCount());
 
     // *************************
     // Job identifier management
     // *************************
     // Let's read it from the JSON message
-    xbt_assert(data_object.HasMember("job_id"), "Invalid JSON message: the 'data' value of event %d (EXECUTE_JOB) should contain a 'job_id' key.", event_number);
-    const Value & job_id_value = data_object["job_id"];
-    xbt_assert(job_id_value.IsString(), "Invalid JSON message: the 'job_id' value in the 'data' value of event %d (EXECUTE_JOB) should be a string.", event_number);
-    string job_id = job_id_value.GetString();
+    protocol_assert(job_object.HasMember("job_id"), "Invalid JSON message: the allocation object of event %d (%s) should contain a 'job_id' key.", event_number, event_type);
+    const Value & job_id_value = job_object["job_id"];
+    protocol_assert(job_id_value.IsString(), "Invalid JSON message: the 'job_id' value in the allocation object of event %d (%s) should be a string.", event_number, event_type);
+    const char * job_id = job_id_value.GetString();
 
     // Let's retrieve the job identifier
-    if (!identify_job_from_string(context, job_id, message->allocation->job_id,
+    if (!identify_job_from_string(context, job_id, job_id_value.GetStringLength(), allocation->job_id,
                                   IdentifyJobReturnCondition::STRING_VALID))
     {
-        xbt_assert(false, "Invalid JSON message: in event %d (EXECUTE_JOB): "
+        xbt_assert(false, "Invalid JSON message: in event %d (%s): "
                           "The job identifier '%s' is not valid. "
                           "Job identifiers must be of the form [WORKLOAD_NAME!]JOB_ID. "
                           "If WORKLOAD_NAME! is omitted, WORKLOAD_NAME='static' is used. "
                           "Furthermore, the corresponding job must exist.",
-                   event_number, job_id.c_str());
+                   event_number, event_type, job_id);
     }
 
     // *********************
     // Allocation management
     // *********************
     // Let's read it from the JSON message
-    xbt_assert(data_object.HasMember("alloc"), "Invalid JSON message: the 'data' value of event %d (EXECUTE_JOB) should contain a 'alloc' key.", event_number);
-    const Value & alloc_value = data_object["alloc"];
-    xbt_assert(alloc_value.IsString(), "Invalid JSON message: the 'alloc' value in the 'data' value of event %d (EXECUTE_JOB) should be a string.", event_number);
+    protocol_assert(job_object.HasMember("alloc"), "Invalid JSON message: the allocation object of event %d (%s) should contain a 'alloc' key.", event_number, event_type);
+    const Value & alloc_value = job_object["alloc"];
+    protocol_assert(alloc_value.IsString(), "Invalid JSON message: the 'alloc' value in the allocation object of event %d (%s) should be a string.", event_number, event_type);
     string alloc = alloc_value.GetString();
 
-    message->allocation->machine_ids = MachineRange::from_string_hyphen(alloc, " ", "-", "Invalid JSON message received from the scheduler");
-    int nb_allocated_resources = message->allocation->machine_ids.size();
+    allocation->machine_ids = MachineRange::from_string_hyphen(alloc, " ", "-", "Invalid JSON message received from the scheduler");
+    int nb_allocated_resources = allocation->machine_ids.size();
     (void) nb_allocated_resources; // Avoids a warning if assertions are ignored
-    xbt_assert(nb_allocated_resources > 0, "Invalid JSON message: in event %d (EXECUTE_JOB): the number of allocated resources should be strictly positive (got %d).", event_number, nb_allocated_resources);
+    xbt_assert(nb_allocated_resources > 0, "Invalid JSON message: in event %d (%s): the number of allocated resources should be strictly positive (got %d).", event_number, event_type, nb_allocated_resources);
 
     // *****************************
     // Mapping management (optional)
     // *****************************
-    if (data_object.HasMember("mapping"))
+    if (job_object.HasMember("mapping"))
     {
-        const Value & mapping_value = data_object["mapping"];
-        xbt_assert(mapping_value.IsObject(), "Invalid JSON message: the 'mapping' value in the 'data' value of event %d (EXECUTE_JOB) should be a string.", event_number);
-        xbt_assert(mapping_value.MemberCount() > 0, "Invalid JSON: the 'mapping' value in the 'data' value of event %d (EXECUTE_JOB) must be a non-empty object", event_number);
-        map<int,int> mapping_map;
+        const Value & mapping_value = job_object["mapping"];
+        protocol_assert(mapping_value.IsObject(), "Invalid JSON message: the 'mapping' value in the allocation object of event %d (%s) should be a string.", event_number, event_type);
+        protocol_assert(mapping_value.MemberCount() > 0, "Invalid JSON: the 'mapping' value in the allocation object of event %d (%s) must be a non-empty object", event_number, event_type);
 
-        // Let's fill the map from the JSON description
-        for (auto it = mapping_value.MemberBegin(); it != mapping_value.MemberEnd(); ++it)
+        if (_validation == ProtocolValidation::TRUSTED)
         {
-            const Value & key_value = it->name;
-            const Value & value_value = it->value;
-
-            xbt_assert(key_value.IsInt() || key_value.IsString(), "Invalid JSON message: Invalid 'mapping' of event %d (EXECUTE_JOB): a key is not an integer nor a string", event_number);
-            xbt_assert(value_value.IsInt() || value_value.IsString(), "Invalid JSON message: Invalid 'mapping' of event %d (EXECUTE_JOB): a value is not an integer nor a string", event_number);
-
-            int executor;
-            int resource;
-
-            try
+            // Trusted schedulers give a mapping whose executors are exactly [0, nb_executors[.
+            // The indexes are still checked, as a wrong one would corrupt memory.
+            const int nb_executors = (int) mapping_value.MemberCount();
+            allocation->mapping.resize(nb_executors);
+            for (auto it = mapping_value.MemberBegin(); it != mapping_value.MemberEnd(); ++it)
             {
-                if (key_value.IsInt())
+                // Object keys are always strings
+                int executor = -1;
+                int resource = -1;
+                parse_mapping_index(it->name.GetString(), executor);
+                if (it->value.IsInt())
                 {
-                    executor = key_value.GetInt();
+                    resource = it->value.GetInt();
                 }
-                else
+                else if (it->value.IsString())
                 {
-                    executor = std::stoi(key_value.GetString());
+                    parse_mapping_index(it->value.GetString(), resource);
                 }
 
-                if (value_value.IsInt())
+                xbt_assert(executor >= 0 && executor < nb_executors, "Invalid JSON message: Invalid 'mapping' object of event %d (%s): executor '%s' should be an integer in [0,%d[.", event_number, event_type, it->name.GetString(), nb_executors);
+                xbt_assert(resource >= 0 && resource < nb_allocated_resources, "Invalid JSON message: Invalid 'mapping' object of event %d (%s): executor %d should use an integer resource index in [0,%d[.", event_number, event_type, executor, nb_allocated_resources);
+                allocation->mapping[executor] = resource;
+            }
+        }
+        else
+        {
+            map<int,int> mapping_map;
+
+            // Let's fill the map from the JSON description
+            for (auto it = mapping_value.MemberBegin(); it != mapping_value.MemberEnd(); ++it)
+            {
+                const Value & key_value = it->name;
+                const Value & value_value = it->value;
+
+                xbt_assert(key_value.IsInt() || key_value.IsString(), "Invalid JSON message: Invalid 'mapping' of event %d (%s): a key is not an integer nor a string", event_number, event_type);
+                xbt_assert(value_value.IsInt() || value_value.IsString(), "Invalid JSON message: Invalid 'mapping' of event %d (%s): a value is not an integer nor a string", event_number, event_type);
+
+                int executor;
+                int resource;
+
+                try
                 {
-                    resource = value_value.GetInt();
+                    if (key_value.IsInt())
+                    {
+                        executor = key_value.GetInt();
+                    }
+                    else
+                    {
+                        executor = std::stoi(key_value.GetString());
+                    }
+
+                    if (value_value.IsInt())
+                    {
+                        resource = value_value.GetInt();
+                    }
+                    else
+                    {
+                        resource = std::stoi(value_value.GetString());
+                    }
                 }
-                else
+                catch (const std::exception &)
                 {
-                    resource = std::stoi(value_value.GetString());
+                    xbt_assert(false, "Invalid JSON message: Invalid 'mapping' object of event %d (%s): all keys and values must be integers (or strings representing integers)", event_number, event_type);
+                    throw;
                 }
-            }
-            catch (const std::exception &)
-            {
-                xbt_assert(false, "Invalid JSON message: Invalid 'mapping' object of event %d (EXECUTE_JOB): all keys and values must be integers (or strings representing integers)", event_number);
-                throw;
+
+                mapping_map[executor] = resource;
             }
 
-            mapping_map[executor] = resource;
-        }
+            // Let's write the mapping as a vector (keys will be implicit between 0 and nb_executor-1)
+            allocation->mapping.reserve(mapping_map.size());
+            auto mit = mapping_map.begin();
+            int nb_inserted = 0;
 
-        // Let's write the mapping as a vector (keys will be implicit between 0 and nb_executor-1)
-        message->allocation->mapping.reserve(mapping_map.size());
-        auto mit = mapping_map.begin();
-        int nb_inserted = 0;
+            xbt_assert(mit->first == nb_inserted, "Invalid JSON message: Invalid 'mapping' object of event %d (%s): no resource associated to executor %d.", event_number, event_type, nb_inserted);
+            xbt_assert(mit->second >= 0 && mit->second < nb_allocated_resources, "Invalid JSON message: Invalid 'mapping' object of event %d (%s): executor %d should use the %d-th resource within the allocation, but there are only %d allocated resources.", event_number, event_type, mit->first, mit->second, nb_allocated_resources);
+            allocation->mapping.push_back(mit->second);
 
-        xbt_assert(mit->first == nb_inserted, "Invalid JSON message: Invalid 'mapping' object of event %d (EXECUTE_JOB): no resource associated to executor %d.", event_number, nb_inserted);
-        xbt_assert(mit->second >= 0 && mit->second < nb_allocated_resources, "Invalid JSON message: Invalid 'mapping' object of event %d (EXECUTE_JOB): executor %d should use the %d-th resource within the allocation, but there are only %d allocated resources.", event_number, mit->first, mit->second, nb_allocated_resources);
-        message->allocation->mapping.push_back(mit->second);
+            for (++mit, ++nb_inserted; mit != mapping_map.end(); ++mit, ++nb_inserted)
+            {
+                xbt_assert(mit->first == nb_inserted, "Invalid JSON message: Invalid 'mapping' object of event %d (%s): no resource associated to executor %d.", event_number, event_type, nb_inserted);
+                xbt_assert(mit->second >= 0 && mit->second < nb_allocated_resources, "Invalid JSON message: Invalid 'mapping' object of event %d (%s): executor %d should use the %d-th resource within the allocation, but there are only %d allocated resources.", event_number, event_type, mit->first, mit->second, nb_allocated_resources);
+                allocation->mapping.push_back(mit->second);
+            }
 
-        for (++mit, ++nb_inserted; mit != mapping_map.end(); ++mit, ++nb_inserted)
-        {
-            xbt_assert(mit->first == nb_inserted, "Invalid JSON message: Invalid 'mapping' object of event %d (EXECUTE_JOB): no resource associated to executor %d.", event_number, nb_inserted);
-            xbt_assert(mit->second >= 0 && mit->second < nb_allocated_resources, "Invalid JSON message: Invalid 'mapping' object of event %d (EXECUTE_JOB): executor %d should use the %d-th resource within the allocation, but there are only %d allocated resources.", event_number, mit->first, mit->second, nb_allocated_resources);
-            message->allocation->mapping.push_back(mit->second);
+            xbt_assert(allocation->mapping.size() == mapping_map.size());
         }
-
-        xbt_assert(message->allocation->mapping.size() == mapping_map.size());
     }
     else
     {
         // Default mapping
-        message->allocation->mapping.resize(nb_allocated_resources);
+        allocation->mapping.resize(nb_allocated_resources);
         for (int i = 0; i < nb_allocated_resources; ++i)
         {
-            message->allocation->mapping[i] = i;
+            allocation->mapping[i] = i;
         }
     }
 
+    return allocation;
+}
+
+void JsonProtocolReader::handle_execute_job(int event_number,
+                                            double timestamp,
+                                            const Value &data_object)
+{
+    /* {
+      "timestamp": 10.0,
+      "type": "EXECUTE_JOB",
+      "data": {
+        "job_id": "w12!45",
+        "alloc": "2-3",
+        "mapping": {"0": "0", "1": "0", "2": "1", "3": "1"}
+      }
+    } */
+
+    ExecuteJobMessage * message = new ExecuteJobMessage;
+    message->allocation = parse_job_allocation(event_number, "EXECUTE_JOB", data_object);
+
     // Everything has been parsed correctly, let's inject the message into the simulation.
     send_message(timestamp, "server", IPMessageType::SCHED_EXECUTE_JOB, (void*) message);
 }
 
+void JsonProtocolReader::handle_execute_jobs(int event_number,
+                                             double timestamp,
+                                             const Value &data_object)
+{
+    (void) event_number; // Avoids a warning if assertions are ignored
+    /* {
+      "timestamp": 10.0,
+      "type": "EXECUTE_JOBS",
+      "data": {
+        "jobs": [
+          {"job_id": "w12!45", "alloc": "2-3", "mapping": {"0": "0", "1": "0", "2": "1", "3": "1"}},
+          {"job_id": "w12!46", "alloc": "0-1"}
+        ]
+      }
+    } */
+
+    protocol_assert(data_object.IsObject(), "Invalid JSON message: the 'data' value of event %d (EXECUTE_JOBS) should be an object", event_number);
+    protocol_assert(data_object.MemberCount() == 1, "Invalid JSON message: the 'data' value of event %d (EXECUTE_JOBS) should be of size 1 (size=%d)", event_number, (int)data_object.MemberCount());
+    protocol_assert(data_object.HasMember("jobs"), "Invalid JSON message: the 'data' value of event %d (EXECUTE_JOBS) should contain a 'jobs' key.", event_number);
+    const Value & jobs_array = data_object["jobs"];
+    protocol_assert(jobs_array.IsArray(), "Invalid JSON message: the 'jobs' value in the 'data' value of event %d (EXECUTE_JOBS) should be an array.", event_number);
+    protocol_assert(jobs_array.Size() > 0, "Invalid JSON message: the 'jobs' array in the 'data' value of event %d (EXECUTE_JOBS) should be non-empty.", event_number);
+
+    ExecuteJobsMessage * message = new ExecuteJobsMessage;
+    message->allocations.reserve(jobs_array.Size());
+    for (SizeType i = 0; i < jobs_array.Size(); ++i)
+    {
+        message->allocations.push_back(parse_job_allocation(event_number, "EXECUTE_JOBS", jobs_array[i]));
+    }
+
+    // Everything has been parsed correctly, let's inject all the allocations into the simulation in one message.
+    send_message(timestamp, "server", IPMessageType::SCHED_EXECUTE_JOBS, (void*) message);
+}
+
 void JsonProtocolReader::handle_call_me_later(int event_number,
                                               double timestamp,
                                               const Value &data_object)
@@ -875,12 +1505,12 @@ void JsonProtocolReader::handle_call_me_later(int event_number,
 
     CallMeLaterMessage * message = new CallMeLaterMessage;
 
-    xbt_assert(data_object.IsObject(), "Invalid JSON message: the 'data' value of event %d (CALL_ME_LATER) should be an object", event_number);
-    xbt_assert(data_object.MemberCount() == 1, "Invalid JSON message: the 'data' value of event %d (CALL_ME_LATER) should be of size 1 (size=%d)", event_number, (int)data_object.MemberCount());
+    protocol_assert(data_object.IsObject(), "Invalid JSON message: the 'data' value of event %d (CALL_ME_LATER) should be an object", event_number);
+    protocol_assert(data_object.MemberCount() == 1, "Invalid JSON message: the 'data' value of event %d (CALL_ME_LATER) should be of size 1 (size=%d)", event_number, (int)data_object.MemberCount());
 
-    xbt_assert(data_object.HasMember("timestamp"), "Invalid JSON message: the 'data' value of event %d (CALL_ME_LATER) should contain a 'timestamp' key.", event_number);
+    protocol_assert(data_object.HasMember("timestamp"), "Invalid JSON message: the 'data' value of event %d (CALL_ME_LATER) should contain a 'timestamp' key.", event_number);
     const Value & timestamp_value = data_object["timestamp"];
-    xbt_assert(timestamp_value.IsNumber(), "Invalid JSON message: the 'timestamp' value in the 'data' value of event %d (CALL_ME_LATER) should be a number.", event_number);
+    protocol_assert(timestamp_value.IsNumber(), "Invalid JSON message: the 'timestamp' value in the 'data' value of event %d (CALL_ME_LATER) should be a number.", event_number);
     message->target_time = timestamp_value.GetDouble();
 
     if (message->target_time < MSG_get_clock())
@@ -907,12 +1537,12 @@ void JsonProtocolReader::handle_set_resource_state(int event_number,
     // Resources management
     // ********************
     // Let's read it from the JSON message
-    xbt_assert(data_object.IsObject(), "Invalid JSON message: the 'data' value of event %d (SET_RESOURCE_STATE) should be an object", event_number);
-    xbt_assert(data_object.MemberCount() == 2, "Invalid JSON message: the 'data' value of event %d (SET_RESOURCE_STATE) should be of size 2 (size=%d)", event_number, (int)data_object.MemberCount());
+    protocol_assert(data_object.IsObject(), "Invalid JSON message: the 'data' value of event %d (SET_RESOURCE_STATE) should be an object", event_number);
+    protocol_assert(data_object.MemberCount() == 2, "Invalid JSON message: the 'data' value of event %d (SET_RESOURCE_STATE) should be of size 2 (size=%d)", event_number, (int)data_object.MemberCount());
 
-    xbt_assert(data_object.HasMember("resources"), "Invalid JSON message: the 'data' value of event %d (SET_RESOURCE_STATE) should contain a 'resources' key.", event_number);
+    protocol_assert(data_object.HasMember("resources"), "Invalid JSON message: the 'data' value of event %d (SET_RESOURCE_STATE) should contain a 'resources' key.", event_number);
     const Value & resources_value = data_object["resources"];
-    xbt_assert(resources_value.IsString(), "Invalid JSON message: the 'resources' value in the 'data' value of event %d (SET_RESOURCE_STATE) should be a string.", event_number);
+    protocol_assert(resources_value.IsString(), "Invalid JSON message: the 'resources' value in the 'data' value of event %d (SET_RESOURCE_STATE) should be a string.", event_number);
     string resources = resources_value.GetString();
 
     message->machine_ids = MachineRange::from_string_hyphen(resources, " ", "-", "Invalid JSON message received from the scheduler");
@@ -921,9 +1551,9 @@ void JsonProtocolReader::handle_set_resource_state(int event_number,
     xbt_assert(nb_allocated_resources > 0, "Invalid JSON message: in event %d (SET_RESOURCE_STATE): the number of allocated resources should be strictly positive (got %d).", event_number, nb_allocated_resources);
 
     // State management
-    xbt_assert(data_object.HasMember("state"), "Invalid JSON message: the 'data' value of event %d (SET_RESOURCE_STATE) should contain a 'state' key.", event_number);
+    protocol_assert(data_object.HasMember("state"), "Invalid JSON message: the 'data' value of event %d (SET_RESOURCE_STATE) should contain a 'state' key.", event_number);
     const Value & state_value = data_object["state"];
-    xbt_assert(state_value.IsString(), "Invalid JSON message: the 'state' value in the 'data' value of event %d (SET_RESOURCE_STATE) should be a string.", event_number);
+    protocol_assert(state_value.IsString(), "Invalid JSON message: the 'state' value in the 'data' value of event %d (SET_RESOURCE_STATE) should be a string.", event_number);
     string state_value_string = state_value.GetString();
     try
     {
@@ -953,35 +1583,34 @@ void JsonProtocolReader::handle_set_job_metadata(int event_number,
       }
     } */
 
-    xbt_assert(data_object.IsObject(), "Invalid JSON message: the 'data' value of event %d (SET_JOB_METADATA) should be an object", event_number);
-    xbt_assert(data_object.MemberCount() == 2, "Invalid JSON message: the 'data' value of event %d (SET_JOB_METADATA) should be of size 2 (size=%d)", event_number, (int)data_object.MemberCount());
+    protocol_assert(data_object.IsObject(), "Invalid JSON message: the 'data' value of event %d (SET_JOB_METADATA) should be an object", event_number);
+    protocol_assert(data_object.MemberCount() == 2, "Invalid JSON message: the 'data' value of event %d (SET_JOB_METADATA) should be of size 2 (size=%d)", event_number, (int)data_object.MemberCount());
 
-    xbt_assert(data_object.HasMember("job_id"), "Invalid JSON message: the 'data' value of event %d (SET_JOB_METADATA) should have a 'job_id' key", event_number);
+    protocol_assert(data_object.HasMember("job_id"), "Invalid JSON message: the 'data' value of event %d (SET_JOB_METADATA) should have a 'job_id' key", event_number);
     const Value & job_id_value = data_object["job_id"];
-    xbt_assert(job_id_value.IsString(), "Invalid JSON message: in event %d (SET_JOB_METADATA): ['data']['job_id'] should be a string", event_number);
-    string job_id = job_id_value.GetString();
+    protocol_assert(job_id_value.IsString(), "Invalid JSON message: in event %d (SET_JOB_METADATA): ['data']['job_id'] should be a string", event_number);
+    const char * job_id = job_id_value.GetString();
 
-    xbt_assert(data_object.HasMember("metadata"), "Invalid JSON message: the 'data' value of event %d (SET_JOB_METADATA) should contain a 'metadata' key.", event_number);
+    protocol_assert(data_object.HasMember("metadata"), "Invalid JSON message: the 'data' value of event %d (SET_JOB_METADATA) should contain a 'metadata' key.", event_number);
     const Value & metadata_value = data_object["metadata"];
-    xbt_assert(metadata_value.IsString(), "Invalid JSON message: the 'metadata' value in the 'data' value of event %d (SET_JOB_METADATA) should be a string.", event_number);
+    protocol_assert(metadata_value.IsString(), "Invalid JSON message: the 'metadata' value in the 'data' value of event %d (SET_JOB_METADATA) should be a string.", event_number);
     string metadata = metadata_value.GetString();
 
     // Check metadata validity regarding CSV output
-    boost::regex r("[^\"]*");
-    xbt_assert(boost::regex_match(metadata, r), "Invalid JSON message: the 'metadata' value in the 'data' value of event %d (SET_JOB_METADATA) should not contain double quotes (got ###%s###)", event_number, metadata.c_str());
+    xbt_assert(metadata.find('"') == string::npos, "Invalid JSON message: the 'metadata' value in the 'data' value of event %d (SET_JOB_METADATA) should not contain double quotes (got ###%s###)", event_number, metadata.c_str());
 
     JobIdentifier job_identifier;
-    if (!identify_job_from_string(context, job_id, job_identifier))
+    if (!identify_job_from_string(context, job_id, job_id_value.GetStringLength(), job_identifier))
     {
         xbt_assert(false, "Invalid JSON message: "
                           "Invalid job change job state received: The job identifier '%s' is not valid. "
                           "Job identifiers must be of the form [WORKLOAD_NAME!]JOB_ID. "
                           "If WORKLOAD_NAME! is omitted, WORKLOAD_NAME='static' is used. "
-                          "Furthermore, the corresponding job must exist.", job_id.c_str());
+                          "Furthermore, the corresponding job must exist.", job_id);
     }
 
     Job * job = context->workloads.job_at(job_identifier);
-    job->metadata = metadata;
+    job->cold_data().metadata = metadata;
 }
 
 void JsonProtocolReader::handle_change_job_state(int event_number,
@@ -999,16 +1628,16 @@ void JsonProtocolReader::handle_change_job_state(int event_number,
       }
     } */
 
-    xbt_assert(data_object.IsObject(), "Invalid JSON message: the 'data' value of event %d (CHANGE_JOB_STATE) should be an object", event_number);
+    protocol_assert(data_object.IsObject(), "Invalid JSON message: the 'data' value of event %d (CHANGE_JOB_STATE) should be an object", event_number);
 
-    xbt_assert(data_object.HasMember("job_id"), "Invalid JSON message: the 'data' value of event %d (CHANGE_JOB_STATE) should have a 'job_id' key", event_number);
+    protocol_assert(data_object.HasMember("job_id"), "Invalid JSON message: the 'data' value of event %d (CHANGE_JOB_STATE) should have a 'job_id' key", event_number);
     const Value & job_id_value = data_object["job_id"];
-    xbt_assert(job_id_value.IsString(), "Invalid JSON message: in event %d (CHANGE_JOB_STATE): ['data']['job_id'] should be a string", event_number);
-    string job_id = job_id_value.GetString();
+    protocol_assert(job_id_value.IsString(), "Invalid JSON message: in event %d (CHANGE_JOB_STATE): ['data']['job_id'] should be a string", event_number);
+    const char * job_id = job_id_value.GetString();
 
-    xbt_assert(data_object.HasMember("job_state"), "Invalid JSON message: the 'data' value of event %d (CHANGE_JOB_STATE) should have a 'job_state' key", event_number);
+    protocol_assert(data_object.HasMember("job_state"), "Invalid JSON message: the 'data' value of event %d (CHANGE_JOB_STATE) should have a 'job_state' key", event_number);
     const Value & job_state_value = data_object["job_state"];
-    xbt_assert(job_state_value.IsString(), "Invalid JSON message: in event %d (CHANGE_JOB_STATE): ['data']['job_state'] should be a string", event_number);
+    protocol_assert(job_state_value.IsString(), "Invalid JSON message: in event %d (CHANGE_JOB_STATE): ['data']['job_state'] should be a string", event_number);
     string job_state = job_state_value.GetString();
 
     set<string> allowed_states = {"NOT_SUBMITTED",
@@ -1030,7 +1659,7 @@ void JsonProtocolReader::handle_change_job_state(int event_number,
     if (data_object.HasMember("kill_reason"))
     {
         const Value & kill_reason_value = data_object["kill_reason"];
-        xbt_assert(kill_reason_value.IsString(), "Invalid JSON message: in event %d (CHANGE_kill_reason): ['data']['kill_reason'] should be a string", event_number);
+        protocol_assert(kill_reason_value.IsString(), "Invalid JSON message: in event %d (CHANGE_kill_reason): ['data']['kill_reason'] should be a string", event_number);
         kill_reason = kill_reason_value.GetString();
 
         if (kill_reason != "" && job_state != "COMPLETED_KILLED")
@@ -1041,13 +1670,13 @@ void JsonProtocolReader::handle_change_job_state(int event_number,
 
     ChangeJobStateMessage * message = new ChangeJobStateMessage;
 
-    if (!identify_job_from_string(context, job_id, message->job_id))
+    if (!identify_job_from_string(context, job_id, job_id_value.GetStringLength(), message->job_id))
     {
         xbt_assert(false, "Invalid JSON message: "
                           "Invalid job change job state received: The job identifier '%s' is not valid. "
                           "Job identifiers must be of the form [WORKLOAD_NAME!]JOB_ID. "
                           "If WORKLOAD_NAME! is omitted, WORKLOAD_NAME='static' is used. "
-                          "Furthermore, the corresponding job must exist.", job_id.c_str());
+                          "Furthermore, the corresponding job must exist.", job_id);
     }
 
     message->job_state = job_state;
@@ -1067,11 +1696,11 @@ void JsonProtocolReader::handle_notify(int event_number,
       "data": { "type": "submission_finished" }
     } */
 
-    xbt_assert(data_object.IsObject(), "Invalid JSON message: the 'data' value of event %d (NOTIFY) should be an object", event_number);
+    protocol_assert(data_object.IsObject(), "Invalid JSON message: the 'data' value of event %d (NOTIFY) should be an object", event_number);
 
-    xbt_assert(data_object.HasMember("type"), "Invalid JSON message: the 'data' value of event %d (NOTIFY) should have a 'type' key", event_number);
+    protocol_assert(data_object.HasMember("type"), "Invalid JSON message: the 'data' value of event %d (NOTIFY) should have a 'type' key", event_number);
     const Value & notify_type_value = data_object["type"];
-    xbt_assert(notify_type_value.IsString(), "Invalid JSON message: in event %d (NOTIFY): ['data']['type'] should be a string", event_number);
+    protocol_assert(notify_type_value.IsString(), "Invalid JSON message: in event %d (NOTIFY): ['data']['type'] should be a string", event_number);
     string notify_type = notify_type_value.GetString();
 
     if (notify_type == "submission_finished")
@@ -1104,27 +1733,27 @@ void JsonProtocolReader::handle_to_job_msg(int event_number,
       }
     } */
 
-    xbt_assert(data_object.IsObject(), "Invalid JSON message: the 'data' value of event %d (TO_JOB_MSG) should be an object", event_number);
+    protocol_assert(data_object.IsObject(), "Invalid JSON message: the 'data' value of event %d (TO_JOB_MSG) should be an object", event_number);
 
-    xbt_assert(data_object.HasMember("job_id"), "Invalid JSON message: the 'data' value of event %d (TO_JOB_MSG) should have a 'job_id' key", event_number);
+    protocol_assert(data_object.HasMember("job_id"), "Invalid JSON message: the 'data' value of event %d (TO_JOB_MSG) should have a 'job_id' key", event_number);
     const Value & job_id_value = data_object["job_id"];
-    xbt_assert(job_id_value.IsString(), "Invalid JSON message: in event %d (TO_JOB_MSG): ['data']['job_id'] should be a string", event_number);
-    string job_id = job_id_value.GetString();
+    protocol_assert(job_id_value.IsString(), "Invalid JSON message: in event %d (TO_JOB_MSG): ['data']['job_id'] should be a string", event_number);
+    const char * job_id = job_id_value.GetString();
 
-    xbt_assert(data_object.HasMember("msg"), "Invalid JSON msg: the 'data' value of event %d (TO_JOB_MSG) should have a 'msg' key", event_number);
+    protocol_assert(data_object.HasMember("msg"), "Invalid JSON msg: the 'data' value of event %d (TO_JOB_MSG) should have a 'msg' key", event_number);
     const Value & msg_value = data_object["msg"];
-    xbt_assert(msg_value.IsString(), "Invalid JSON msg: in event %d (TO_JOB_MSG): ['data']['msg'] should be a string", event_number);
+    protocol_assert(msg_value.IsString(), "Invalid JSON msg: in event %d (TO_JOB_MSG): ['data']['msg'] should be a string", event_number);
     string msg = msg_value.GetString();
 
     ToJobMessage * message = new ToJobMessage;
 
-    if (!identify_job_from_string(context, job_id, message->job_id))
+    if (!identify_job_from_string(context, job_id, job_id_value.GetStringLength(), message->job_id))
     {
         xbt_assert(false, "Invalid JSON message: "
                           "Invalid job change job state received: The job identifier '%s' is not valid. "
                           "Job identifiers must be of the form [WORKLOAD_NAME!]JOB_ID. "
                           "If WORKLOAD_NAME! is omitted, WORKLOAD_NAME='static' is used. "
-                          "Furthermore, the corresponding job must exist.", job_id.c_str());
+                          "Furthermore, the corresponding job must exist.", job_id);
     }
     message->message = msg;
 
@@ -1165,17 +1794,17 @@ void JsonProtocolReader::handle_submit_job(int event_number,
 
     xbt_assert(context->submission_sched_enabled, "Invalid JSON message: dynamic job submission received but the option seems disabled...");
 
-    xbt_assert(data_object.IsObject(), "Invalid JSON message: the 'data' value of event %d (SUBMIT_JOB) should be an object", event_number);
+    protocol_assert(data_object.IsObject(), "Invalid JSON message: the 'data' value of event %d (SUBMIT_JOB) should be an object", event_number);
 
-    xbt_assert(data_object.HasMember("job_id"), "Invalid JSON message: the 'data' value of event %d (SUBMIT_JOB) should have a 'job_id' key", event_number);
+    protocol_assert(data_object.HasMember("job_id"), "Invalid JSON message: the 'data' value of event %d (SUBMIT_JOB) should have a 'job_id' key", event_number);
     const Value & job_id_value = data_object["job_id"];
-    xbt_assert(job_id_value.IsString(), "Invalid JSON message: in event %d (SUBMIT_JOB): ['data']['job_id'] should be a string", event_number);
-    string job_id = job_id_value.GetString();
+    protocol_assert(job_id_value.IsString(), "Invalid JSON message: in event %d (SUBMIT_JOB): ['data']['job_id'] should be a string", event_number);
+    const char * job_id = job_id_value.GetString();
 
-    if (!identify_job_from_string(context, job_id, message->job_id,
+    if (!identify_job_from_string(context, job_id, job_id_value.GetStringLength(), message->job_id,
                                   IdentifyJobReturnCondition::STRING_VALID__JOB_DOES_NOT_EXISTS))
     {
-        xbt_assert(false, "Invalid JSON message: in event %d (SUBMIT_JOB): job_id '%s' seems invalid (already exists?)", event_number, job_id.c_str());
+        xbt_assert(false, "Invalid JSON message: in event %d (SUBMIT_JOB): job_id '%s' seems invalid (already exists?)", event_number, job_id);
     }
 
     // Read the job description, either directly or from Redis
@@ -1184,7 +1813,7 @@ void JsonProtocolReader::handle_submit_job(int event_number,
         xbt_assert(!context->redis_enabled, "Invalid JSON message: in event %d (SUBMIT_JOB): 'job' object is given but redis seems disabled...", event_number);
 
         const Value & job_object = data_object["job"];
-        xbt_assert(job_object.IsObject(), "Invalid JSON message: in event %d (SUBMIT_JOB): ['data']['job'] should be an object", event_number);
+        protocol_assert(job_object.IsObject(), "Invalid JSON message: in event %d (SUBMIT_JOB): ['data']['job'] should be an object", event_number);
 
         StringBuffer buffer;
         ::Writer<rapidjson::StringBuffer> writer(buffer);
@@ -1204,13 +1833,13 @@ void JsonProtocolReader::handle_submit_job(int event_number,
     // Create the job into memory now (so that following events at the same timestamp can refer to this job).
     // But first, create the workload if needed.
     Workload * workload = nullptr;
-    if (context->workloads.exists(message->job_id.workload_name))
+    if (context->workloads.exists(message->job_id.workload_name()))
     {
-        workload = context->workloads.at(message->job_id.workload_name);
+        workload = context->workloads.at(message->job_id.workload_name());
     }
     else
     {
-        workload = new Workload(message->job_id.workload_name, "Dynamic");
+        workload = new Workload(message->job_id.workload_name(), "Dynamic");
         context->workloads.insert_workload(workload->name, workload);
     }
 
@@ -1219,7 +1848,7 @@ void JsonProtocolReader::handle_submit_job(int event_number,
     Job * job = Job::from_json(message->job_description, workload,
                                "Invalid JSON job submitted by the scheduler");
     workload->jobs->add_job(job);
-    job->id = JobIdentifier(workload->name, job->number);
+    job->id = JobIdentifier(message->job_id.workload_id, job->number);
     job->state = JobState::JOB_STATE_SUBMITTED;
 
     // Read the profile description if possible
@@ -1228,7 +1857,7 @@ void JsonProtocolReader::handle_submit_job(int event_number,
         xbt_assert(!context->redis_enabled, "Invalid JSON message: in event %d (SUBMIT_JOB): 'profile' object is given but redis seems disabled...", event_number);
 
         const Value & profile_object = data_object["profile"];
-        xbt_assert(profile_object.IsObject(), "Invalid JSON message: in event %d (SUBMIT_JOB): ['data']['profile'] should be an object", event_number);
+        protocol_assert(profile_object.IsObject(), "Invalid JSON message: in event %d (SUBMIT_JOB): ['data']['profile'] should be an object", event_number);
 
         StringBuffer buffer;
         ::Writer<rapidjson::StringBuffer> writer(buffer);
@@ -1238,7 +1867,7 @@ void JsonProtocolReader::handle_submit_job(int event_number,
     }
     else if (context->redis_enabled)
     {
-        string profile_key = RedisStorage::profile_key(message->job_id.workload_name,
+        string profile_key = RedisStorage::profile_key(message->job_id.workload_name(),
                                                        job->profile);
         message->job_profile_description = context->storage.get(profile_key);
     }
@@ -1296,22 +1925,22 @@ void JsonProtocolReader::handle_submit_profile(int event_number,
 
     xbt_assert(context->submission_sched_enabled, "Invalid JSON message: dynamic profile submission received but the option seems disabled...");
 
-    xbt_assert(data_object.IsObject(), "Invalid JSON message: the 'data' value of event %d (SUBMIT_JOB) should be an object", event_number);
+    protocol_assert(data_object.IsObject(), "Invalid JSON message: the 'data' value of event %d (SUBMIT_JOB) should be an object", event_number);
 
-    xbt_assert(data_object.HasMember("workload_name"), "Invalid JSON message: the 'data' value of event %d (SUBMIT_PROFILE) should have a 'workload_name' key", event_number);
+    protocol_assert(data_object.HasMember("workload_name"), "Invalid JSON message: the 'data' value of event %d (SUBMIT_PROFILE) should have a 'workload_name' key", event_number);
     const Value & workload_name_value = data_object["workload_name"];
-    xbt_assert(workload_name_value.IsString(), "Invalid JSON message: in event %d (SUBMIT_PROFILE): ['data']['workload_name'] should be a string", event_number);
+    protocol_assert(workload_name_value.IsString(), "Invalid JSON message: in event %d (SUBMIT_PROFILE): ['data']['workload_name'] should be a string", event_number);
     string workload_name = workload_name_value.GetString();
 
-    xbt_assert(data_object.HasMember("profile_name"), "Invalid JSON message: the 'data' value of event %d (SUBMIT_PROFILE) should have a 'profile_name' key", event_number);
+    protocol_assert(data_object.HasMember("profile_name"), "Invalid JSON message: the 'data' value of event %d (SUBMIT_PROFILE) should have a 'profile_name' key", event_number);
     const Value & profile_name_value = data_object["profile_name"];
-    xbt_assert(profile_name_value.IsString(), "Invalid JSON message: in event %d (SUBMIT_PROFILE): ['data']['profile_name'] should be a string", event_number);
+    protocol_assert(profile_name_value.IsString(), "Invalid JSON message: in event %d (SUBMIT_PROFILE): ['data']['profile_name'] should be a string", event_number);
     string profile_name = profile_name_value.GetString();
 
-    xbt_assert(data_object.HasMember("profile"), "Invalid JSON message: the 'data' value of event %d (SUBMIT_PROFILE) should have a 'profile' key", event_number);
+    protocol_assert(data_object.HasMember("profile"), "Invalid JSON message: the 'data' value of event %d (SUBMIT_PROFILE) should have a 'profile' key", event_number);
 
     const Value & profile_object = data_object["profile"];
-    xbt_assert(profile_object.IsObject(), "Invalid JSON message: in event %d (SUBMIT_PROFILE): ['data']['profile'] should be an object", event_number);
+    protocol_assert(profile_object.IsObject(), "Invalid JSON message: in event %d (SUBMIT_PROFILE): ['data']['profile'] should be an object", event_number);
 
     message->workload_name = workload_name;
     message->profile_name = profile_name;
@@ -1368,32 +1997,32 @@ void JsonProtocolReader::handle_kill_job(int event_number,
 
     KillJobMessage * message = new KillJobMessage;
 
-    xbt_assert(data_object.IsObject(), "Invalid JSON message: the 'data' value of event %d (KILL_JOB) should be an object", event_number);
-    xbt_assert(data_object.MemberCount() == 1, "Invalid JSON message: the 'data' value of event %d (KILL_JOB) should be of size 1 (size=%d)", event_number, (int)data_object.MemberCount());
+    protocol_assert(data_object.IsObject(), "Invalid JSON message: the 'data' value of event %d (KILL_JOB) should be an object", event_number);
+    protocol_assert(data_object.MemberCount() == 1, "Invalid JSON message: the 'data' value of event %d (KILL_JOB) should be of size 1 (size=%d)", event_number, (int)data_object.MemberCount());
 
-    xbt_assert(data_object.HasMember("job_ids"), "Invalid JSON message: the 'data' value of event %d (KILL_JOB) should contain a 'job_ids' key.", event_number);
+    protocol_assert(data_object.HasMember("job_ids"), "Invalid JSON message: the 'data' value of event %d (KILL_JOB) should contain a 'job_ids' key.", event_number);
     const Value & job_ids_array = data_object["job_ids"];
-    xbt_assert(job_ids_array.IsArray(), "Invalid JSON message: the 'job_ids' value in the 'data' value of event %d (KILL_JOB) should be an array.", event_number);
-    xbt_assert(job_ids_array.Size() > 0, "Invalid JSON message: the 'job_ids' array in the 'data' value of event %d (KILL_JOB) should be non-empty.", event_number);
+    protocol_assert(job_ids_array.IsArray(), "Invalid JSON message: the 'job_ids' value in the 'data' value of event %d (KILL_JOB) should be an array.", event_number);
+    protocol_assert(job_ids_array.Size() > 0, "Invalid JSON message: the 'job_ids' array in the 'data' value of event %d (KILL_JOB) should be non-empty.", event_number);
     message->jobs_ids.resize(job_ids_array.Size());
 
     for (unsigned int i = 0; i < job_ids_array.Size(); ++i)
     {
         const Value & job_id_value = job_ids_array[i];
-        if (!identify_job_from_string(context, job_id_value.GetString(), message->jobs_ids[i]))
+        if (!identify_job_from_string(context, job_id_value.GetString(), job_id_value.GetStringLength(), message->jobs_ids[i]))
         {
-            xbt_assert(false, "Invalid JSON message: in event %d (KILL_JOB): job_id %d ('%s') is invalid.", event_number, i, message->jobs_ids[i].to_string().c_str());
+            xbt_assert(false, "Invalid JSON message: in event %d (KILL_JOB): job_id %d ('%s') is invalid.", event_number, i, job_id_value.GetString());
         }
     }
 
     send_message(timestamp, "server", IPMessageType::SCHED_KILL_JOB, (void *) message);
 }
 
-void JsonProtocolReader::send_message(double when,
-                                      const string &destination_mailbox,
-                                      IPMessageType type,
-                                      void *data,
-                                      bool detached) const
+void AbstractProtocolReader::send_message(double when,
+                                          const string &destination_mailbox,
+                                          IPMessageType type,
+                                          void *data,
+                                          bool detached) const
 {
     // Let's wait until "when" time is reached
     double current_time = MSG_get_clock();
@@ -1405,3 +2034,345 @@ void JsonProtocolReader::send_message(double when,
     // Let's actually send the message
     generic_send_message(destination_mailbox, type, data, detached);
 }
+
+
+
+/**
+ * @brief Generator which leaves a rapidjson::Document untouched
+ * @details Used with rapidjson::Document::Populate to finalize a document whose SAX events
+ *          have already been given to it.
+ */
+struct DocumentFinalizer
+{
+    /**
+     * @brief Generates nothing
+     * @return true
+     */
+    template <typename Handler>
+    bool operator()(Handler &)
+    {
+        return true;
+    }
+};
+
+ProtocolMessageStreamHandler::ProtocolMessageStreamHandler(JsonProtocolReader * reader) :
+    _reader(reader),
+    _event_allocator(_event_buffer, event_buffer_size),
+    _event_doc(&_event_allocator)
+{
+}
+
+double ProtocolMessageStreamHandler::finish()
+{
+    xbt_assert(_depth == 0 && _event_depth == 0 && _ignored_depth == 0,
+               "Invalid JSON message: message is incomplete");
+    xbt_assert(_has_now, "Invalid JSON message: no 'now' key");
+    xbt_assert(_has_events, "Invalid JSON message: no 'events' key");
+    xbt_assert(_events_before_now.empty());
+
+    return _now;
+}
+
+bool ProtocolMessageStreamHandler::Null()
+{
+    if (_event_depth > 0)
+    {
+        return _event_doc.Null();
+    }
+    return on_scalar(false, 0);
+}
+
+bool ProtocolMessageStreamHandler::Bool(bool b)
+{
+    if (_event_depth > 0)
+    {
+        return _event_doc.Bool(b);
+    }
+    return on_scalar(false, 0);
+}
+
+bool ProtocolMessageStreamHandler::Int(int i)
+{
+    if (_event_depth > 0)
+    {
+        return _event_doc.Int(i);
+    }
+    return on_scalar(true, i);
+}
+
+bool ProtocolMessageStreamHandler::Uint(unsigned u)
+{
+    if (_event_depth > 0)
+    {
+        return _event_doc.Uint(u);
+    }
+    return on_scalar(true, u);
+}
+
+bool ProtocolMessageStreamHandler::Int64(int64_t i)
+{
+    if (_event_depth > 0)
+    {
+        return _event_doc.Int64(i);
+    }
+    return on_scalar(true, (double) i);
+}
+
+bool ProtocolMessageStreamHandler::Uint64(uint64_t u)
+{
+    if (_event_depth > 0)
+    {
+        return _event_doc.Uint64(u);
+    }
+    return on_scalar(true, (double) u);
+}
+
+bool ProtocolMessageStreamHandler::Double(double d)
+{
+    if (_event_depth > 0)
+    {
+        return _event_doc.Double(d);
+    }
+    return on_scalar(true, d);
+}
+
+bool ProtocolMessageStreamHandler::RawNumber(const char * str, SizeType length, bool copy)
+{
+    if (_event_depth > 0)
+    {
+        return _event_doc.RawNumber(str, length, copy);
+    }
+    return on_scalar(true, std::stod(string(str, length)));
+}
+
+bool ProtocolMessageStreamHandler::String(const char * str, SizeType length, bool copy)
+{
+    if (_event_depth > 0)
+    {
+        return _event_doc.String(str, length, copy);
+    }
+    return on_scalar(false, 0);
+}
+
+bool ProtocolMessageStreamHandler::Key(const char * str, SizeType length, bool copy)
+{
+    if (_event_depth > 0)
+    {
+        return _event_doc.Key(str, length, copy);
+    }
+
+    if (_ignored_depth == 0)
+    {
+        // Keys outside events can only be found in the message object
+        string key(str, length);
+        if (key == "now")
+        {
+            _current_key = MessageKey::NOW;
+        }
+        else if (key == "events")
+        {
+            _current_key = MessageKey::EVENTS;
+        }
+        else
+        {
+            _current_key = MessageKey::OTHER;
+        }
+    }
+    return true;
+}
+
+bool ProtocolMessageStreamHandler::StartObject()
+{
+    if (_event_depth > 0)
+    {
+        ++_event_depth;
+        return _event_doc.StartObject();
+    }
+
+    if (_ignored_depth > 0)
+    {
+        ++_ignored_depth;
+        return true;
+    }
+
+    switch (_depth)
+    {
+    case 0: // The message object
+        _depth = 1;
+        return true;
+    case 1: // A value of the message object
+        xbt_assert(_current_key != MessageKey::NOW, "Invalid JSON message: 'now' value should be a number.");
+        xbt_assert(_current_key != MessageKey::EVENTS, "Invalid JSON message: 'events' value should be an array.");
+        _ignored_depth = 1;
+        return true;
+    default: // An event
+        _event_depth = 1;
+        return _event_doc.StartObject();
+    }
+}
+
+bool ProtocolMessageStreamHandler::EndObject(SizeType member_count)
+{
+    if (_event_depth > 0)
+    {
+        bool ret = _event_doc.EndObject(member_count);
+        if (--_event_depth == 0)
+        {
+            on_event_complete();
+        }
+        return ret;
+    }
+
+    if (_ignored_depth > 0)
+    {
+        --_ignored_depth;
+        return true;
+    }
+
+    // End of the message object
+    _depth = 0;
+    return true;
+}
+
+bool ProtocolMessageStreamHandler::StartArray()
+{
+    if (_event_depth > 0)
+    {
+        ++_event_depth;
+        return _event_doc.StartArray();
+    }
+
+    if (_ignored_depth > 0)
+    {
+        ++_ignored_depth;
+        return true;
+    }
+
+    switch (_depth)
+    {
+    case 0:
+        xbt_assert(false, "Invalid JSON message: not a JSON object");
+        return false;
+    case 1: // A value of the message object
+        xbt_assert(_current_key != MessageKey::NOW, "Invalid JSON message: 'now' value should be a number.");
+        if (_current_key == MessageKey::EVENTS)
+        {
+            _has_events = true;
+            _depth = 2;
+        }
+        else
+        {
+            _ignored_depth = 1;
+        }
+        return true;
+    default:
+        xbt_assert(false, "Invalid JSON message: event %d should be an object.", _nb_events);
+        return false;
+    }
+}
+
+bool ProtocolMessageStreamHandler::EndArray(SizeType element_count)
+{
+    if (_event_depth > 0)
+    {
+        --_event_depth;
+        return _event_doc.EndArray(element_count);
+    }
+
+    if (_ignored_depth > 0)
+    {
+        --_ignored_depth;
+        return true;
+    }
+
+    // End of the events array
+    _depth = 1;
+    return true;
+}
+
+bool ProtocolMessageStreamHandler::on_scalar(bool is_number, double number)
+{
+    if (_ignored_depth > 0)
+    {
+        return true;
+    }
+
+    switch (_depth)
+    {
+    case 0:
+        xbt_assert(false, "Invalid JSON message: not a JSON object");
+        return false;
+    case 1: // A value of the message object
+        xbt_assert(_current_key != MessageKey::EVENTS, "Invalid JSON message: 'events' value should be an array.");
+        if (_current_key == MessageKey::NOW)
+        {
+            xbt_assert(is_number, "Invalid JSON message: 'now' value should be a number.");
+            _now = number;
+            _has_now = true;
+
+            // Events read before 'now' can now be applied
+            for (unsigned int i = 0; i < _events_before_now.size(); ++i)
+            {
+                _reader->parse_and_apply_event(*_events_before_now[i], i, _now);
+            }
+            _events_before_now.clear();
+        }
+        return true;
+    default:
+        xbt_assert(false, "Invalid JSON message: event %d should be an object.", _nb_events);
+        return false;
+    }
+}
+
+void ProtocolMessageStreamHandler::on_event_complete()
+{
+    DocumentFinalizer finalizer;
+    _event_doc.Populate(finalizer);
+
+    if (_has_now)
+    {
+        _reader->parse_and_apply_event(_event_doc, _nb_events, _now);
+    }
+    else
+    {
+        // The event is copied since the event document is reused
+        Document * event_copy = new Document;
+        event_copy->CopyFrom(_event_doc, event_copy->GetAllocator());
+        _events_before_now.push_back(unique_ptr<Document>(event_copy));
+    }
+    ++_nb_events;
+
+    // The memory of the event is released, so that it is reused by the next event
+    _event_doc.SetNull();
+    _event_allocator.Clear();
+}
+
+
+
+MsgpackProtocolReader::MsgpackProtocolReader(BatsimContext * context) :
+    JsonProtocolReader(context)
+{
+}
+
+MsgpackProtocolReader::~MsgpackProtocolReader()
+{
+}
+
+void MsgpackProtocolReader::parse_and_apply_message(const string & message)
+{
+    if (is_json_message(message.data(), message.size()))
+    {
+        JsonProtocolReader::parse_and_apply_message(message);
+        return;
+    }
+
+    ProtocolMessageStreamHandler handler(this);
+    MsgpackReader reader(message.data(), message.size());
+    reader.parse(handler);
+
+    xbt_assert(!reader.has_parse_error(), "Invalid MessagePack message: could not be parsed: %s",
+               reader.parse_error().c_str());
+    double now = handler.finish();
+
+    send_message(now, "server", IPMessageType::SCHED_READY);
+}
@@ -1,22 +1,87 @@
 #pragma once
 
+#include <cmath>
 #include <functional>
+#include <memory>
 #include <vector>
 #include <string>
 #include <map>
 
 #include <rapidjson/document.h>
+#include <rapidjson/reader.h>
 #include <rapidjson/writer.h>
 
+#include <xbt.h>
+
 #include "machine_range.hpp"
 #include "machines.hpp"
+#include "msgpack.hpp"
 #include "workload.hpp"
 #include "ipp.hpp"
 
 struct BatsimContext;
 
 /**
- * @brief Custom rapidjson Writer to force fixed float writing precision
+ * @brief Enumerates the formats that can be used to encode protocol messages
+ */
+enum class ProtocolFormat
+{
+    JSON        //!< Messages are JSON texts
+    ,MSGPACK    //!< Messages are MessagePack objects (except the one that contains SIMULATION_BEGINS, which is JSON)
+};
+
+/**
+ * @brief Returns the std::string corresponding to a ProtocolFormat
+ * @param[in] format The ProtocolFormat
+ * @return The std::string corresponding to format
+ */
+std::string protocol_format_to_string(ProtocolFormat format);
+
+/**
+ * @brief Returns the ProtocolFormat corresponding to a std::string
+ * @param[in] str The std::string. Must be "json" or "msgpack".
+ * @return The ProtocolFormat corresponding to str
+ */
+ProtocolFormat protocol_format_from_string(const std::string & str);
+
+/**
+ * @brief Enumerates how strictly the messages received from the scheduler are checked
+ */
+enum class ProtocolValidation
+{
+    AUDIT       //!< The format of every event is checked, invalid messages abort the simulation with an explicit error
+    ,TRUSTED    //!< Events are decoded with minimal checking. The behaviour on invalid messages is undefined
+};
+
+/**
+ * @brief Returns the std::string corresponding to a ProtocolValidation
+ * @param[in] validation The ProtocolValidation
+ * @return The std::string corresponding to validation
+ */
+std::string protocol_validation_to_string(ProtocolValidation validation);
+
+/**
+ * @brief Returns the ProtocolValidation corresponding to a std::string
+ * @param[in] str The std::string. Must be "audit" or "trusted".
+ * @return The ProtocolValidation corresponding to str
+ */
+ProtocolValidation protocol_validation_from_string(const std::string & str);
+
+/**
+ * @brief Returns whether a protocol message is a JSON text (rather than a MessagePack object)
+ * @details JSON messages are objects, which start by '{' (after optional whitespaces).
+ *          MessagePack maps never start by such bytes.
+ * @param[in] data The message bytes
+ * @param[in] size The number of bytes of the message
+ * @return Whether the message is a JSON text
+ */
+bool is_json_message(const char * data, size_t size);
+
+/**
+ * @brief Custom rapidjson Writer whose float writing precision can be chosen
+ * @details By default, doubles are written with the shortest representation that reads back to
+ *          the same value (Grisu2, from rapidjson). A fixed number of decimal places can also be
+ *          used, which is how Batsim used to write doubles.
  */
 template<typename OutputStream>
 class Writer : public rapidjson::Writer<OutputStream>
@@ -30,33 +95,289 @@ public:
     {
     }
 
+    /**
+     * @brief Resets the writer, so that a new value can be written in a (possibly different) stream
+     * @param[in,out] os The output stream
+     */
+    void Reset(OutputStream& os)
+    {
+        rapidjson::Writer<OutputStream>::Reset(os);
+        os_ = &os;
+    }
+
+    /**
+     * @brief Sets how doubles are written
+     * @param[in] decimal_places The number of decimal places of doubles, in [0,max_decimal_places].
+     *            -1 means that doubles are written exactly (shortest round-trip representation).
+     */
+    void SetDecimalPlaces(int decimal_places)
+    {
+        RAPIDJSON_ASSERT(decimal_places >= -1 && decimal_places <= max_decimal_places);
+        decimal_places_ = decimal_places;
+    }
+
     /**
      * @brief Adds a double in the output stream
-     * @param[in] d The double to add in the stream
+     * @param[in] d The double to add in the stream. Must be finite, as JSON cannot represent NaN nor infinities.
      * @return true on success, false otherwise
      */
     bool Double(double d)
     {
-        this->Prefix(rapidjson::kNumberType);
+        // rapidjson would silently write nothing, which would make the message malformed
+        xbt_assert(std::isfinite(d), "Cannot write the non-finite double %g in a JSON message", d);
+
+        if (decimal_places_ < 0)
+        {
+            return rapidjson::Writer<OutputStream>::Double(d);
+        }
 
-        const int buf_size = 32;
-        char * buffer = new char[buf_size];
+        this->Prefix(rapidjson::kNumberType);
 
-        int ret = snprintf(buffer, buf_size, "%6f", d);
+        // Large enough for the integral part of any double, the decimal places and the sign
+        char buffer[512];
+        int ret = snprintf(buffer, sizeof(buffer), "%.*f", decimal_places_, d);
         RAPIDJSON_ASSERT(ret >= 1);
-        RAPIDJSON_ASSERT(ret < buf_size - 1);
+        RAPIDJSON_ASSERT(ret < (int) sizeof(buffer));
 
+        rapidjson::PutReserve(*os_, ret);
         for (int i = 0; i < ret; ++i)
         {
-            os_->Put(buffer[i]);
+            rapidjson::PutUnsafe(*os_, buffer[i]);
         }
 
-        delete[] buffer;
-        return ret < (buf_size - 1);
+        return true;
     }
 
+    static const int max_decimal_places = 20; //!< The maximum number of decimal places of doubles
+
 private:
     OutputStream* os_; //!< The output stream
+    int decimal_places_ = -1; //!< The number of decimal places of doubles (-1 for exact doubles)
+};
+
+/**
+ * @brief rapidjson output stream which appends characters to a std::string
+ */
+class StringOutputStream
+{
+public:
+    typedef char Ch; //!< The character type
+
+    /**
+     * @brief Builds a StringOutputStream
+     * @param[in,out] str The string in which characters are appended
+     */
+    explicit StringOutputStream(std::string & str) : _str(&str) {}
+
+    /**
+     * @brief Appends a character
+     * @param[in] c The character
+     */
+    void Put(char c) { _str->push_back(c); }
+
+    /**
+     * @brief Does nothing (characters are directly appended)
+     */
+    void Flush() {}
+
+private:
+    std::string * _str; //!< The string in which characters are appended
+};
+
+/**
+ * @brief Encodes protocol events into buffers that are reused from one message to another
+ * @details Events are given as SAX events (the rapidjson Handler concept), which also allows to
+ *          give rapidjson values via their Accept method.
+ *          Two buffers are used alternately, so that a generated message remains valid while the
+ *          next one is being built. The buffers keep their capacity when they are cleared, which
+ *          means that encoding messages does not allocate memory in steady state.
+ */
+class ProtocolMessageEncoder
+{
+public:
+    /**
+     * @brief Destroys a ProtocolMessageEncoder
+     */
+    virtual ~ProtocolMessageEncoder() {}
+
+    /**
+     * @brief Must be called before writing each event
+     */
+    virtual void start_event() = 0;
+
+    /**
+     * @brief Finishes the current message
+     * @param[in] now The message date
+     * @return A view on the message. It remains valid until clear is called twice.
+     */
+    virtual ProtocolMessage finish_message(double now) = 0;
+
+    /**
+     * @brief Starts a new message, in the buffer that is not used by the previous message
+     */
+    virtual void clear() = 0;
+
+    // SAX events
+    virtual bool Null() = 0; //!< SAX event. @return true on success
+    virtual bool Bool(bool b) = 0; //!< SAX event. @param[in] b The value. @return true on success
+    virtual bool Int(int i) = 0; //!< SAX event. @param[in] i The value. @return true on success
+    virtual bool Uint(unsigned u) = 0; //!< SAX event. @param[in] u The value. @return true on success
+    virtual bool Int64(int64_t i) = 0; //!< SAX event. @param[in] i The value. @return true on success
+    virtual bool Uint64(uint64_t u) = 0; //!< SAX event. @param[in] u The value. @return true on success
+    virtual bool Double(double d) = 0; //!< SAX event. @param[in] d The value. @return true on success
+    virtual bool RawNumber(const char * str, rapidjson::SizeType length, bool copy) = 0; //!< SAX event. @param[in] str The number string. @param[in] length The length of str. @param[in] copy Unused. @return true on success
+    virtual bool String(const char * str, rapidjson::SizeType length, bool copy) = 0; //!< SAX event. @param[in] str The string. @param[in] length The length of str. @param[in] copy Unused. @return true on success
+    virtual bool Key(const char * str, rapidjson::SizeType length, bool copy) = 0; //!< SAX event. @param[in] str The key. @param[in] length The length of str. @param[in] copy Unused. @return true on success
+    virtual bool StartObject() = 0; //!< SAX event. @return true on success
+    virtual bool EndObject(rapidjson::SizeType member_count) = 0; //!< SAX event. @param[in] member_count The number of members. @return true on success
+    virtual bool StartArray() = 0; //!< SAX event. @return true on success
+    virtual bool EndArray(rapidjson::SizeType element_count) = 0; //!< SAX event. @param[in] element_count The number of elements. @return true on success
+
+    /**
+     * @brief Writes a value which is already serialised in JSON
+     * @details This allows to emit job and profile descriptions without parsing them again.
+     * @param[in] json The JSON text of the value. Must be valid.
+     * @param[in] length The number of bytes of json
+     * @param[in] type The type of the value
+     * @return true on success
+     */
+    virtual bool RawValue(const char * json, size_t length, rapidjson::Type type) = 0;
+
+    /**
+     * @brief Writes a null-terminated string
+     * @param[in] str The string
+     * @return true on success
+     */
+    bool String(const char * str) { return String(str, (rapidjson::SizeType) strlen(str), false); }
+
+    /**
+     * @brief Writes a std::string
+     * @param[in] str The string
+     * @return true on success
+     */
+    bool String(const std::string & str) { return String(str.c_str(), (rapidjson::SizeType) str.size(), false); }
+
+    /**
+     * @brief Writes a null-terminated object key
+     * @param[in] str The key
+     * @return true on success
+     */
+    bool Key(const char * str) { return Key(str, (rapidjson::SizeType) strlen(str), false); }
+
+    /**
+     * @brief Closes the last opened object
+     * @return true on success
+     */
+    bool EndObject() { return EndObject(0); }
+
+    /**
+     * @brief Closes the last opened array
+     * @return true on success
+     */
+    bool EndArray() { return EndArray(0); }
+};
+
+/**
+ * @brief Encodes protocol events in JSON
+ * @details Some room is reserved at the beginning of the buffer, in which the message header
+ *          ('{"now":...,"events":[') is written once the message date is known.
+ *          The message then starts where its header starts, which avoids moving the events.
+ */
+class JsonMessageEncoder : public ProtocolMessageEncoder
+{
+public:
+    /**
+     * @brief Builds a JsonMessageEncoder
+     * @param[in] decimal_places The number of decimal places of doubles (-1 for exact doubles)
+     */
+    explicit JsonMessageEncoder(int decimal_places = -1);
+
+    void start_event();
+    ProtocolMessage finish_message(double now);
+    void clear();
+
+    using ProtocolMessageEncoder::String;
+    using ProtocolMessageEncoder::Key;
+    using ProtocolMessageEncoder::EndObject;
+    using ProtocolMessageEncoder::EndArray;
+
+    bool Null();
+    bool Bool(bool b);
+    bool Int(int i);
+    bool Uint(unsigned u);
+    bool Int64(int64_t i);
+    bool Uint64(uint64_t u);
+    bool Double(double d);
+    bool RawNumber(const char * str, rapidjson::SizeType length, bool copy);
+    bool String(const char * str, rapidjson::SizeType length, bool copy);
+    bool Key(const char * str, rapidjson::SizeType length, bool copy);
+    bool StartObject();
+    bool EndObject(rapidjson::SizeType member_count);
+    bool StartArray();
+    bool EndArray(rapidjson::SizeType element_count);
+    bool RawValue(const char * json, size_t length, rapidjson::Type type);
+
+private:
+    static const size_t header_slot_size = 512; //!< The room reserved for the message header. Large enough for any double.
+
+    std::string _buffers[2]; //!< The buffers in which messages are alternately written
+    int _current_buffer = 0; //!< The index of the buffer of the current message
+    std::string _header; //!< The buffer in which message headers are written
+    StringOutputStream _buffer_stream; //!< The stream associated with the current buffer
+    StringOutputStream _header_stream; //!< The stream associated with _header
+    ::Writer<StringOutputStream> _writer; //!< The JSON writer
+    int _nb_events = 0; //!< The number of events of the current message
+    bool _is_finished = false; //!< Whether the current message has been finished
+};
+
+/**
+ * @brief Encodes protocol events in MessagePack
+ * @details The message header (a 2-element map, the 'now' key and its float 64 value, the 'events'
+ *          key and the array 32 header) has a fixed size. Room is reserved for it at the beginning
+ *          of the buffer, and it is written once the message date and its number of events are known.
+ */
+class MsgpackMessageEncoder : public ProtocolMessageEncoder
+{
+public:
+    /**
+     * @brief Builds a MsgpackMessageEncoder
+     */
+    MsgpackMessageEncoder();
+
+    void start_event();
+    ProtocolMessage finish_message(double now);
+    void clear();
+
+    using ProtocolMessageEncoder::String;
+    using ProtocolMessageEncoder::Key;
+    using ProtocolMessageEncoder::EndObject;
+    using ProtocolMessageEncoder::EndArray;
+
+    bool Null();
+    bool Bool(bool b);
+    bool Int(int i);
+    bool Uint(unsigned u);
+    bool Int64(int64_t i);
+    bool Uint64(uint64_t u);
+    bool Double(double d);
+    bool RawNumber(const char * str, rapidjson::SizeType length, bool copy);
+    bool String(const char * str, rapidjson::SizeType length, bool copy);
+    bool Key(const char * str, rapidjson::SizeType length, bool copy);
+    bool StartObject();
+    bool EndObject(rapidjson::SizeType member_count);
+    bool StartArray();
+    bool EndArray(rapidjson::SizeType element_count);
+    bool RawValue(const char * json, size_t length, rapidjson::Type type);
+
+private:
+    static const size_t header_size = 26; //!< The size of the message header
+
+    std::string _buffers[2]; //!< The buffers in which messages are alternately written
+    int _current_buffer = 0; //!< The index of the buffer of the current message
+    MsgpackWriter _writer; //!< The MessagePack writer
+    rapidjson::Reader _json_reader; //!< Transcodes raw JSON values into MessagePack (kept to reuse its memory)
+    uint32_t _nb_events = 0; //!< The number of events of the current message
+    bool _is_finished = false; //!< Whether the current message has been finished
 };
 
 /**
@@ -93,13 +414,17 @@ public:
 
     /**
      * @brief Appends a JOB_SUBMITTED event.
+     * @details If jobs submissions are batched by timestamp, the job is added to the JOB_SUBMITTED
+     *          event of the jobs submitted at the same date (if any).
      * @param[in] job_id The identifier of the submitted job.
+     * @param[in] profile_name The name of the job profile
      * @param[in] job_json_description The job JSON description (optional if redis is enabled)
      * @param[in] profile_json_description The profile JSON description (optional if redis is
      *            disabled or if profiles are not forwarded)
      * @param[in] date The event date. Must be greater than or equal to the previous event.
      */
-    virtual void append_job_submitted(const std::string & job_id,
+    virtual void append_job_submitted(const JobIdentifier & job_id,
+                                      const std::string & profile_name,
                                       const std::string & job_json_description,
                                       const std::string & profile_json_description,
                                       double date) = 0;
@@ -114,7 +439,7 @@ public:
      * @param[in] return_code The job return code
      * @param[in] date The event date. Must be greater than or equal to the previous event.
      */
-    virtual void append_job_completed(const std::string & job_id,
+    virtual void append_job_completed(const JobIdentifier & job_id,
                                       const std::string & job_status,
                                       const std::string & job_state,
                                       const std::string & kill_reason,
@@ -128,8 +453,8 @@ public:
      * @param[in] date The event date. Must be greater than or equal to the previous event.
      * @param[in] job_progress Contains the progress of each job that has really been killed.
      */
-    virtual void append_job_killed(const std::vector<std::string> & job_ids,
-                                   const std::map<std::string, BatTask *> & job_progress,
+    virtual void append_job_killed(const std::vector<JobIdentifier> & job_ids,
+                                   const std::map<JobIdentifier, BatTask *> & job_progress,
                                    double date) = 0;
 
     /**
@@ -138,7 +463,7 @@ public:
      * @param[in] message The message to be sent to the scheduler.
      * @param[in] date The event date. Must be greater than or equal to the previous event.
      */
-    virtual void append_from_job_message(const std::string & job_id,
+    virtual void append_from_job_message(const JobIdentifier & job_id,
                                          const rapidjson::Document & message,
                                          double date) = 0;
 
@@ -183,18 +508,32 @@ public:
     virtual void clear() = 0;
 
     /**
-     * @brief Generates a string representation of the message containing all the events since the
-     *        last call to clear.
+     * @brief Generates the message containing all the events since the last call to clear.
      * @param[in] date The message date. Must be greater than or equal to the inner events dates.
-     * @return A string representation of the events added since the last call to clear.
+     * @return A view on the message. The viewed bytes belong to the writer and remain valid until
+     *         clear is called twice.
      */
-    virtual std::string generate_current_message(double date) = 0;
+    virtual ProtocolMessage generate_current_message(double date) = 0;
 
     /**
      * @brief Returns whether the Writer has content
      * @return Whether the Writer has content
      */
     virtual bool is_empty() = 0;
+
+    /**
+     * @brief Returns whether the Writer contains events which should trigger a call to the scheduler
+     * @details Deferred events (see protocol.deferred_events in the configuration) are only sent along with
+     *          other events.
+     * @return Whether the Writer contains non-deferred events
+     */
+    virtual bool has_triggering_events() = 0;
+
+    /**
+     * @brief Returns the number of events pushed into the Writer since last clear
+     * @return The number of events pushed into the Writer since last clear
+     */
+    virtual int nb_events() = 0;
 };
 
 /**
@@ -243,13 +582,17 @@ public:
 
     /**
      * @brief Appends a JOB_SUBMITTED event.
+     * @details If jobs submissions are batched by timestamp, the job is added to the JOB_SUBMITTED
+     *          event of the jobs submitted at the same date (if any).
      * @param[in] job_id The identifier of the submitted job.
+     * @param[in] profile_name The name of the job profile
      * @param[in] job_json_description The job JSON description (optional if redis is enabled)
      * @param[in] profile_json_description The profile JSON description (optional if redis is
      *            disabled or if profiles are not forwarded)
      * @param[in] date The event date. Must be greater than or equal to the previous event.
      */
-    void append_job_submitted(const std::string & job_id,
+    void append_job_submitted(const JobIdentifier & job_id,
+                              const std::string & profile_name,
                               const std::string & job_json_description,
                               const std::string & profile_json_description,
                               double date);
@@ -264,7 +607,7 @@ public:
      * @param[in] return_code The job return code
      * @param[in] date The event date. Must be greater than or equal to the previous event.
      */
-    void append_job_completed(const std::string & job_id,
+    void append_job_completed(const JobIdentifier & job_id,
                               const std::string & job_status,
                               const std::string & job_state,
                               const std::string & kill_reason,
@@ -278,8 +621,8 @@ public:
      * @param[in] date The event date. Must be greater than or equal to the previous event.
      * @param[in] job_progress Contains the progress of each job that has really been killed.
      */
-    void append_job_killed(const std::vector<std::string> & job_ids,
-                           const std::map<std::string, BatTask *> & job_progress,
+    void append_job_killed(const std::vector<JobIdentifier> & job_ids,
+                           const std::map<JobIdentifier, BatTask *> & job_progress,
                            double date);
 
     /**
@@ -288,7 +631,7 @@ public:
      * @param[in] message The message to be sent to the scheduler.
      * @param[in] date The event date. Must be greater than or equal to the previous event.
      */
-    void append_from_job_message(const std::string & job_id,
+    void append_from_job_message(const JobIdentifier & job_id,
                                  const rapidjson::Document & message,
                                  double date);
 
@@ -329,16 +672,17 @@ public:
     // Management functions
     /**
      * @brief Clears inner content. Should be called directly after generate_current_message.
+     * @details The last generated message remains valid until the next call to clear.
      */
     void clear();
 
     /**
-     * @brief Generates a string representation of the message containing all the events since the
-     *        last call to clear.
+     * @brief Generates the message containing all the events since the last call to clear.
      * @param[in] date The message date. Must be greater than or equal to the inner events dates.
-     * @return A string representation of the events added since the last call to clear.
+     * @return A view on the message. The viewed bytes belong to the writer and remain valid until
+     *         clear is called twice.
      */
-    std::string generate_current_message(double date);
+    ProtocolMessage generate_current_message(double date);
 
     /**
      * @brief Returns whether the Writer has content
@@ -346,24 +690,121 @@ public:
      */
     bool is_empty() { return _is_empty; }
 
-private:
     /**
-     * @brief Converts a machine to a json value.
-     * @param[in] machine The machine to be converted
-     * @return The json value
+     * @brief Returns whether the Writer contains events which should trigger a call to the scheduler
+     * @return Whether the Writer contains non-deferred events
      */
-    rapidjson::Value machine_to_json_value(const Machine & machine);
+    bool has_triggering_events() { return _has_triggering_events; }
+
+    /**
+     * @brief Returns the number of events pushed into the Writer since last clear
+     * @return The number of events pushed into the Writer since last clear
+     */
+    int nb_events() { return _nb_events; }
+
+protected:
+    /**
+     * @brief Builds a JsonProtocolWriter which uses a given encoder
+     * @param[in,out] context The BatsimContext
+     * @param[in] encoder The encoder of the events. Its ownership is transferred to the JsonProtocolWriter.
+     */
+    JsonProtocolWriter(BatsimContext * context, ProtocolMessageEncoder * encoder);
 
 private:
+    /**
+     * @brief Starts writing an event. Its data object must then be written, followed by a call to end_event.
+     * @param[in] type The event type
+     * @param[in] date The event date. Must be greater than or equal to the previous event.
+     */
+    void start_event(const char * type, double date);
+
+    /**
+     * @brief Finishes writing an event
+     */
+    void end_event();
+
+    /**
+     * @brief Finishes the batched JOB_SUBMITTED event being written (if any)
+     */
+    void end_job_submission_batch();
+
+    /**
+     * @brief Writes a machine as a JSON object
+     * @param[in] machine The machine to be written
+     */
+    void write_machine(const Machine & machine);
+
+    /**
+     * @brief Writes a group of machines as a JSON object
+     * @param[in] group The group of machines to be written
+     */
+    void write_machine_group(const MachineGroup & group);
+
+    /**
+     * @brief Writes a JSON text (e.g., a job description) as a value
+     * @param[in] json_text The JSON text
+     */
+    void write_json_text(const std::string & json_text);
+
+    /**
+     * @brief Writes a job identifier as a string (formatted in _job_id_buffer)
+     * @param[in] job_id The job identifier
+     */
+    void write_job_id(const JobIdentifier & job_id);
+
+protected:
     BatsimContext * _context; //!< The BatsimContext
     bool _is_empty = true; //!< Stores whether events have been pushed into the writer since last clear.
+    bool _has_triggering_events = false; //!< Stores whether non-deferred events have been pushed into the writer since last clear.
+    int _nb_events = 0; //!< The number of events pushed into the writer since last clear
     double _last_date = -1; //!< The date of the latest pushed event/message
-    rapidjson::Document _doc; //!< A rapidjson document
-    rapidjson::Document::AllocatorType & _alloc; //!< The allocated of _doc
-    rapidjson::Value _events = rapidjson::Value(rapidjson::kArrayType); //!< A rapidjson array in which the events are pushed
+    std::unique_ptr<ProtocolMessageEncoder> _encoder; //!< Encodes the events into a reused buffer
+    rapidjson::Reader _json_text_reader; //!< Transcodes JSON texts into _encoder (kept to reuse its memory)
+
+    bool _is_job_submission_batch_open = false; //!< Whether a batched JOB_SUBMITTED event is being written
+    std::vector<JobIdentifier> _batch_job_ids; //!< The identifiers of the jobs of the current batch
+    std::map<std::string, std::string> _batch_profiles; //!< The profiles of the current batch: maps WORKLOAD!PROFILE_NAME to the profile JSON description
+    std::string _batch_profile_key; //!< Buffer in which the keys of _batch_profiles are built
+    std::string _job_id_buffer; //!< Buffer in which job identifiers are formatted
     const std::vector<std::string> accepted_completion_statuses = {"SUCCESS", "FAILED", "TIMEOUT"}; //!< The list of accepted statuses for the JOB_COMPLETED message
 };
 
+/**
+ * @brief The MessagePack implementation of the AbstractProtocolWriter
+ * @details Events are encoded in MessagePack instead of JSON.
+ *          The first message (which contains SIMULATION_BEGINS) is still encoded in JSON,
+ *          so that any scheduler can read which format is used afterwards.
+ */
+class MsgpackProtocolWriter : public JsonProtocolWriter
+{
+public:
+    /**
+     * @brief Creates an empty MsgpackProtocolWriter
+     * @param[in,out] context The BatsimContext
+     */
+    explicit MsgpackProtocolWriter(BatsimContext * context);
+
+    /**
+     * @brief MsgpackProtocolWriter cannot be copied.
+     * @param[in] other Another instance
+     */
+    MsgpackProtocolWriter(const MsgpackProtocolWriter & other) = delete;
+
+    /**
+     * @brief Destroys a MsgpackProtocolWriter
+     */
+    ~MsgpackProtocolWriter();
+
+    /**
+     * @brief Clears inner content. Should be called directly after generate_current_message.
+     * @details Switches to MessagePack once the first message has been generated.
+     */
+    void clear();
+
+private:
+    std::unique_ptr<ProtocolMessageEncoder> _first_message_encoder; //!< The JSON encoder of the first message (kept while the message may be in use)
+};
+
 
 
 /**
@@ -382,6 +823,22 @@ public:
      * @param[in] message The protocol message
      */
     virtual void parse_and_apply_message(const std::string & message) = 0;
+
+protected:
+    /**
+     * @brief Sends a message at a given time, sleeping to reach the given time if needed
+     * @details Virtual so that the unit tests can check the messages produced by a reader.
+     * @param[in] when The date at which the message should be sent
+     * @param[in] destination_mailbox The destination mailbox
+     * @param[in] type The message type
+     * @param[in] data The message data
+     * @param[in] detached Whether the send should be detached
+     */
+    virtual void send_message(double when,
+                              const std::string & destination_mailbox,
+                              IPMessageType type,
+                              void * data = nullptr,
+                              bool detached = false) const;
 };
 
 /**
@@ -454,6 +911,14 @@ public:
      */
     void handle_execute_job(int event_number, double timestamp, const rapidjson::Value & data_object);
 
+    /**
+     * @brief Handles an EXECUTE_JOBS event
+     * @param[in] event_number The event number in [0,nb_events[.
+     * @param[in] timestamp The event timestamp
+     * @param[in] data_object The data associated with the event (JSON object)
+     */
+    void handle_execute_jobs(int event_number, double timestamp, const rapidjson::Value & data_object);
+
     /**
      * @brief Handles an CHANGE_JOB_STATE event
      * @param[in] event_number The event number in [0,nb_events[.
@@ -528,22 +993,142 @@ public:
 
 private:
     /**
-     * @brief Sends a message at a given time, sleeping to reach the given time if needed
-     * @param[in] when The date at which the message should be sent
-     * @param[in] destination_mailbox The destination mailbox
-     * @param[in] type The message type
-     * @param[in] data The message data
-     * @param[in] detached Whether the send should be detached
+     * @brief Parses the allocation of a job (an EXECUTE_JOB data object or an element of the EXECUTE_JOBS jobs array)
+     * @param[in] event_number The event number in [0,nb_events[.
+     * @param[in] event_type The event type (used in error messages)
+     * @param[in] job_object The allocation of the job (JSON object)
+     * @return The parsed allocation
      */
-    void send_message(double when,
-                      const std::string & destination_mailbox,
-                      IPMessageType type,
-                      void * data = nullptr,
-                      bool detached = false) const;
+    SchedulingAllocation * parse_job_allocation(int event_number,
+                                                const char * event_type,
+                                                const rapidjson::Value & job_object);
 
 private:
     //! Maps message types to their handler functions
     std::map<std::string, std::function<void(JsonProtocolReader*, int, double, const rapidjson::Value&)>> _type_to_handler_map;
     std::vector<std::string> accepted_requests = {"consumed_energy"}; //!< The currently acceptes requests for the QUERY_REQUEST message
     BatsimContext * context = nullptr; //!< The BatsimContext
+    ProtocolValidation _validation; //!< How strictly the received events are checked
+};
+
+/**
+ * @brief rapidjson SAX handler which decodes protocol messages event by event
+ * @details Each event object is built into a small rapidjson::Document while its SAX events are
+ *          received, and given to JsonProtocolReader::parse_and_apply_event as soon as it is complete.
+ *          The whole message is therefore never materialised in memory.
+ *          Events completed before the 'now' field of the message has been read are kept aside
+ *          until it is read, since 'now' is needed to check the events' timestamps.
+ */
+class ProtocolMessageStreamHandler
+{
+public:
+    /**
+     * @brief Builds a ProtocolMessageStreamHandler
+     * @param[in] reader The JsonProtocolReader in charge of applying the decoded events
+     */
+    explicit ProtocolMessageStreamHandler(JsonProtocolReader * reader);
+
+    /**
+     * @brief ProtocolMessageStreamHandler cannot be copied.
+     * @param[in] other Another instance
+     */
+    ProtocolMessageStreamHandler(const ProtocolMessageStreamHandler & other) = delete;
+
+    /**
+     * @brief Checks that the message has been entirely read
+     * @return The 'now' value of the message
+     */
+    double finish();
+
+    // SAX events
+    bool Null(); //!< SAX event. @return true
+    bool Bool(bool b); //!< SAX event. @param[in] b The value. @return true
+    bool Int(int i); //!< SAX event. @param[in] i The value. @return true
+    bool Uint(unsigned u); //!< SAX event. @param[in] u The value. @return true
+    bool Int64(int64_t i); //!< SAX event. @param[in] i The value. @return true
+    bool Uint64(uint64_t u); //!< SAX event. @param[in] u The value. @return true
+    bool Double(double d); //!< SAX event. @param[in] d The value. @return true
+    bool RawNumber(const char * str, rapidjson::SizeType length, bool copy); //!< SAX event. @param[in] str The number string. @param[in] length The length of str. @param[in] copy Whether str should be copied. @return true
+    bool String(const char * str, rapidjson::SizeType length, bool copy); //!< SAX event. @param[in] str The string. @param[in] length The length of str. @param[in] copy Whether str should be copied. @return true
+    bool Key(const char * str, rapidjson::SizeType length, bool copy); //!< SAX event. @param[in] str The key. @param[in] length The length of str. @param[in] copy Whether str should be copied. @return true
+    bool StartObject(); //!< SAX event. @return true
+    bool EndObject(rapidjson::SizeType member_count); //!< SAX event. @param[in] member_count The number of members. @return true
+    bool StartArray(); //!< SAX event. @return true
+    bool EndArray(rapidjson::SizeType element_count); //!< SAX event. @param[in] element_count The number of elements. @return true
+
+private:
+    /**
+     * @brief Enumerates the keys of the message object whose values are used
+     */
+    enum class MessageKey
+    {
+        NOW         //!< The 'now' key
+        ,EVENTS     //!< The 'events' key
+        ,OTHER      //!< Any other key (its value is ignored)
+    };
+
+    /**
+     * @brief Handles a scalar value outside of any event
+     * @param[in] is_number Whether the value is a number
+     * @param[in] number The value (if is_number is true)
+     * @return true
+     */
+    bool on_scalar(bool is_number, double number);
+
+    /**
+     * @brief Called when the current event has been completely read
+     */
+    void on_event_complete();
+
+private:
+    static const size_t event_buffer_size = 16 * 1024; //!< The size of the memory pool in which events are built
+
+    JsonProtocolReader * _reader; //!< The JsonProtocolReader which applies events
+
+    int _depth = 0; //!< The depth within the message (0: outside the message, 1: in the message object, 2: in the events array)
+    int _event_depth = 0; //!< The depth within the current event (0 if no event is being read)
+    int _ignored_depth = 0; //!< The depth within an ignored value (0 if no value is being ignored)
+    MessageKey _current_key = MessageKey::OTHER; //!< The key of the message object whose value is being read
+
+    bool _has_now = false; //!< Whether the 'now' value has been read
+    bool _has_events = false; //!< Whether the 'events' value has been found
+    double _now = -1; //!< The 'now' value of the message
+    int _nb_events = 0; //!< The number of events which have been completely read
+
+    alignas(8) char _event_buffer[event_buffer_size]; //!< The memory in which events are built (most of the time)
+    rapidjson::Document::AllocatorType _event_allocator; //!< The allocator of the event documents
+    rapidjson::Document _event_doc; //!< The document of the current event
+    std::vector<std::unique_ptr<rapidjson::Document>> _events_before_now; //!< The events read before 'now'
+};
+
+/**
+ * @brief In charge of parsing a MessagePack message and injecting messages into the simulation
+ * @details JSON messages are also accepted, as schedulers may answer to the JSON-encoded
+ *          SIMULATION_BEGINS message in JSON.
+ */
+class MsgpackProtocolReader : public JsonProtocolReader
+{
+public:
+    /**
+     * @brief Constructor
+     * @param[in] context The BatsimContext
+     */
+    explicit MsgpackProtocolReader(BatsimContext * context);
+
+    /**
+     * @brief MsgpackProtocolReader cannot be copied.
+     * @param[in] other Another instance
+     */
+    MsgpackProtocolReader(const MsgpackProtocolReader & other) = delete;
+
+    /**
+     * @brief Destructor
+     */
+    ~MsgpackProtocolReader();
+
+    /**
+     * @brief Parses a message and injects events in the simulation
+     * @param[in] message The protocol message
+     */
+    void parse_and_apply_message(const std::string & message);
 };
@@ -0,0 +1,54 @@
+/**
+ * @file scheduler_calls.cpp
+ * @brief Contains the measures of the calls to the scheduler
+ */
+
+#include "scheduler_calls.hpp"
+
+#include <fstream>
+
+#include <xbt.h>
+
+using namespace std;
+
+void SchedulerCallStatistics::record_call(const SchedulerCallMeasures & measures)
+{
+    _histograms[ENCODING].record(measures.encoding.count());
+    _histograms[COMPRESSION].record(measures.compression.count());
+    _histograms[SENDING].record(measures.sending.count());
+    _histograms[WAITING].record(measures.waiting.count());
+    _histograms[DECOMPRESSION].record(measures.decompression.count());
+    _histograms[DECODING].record(measures.decoding.count());
+    _histograms[TOTAL].record((measures.encoding + measures.compression + measures.sending + measures.waiting +
+                               measures.decompression + measures.decoding).count());
+    _histograms[SENT_BYTES].record(measures.sent_bytes);
+    _histograms[RECEIVED_BYTES].record(measures.received_bytes);
+    _histograms[NB_EVENTS].record(measures.nb_events);
+}
+
+void SchedulerCallStatistics::export_to_csv(const string & filename) const
+{
+    static const char * metric_names[NB_METRICS] = {"encoding", "compression", "sending", "waiting",
+                                                    "decompression", "decoding", "total",
+                                                    "sent_size", "received_size", "nb_events"};
+    static const char * metric_units[NB_METRICS] = {"ns", "ns", "ns", "ns", "ns", "ns", "ns",
+                                                    "bytes", "bytes", "events"};
+
+    ofstream f(filename, ios_base::trunc);
+    xbt_assert(f.is_open(), "Cannot write file '%s'", filename.c_str());
+
+    f << "metric,unit,bucket_min,bucket_max,count\n";
+    for (int metric = 0; metric < NB_METRICS; ++metric)
+    {
+        const Histogram & histogram = _histograms[metric];
+        for (int bucket = 0; bucket < histogram.nb_buckets(); ++bucket)
+        {
+            if (histogram.bucket_count(bucket) > 0)
+            {
+                f << metric_names[metric] << ',' << metric_units[metric] << ','
+                  << histogram.bucket_lower_bound(bucket) << ',' << histogram.bucket_upper_bound(bucket) << ','
+                  << histogram.bucket_count(bucket) << '\n';
+            }
+        }
+    }
+}
@@ -0,0 +1,77 @@
+/**
+ * @file scheduler_calls.hpp
+ * @brief Contains the measures of the calls to the scheduler
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include <chrono>
+#include <string>
+
+#include "histogram.hpp"
+
+/**
+ * @brief The measures of one call to the scheduler, phase by phase
+ */
+struct SchedulerCallMeasures
+{
+    std::chrono::nanoseconds encoding{0}; //!< Time taken to finish the message. Events are encoded as they occur, this is not included
+    std::chrono::nanoseconds compression{0}; //!< Time taken to compress the message
+    std::chrono::nanoseconds sending{0}; //!< Time taken to hand the message over to the transport
+    std::chrono::nanoseconds waiting{0}; //!< Time between the message sending and the reply reception: the scheduler think time and the transfers
+    std::chrono::nanoseconds decompression{0}; //!< Time taken to decompress the reply
+    std::chrono::nanoseconds decoding{0}; //!< Time taken to decode the reply and to inject its events into the simulation
+    uint64_t sent_bytes = 0; //!< The size of the message, as sent to the transport
+    uint64_t received_bytes = 0; //!< The size of the reply, as received from the transport
+    int nb_events = 0; //!< The number of events of the message
+};
+
+/**
+ * @brief Aggregates the measures of the calls to the scheduler into histograms
+ */
+class SchedulerCallStatistics
+{
+public:
+    /**
+     * @brief Adds the measures of a call to the statistics
+     * @param[in] measures The measures of the call
+     */
+    void record_call(const SchedulerCallMeasures & measures);
+
+    /**
+     * @brief Returns the number of recorded calls
+     * @return The number of recorded calls
+     */
+    uint64_t nb_calls() const { return _histograms[TOTAL].count(); }
+
+    /**
+     * @brief Writes the histograms into a CSV file
+     * @details Each row is a non-empty bucket of the histogram of a metric
+     *          (columns metric,unit,bucket_min,bucket_max,count).
+     * @param[in] filename The name of the CSV file
+     */
+    void export_to_csv(const std::string & filename) const;
+
+private:
+    /**
+     * @brief The metrics measured on each call
+     */
+    enum Metric
+    {
+        ENCODING
+        ,COMPRESSION
+        ,SENDING
+        ,WAITING
+        ,DECOMPRESSION
+        ,DECODING
+        ,TOTAL
+        ,SENT_BYTES
+        ,RECEIVED_BYTES
+        ,NB_EVENTS
+        ,NB_METRICS
+    };
+
+    Histogram _histograms[NB_METRICS]; //!< The histogram of each metric
+};
@@ -0,0 +1,151 @@
+/**
+ * @file scheduler_plugin.hpp
+ * @brief Contains the interface of the schedulers loaded as plugins into Batsim's process
+ * @details A scheduler plugin is a shared library which only needs this header.
+ *          It must define the batsim_create_scheduler and batsim_destroy_scheduler functions.
+ *          Batsim gives the plugin typed events and gets typed decisions back, without any
+ *          serialization nor socket between them.
+ *
+ *          Although the entry points are extern "C" (so that dlsym finds them by name), a
+ *          SchedulerPlugin and std::string, std::vector and std::pair values cross the library
+ *          boundary. The plugin must therefore be built with the same compiler, against the same
+ *          libstdc++ and with the same _GLIBCXX_USE_CXX11_ABI value as Batsim. Otherwise, the
+ *          layouts of these classes may differ and Batsim's behavior is undefined:
+ *          BATSIM_SCHEDULER_PLUGIN_API_VERSION only detects changes of this interface, not of the C++ ABI.
+ */
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+//! The version of the plugin interface. Batsim refuses plugins built against another version.
+//! It does not cover the C++ ABI, which must be the same as Batsim's (see the file description).
+#define BATSIM_SCHEDULER_PLUGIN_API_VERSION 1
+
+/**
+ * @brief A set of resources, as a list of closed intervals of resource ids (e.g. {{0,3},{7,7}} for "0-3 7")
+ */
+typedef std::vector<std::pair<int, int>> PluginResourceIntervals;
+
+/**
+ * @brief The types of the events sent by Batsim to a scheduler plugin
+ */
+enum class PluginEventType
+{
+    SIMULATION_BEGINS           //!< The simulation begins
+    ,SIMULATION_ENDS            //!< The simulation ends
+    ,JOB_SUBMITTED              //!< A job has been submitted
+    ,JOB_COMPLETED              //!< A job has completed
+    ,JOB_KILLED                 //!< Some jobs have been killed
+    ,FROM_JOB_MSG               //!< A job sent a message to the scheduler
+    ,RESOURCE_STATE_CHANGED     //!< The state of some resources has changed
+    ,REQUESTED_CALL             //!< A call requested by the scheduler (CALL_ME_LATER) occurs
+};
+
+/**
+ * @brief An event sent by Batsim to a scheduler plugin
+ * @details Only the fields related to the event type are set. They are listed in the
+ *          description of each field.
+ */
+struct PluginEvent
+{
+    PluginEventType type; //!< The event type
+    double timestamp; //!< The date at which the event occurred
+
+    std::string job_id; //!< The job identifier (JOB_SUBMITTED, JOB_COMPLETED, FROM_JOB_MSG)
+    std::vector<std::string> job_ids; //!< The identifiers of the killed jobs (JOB_KILLED)
+    std::string profile; //!< The job profile name (JOB_SUBMITTED)
+    int nb_requested_resources = 0; //!< The number of resources requested by the job (JOB_SUBMITTED)
+    double walltime = -1; //!< The job walltime, -1 if the job has none (JOB_SUBMITTED)
+
+    std::string job_status; //!< The job status: SUCCESS, FAILED or TIMEOUT (JOB_COMPLETED)
+    std::string job_state; //!< The job state, e.g. COMPLETED_SUCCESSFULLY (JOB_COMPLETED)
+    std::string kill_reason; //!< Why the job has been killed, if it has been (JOB_COMPLETED)
+    int return_code = 0; //!< The job return code (JOB_COMPLETED)
+
+    PluginResourceIntervals resources; //!< The job allocation (JOB_COMPLETED) or the resources whose state changed (RESOURCE_STATE_CHANGED)
+    std::string state; //!< The new state of the resources (RESOURCE_STATE_CHANGED)
+
+    int nb_resources = 0; //!< The number of compute resources (SIMULATION_BEGINS)
+    bool allow_time_sharing = false; //!< Whether time sharing is enabled (SIMULATION_BEGINS)
+
+    std::string json; //!< The Batsim configuration (SIMULATION_BEGINS), the job description (JOB_SUBMITTED) or the job message (FROM_JOB_MSG), as JSON text
+};
+
+/**
+ * @brief The types of the decisions taken by a scheduler plugin
+ */
+enum class PluginDecisionType
+{
+    EXECUTE_JOB                 //!< Execute a job on some resources
+    ,REJECT_JOB                 //!< Reject a job
+    ,KILL_JOBS                  //!< Kill some jobs
+    ,CALL_ME_LATER              //!< Ask Batsim to call the scheduler at a given date
+    ,SET_RESOURCE_STATE         //!< Change the power state of some resources
+    ,SUBMISSION_FINISHED        //!< The scheduler will no longer submit jobs (dynamic submissions)
+    ,CONTINUE_SUBMISSION        //!< The scheduler submits jobs again (dynamic submissions)
+};
+
+/**
+ * @brief A decision taken by a scheduler plugin
+ * @details Only the fields related to the decision type should be set. They are listed in the
+ *          description of each field.
+ */
+struct PluginDecision
+{
+    PluginDecisionType type; //!< The decision type
+    double timestamp; //!< The date at which the decision has been taken
+
+    std::string job_id; //!< The job identifier, of the form WORKLOAD!NUMBER (EXECUTE_JOB, REJECT_JOB)
+    std::vector<std::string> job_ids; //!< The identifiers of the jobs to kill (KILL_JOBS)
+    PluginResourceIntervals resources; //!< The job allocation (EXECUTE_JOB) or the resources to switch (SET_RESOURCE_STATE)
+    std::vector<int> mapping; //!< Optional. The resource (as an index in the allocation) of each executor of the job (EXECUTE_JOB)
+    double call_date = 0; //!< The date at which the scheduler should be called (CALL_ME_LATER)
+    int pstate = 0; //!< The power state the resources should be put in (SET_RESOURCE_STATE)
+};
+
+/**
+ * @brief The interface a scheduler plugin implements
+ */
+class SchedulerPlugin
+{
+public:
+    /**
+     * @brief Destructor
+     */
+    virtual ~SchedulerPlugin() {}
+
+    /**
+     * @brief Called each time Batsim calls the scheduler
+     * @param[in] now The current simulation date
+     * @param[in] events The events that occurred since the previous call, ordered by date
+     * @param[out] decisions The decisions taken by the scheduler, ordered by date. Empty when called.
+     * @return The simulation date at which the scheduler is done taking decisions. It must be
+     *         greater than or equal to now and to the dates of the decisions.
+     */
+    virtual double take_decisions(double now,
+                                  const std::vector<PluginEvent> & events,
+                                  std::vector<PluginDecision> & decisions) = 0;
+};
+
+extern "C"
+{
+    /**
+     * @brief Creates the scheduler of a plugin. Called once when Batsim starts.
+     * @details Despite the C linkage, this passes C++ objects: the plugin must share Batsim's
+     *          compiler, libstdc++ and _GLIBCXX_USE_CXX11_ABI value (see the file description).
+     * @param[in] api_version The plugin interface version Batsim has been built with
+     *            (BATSIM_SCHEDULER_PLUGIN_API_VERSION). The plugin should return nullptr if it differs.
+     * @param[in] configuration The Batsim configuration, as JSON text
+     * @return The scheduler, or nullptr if it cannot be created
+     */
+    SchedulerPlugin * batsim_create_scheduler(int api_version, const char * configuration);
+
+    /**
+     * @brief Destroys a scheduler created by batsim_create_scheduler. Called once when Batsim ends.
+     * @param[in] scheduler The scheduler
+     */
+    void batsim_destroy_scheduler(SchedulerPlugin * scheduler);
+}
@@ -5,6 +5,8 @@
 
 #include "server.hpp"
 
+#include <array>
+#include <chrono>
 #include <string>
 
 #include <boost/algorithm/string.hpp>
@@ -39,41 +41,30 @@ int server_process(int argc, char *argv[])
                                                     context->allow_time_sharing,
                                                     MSG_get_clock());
 
-    RequestReplyProcessArguments * req_rep_args = new RequestReplyProcessArguments;
-    req_rep_args->context = context;
-    req_rep_args->send_buffer = context->proto_writer->generate_current_message(MSG_get_clock());
-    context->proto_writer->clear();
+    call_scheduler(data);
 
-    MSG_process_create("Scheduler REQ-REP", request_reply_scheduler_process,
-                       (void*)req_rep_args, MSG_host_self());
-    data->sched_ready = false;
+    // Let's prepare a handler table, indexed by message type, to react on events
+    const ServerMessageHandlers & handlers = server_message_handlers();
+
+    // Receives one message from the server mailbox and handles it
+    auto receive_and_handle_message = [&handlers, data]()
+    {
+        msg_task_t task_received = NULL;
+        MSG_task_receive(&(task_received), "server");
 
-    // Let's prepare a handler map to react on events
-    std::map<IPMessageType, std::function<void(ServerData *, IPMessage *)>> handler_map;
-    handler_map[IPMessageType::JOB_SUBMITTED] = server_on_job_submitted;
-    handler_map[IPMessageType::JOB_SUBMITTED_BY_DP] = server_on_submit_job;
-    handler_map[IPMessageType::PROFILE_SUBMITTED_BY_DP] = server_on_submit_profile;
-    handler_map[IPMessageType::JOB_COMPLETED] = server_on_job_completed;
-    handler_map[IPMessageType::PSTATE_MODIFICATION] = server_on_pstate_modification;
-    handler_map[IPMessageType::SCHED_EXECUTE_JOB] = server_on_execute_job;
-    handler_map[IPMessageType::SCHED_CHANGE_JOB_STATE] = server_on_change_job_state;
-    handler_map[IPMessageType::TO_JOB_MSG] = server_on_to_job_msg;
-    handler_map[IPMessageType::FROM_JOB_MSG] = server_on_from_job_msg;
-    handler_map[IPMessageType::SCHED_REJECT_JOB] = server_on_reject_job;
-    handler_map[IPMessageType::SCHED_KILL_JOB] = server_on_kill_jobs;
-    handler_map[IPMessageType::SCHED_CALL_ME_LATER] = server_on_call_me_later;
-    handler_map[IPMessageType::SCHED_TELL_ME_ENERGY] = server_on_sched_tell_me_energy;
-    handler_map[IPMessageType::SCHED_WAIT_ANSWER] = server_on_sched_wait_answer;
-    handler_map[IPMessageType::WAIT_QUERY] = server_on_wait_query;
-    handler_map[IPMessageType::SCHED_READY] = server_on_sched_ready;
-    handler_map[IPMessageType::WAITING_DONE] = server_on_waiting_done;
-    handler_map[IPMessageType::KILLING_DONE] = server_on_killing_done;
-    handler_map[IPMessageType::SUBMITTER_HELLO] = server_on_submitter_hello;
-    handler_map[IPMessageType::SUBMITTER_BYE] = server_on_submitter_bye;
-    handler_map[IPMessageType::SWITCHED_ON] = server_on_switched;
-    handler_map[IPMessageType::SWITCHED_OFF] = server_on_switched;
-    handler_map[IPMessageType::END_DYNAMIC_SUBMIT] = server_on_end_dynamic_submit;
-    handler_map[IPMessageType::CONTINUE_DYNAMIC_SUBMIT] = server_on_continue_dynamic_submit;
+        handle_server_message(handlers, data, (IPMessage *) MSG_task_get_data(task_received));
+        MSG_task_destroy(task_received);
+
+        // Let's report the simulation progress if needed
+        if (data->context->telemetry != nullptr)
+        {
+            data->context->telemetry->count_message();
+            if (data->context->telemetry->is_due())
+            {
+                data->context->telemetry->emit(make_telemetry_sample(data));
+            }
+        }
+    };
 
     // Simulation loop
     while ((data->nb_submitters == 0 && !context->submission_sched_enabled) || // If dynamic submissions are not enabled: wait for the first submitter
@@ -86,38 +77,23 @@ int server_process(int argc, char *argv[])
            (context->submission_sched_enabled && // If dynamic job submission are enabled
             !context->submission_sched_finished)) // The end of submissions must have been received
     {
-        // Let's wait a message from a node or the request-reply process...
-        msg_task_t task_received = NULL;
-        IPMessage * task_data;
-        MSG_task_receive(&(task_received), "server");
-
-        // Let's handle the message
-        task_data = (IPMessage *) MSG_task_get_data(task_received);
-        XBT_INFO("Server received a message of type %s:",
-                 ip_message_type_to_string(task_data->type).c_str());
+        // Let's wait a message from a node or the request-reply process, then handle it
+        receive_and_handle_message();
 
-        xbt_assert(handler_map.count(task_data->type) == 1,
-                   "The server does not know how to handle message type %s.",
-                   ip_message_type_to_string(task_data->type).c_str());
-        auto handler_function = handler_map[task_data->type];
-        handler_function(data, task_data);
-
-        // Let's delete the message data
-        delete task_data;
-        MSG_task_destroy(task_received);
+        // When calls are coalesced, let's also handle the messages which have already been posted
+        // at the current date, so that the scheduler is called once with all their events
+        if (context->protocol_coalesce_calls)
+        {
+            while (MSG_task_listen("server"))
+            {
+                receive_and_handle_message();
+            }
+        }
 
         // Let's send a message to the scheduler if needed
-        if (data->sched_ready && // The scheduler must be ready
-            !data->end_of_simulation_sent && // It will NOT be called if SIMULATION_ENDS has already been sent
-            !context->proto_writer->is_empty()) // There must be something to send to it
+        if (scheduler_should_be_called(data))
         {
-            RequestReplyProcessArguments * req_rep_args = new RequestReplyProcessArguments;
-            req_rep_args->context = context;
-            req_rep_args->send_buffer = context->proto_writer->generate_current_message(MSG_get_clock());
-            context->proto_writer->clear();
-
-            MSG_process_create("Scheduler REQ-REP", request_reply_scheduler_process, (void*)req_rep_args, MSG_host_self());
-            data->sched_ready = false;
+            call_scheduler(data);
             if (data->all_jobs_submitted_and_completed)
             {
                 data->end_of_simulation_sent = true;
@@ -127,6 +103,10 @@ int server_process(int argc, char *argv[])
     } // end of while
 
     XBT_INFO("Simulation is finished!");
+    if (context->telemetry != nullptr)
+    {
+        context->telemetry->emit(make_telemetry_sample(data));
+    }
     bool simulation_is_completed = data->all_jobs_submitted_and_completed;
     (void) simulation_is_completed; // Avoids a warning if assertions are ignored
     xbt_assert(simulation_is_completed, "Left simulation loop, but the simulation does NOT seem finished...");
@@ -136,6 +116,72 @@ int server_process(int argc, char *argv[])
     return 0;
 }
 
+/**
+ * @brief Builds the handlers of the messages received by the server_process
+ * @return The handlers, indexed by message type
+ */
+static ServerMessageHandlers make_server_message_handlers()
+{
+    ServerMessageHandlers handler_table;
+    handler_table.fill(nullptr);
+    auto set_handler = [&handler_table](IPMessageType type, ServerMessageHandler handler)
+    {
+        handler_table[static_cast<int>(type)] = handler;
+    };
+    set_handler(IPMessageType::JOB_SUBMITTED, server_on_job_submitted);
+    set_handler(IPMessageType::JOB_SUBMITTED_BY_DP, server_on_submit_job);
+    set_handler(IPMessageType::PROFILE_SUBMITTED_BY_DP, server_on_submit_profile);
+    set_handler(IPMessageType::JOB_COMPLETED, server_on_job_completed);
+    set_handler(IPMessageType::PSTATE_MODIFICATION, server_on_pstate_modification);
+    set_handler(IPMessageType::SCHED_EXECUTE_JOB, server_on_execute_job);
+    set_handler(IPMessageType::SCHED_EXECUTE_JOBS, server_on_execute_jobs);
+    set_handler(IPMessageType::SCHED_CHANGE_JOB_STATE, server_on_change_job_state);
+    set_handler(IPMessageType::TO_JOB_MSG, server_on_to_job_msg);
+    set_handler(IPMessageType::FROM_JOB_MSG, server_on_from_job_msg);
+    set_handler(IPMessageType::SCHED_REJECT_JOB, server_on_reject_job);
+    set_handler(IPMessageType::SCHED_KILL_JOB, server_on_kill_jobs);
+    set_handler(IPMessageType::SCHED_CALL_ME_LATER, server_on_call_me_later);
+    set_handler(IPMessageType::SCHED_TELL_ME_ENERGY, server_on_sched_tell_me_energy);
+    set_handler(IPMessageType::SCHED_WAIT_ANSWER, server_on_sched_wait_answer);
+    set_handler(IPMessageType::WAIT_QUERY, server_on_wait_query);
+    set_handler(IPMessageType::SCHED_READY, server_on_sched_ready);
+    set_handler(IPMessageType::WAITING_DONE, server_on_waiting_done);
+    set_handler(IPMessageType::KILLING_DONE, server_on_killing_done);
+    set_handler(IPMessageType::SUBMITTER_HELLO, server_on_submitter_hello);
+    set_handler(IPMessageType::SUBMITTER_BYE, server_on_submitter_bye);
+    set_handler(IPMessageType::SWITCHED_ON, server_on_switched);
+    set_handler(IPMessageType::SWITCHED_OFF, server_on_switched);
+    set_handler(IPMessageType::END_DYNAMIC_SUBMIT, server_on_end_dynamic_submit);
+    set_handler(IPMessageType::CONTINUE_DYNAMIC_SUBMIT, server_on_continue_dynamic_submit);
+
+    return handler_table;
+}
+
+const ServerMessageHandlers & server_message_handlers()
+{
+    // Built once. std::array cannot be filled by index in a C++11 constant expression, and a positional
+    // initializer would silently depend on the order of the IPMessageType values.
+    static const ServerMessageHandlers handler_table = make_server_message_handlers();
+    return handler_table;
+}
+
+void handle_server_message(const ServerMessageHandlers & handlers,
+                           ServerData * data,
+                           IPMessage * task_data)
+{
+    XBT_INFO("Server received a message of type %s:",
+             ip_message_type_to_string(task_data->type));
+
+    ServerMessageHandler handler_function = handlers[static_cast<int>(task_data->type)];
+    xbt_assert(handler_function != nullptr,
+               "The server does not know how to handle message type %s.",
+               ip_message_type_to_string(task_data->type));
+    handler_function(data, task_data);
+
+    // Let's delete the message data
+    delete task_data;
+}
+
 void server_on_submitter_hello(ServerData * data,
                                IPMessage * task_data)
 {
@@ -187,16 +233,17 @@ void server_on_job_completed(ServerData * data,
     xbt_assert(task_data->data != nullptr);
     JobCompletedMessage * message = (JobCompletedMessage *) task_data->data;
 
-    if (data->origin_of_jobs.count(message->job_id) == 1)
+    auto origin = data->origin_of_jobs.find(message->job_id);
+    if (origin != data->origin_of_jobs.end())
     {
         // Let's call the submitter which submitted the job back
         SubmitterJobCompletionCallbackMessage * msg = new SubmitterJobCompletionCallbackMessage;
         msg->job_id = message->job_id;
 
-        ServerData::Submitter * submitter = data->origin_of_jobs.at(message->job_id);
+        ServerData::Submitter * submitter = origin->second;
         dsend_message(submitter->mailbox, IPMessageType::SUBMITTER_CALLBACK, (void*) msg);
 
-        data->origin_of_jobs.erase(message->job_id);
+        data->origin_of_jobs.erase(origin);
     }
 
     data->nb_running_jobs--;
@@ -222,14 +269,17 @@ void server_on_job_completed(ServerData * data,
         status = "TIMEOUT";
     }
 
-    data->context->proto_writer->append_job_completed(message->job_id.to_string(),
+    data->context->proto_writer->append_job_completed(message->job_id,
                                                       status,
                                                       job_state_to_string(job->state),
-                                                      job->kill_reason,
+                                                      job->kill_reason(),
                                                       job->allocation.to_string_hyphen(" "),
                                                       job->return_code,
                                                       MSG_get_clock());
 
+    // Only what the output files need is kept from now on
+    job->release_completed_job_data();
+
     check_submitted_and_completed(data);
 }
 
@@ -250,37 +300,39 @@ void server_on_job_submitted(ServerData * data,
     xbt_assert(data->submitters.count(message->submitter_name) == 1);
 
     ServerData::Submitter * submitter = data->submitters.at(message->submitter_name);
-    if (submitter->should_be_called_back)
-    {
-        xbt_assert(data->origin_of_jobs.count(message->job_id) == 0);
-        data->origin_of_jobs[message->job_id] = submitter;
-    }
 
-    // Let's retrieve the Job from memory (or add it into memory if it is dynamic)
-    XBT_INFO("GOT JOB: %s %d\n", message->job_id.workload_name.c_str(), message->job_id.job_number);
-    xbt_assert(data->context->workloads.job_exists(message->job_id));
-    Job * job = data->context->workloads.job_at(message->job_id);
-    job->id = message->job_id;
-
-    // Update control information
-    job->state = JobState::JOB_STATE_SUBMITTED;
-    ++data->nb_submitted_jobs;
-    XBT_INFO("Job %s SUBMITTED. %d jobs submitted so far",
-             message->job_id.to_string().c_str(), data->nb_submitted_jobs);
+    // Descriptions are given by reference (the writer emits them as they are)
+    const string no_description;
+    const bool forward_job = !data->context->redis_enabled;
+    const bool forward_profile = forward_job && data->context->submission_forward_profiles;
 
-    string job_json_description, profile_json_description;
-
-    if (!data->context->redis_enabled)
+    for (const JobIdentifier & job_id : message->job_ids)
     {
-        job_json_description = job->json_description;
-        if (data->context->submission_forward_profiles)
+        if (submitter->should_be_called_back)
         {
-            profile_json_description = job->workload->profiles->at(job->profile)->json_description;
+            xbt_assert(data->origin_of_jobs.count(job_id) == 0);
+            data->origin_of_jobs[job_id] = submitter;
         }
-    }
 
-    data->context->proto_writer->append_job_submitted(job->id.to_string(), job_json_description,
-                                                      profile_json_description, MSG_get_clock());
+        // Let's retrieve the Job from memory (or add it into memory if it is dynamic)
+        XBT_INFO("GOT JOB: %s %d\n", job_id.workload_name().c_str(), job_id.job_number);
+        xbt_assert(data->context->workloads.job_exists(job_id));
+        Job * job = data->context->workloads.job_at(job_id);
+        job->id = job_id;
+
+        // Update control information
+        job->state = JobState::JOB_STATE_SUBMITTED;
+        ++data->nb_submitted_jobs;
+        XBT_INFO("Job %s SUBMITTED. %d jobs submitted so far",
+                 job_id.to_string().c_str(), data->nb_submitted_jobs);
+
+        const string & job_json_description = forward_job ? job->json_description : no_description;
+        const string & profile_json_description = forward_profile ?
+            job->workload->profiles->at(job->profile)->json_description : no_description;
+
+        data->context->proto_writer->append_job_submitted(job->id, job->profile, job_json_description,
+                                                          profile_json_description, MSG_get_clock());
+    }
 }
 
 void server_on_pstate_modification(ServerData * data,
@@ -481,35 +533,48 @@ void server_on_killing_done(ServerData * data,
 
     vector<string> job_ids_str;
     vector<string> really_killed_job_ids_str;
-    job_ids_str.reserve(message->jobs_ids.size());
-    map<string, BatTask *> jobs_progress_str;
+    vector<Job *> really_killed_jobs;
+    const bool log_killed_jobs = XBT_LOG_ISENABLED(server, xbt_log_priority_info);
 
     // manage job Id list
     for (const JobIdentifier & job_id : message->jobs_ids)
     {
-        job_ids_str.push_back(job_id.to_string());
-
-        // store job progress from BatTask tree in str
-        jobs_progress_str[job_id.to_string()] = message->jobs_progress[job_id];
+        if (log_killed_jobs)
+        {
+            job_ids_str.push_back(job_id.to_string());
+        }
 
-        const Job * job = data->context->workloads.job_at(job_id);
+        Job * job = data->context->workloads.job_at(job_id);
         if (job->state == JobState::JOB_STATE_COMPLETED_KILLED)
         {
+            really_killed_jobs.push_back(job);
             data->nb_running_jobs--;
             xbt_assert(data->nb_running_jobs >= 0);
             data->nb_completed_jobs++;
             xbt_assert(data->nb_completed_jobs + data->nb_running_jobs <= data->nb_submitted_jobs);
 
-            really_killed_job_ids_str.push_back(job_id.to_string());
-
+            if (log_killed_jobs)
+            {
+                really_killed_job_ids_str.push_back(job_id.to_string());
+            }
         }
     }
 
-    XBT_INFO("Jobs {%s} have been killed (the following ones have REALLY been killed: {%s})",
-             boost::algorithm::join(job_ids_str, ",").c_str(),
-             boost::algorithm::join(really_killed_job_ids_str, ",").c_str());
+    if (log_killed_jobs)
+    {
+        XBT_INFO("Jobs {%s} have been killed (the following ones have REALLY been killed: {%s})",
+                 boost::algorithm::join(job_ids_str, ",").c_str(),
+                 boost::algorithm::join(really_killed_job_ids_str, ",").c_str());
+    }
+
+    data->context->proto_writer->append_job_killed(message->jobs_ids, message->jobs_progress, MSG_get_clock());
 
-    data->context->proto_writer->append_job_killed(job_ids_str, jobs_progress_str, MSG_get_clock());
+    // The progress of the killed jobs (which points into their tasks) is not used anymore:
+    // only what the output files need is kept from now on
+    for (Job * job : really_killed_jobs)
+    {
+        job->release_completed_job_data();
+    }
     --data->nb_killers;
 
     check_submitted_and_completed(data);
@@ -548,7 +613,7 @@ void server_on_submit_job(ServerData * data,
 
     const Job * job = data->context->workloads.job_at(message->job_id);
 
-    Workload * workload = data->context->workloads.at(message->job_id.workload_name);
+    const Workload * workload = job->workload;
     xbt_assert(workload->profiles->exists(job->profile),
                "Dynamically submitted job '%s' has no profile: "
                "Workload '%s' has no profile named '%s'. "
@@ -562,18 +627,15 @@ void server_on_submit_job(ServerData * data,
 
     if (data->context->submission_sched_ack)
     {
-        string job_json_description, profile_json_description;
-
-        if (!data->context->redis_enabled)
-        {
-            job_json_description = job->json_description;
-            if (data->context->submission_forward_profiles)
-            {
-                profile_json_description = job->workload->profiles->at(job->profile)->json_description;
-            }
-        }
-
-        data->context->proto_writer->append_job_submitted(job->id.to_string(), job_json_description,
+        // Descriptions are given by reference (the writer emits them as they are)
+        const string no_description;
+        const bool forward_job = !data->context->redis_enabled;
+        const bool forward_profile = forward_job && data->context->submission_forward_profiles;
+        const string & job_json_description = forward_job ? job->json_description : no_description;
+        const string & profile_json_description = forward_profile ?
+            job->workload->profiles->at(job->profile)->json_description : no_description;
+
+        data->context->proto_writer->append_job_submitted(job->id, job->profile, job_json_description,
                                                           profile_json_description,
                                                           MSG_get_clock());
     }
@@ -657,7 +719,10 @@ void server_on_change_job_state(ServerData * data,
     }
 
     job->state = new_state;
-    job->kill_reason = message->kill_reason;
+    if (!message->kill_reason.empty() || job->cold != nullptr)
+    {
+        job->cold_data().kill_reason = message->kill_reason;
+    }
 
     XBT_INFO("Job state changed: Job %d (workload=%s)",
              job->number, job->workload->name.c_str());
@@ -677,7 +742,7 @@ void server_on_to_job_msg(ServerData * data,
              job->number, job->workload->name.c_str(),
              message->message.c_str());
 
-    job->incoming_message_buffer.push_back(message->message);
+    job->cold_data().incoming_message_buffer.push_back(message->message);
 
     check_submitted_and_completed(data);
 }
@@ -693,7 +758,7 @@ void server_on_from_job_msg(ServerData * data,
     XBT_INFO("Send message to scheduler: Job %d (workload=%s)",
              job->number, job->workload->name.c_str());
 
-    data->context->proto_writer->append_from_job_message(message->job_id.to_string(),
+    data->context->proto_writer->append_from_job_message(message->job_id,
                                                          message->message,
                                                          MSG_get_clock());
 
@@ -773,8 +838,24 @@ void server_on_execute_job(ServerData * data,
 {
     xbt_assert(task_data->data != nullptr);
     ExecuteJobMessage * message = (ExecuteJobMessage *) task_data->data;
-    SchedulingAllocation * allocation = message->allocation;
+    execute_job_allocation(data, message->allocation);
+}
+
+void server_on_execute_jobs(ServerData * data,
+                            IPMessage * task_data)
+{
+    xbt_assert(task_data->data != nullptr);
+    ExecuteJobsMessage * message = (ExecuteJobsMessage *) task_data->data;
 
+    for (SchedulingAllocation * allocation : message->allocations)
+    {
+        execute_job_allocation(data, allocation);
+    }
+}
+
+void execute_job_allocation(ServerData * data,
+                            SchedulingAllocation * allocation)
+{
     xbt_assert(data->context->workloads.job_exists(allocation->job_id),
                "Trying to execute job '%s', which does NOT exist!",
                allocation->job_id.to_string().c_str());
@@ -857,6 +938,25 @@ void server_on_execute_job(ServerData * data,
     job->execution_processes.insert(process);
 }
 
+bool only_scheduler_can_resume_simulation(const ServerData * data)
+{
+    return data->nb_running_jobs == 0 &&
+           data->nb_switching_machines == 0 &&
+           data->nb_waiters == 0 &&
+           data->nb_killers == 0;
+    // Submitters are not waited for: they are either sleeping until their next submission date or
+    // waiting for a job completion callback (which may itself depend on the deferred events)
+}
+
+bool scheduler_should_be_called(const ServerData * data)
+{
+    AbstractProtocolWriter * writer = data->context->proto_writer;
+    return data->sched_ready && // The scheduler must be ready
+           !data->end_of_simulation_sent && // It will NOT be called if SIMULATION_ENDS has already been sent
+           (writer->has_triggering_events() || // There must be something worth sending to it...
+            (!writer->is_empty() && only_scheduler_can_resume_simulation(data))); // ...or deferred events that nothing else would flush
+}
+
 void check_submitted_and_completed(ServerData * data)
 {
     if (!data->all_jobs_submitted_and_completed && // guard to prevent multiple SIMULATION_ENDS events
@@ -871,3 +971,42 @@ void check_submitted_and_completed(ServerData * data)
         data->context->proto_writer->append_simulation_ends(MSG_get_clock());
     }
 }
+
+void call_scheduler(ServerData * data)
+{
+    BatsimContext * context = data->context;
+
+    RequestReplyProcessArguments * req_rep_args = new RequestReplyProcessArguments;
+    req_rep_args->context = context;
+    req_rep_args->measures.nb_events = context->proto_writer->nb_events();
+
+    auto start = chrono::steady_clock::now();
+    req_rep_args->send_buffer = context->proto_writer->generate_current_message(MSG_get_clock());
+    req_rep_args->measures.encoding = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start);
+    context->proto_writer->clear();
+
+    MSG_process_create("Scheduler REQ-REP", request_reply_scheduler_process, (void*)req_rep_args, MSG_host_self());
+    data->sched_ready = false;
+}
+
+TelemetrySample make_telemetry_sample(const ServerData * data)
+{
+    BatsimContext * context = data->context;
+
+    TelemetrySample sample;
+    sample.simulation_time = MSG_get_clock();
+    sample.nb_submitted_jobs = data->nb_submitted_jobs;
+    sample.nb_running_jobs = data->nb_running_jobs;
+    sample.nb_completed_jobs = data->nb_completed_jobs;
+    sample.nb_processes = MSG_process_get_number();
+    sample.writer_nb_events = context->proto_writer->nb_events();
+    sample.paje_buffered_bytes = context->paje_tracer.nb_buffered_bytes();
+    sample.energy_buffered_bytes = context->energy_tracer.nb_buffered_bytes();
+    sample.pstate_buffered_bytes = context->pstate_tracer.nb_buffered_bytes();
+    sample.machine_states_buffered_bytes = context->machine_state_tracer.nb_buffered_bytes();
+    if (context->output_writer != nullptr)
+    {
+        sample.background_pending_bytes = context->output_writer->nb_pending_bytes();
+    }
+    return sample;
+}
@@ -5,10 +5,13 @@
 
 #pragma once
 
+#include <array>
 #include <string>
 #include <map>
+#include <unordered_map>
 
 #include "ipp.hpp"
+#include "telemetry.hpp"
 
 struct BatsimContext;
 
@@ -42,16 +45,77 @@ struct ServerData
     bool end_of_simulation_sent = false; //!< Whether the SIMULATION_ENDS event has been sent to the scheduler.
 
     std::map<std::string, Submitter*> submitters;   //!< The submitters
-    std::map<JobIdentifier, Submitter*> origin_of_jobs; //!< Stores whether a Submitter must be notified on job completion
+    std::unordered_map<JobIdentifier, Submitter*> origin_of_jobs; //!< Stores whether a Submitter must be notified on job completion
     //map<std::pair<int,double>, Submitter*> origin_of_wait_queries;
 };
 
+/**
+ * @brief The functions which handle the messages received by the server_process
+ */
+typedef void (*ServerMessageHandler)(ServerData * data, IPMessage * task_data);
+
+/**
+ * @brief The handlers of the messages received by the server_process, indexed by message type
+ */
+typedef std::array<ServerMessageHandler, NB_IP_MESSAGE_TYPES> ServerMessageHandlers;
+
+/**
+ * @brief Returns the handlers of the messages received by the server_process
+ * @return The handlers, indexed by message type (nullptr for the types the server does not handle).
+ *         The table is built on the first call, then shared.
+ */
+const ServerMessageHandlers & server_message_handlers();
+
+/**
+ * @brief Handles a message received by the server_process, then deletes its data
+ * @param[in] handlers The handlers of the messages, indexed by message type
+ * @param[in,out] data The data associated with the server_process
+ * @param[in] task_data The message to handle
+ */
+void handle_server_message(const ServerMessageHandlers & handlers,
+                           ServerData * data,
+                           IPMessage * task_data);
+
+/**
+ * @brief Generates the message of the events pushed into the protocol writer, and starts the
+ *        process which sends it to the scheduler
+ * @param[in,out] data The data associated with the server_process
+ */
+void call_scheduler(ServerData * data);
+
 /**
  * @brief Checks whether all jobs are submitted and completed
  * @param[in,out] data The data associated with the server_process
  */
 void check_submitted_and_completed(ServerData * data);
 
+/**
+ * @brief Returns whether no simulated process started by the scheduler's decisions can send a message to
+ *        the server anymore, which means that only a decision of the scheduler can make the simulation progress
+ * @details This is used to flush deferred events, which would otherwise never be sent.
+ *          Unfinished submitters do not prevent the flush: a submitter waiting for a job completion
+ *          callback would wait forever, and a sleeping one would delay the events to its next submission date.
+ * @param[in] data The data associated with the server_process
+ * @return Whether only the scheduler can make the simulation progress
+ */
+bool only_scheduler_can_resume_simulation(const ServerData * data);
+
+/**
+ * @brief Returns whether the events pushed into the protocol writer should be sent to the scheduler now
+ * @details Deferred events are held back until a non-deferred event is pushed, or until only the
+ *          scheduler can make the simulation progress.
+ * @param[in] data The data associated with the server_process
+ * @return Whether the scheduler should be called now
+ */
+bool scheduler_should_be_called(const ServerData * data);
+
+/**
+ * @brief Gathers the state of the simulation reported by the telemetry
+ * @param[in] data The data associated with the server_process
+ * @return The state of the simulation
+ */
+TelemetrySample make_telemetry_sample(const ServerData * data);
+
 /**
  * @brief Process used to orchestrate the simulation
  * @param[in] argc The number of arguments
@@ -223,6 +287,22 @@ void server_on_call_me_later(ServerData * data,
 void server_on_execute_job(ServerData * data,
                            IPMessage * task_data);
 
+/**
+ * @brief Server SCHED_EXECUTE_JOBS handler
+ * @param[in,out] data The data associated with the server_process
+ * @param[in,out] task_data The data associated with the message the server received
+ */
+void server_on_execute_jobs(ServerData * data,
+                            IPMessage * task_data);
+
+/**
+ * @brief Checks a job allocation decided by the scheduler and starts the execution of the job
+ * @param[in,out] data The data associated with the server_process
+ * @param[in,out] allocation The job allocation. Its ownership is given to the job execution process.
+ */
+void execute_job_allocation(ServerData * data,
+                            SchedulingAllocation * allocation);
+
 /**
  * @brief Server SCHED_CHANGE_JOB_STATE handler
  * @param[in,out] data The data associated with the server_process
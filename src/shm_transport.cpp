@@ -0,0 +1,101 @@
+/**
+ * @file shm_transport.cpp
+ * @brief Contains the shared-memory transport between Batsim and a co-located scheduler
+ */
+
+#include "shm_transport.hpp"
+
+#include <errno.h>
+
+#include <stdexcept>
+
+#include <xbt.h>
+
+using namespace std;
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(shm_transport, "shm_transport"); //!< Logging
+
+SharedMemoryTransport::SharedMemoryTransport(const string & name, uint64_t capacity) :
+    _name(name)
+{
+    xbt_assert(capacity > 0 && (capacity & (capacity - 1)) == 0,
+               "Invalid shared memory capacity %lu: it must be a power of two", (unsigned long) capacity);
+
+    // The object is never taken over, as it may belong to another running instance
+    int fd = shm_open(_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    xbt_assert(fd >= 0 || errno != EEXIST,
+               "Cannot create shared memory object '%s': it already exists. Another Batsim instance may be "
+               "using it. If it has been left by a previous run, remove it (/dev/shm%s) or use another endpoint.",
+               _name.c_str(), _name.c_str());
+    xbt_assert(fd >= 0, "Cannot create shared memory object '%s': %s", _name.c_str(), strerror(errno));
+
+    size_t size = batsim_shm_size(capacity);
+    int truncate_ret = ftruncate(fd, size);
+    (void) truncate_ret; // Avoids a warning if assertions are ignored
+    xbt_assert(truncate_ret == 0, "Cannot resize shared memory object '%s': %s", _name.c_str(), strerror(errno));
+
+    void * memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    xbt_assert(memory != MAP_FAILED, "Cannot map shared memory object '%s': %s", _name.c_str(), strerror(errno));
+
+    // The object is zero-filled by ftruncate. The magic number is written last, as it tells the scheduler the object is ready.
+    _header = (batsim_shm_header *) memory;
+    _header->version = BATSIM_SHM_VERSION;
+    _header->capacity = capacity;
+    __atomic_store_n(&_header->magic, BATSIM_SHM_MAGIC, __ATOMIC_RELEASE);
+
+    XBT_INFO("Shared memory object '%s' created (%lu bytes per ring)", _name.c_str(), (unsigned long) capacity);
+}
+
+SharedMemoryTransport::~SharedMemoryTransport()
+{
+    batsim_shm_detach(_header);
+    _header = nullptr;
+
+    shm_unlink(_name.c_str());
+}
+
+void SharedMemoryTransport::send(const char * data, size_t size)
+{
+    if (batsim_shm_send(_header, BATSIM_SHM_TO_SCHEDULER, data, size) != 0)
+    {
+        throw runtime_error("The scheduler left the shared memory object '" + _name + "'");
+    }
+}
+
+void SharedMemoryTransport::recv(string & message)
+{
+    uint64_t size;
+    if (batsim_shm_recv_size(_header, BATSIM_SHM_TO_BATSIM, &size) != 0)
+    {
+        throw runtime_error("The scheduler left the shared memory object '" + _name + "'");
+    }
+
+    // The size comes from the scheduler's process, which may have corrupted the ring
+    if (size > BATSIM_SHM_MAX_MESSAGE_SIZE)
+    {
+        throw runtime_error("Invalid message size " + to_string(size) + " read from the shared memory object '" +
+                            _name + "' (at most " + to_string(BATSIM_SHM_MAX_MESSAGE_SIZE) + " bytes are accepted)");
+    }
+
+    message.resize(size);
+    if (size > 0 && batsim_shm_read(_header, BATSIM_SHM_TO_BATSIM, &message[0], size) != 0)
+    {
+        throw runtime_error("The scheduler left the shared memory object '" + _name + "'");
+    }
+}
+
+bool SharedMemoryTransport::is_shm_endpoint(const string & endpoint)
+{
+    return endpoint.compare(0, 6, "shm://") == 0;
+}
+
+string SharedMemoryTransport::shm_name(const string & endpoint)
+{
+    string name = endpoint.substr(6);
+    if (name.empty() || name[0] != '/')
+    {
+        name = '/' + name;
+    }
+    return name;
+}
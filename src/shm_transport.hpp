@@ -0,0 +1,72 @@
+/**
+ * @file shm_transport.hpp
+ * @brief Contains the shared-memory transport between Batsim and a co-located scheduler
+ */
+
+#pragma once
+
+#include <string>
+
+#include "batsim_shm.h"
+
+/**
+ * @brief Batsim's side of the shared-memory transport (see batsim_shm.h)
+ * @details It replaces the ZeroMQ socket when Batsim's socket endpoint is "shm://<name>".
+ *          Batsim creates the shared memory object, which the scheduler attaches to with
+ *          batsim_shm_attach. The object is removed when the SharedMemoryTransport is destroyed.
+ */
+class SharedMemoryTransport
+{
+public:
+    /**
+     * @brief Creates the shared memory object
+     * @param[in] name The name of the shared memory object (e.g. "/batsim")
+     * @param[in] capacity The size of the data area of each ring. Must be a power of two.
+     */
+    explicit SharedMemoryTransport(const std::string & name,
+                                   uint64_t capacity = BATSIM_SHM_DEFAULT_CAPACITY);
+
+    /**
+     * @brief SharedMemoryTransport cannot be copied.
+     * @param[in] other Another instance
+     */
+    SharedMemoryTransport(const SharedMemoryTransport & other) = delete;
+
+    /**
+     * @brief Tells the scheduler Batsim leaves, then removes the shared memory object
+     */
+    ~SharedMemoryTransport();
+
+    /**
+     * @brief Sends a message to the scheduler
+     * @param[in] data The message bytes
+     * @param[in] size The message size
+     * @throw std::runtime_error if the scheduler left
+     */
+    void send(const char * data, size_t size);
+
+    /**
+     * @brief Waits for a message from the scheduler
+     * @param[out] message The received message
+     * @throw std::runtime_error if the scheduler left
+     */
+    void recv(std::string & message);
+
+    /**
+     * @brief Returns whether a string is a shared-memory endpoint ("shm://<name>")
+     * @param[in] endpoint The endpoint
+     * @return Whether the endpoint is a shared-memory endpoint
+     */
+    static bool is_shm_endpoint(const std::string & endpoint);
+
+    /**
+     * @brief Returns the name of the shared memory object of a shared-memory endpoint
+     * @param[in] endpoint The endpoint ("shm://<name>")
+     * @return The name of the shared memory object, with a leading '/'
+     */
+    static std::string shm_name(const std::string & endpoint);
+
+private:
+    std::string _name; //!< The name of the shared memory object
+    batsim_shm_header * _header = nullptr; //!< The mapped shared memory object
+};
@@ -0,0 +1,100 @@
+/**
+ * @file telemetry.cpp
+ * @brief Contains the periodic emission of the simulation progress (telemetry)
+ */
+
+#include "telemetry.hpp"
+
+#include <xbt.h>
+
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+using namespace std;
+using namespace rapidjson;
+
+TelemetryEmitter::TelemetryEmitter(const string & destination,
+                                   double interval,
+                                   zmq::context_t & zmq_context) :
+    _interval(chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(interval))),
+    _start(chrono::steady_clock::now()),
+    _next_emission(_start + _interval),
+    _last_emission(_start)
+{
+    xbt_assert(interval >= 0, "Invalid telemetry interval %g: it should be non-negative", interval);
+
+    if (is_zmq_endpoint(destination))
+    {
+        _socket = new zmq::socket_t(zmq_context, ZMQ_PUB);
+        _socket->bind(destination);
+    }
+    else
+    {
+        _file.open(destination, ios::app);
+        xbt_assert(_file.is_open(), "Cannot open telemetry file '%s' for writing", destination.c_str());
+    }
+}
+
+TelemetryEmitter::~TelemetryEmitter()
+{
+    delete _socket;
+    _socket = nullptr;
+}
+
+bool TelemetryEmitter::is_zmq_endpoint(const string & destination)
+{
+    return destination.find("://") != string::npos;
+}
+
+void TelemetryEmitter::emit(const TelemetrySample & sample)
+{
+    auto now = chrono::steady_clock::now();
+    double real_time = chrono::duration<double>(now - _start).count();
+    double elapsed = chrono::duration<double>(now - _last_emission).count();
+
+    double messages_per_second = 0;
+    double simulation_time_per_second = 0;
+    if (elapsed > 0)
+    {
+        messages_per_second = (_nb_messages - _last_nb_messages) / elapsed;
+        simulation_time_per_second = (sample.simulation_time - _last_simulation_time) / elapsed;
+    }
+
+    StringBuffer buffer;
+    Writer<StringBuffer> writer(buffer);
+    writer.StartObject();
+    writer.Key("real_time"); writer.Double(real_time);
+    writer.Key("simulation_time"); writer.Double(sample.simulation_time);
+    writer.Key("nb_messages"); writer.Int64(_nb_messages);
+    writer.Key("messages_per_second"); writer.Double(messages_per_second);
+    writer.Key("simulation_time_per_second"); writer.Double(simulation_time_per_second);
+    writer.Key("nb_submitted_jobs"); writer.Int(sample.nb_submitted_jobs);
+    writer.Key("nb_running_jobs"); writer.Int(sample.nb_running_jobs);
+    writer.Key("nb_completed_jobs"); writer.Int(sample.nb_completed_jobs);
+    writer.Key("nb_processes"); writer.Int(sample.nb_processes);
+    writer.Key("writer_nb_events"); writer.Int(sample.writer_nb_events);
+    writer.Key("paje_buffered_bytes"); writer.Int64(sample.paje_buffered_bytes);
+    writer.Key("energy_buffered_bytes"); writer.Int64(sample.energy_buffered_bytes);
+    writer.Key("pstate_buffered_bytes"); writer.Int64(sample.pstate_buffered_bytes);
+    writer.Key("machine_states_buffered_bytes"); writer.Int64(sample.machine_states_buffered_bytes);
+    writer.Key("background_pending_bytes"); writer.Int64(sample.background_pending_bytes);
+    writer.EndObject();
+
+    if (_socket != nullptr)
+    {
+        // PUB sockets never block: records are dropped if no subscriber keeps up
+        _socket->send(buffer.GetString(), buffer.GetSize());
+    }
+    else
+    {
+        // Records are flushed one by one, so that the file can be followed while the simulation runs
+        _file.write(buffer.GetString(), buffer.GetSize());
+        _file.put('\n');
+        _file.flush();
+    }
+
+    _last_emission = now;
+    _next_emission = now + _interval;
+    _last_nb_messages = _nb_messages;
+    _last_simulation_time = sample.simulation_time;
+}
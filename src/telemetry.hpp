@@ -0,0 +1,98 @@
+/**
+ * @file telemetry.hpp
+ * @brief Contains the periodic emission of the simulation progress (telemetry)
+ */
+
+#pragma once
+
+#include <chrono>
+#include <fstream>
+#include <string>
+
+#include <zmq.hpp>
+
+/**
+ * @brief The state of the simulation at the time a telemetry record is emitted
+ */
+struct TelemetrySample
+{
+    double simulation_time = 0; //!< The simulated time (in seconds)
+    int nb_submitted_jobs = 0; //!< The number of jobs submitted so far
+    int nb_running_jobs = 0; //!< The number of jobs being executed
+    int nb_completed_jobs = 0; //!< The number of jobs completed so far
+    int nb_processes = 0; //!< The number of live SimGrid processes
+    int writer_nb_events = 0; //!< The number of events waiting in the protocol writer
+    long long paje_buffered_bytes = 0; //!< The number of bytes buffered by the Pajé tracer
+    long long energy_buffered_bytes = 0; //!< The number of bytes buffered by the energy consumption tracer
+    long long pstate_buffered_bytes = 0; //!< The number of bytes buffered by the power state changes tracer
+    long long machine_states_buffered_bytes = 0; //!< The number of bytes buffered by the machine states tracer
+    long long background_pending_bytes = 0; //!< The number of bytes waiting to be written by the BackgroundWriter
+};
+
+/**
+ * @brief Periodically emits the simulation progress, as one JSON object per line
+ * @details Records are emitted at most once per wall-clock interval, either on a ZeroMQ PUB socket
+ *          (if the destination is an endpoint such as tcp://0.0.0.0:28001) or at the end of a file.
+ *          Besides the TelemetrySample fields, each record contains the real time elapsed since
+ *          the emitter creation and the rates of handled messages and simulated time over the
+ *          last interval.
+ */
+class TelemetryEmitter
+{
+public:
+    /**
+     * @brief Builds a TelemetryEmitter
+     * @param[in] destination The ZeroMQ endpoint the PUB socket binds to, or the name of the file to append records to
+     * @param[in] interval The minimum wall-clock time between two records (in seconds)
+     * @param[in] zmq_context The ZeroMQ context in which the PUB socket is created
+     */
+    TelemetryEmitter(const std::string & destination,
+                     double interval,
+                     zmq::context_t & zmq_context);
+
+    /**
+     * @brief TelemetryEmitter cannot be copied.
+     * @param[in] other Another instance
+     */
+    TelemetryEmitter(const TelemetryEmitter & other) = delete;
+
+    /**
+     * @brief Destroys a TelemetryEmitter
+     */
+    ~TelemetryEmitter();
+
+    /**
+     * @brief Returns whether a telemetry destination is a ZeroMQ endpoint (rather than a file name)
+     * @param[in] destination The telemetry destination
+     * @return Whether the destination is a ZeroMQ endpoint
+     */
+    static bool is_zmq_endpoint(const std::string & destination);
+
+    /**
+     * @brief Counts a message handled by the server
+     */
+    void count_message() { ++_nb_messages; }
+
+    /**
+     * @brief Returns whether the interval since the last record has elapsed
+     * @return Whether a record should be emitted
+     */
+    bool is_due() const { return std::chrono::steady_clock::now() >= _next_emission; }
+
+    /**
+     * @brief Emits a record
+     * @param[in] sample The state of the simulation
+     */
+    void emit(const TelemetrySample & sample);
+
+private:
+    zmq::socket_t * _socket = nullptr; //!< The PUB socket, if the destination is a ZeroMQ endpoint
+    std::ofstream _file; //!< The file records are appended to, if the destination is a file
+    std::chrono::steady_clock::duration _interval; //!< The minimum wall-clock time between two records
+    std::chrono::steady_clock::time_point _start; //!< When the emitter has been created
+    std::chrono::steady_clock::time_point _next_emission; //!< From when the next record can be emitted
+    std::chrono::steady_clock::time_point _last_emission; //!< When the previous record has been emitted
+    long long _nb_messages = 0; //!< The number of messages handled by the server
+    long long _last_nb_messages = 0; //!< The number of messages handled by the server when the previous record has been emitted
+    double _last_simulation_time = 0; //!< The simulated time when the previous record has been emitted
+};
@@ -0,0 +1,112 @@
+#include "test_binary_workload.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <string>
+
+#include <xbt.h>
+
+#include <rapidjson/document.h>
+
+#include "../binary_workload.hpp"
+#include "../jobs.hpp"
+#include "../profiles.hpp"
+#include "../workload.hpp"
+
+using namespace std;
+using namespace rapidjson;
+
+void test_binary_workload()
+{
+    char json_filename[] = "/tmp/batsim_workload_json_XXXXXX";
+    int fd = mkstemp(json_filename);
+    xbt_assert(fd != -1, "Cannot create a temporary file");
+    close(fd);
+
+    ofstream json_file(json_filename);
+    json_file << R"({
+  "nb_res": 4,
+  "jobs": [
+    {"id": 1, "subtime": 10, "walltime": 100, "res": 4, "profile": "a", "extra": {"x": [1, 2]}},
+    {"id": 2, "subtime": 0.5, "res": 1, "profile": "b"},
+    {"id": 3, "subtime": 10, "res": 1, "profile": "b"}
+  ],
+  "profiles": {"a": {"type": "delay", "delay": 5}, "b": {"type": "delay", "delay": 1}}
+})";
+    json_file.close();
+
+    char binary_filename[] = "/tmp/batsim_workload_bin_XXXXXX";
+    fd = mkstemp(binary_filename);
+    xbt_assert(fd != -1, "Cannot create a temporary file");
+    close(fd);
+
+    Workload json_workload("w0", json_filename);
+    int nb_res = -1;
+    json_workload.load_from_json(json_filename, nb_res);
+    write_binary_workload(&json_workload, nb_res, binary_filename);
+    unlink(json_filename);
+
+    xbt_assert(BinaryWorkloadFile::is_binary_workload(binary_filename), "The binary workload is not detected");
+    xbt_assert(!BinaryWorkloadFile::is_binary_workload("/dev/null"), "An empty file is detected as binary workload");
+
+    // Records must be sorted by submission time then number
+    {
+        BinaryWorkloadFile file(binary_filename);
+        xbt_assert(file.header().nb_res == 4, "Invalid nb_res %d", file.header().nb_res);
+        xbt_assert(file.header().nb_jobs == 3 && file.header().nb_profiles == 2, "Invalid numbers of records");
+        const int expected_numbers[] = {2, 1, 3};
+        for (int i = 0; i < 3; ++i)
+        {
+            xbt_assert(file.job(i).number == expected_numbers[i], "Invalid job record %d", i);
+        }
+    }
+
+    for (bool lazy : {false, true})
+    {
+        Workload binary_workload("w1", binary_filename);
+        int binary_nb_res = -1;
+        binary_workload.load_from_binary(binary_filename, binary_nb_res, lazy);
+        xbt_assert(binary_nb_res == 4, "Invalid nb_res %d", binary_nb_res);
+        xbt_assert(binary_workload.profiles->nb_profiles() == 2, "Invalid number of profiles");
+        xbt_assert(binary_workload.profiles->at("a")->json_description == json_workload.profiles->at("a")->json_description,
+                   "Profile 'a' has been modified");
+
+        if (lazy)
+        {
+            // The records are not copied into an index
+            xbt_assert(binary_workload.lazy_jobs.empty() && binary_workload.jobs->nb_jobs() == 0,
+                       "Jobs should neither be indexed nor built in lazy mode");
+            const uint64_t nb_jobs = binary_workload.binary_file()->header().nb_jobs;
+            xbt_assert(nb_jobs == 3, "Invalid number of job records %d", (int) nb_jobs);
+            for (uint64_t i = 0; i < nb_jobs; ++i)
+            {
+                binary_workload.materialize_binary_job(i);
+            }
+        }
+        xbt_assert(binary_workload.jobs->nb_jobs() == 3, "Invalid number of jobs %d", binary_workload.jobs->nb_jobs());
+
+        for (const Job * expected : json_workload.jobs->jobs())
+        {
+            const Job * job = binary_workload.jobs->at(expected->number);
+            xbt_assert(job->submission_time == expected->submission_time && job->walltime == expected->walltime &&
+                       job->required_nb_res == expected->required_nb_res && job->profile == expected->profile,
+                       "Job %d has been modified", expected->number);
+
+            Document description;
+            description.Parse(job->json_description.c_str());
+            xbt_assert(!description.HasParseError() && description.IsObject(), "Invalid description '%s'",
+                       job->json_description.c_str());
+            xbt_assert(description["id"].GetString() == "w1!" + to_string(job->number), "Invalid id in '%s'",
+                       job->json_description.c_str());
+            xbt_assert(description.HasMember("subtime") && description.HasMember("res") &&
+                       description.HasMember("profile"), "Missing members in '%s'", job->json_description.c_str());
+        }
+        xbt_assert(binary_workload.jobs->at(1)->json_description.find(R"("extra":{"x":[1,2]})") != string::npos,
+                   "Unused members should be kept: '%s'", binary_workload.jobs->at(1)->json_description.c_str());
+    }
+
+    unlink(binary_filename);
+}
@@ -2,12 +2,23 @@
 
 #include <stdio.h>
 
+#include <fstream>
+#include <iterator>
+#include <string>
+
 #include "../export.hpp"
 
 void test_buffered_writer()
 {
     const char * filename = "/tmp/test_wbuf";
-    WriteBuffer * buf = new WriteBuffer(filename, 4);
+    WriteBuffer * buf = new WriteBuffer(filename, nullptr, 4);
+
+    // Buffered bytes are counted until they are flushed
+    buf->append_text("ok");
+    xbt_assert(buf->nb_buffered_bytes() == 2, "Invalid number of buffered bytes (%zu)", buf->nb_buffered_bytes());
+    buf->flush_buffer();
+    xbt_assert(buf->nb_buffered_bytes() == 0, "Invalid number of buffered bytes after flush (%zu)",
+               buf->nb_buffered_bytes());
 
     // Smaller than the buffer size
     for (int i = 0; i < 10; ++i)
@@ -68,3 +79,59 @@ void test_pstate_writer()
     int remove_ret = remove(filename);
     xbt_assert(remove_ret == 0, "Could not remove file '%s'.", filename);
 }
+
+void test_background_writer()
+{
+    const char * direct_filename = "/tmp/test_wbuf_direct";
+    const char * background_filename = "/tmp/test_wbuf_background";
+    BackgroundWriter * background_writer = new BackgroundWriter;
+    WriteBuffer * direct_buf = new WriteBuffer(direct_filename, nullptr, 16);
+    WriteBuffer * background_buf = new WriteBuffer(background_filename, background_writer, 16);
+
+    // Buffered bytes are counted until they are flushed, then until they are written
+    direct_buf->append_text("0123456789");
+    background_buf->append_text("0123456789");
+    xbt_assert(background_buf->nb_buffered_bytes() == 10, "Invalid number of buffered bytes (%zu)",
+               background_buf->nb_buffered_bytes());
+    background_buf->flush_buffer();
+    xbt_assert(background_buf->nb_buffered_bytes() == 0, "Invalid number of buffered bytes after flush (%zu)",
+               background_buf->nb_buffered_bytes());
+    xbt_assert(background_writer->nb_pending_bytes() <= 10, "Invalid number of pending bytes (%zu)",
+               background_writer->nb_pending_bytes());
+    background_writer->wait_until_idle();
+    xbt_assert(background_writer->nb_pending_bytes() == 0, "Invalid number of pending bytes once idle (%zu)",
+               background_writer->nb_pending_bytes());
+
+    // Texts smaller and bigger than the buffer, with some explicit flushes
+    for (int i = 0; i < 1000; ++i)
+    {
+        const std::string text = std::to_string(i) + (i % 7 == 0 ? " is a line bigger than the buffer\n" : "\n");
+        direct_buf->append_text(text.c_str());
+        background_buf->append_text(text.c_str());
+
+        if (i % 100 == 0)
+        {
+            direct_buf->flush_buffer();
+            background_buf->flush_buffer();
+        }
+    }
+
+    // Flush content, close files and release memory
+    delete direct_buf;
+    delete background_buf;
+    delete background_writer;
+
+    // Both files should have the same content
+    std::ifstream direct_file(direct_filename);
+    std::ifstream background_file(background_filename);
+    const std::string direct_content((std::istreambuf_iterator<char>(direct_file)), std::istreambuf_iterator<char>());
+    const std::string background_content((std::istreambuf_iterator<char>(background_file)), std::istreambuf_iterator<char>());
+    xbt_assert(!direct_content.empty() && direct_content == background_content,
+               "The files written directly and in background differ");
+
+    // Remove temporary files
+    int remove_ret = remove(direct_filename);
+    xbt_assert(remove_ret == 0, "Could not remove file '%s'.", direct_filename);
+    remove_ret = remove(background_filename);
+    xbt_assert(remove_ret == 0, "Could not remove file '%s'.", background_filename);
+}
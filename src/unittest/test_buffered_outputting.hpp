@@ -2,3 +2,4 @@
 
 void test_buffered_writer();
 void test_pstate_writer();
+void test_background_writer();
@@ -0,0 +1,82 @@
+#include "test_compression.hpp"
+
+#include <string>
+
+#include <xbt.h>
+
+#include <zstd.h>
+
+#include "../compression.hpp"
+#include "../msgpack.hpp"
+#include "test_protocol_reader.hpp"
+
+using namespace std;
+
+void test_wrapper_compression_roundtrip(MessageCompressor & compressor, const string & message)
+{
+    ProtocolMessage compressed = compressor.compress({message.data(), message.size()});
+    xbt_assert(MessageCompressor::is_compressed(compressed.data, compressed.size),
+               "The compressed message (%zu bytes) is not detected as compressed", message.size());
+    xbt_assert(!MessageCompressor::is_compressed(message.data(), message.size()),
+               "The uncompressed message (%zu bytes) is detected as compressed", message.size());
+
+    // The compressed bytes are copied, as decompress could be given the compressor's own buffer
+    const string compressed_copy(compressed.data, compressed.size);
+    const string & decompressed = compressor.decompress(compressed_copy.data(), compressed_copy.size());
+    xbt_assert(decompressed == message, "Compression round trip changed a %zu-byte message", message.size());
+}
+
+void test_message_compression()
+{
+    MessageCompressor compressor(3);
+
+    test_wrapper_compression_roundtrip(compressor, "{}");
+    test_wrapper_compression_roundtrip(compressor, "{\"now\":1.5,\"events\":[]}");
+
+    // A big message, similar to what a large workload submission looks like
+    string big = "{\"now\":0,\"events\":[";
+    for (int i = 0; i < 10000; ++i)
+    {
+        if (i > 0)
+        {
+            big += ",";
+        }
+        big += "{\"timestamp\":0,\"type\":\"JOB_SUBMITTED\",\"data\":{\"job_id\":\"w0!" + to_string(i) + "\"}}";
+    }
+    big += "]}";
+    test_wrapper_compression_roundtrip(compressor, big);
+
+    // Buffers are reused between messages
+    test_wrapper_compression_roundtrip(compressor, "{\"now\":2,\"events\":[]}");
+
+    // MessagePack messages can be compressed too
+    string msgpack_message;
+    MsgpackWriter writer(msgpack_message);
+    writer.StartObject();
+    writer.Key("now", 3, false);
+    writer.Double(42);
+    writer.EndObject(1);
+    test_wrapper_compression_roundtrip(compressor, msgpack_message);
+
+    // The messages bigger than the maximum size are rejected, whether their header gives their size or not
+    MessageCompressor bounded_compressor(3, 1000);
+    test_wrapper_compression_roundtrip(bounded_compressor, string(1000, 'a'));
+
+    const string too_big(1001, 'a');
+    const ProtocolMessage sized = compressor.compress({too_big.data(), too_big.size()});
+    const string sized_frame(sized.data, sized.size);
+    xbt_assert(test_wrapper_aborts([&]() { bounded_compressor.decompress(sized_frame.data(), sized_frame.size()); }),
+               "Decompressing a message whose header announces too many bytes should fail");
+
+    ZSTD_CCtx * context = ZSTD_createCCtx();
+    ZSTD_CCtx_setParameter(context, ZSTD_c_contentSizeFlag, 0);
+    string unsized_frame(ZSTD_compressBound(too_big.size()), '\0');
+    size_t unsized_size = ZSTD_compress2(context, &unsized_frame[0], unsized_frame.size(), too_big.data(), too_big.size());
+    ZSTD_freeCCtx(context);
+    xbt_assert(!ZSTD_isError(unsized_size), "Cannot compress message: %s", ZSTD_getErrorName(unsized_size));
+    unsized_frame.resize(unsized_size);
+    xbt_assert(ZSTD_getFrameContentSize(unsized_frame.data(), unsized_frame.size()) == ZSTD_CONTENTSIZE_UNKNOWN,
+               "The frame should not give its content size");
+    xbt_assert(test_wrapper_aborts([&]() { bounded_compressor.decompress(unsized_frame.data(), unsized_frame.size()); }),
+               "Decompressing a message bigger than the maximum size should fail");
+}
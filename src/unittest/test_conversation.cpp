@@ -0,0 +1,49 @@
+#include "test_conversation.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include <xbt.h>
+
+#include "../conversation.hpp"
+
+using namespace std;
+
+void test_conversation_record_replay()
+{
+    char filename[] = "/tmp/batsim_conversation_XXXXXX";
+    int fd = mkstemp(filename);
+    xbt_assert(fd != -1, "Cannot create a temporary file");
+    close(fd);
+
+    const vector<string> sent = {"{\"now\":0,\"events\":[]}", "", string(300, 'x'), string("\0\x01\xff", 3)};
+    const vector<string> replies = {"{\"now\":1,\"events\":[]}", string(70000, 'y'), "", "{}"};
+    const vector<long> latencies = {0, 127, 128, 123456789012};
+
+    {
+        ConversationRecorder recorder(filename);
+        for (unsigned int i = 0; i < sent.size(); ++i)
+        {
+            recorder.record_exchange({sent[i].data(), sent[i].size()}, replies[i], chrono::nanoseconds(latencies[i]));
+        }
+        recorder.flush();
+    }
+
+    ConversationReplayer replayer(filename);
+    for (unsigned int i = 0; i < sent.size(); ++i)
+    {
+        xbt_assert(!replayer.is_finished(), "Conversation replay stopped after %u exchanges", i);
+
+        chrono::nanoseconds latency;
+        const string & reply = replayer.replay_exchange({sent[i].data(), sent[i].size()}, latency);
+        xbt_assert(reply == replies[i], "Exchange %u: the replayed reply differs from the recorded one", i);
+        xbt_assert(latency.count() == latencies[i], "Exchange %u: the replayed latency differs from the recorded one", i);
+    }
+    xbt_assert(replayer.is_finished(), "Conversation replay has more exchanges than recorded");
+
+    remove(filename);
+}
@@ -0,0 +1,49 @@
+#include "test_histogram.hpp"
+
+#include <stdint.h>
+
+#include <xbt.h>
+
+#include "../histogram.hpp"
+
+using namespace std;
+
+void test_histogram()
+{
+    Histogram histogram(5);
+    xbt_assert(histogram.value_at_percentile(50) == 0, "Empty histograms should have null percentiles");
+
+    // Small values are counted exactly
+    for (uint64_t value = 0; value < 32; ++value)
+    {
+        histogram.record(value);
+    }
+    for (int bucket = 0; bucket < 32; ++bucket)
+    {
+        xbt_assert(histogram.bucket_lower_bound(bucket) == (uint64_t) bucket &&
+                   histogram.bucket_upper_bound(bucket) == (uint64_t) bucket &&
+                   histogram.bucket_count(bucket) == 1, "Invalid exact bucket %d", bucket);
+    }
+
+    // Bigger values fall in contiguous buckets whose width is bounded by the precision
+    histogram.record(1000);
+    histogram.record(123456789);
+    histogram.record(UINT64_MAX);
+    for (int bucket = 0; bucket + 1 < histogram.nb_buckets(); ++bucket)
+    {
+        uint64_t lower = histogram.bucket_lower_bound(bucket);
+        uint64_t upper = histogram.bucket_upper_bound(bucket);
+        xbt_assert(upper + 1 == histogram.bucket_lower_bound(bucket + 1), "Buckets %d and %d are not contiguous", bucket, bucket + 1);
+        xbt_assert((upper - lower) * 16 <= lower, "Bucket %d is too wide", bucket);
+    }
+    xbt_assert(histogram.bucket_upper_bound(histogram.nb_buckets() - 1) == UINT64_MAX, "The last bucket should end at UINT64_MAX");
+
+    xbt_assert(histogram.count() == 35, "Invalid count");
+    xbt_assert(histogram.min() == 0 && histogram.max() == UINT64_MAX, "Invalid min or max");
+    xbt_assert(histogram.value_at_percentile(0) == 0, "Invalid 0th percentile");
+    xbt_assert(histogram.value_at_percentile(50) == 17, "Invalid median");
+    xbt_assert(histogram.value_at_percentile(100) == UINT64_MAX, "Invalid 100th percentile");
+
+    uint64_t p94 = histogram.value_at_percentile(94); // 33rd value: 1000
+    xbt_assert(p94 >= 1000 && p94 <= 1000 + 1000 / 16, "Invalid 94th percentile (%lu)", (unsigned long) p94);
+}
@@ -0,0 +1,206 @@
+#include "test_jobs.hpp"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <xbt.h>
+
+#include "../context.hpp"
+#include "../ipp.hpp"
+#include "../jobs.hpp"
+#include "../profiles.hpp"
+#include "../protocol.hpp"
+#include "../server.hpp"
+#include "../workload.hpp"
+
+using namespace std;
+
+void test_jobs_storage()
+{
+    Jobs jobs;
+
+    // Dense numbers, a hole, numbers far beyond the others and negative numbers
+    vector<int> numbers;
+    for (int i = 1; i <= 100; ++i)
+    {
+        numbers.push_back(i);
+    }
+    numbers.push_back(300);
+    numbers.push_back(1000000000);
+    numbers.push_back(-3);
+    numbers.push_back(5000); // Stored in the hash table, then in the range of the vector once it has grown
+    for (int i = 101; i <= 6000; ++i)
+    {
+        if (i != 300 && i != 5000)
+        {
+            numbers.push_back(i);
+        }
+    }
+
+    for (int number : numbers)
+    {
+        Job * job = new Job;
+        job->number = number;
+        jobs.add_job(job);
+    }
+
+    xbt_assert(jobs.nb_jobs() == (int) numbers.size(), "Invalid number of jobs %d", jobs.nb_jobs());
+    for (int number : numbers)
+    {
+        xbt_assert(jobs.exists(number), "Job %d should exist", number);
+        xbt_assert(jobs.at(number)->number == number, "Job %d is not the expected one", number);
+    }
+    for (int number : {0, -1, 6001, 999999999})
+    {
+        xbt_assert(!jobs.exists(number), "Job %d should not exist", number);
+        xbt_assert(jobs.find(number) == nullptr, "Job %d should not be found", number);
+    }
+
+    // Jobs must be iterated by increasing number, whatever their storage
+    vector<Job *> sorted_jobs = jobs.jobs();
+    xbt_assert(sorted_jobs.size() == numbers.size(), "Invalid number of iterated jobs %zu", sorted_jobs.size());
+    xbt_assert(sorted_jobs.front()->number == -3 && sorted_jobs.back()->number == 1000000000,
+               "Invalid iteration bounds");
+    for (size_t i = 1; i < sorted_jobs.size(); ++i)
+    {
+        xbt_assert(sorted_jobs[i - 1]->number < sorted_jobs[i]->number, "Jobs are not iterated by increasing number");
+    }
+}
+
+void test_job_identifiers()
+{
+    // Workload names are interned once
+    JobIdentifier w0_1("test_w0", 1);
+    JobIdentifier w1_1("test_w1", 1);
+    xbt_assert(JobIdentifier("test_w0", 1) == w0_1, "Identical job identifiers should be equal");
+    xbt_assert(w0_1 != w1_1 && w0_1.key() != w1_1.key(), "Different workloads should give different identifiers");
+    xbt_assert(JobIdentifier::intern_workload_name("test_w0") == w0_1.workload_id, "A workload name should be interned once");
+    xbt_assert(w1_1.workload_name() == "test_w1", "Invalid workload name '%s'", w1_1.workload_name().c_str());
+
+    // Formatting reuses the given string
+    string buffer;
+    JobIdentifier(w0_1.workload_id, 42).to_string(buffer);
+    xbt_assert(buffer == "test_w0!42", "Invalid job identifier string '%s'", buffer.c_str());
+    JobIdentifier(w1_1.workload_id, -7).to_string(buffer);
+    xbt_assert(buffer == "test_w1!-7", "Invalid job identifier string '%s'", buffer.c_str());
+
+    // Parsing
+    JobIdentifier job_id;
+    bool has_workload_name = false;
+    string valid = "test_w1!123";
+    xbt_assert(JobIdentifier::parse(valid.data(), valid.size(), job_id, has_workload_name),
+               "'%s' should be valid", valid.c_str());
+    xbt_assert(has_workload_name && job_id == JobIdentifier(w1_1.workload_id, 123),
+               "'%s' has been parsed as '%s'", valid.c_str(), job_id.to_string().c_str());
+
+    // As in a simulation, the 'static' workload is known before the identifiers are parsed
+    JobIdentifier::intern_workload_name("static");
+    string without_workload = "5";
+    xbt_assert(JobIdentifier::parse(without_workload.data(), without_workload.size(), job_id, has_workload_name),
+               "'%s' should be valid", without_workload.c_str());
+    xbt_assert(!has_workload_name && job_id.workload_name() == "static" && job_id.job_number == 5,
+               "'%s' has been parsed as '%s'", without_workload.c_str(), job_id.to_string().c_str());
+
+    // Unknown workload names are only interned on request
+    string unknown = "test_unknown_w!3";
+    xbt_assert(JobIdentifier::parse(unknown.data(), unknown.size(), job_id, has_workload_name),
+               "'%s' should be valid", unknown.c_str());
+    xbt_assert(job_id.workload_id == -1 && job_id.job_number == 3 && job_id.workload_name().empty(),
+               "The workload name of '%s' should not have been interned", unknown.c_str());
+    xbt_assert(JobIdentifier::parse(unknown.data(), unknown.size(), job_id, has_workload_name, true),
+               "'%s' should be valid", unknown.c_str());
+    xbt_assert(job_id.workload_id >= 0 && job_id.workload_name() == "test_unknown_w",
+               "The workload name of '%s' should have been interned", unknown.c_str());
+
+    const vector<string> invalid_ids = {"", "test_w0!", "test_w0!1!2", "test_w0!12a", "test_w0!2147483648"};
+    for (const string & invalid : invalid_ids)
+    {
+        xbt_assert(!JobIdentifier::parse(invalid.data(), invalid.size(), job_id, has_workload_name),
+                   "'%s' should be invalid", invalid.c_str());
+    }
+
+    // Hashed containers
+    unordered_map<JobIdentifier, int> origins;
+    origins[w0_1] = 0;
+    origins[w1_1] = 1;
+    xbt_assert(origins.size() == 2 && origins.at(JobIdentifier("test_w1", 1)) == 1, "Invalid hashed lookup");
+}
+
+void test_completed_job_release()
+{
+    // Without metadata, the rarely used data is freed
+    Job * job = new Job;
+    job->json_description = R"({"id":"1","subtime":0,"res":4,"profile":"delay"})";
+    job->cold_data().kill_reason = "Walltime reached";
+    job->cold_data().incoming_message_buffer.push_back("message");
+    job->release_completed_job_data();
+    xbt_assert(job->json_description.empty() && job->json_description.capacity() < 32,
+               "The description of a completed job should be freed");
+    xbt_assert(job->cold == nullptr && job->task == nullptr,
+               "The rarely used data of a completed job without metadata should be freed");
+    delete job;
+
+    // The metadata is kept for the jobs output file
+    job = new Job;
+    job->cold_data().metadata = "scheduler metadata";
+    job->cold_data().smpi_ranks_to_hosts_mapping = {0, 1, 2, 3};
+    job->cold_data().kill_reason = "Killed by the scheduler";
+    job->release_completed_job_data();
+    xbt_assert(job->cold != nullptr && job->metadata() == "scheduler metadata",
+               "The metadata of a completed job should be kept");
+    xbt_assert(job->kill_reason().empty() && job->cold->smpi_ranks_to_hosts_mapping.capacity() == 0,
+               "The other rarely used data of a completed job should be freed");
+    delete job;
+
+    // Killed jobs are released once their progress has been sent to the scheduler
+    BatsimContext context;
+    context.redis_enabled = false;
+    context.protocol_decimal_places = -1;
+    context.protocol_compact_resources = false;
+    JsonProtocolWriter writer(&context);
+    context.proto_writer = &writer;
+
+    Workload * workload = new Workload("test_killed_w0", "test_killed_w0.json");
+    Profile * profile = new Profile;
+    profile->type = ProfileType::DELAY;
+    profile->data = nullptr;
+    profile->name = "delay";
+    workload->profiles->add_profile(profile->name, profile);
+
+    job = new Job;
+    job->number = 1;
+    job->profile = profile->name;
+    job->json_description = R"({"id":"test_killed_w0!1","res":1,"profile":"delay"})";
+    job->cold_data().kill_reason = "Killed by the scheduler";
+    job->task = new BatTask(job, profile);
+    job->task->delay_task_start = 0;
+    job->task->current_task_progress_ratio = 0.5;
+    job->state = JobState::JOB_STATE_COMPLETED_KILLED;
+    workload->jobs->add_job(job);
+    context.workloads.insert_workload(workload->name, workload);
+
+    ServerData data;
+    data.context = &context;
+    data.nb_submitters = 1;
+    data.nb_submitted_jobs = 1;
+    data.nb_running_jobs = 1;
+    data.nb_killers = 1;
+
+    KillingDoneMessage * killing_done = new KillingDoneMessage;
+    killing_done->jobs_ids = {JobIdentifier("test_killed_w0", 1)};
+    killing_done->jobs_progress[JobIdentifier("test_killed_w0", 1)] = job->task;
+    IPMessage * message = new IPMessage;
+    message->type = IPMessageType::KILLING_DONE;
+    message->data = (void *) killing_done;
+    handle_server_message(server_message_handlers(), &data, message);
+
+    xbt_assert(data.nb_completed_jobs == 1 && data.nb_killers == 0, "The kill has not been handled");
+    xbt_assert(job->json_description.empty() && job->cold == nullptr && job->task == nullptr,
+               "The data of a killed job should be freed");
+    ProtocolMessage killed_event = writer.generate_current_message(0);
+    const string sent = string(killed_event.data, killed_event.size);
+    xbt_assert(sent.find(R"("job_progress":{"test_killed_w0!1":{"profile":"delay","progress":0.5}})") != string::npos,
+               "The progress of a killed job should be sent before its data is freed (%s)", sent.c_str());
+    context.proto_writer = nullptr;
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+void test_jobs_storage();
+void test_job_identifiers();
+void test_completed_job_release();
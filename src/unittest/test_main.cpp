@@ -2,10 +2,47 @@
 
 #include "test_numeric_strcmp.hpp"
 #include "test_buffered_outputting.hpp"
+#include "test_msgpack.hpp"
+#include "test_protocol_encoders.hpp"
+#include "test_protocol_reader.hpp"
+#include "test_protocol_writer.hpp"
+#include "test_compression.hpp"
+#include "test_conversation.hpp"
+#include "test_shm_transport.hpp"
+#include "test_histogram.hpp"
+#include "test_pool.hpp"
+#include "test_telemetry.hpp"
+#include "test_workload_index.hpp"
+#include "test_binary_workload.hpp"
+#include "test_jobs.hpp"
+#include "test_server.hpp"
 
 void test_entry_point()
 {
     test_numeric_strcmp();
     test_buffered_writer();
     test_pstate_writer();
+    test_background_writer();
+    test_msgpack_roundtrip();
+    test_protocol_encoders();
+    test_protocol_double_writing();
+    test_protocol_reader();
+    test_trusted_allocation_mapping();
+    test_execute_jobs_reading();
+    test_deferred_events();
+    test_job_submission_batching();
+    test_job_submission_through_server();
+    test_compact_resources();
+    test_message_compression();
+    test_conversation_record_replay();
+    test_shm_transport();
+    test_histogram();
+    test_pool();
+    test_telemetry();
+    test_workload_index();
+    test_binary_workload();
+    test_jobs_storage();
+    test_job_identifiers();
+    test_completed_job_release();
+    test_server_message_dispatch();
 }
@@ -0,0 +1,67 @@
+#include "test_msgpack.hpp"
+
+#include <string>
+
+#include <xbt.h>
+
+#include <rapidjson/document.h>
+
+#include "../msgpack.hpp"
+
+using namespace std;
+
+void test_wrapper_msgpack_roundtrip(const string & json)
+{
+    rapidjson::Document input;
+    input.Parse(json.c_str());
+    xbt_assert(!input.HasParseError(), "Invalid test input '%s'", json.c_str());
+
+    string encoded;
+    MsgpackWriter writer(encoded);
+    bool accepted = input.Accept(writer);
+    xbt_assert(accepted && writer.IsComplete(), "Could not encode '%s' in MessagePack", json.c_str());
+
+    rapidjson::Document output;
+    MsgpackReader reader(encoded.data(), encoded.size());
+    output.Populate(reader);
+    xbt_assert(!reader.has_parse_error(), "Could not decode the MessagePack encoding of '%s': %s",
+               json.c_str(), reader.parse_error().c_str());
+
+    xbt_assert(input == output, "MessagePack round trip of '%s' changed its content", json.c_str());
+}
+
+void test_msgpack_roundtrip()
+{
+    // Scalars
+    test_wrapper_msgpack_roundtrip("[null, true, false]");
+    test_wrapper_msgpack_roundtrip("[0, 1, 127, 128, 255, 256, 65535, 65536, 4294967295, 4294967296]");
+    test_wrapper_msgpack_roundtrip("[-1, -32, -33, -128, -129, -32768, -32769, -2147483648, -2147483649]");
+    test_wrapper_msgpack_roundtrip("[0.5, 1e-300, 1.7976931348623157e308, 42.123456789012345]");
+
+    // Strings of the different MessagePack string sizes
+    test_wrapper_msgpack_roundtrip("[\"\", \"w0!1\"]");
+    test_wrapper_msgpack_roundtrip("\"" + string(31, 'a') + "\"");
+    test_wrapper_msgpack_roundtrip("\"" + string(32, 'a') + "\"");
+    test_wrapper_msgpack_roundtrip("\"" + string(300, 'a') + "\"");
+    test_wrapper_msgpack_roundtrip("\"" + string(70000, 'a') + "\"");
+
+    // Nested containers
+    test_wrapper_msgpack_roundtrip("{}");
+    test_wrapper_msgpack_roundtrip("[[], {}, [[[]]]]");
+    test_wrapper_msgpack_roundtrip(R"({"now": 1024.24, "events": [{"timestamp": 1000, "type": "EXECUTE_JOB",)"
+                                   R"( "data": {"job_id": "w0!1", "alloc": "1 2 4-8", "mapping": {"0": "0"}}}]})");
+
+    // Integer map keys are decoded as strings
+    const char fixmap_int_key[] = {(char)0x81, (char)0x05, (char)0xa1, 'x'};
+    rapidjson::Document doc;
+    MsgpackReader reader(fixmap_int_key, sizeof(fixmap_int_key));
+    doc.Populate(reader);
+    xbt_assert(!reader.has_parse_error() && doc.IsObject() && doc.HasMember("5") && doc["5"] == "x",
+               "MessagePack integer keys are not decoded as expected");
+
+    // Truncated data is detected
+    const char truncated[] = {(char)0x92, (char)0x01};
+    MsgpackReader truncated_reader(truncated, sizeof(truncated));
+    doc.Populate(truncated_reader);
+    xbt_assert(truncated_reader.has_parse_error(), "Truncated MessagePack data has not been detected");
+}
@@ -0,0 +1,63 @@
+#include "test_pool.hpp"
+
+#include <set>
+#include <string>
+
+#include <xbt.h>
+
+#include "../pool.hpp"
+
+using namespace std;
+
+namespace
+{
+    struct PooledTestObject : public Pooled<PooledTestObject>
+    {
+        string name;
+        double value = 0;
+    };
+}
+
+void test_pool()
+{
+    // Released blocks are reused
+    PooledTestObject * object = new PooledTestObject;
+    object->name = "a name which is long enough not to fit into the small string buffer";
+    void * address = object;
+    delete object;
+
+    object = new PooledTestObject;
+    xbt_assert((void *) object == address, "A released block should be reused by the next allocation");
+    xbt_assert(object->name.empty() && object->value == 0, "A reused block should hold a newly constructed object");
+    delete object;
+
+    // Objects in use never share a block, even when several chunks are needed
+    const int nb_objects = 1000;
+    set<PooledTestObject *> objects;
+    for (int i = 0; i < nb_objects; ++i)
+    {
+        PooledTestObject * new_object = new PooledTestObject;
+        new_object->value = i;
+        objects.insert(new_object);
+    }
+    xbt_assert((int) objects.size() == nb_objects, "Objects in use should not share a block");
+    int nb_blocks = FreeListPool<PooledTestObject>::nb_blocks();
+    xbt_assert(nb_blocks >= nb_objects, "The pool should own at least one block per object in use");
+
+    for (PooledTestObject * pooled_object : objects)
+    {
+        delete pooled_object;
+    }
+
+    // Once released, the blocks are enough for the same number of objects
+    objects.clear();
+    for (int i = 0; i < nb_objects; ++i)
+    {
+        objects.insert(new PooledTestObject);
+    }
+    xbt_assert(FreeListPool<PooledTestObject>::nb_blocks() == nb_blocks, "The pool should not grow when it has free blocks");
+    for (PooledTestObject * pooled_object : objects)
+    {
+        delete pooled_object;
+    }
+}
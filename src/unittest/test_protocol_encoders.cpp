@@ -0,0 +1,142 @@
+#include "test_protocol_encoders.hpp"
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <string>
+
+#include <xbt.h>
+
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+
+#include "../msgpack.hpp"
+#include "../protocol.hpp"
+#include "test_protocol_reader.hpp"
+
+using namespace std;
+
+/**
+ * @brief Writes a message with a REQUESTED_CALL event and a RESOURCE_STATE_CHANGED event
+ * @param[in,out] encoder The encoder
+ * @param[in] now The message date
+ * @return The message
+ */
+ProtocolMessage write_test_message(ProtocolMessageEncoder & encoder, double now)
+{
+    encoder.clear();
+
+    encoder.start_event();
+    encoder.StartObject();
+    encoder.Key("timestamp");
+    encoder.Double(now);
+    encoder.Key("type");
+    encoder.String("REQUESTED_CALL");
+    encoder.Key("data");
+    encoder.StartObject();
+    encoder.EndObject();
+    encoder.EndObject();
+
+    encoder.start_event();
+    encoder.StartObject();
+    encoder.Key("timestamp");
+    encoder.Double(now);
+    encoder.Key("type");
+    encoder.String(string("RESOURCE_STATE_CHANGED"));
+    encoder.Key("data");
+    encoder.StartObject();
+    encoder.Key("resources");
+    encoder.String("0-3");
+    encoder.Key("state");
+    encoder.Int(1);
+    encoder.EndObject();
+    encoder.EndObject();
+
+    return encoder.finish_message(now);
+}
+
+void test_protocol_encoders()
+{
+    // JSON messages
+    const string expected_json_1 = R"({"now":10.0,"events":[{"timestamp":10.0,"type":"REQUESTED_CALL","data":{}},)"
+                                   R"({"timestamp":10.0,"type":"RESOURCE_STATE_CHANGED","data":{"resources":"0-3","state":1}}]})";
+    const string expected_json_2 = R"({"now":2000.0,"events":[{"timestamp":2000.0,"type":"REQUESTED_CALL","data":{}},)"
+                                   R"({"timestamp":2000.0,"type":"RESOURCE_STATE_CHANGED","data":{"resources":"0-3","state":1}}]})";
+
+    JsonMessageEncoder json_encoder;
+    ProtocolMessage json_1 = write_test_message(json_encoder, 10);
+    xbt_assert(string(json_1.data, json_1.size) == expected_json_1,
+               "Unexpected JSON message '%.*s'", (int) json_1.size, json_1.data);
+
+    // The previous message must remain valid while the next one is built
+    ProtocolMessage json_2 = write_test_message(json_encoder, 2000);
+    xbt_assert(string(json_2.data, json_2.size) == expected_json_2,
+               "Unexpected JSON message '%.*s'", (int) json_2.size, json_2.data);
+    xbt_assert(string(json_1.data, json_1.size) == expected_json_1,
+               "JSON message has been overwritten by the next one");
+
+    // Fixed decimal places
+    const string expected_fixed = R"({"now":10.000000,"events":[{"timestamp":10.000000,"type":"REQUESTED_CALL","data":{}},)"
+                                  R"({"timestamp":10.000000,"type":"RESOURCE_STATE_CHANGED","data":{"resources":"0-3","state":1}}]})";
+    JsonMessageEncoder fixed_encoder(6);
+    ProtocolMessage fixed = write_test_message(fixed_encoder, 10);
+    xbt_assert(string(fixed.data, fixed.size) == expected_fixed,
+               "Unexpected JSON message '%.*s'", (int) fixed.size, fixed.data);
+
+    // MessagePack messages must have the same content
+    MsgpackMessageEncoder msgpack_encoder;
+    for (double now : {10.0, 2000.0, 10.0})
+    {
+        ProtocolMessage encoded = write_test_message(msgpack_encoder, now);
+
+        rapidjson::Document decoded;
+        MsgpackReader reader(encoded.data, encoded.size);
+        decoded.Populate(reader);
+        xbt_assert(!reader.has_parse_error(), "Could not decode MessagePack message: %s",
+                   reader.parse_error().c_str());
+
+        rapidjson::Document expected;
+        expected.Parse(now == 10 ? expected_json_1.c_str() : expected_json_2.c_str());
+        xbt_assert(decoded == expected, "MessagePack message does not match its JSON counterpart");
+    }
+}
+
+void test_protocol_double_writing()
+{
+    const double values[] = {0, 0.1, 1.0/3, 42.123456789012345, 1e-7, 123456789.987654321,
+                             1e21, 5e-324, 1.7976931348623157e308, -2.5};
+
+    for (double value : values)
+    {
+        rapidjson::StringBuffer buffer;
+        ::Writer<rapidjson::StringBuffer> writer(buffer);
+        writer.Double(value);
+
+        char * end = nullptr;
+        double read_value = strtod(buffer.GetString(), &end);
+        xbt_assert(*end == '\0' && read_value == value,
+                   "Double %.17g has not been written exactly (got '%s')", value, buffer.GetString());
+    }
+
+    rapidjson::StringBuffer buffer;
+    ::Writer<rapidjson::StringBuffer> writer(buffer);
+    writer.SetDecimalPlaces(2);
+    writer.Double(1.0/3);
+    xbt_assert(string(buffer.GetString()) == "0.33",
+               "Double has not been written with 2 decimal places (got '%s')", buffer.GetString());
+
+    // Non-finite doubles cannot be written in JSON, whatever the number of decimal places
+    for (double value : {(double) NAN, (double) INFINITY, -(double) INFINITY})
+    {
+        for (int decimal_places : {-1, 2})
+        {
+            xbt_assert(test_wrapper_aborts([value, decimal_places]() {
+                           rapidjson::StringBuffer non_finite_buffer;
+                           ::Writer<rapidjson::StringBuffer> non_finite_writer(non_finite_buffer);
+                           non_finite_writer.SetDecimalPlaces(decimal_places);
+                           non_finite_writer.Double(value);
+                       }),
+                       "Writing the double %g with %d decimal places should fail", value, decimal_places);
+        }
+    }
+}
@@ -0,0 +1,4 @@
+#pragma once
+
+void test_protocol_encoders();
+void test_protocol_double_writing();
@@ -0,0 +1,326 @@
+#include "test_protocol_reader.hpp"
+
+#include <signal.h>
+#include <stdio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <xbt.h>
+
+#include <rapidjson/document.h>
+
+#include "../context.hpp"
+#include "../ipp.hpp"
+#include "../msgpack.hpp"
+#include "../protocol.hpp"
+
+using namespace std;
+
+string test_wrapper_describe_allocation(const SchedulingAllocation * allocation)
+{
+    string description = allocation->job_id.to_string() + " on " + allocation->machine_ids.to_string_hyphen() + " mapping=";
+    for (unsigned int i = 0; i < allocation->mapping.size(); ++i)
+    {
+        description += (i > 0 ? "," : "") + to_string(allocation->mapping[i]);
+    }
+    return description;
+}
+
+string test_wrapper_describe_message(double when, const string & mailbox, IPMessageType type, void * data)
+{
+    string description = to_string(when) + " " + mailbox + " " + ip_message_type_to_string(type);
+
+    switch (type)
+    {
+    case IPMessageType::SCHED_CALL_ME_LATER:
+        description += " " + to_string(static_cast<CallMeLaterMessage *>(data)->target_time);
+        break;
+    case IPMessageType::SCHED_EXECUTE_JOB:
+        description += " " + test_wrapper_describe_allocation(static_cast<ExecuteJobMessage *>(data)->allocation);
+        break;
+    case IPMessageType::SCHED_EXECUTE_JOBS:
+        for (const SchedulingAllocation * allocation : static_cast<ExecuteJobsMessage *>(data)->allocations)
+        {
+            description += " [" + test_wrapper_describe_allocation(allocation) + "]";
+        }
+        break;
+    case IPMessageType::SCHED_KILL_JOB:
+        for (const JobIdentifier & job_id : static_cast<KillJobMessage *>(data)->jobs_ids)
+        {
+            description += " " + job_id.to_string();
+        }
+        break;
+    case IPMessageType::JOB_SUBMITTED_BY_DP:
+    {
+        const JobSubmittedByDPMessage * message = static_cast<JobSubmittedByDPMessage *>(data);
+        description += " " + message->job_id.to_string() + " " + message->job_description +
+                       " " + message->job_profile_description;
+        break;
+    }
+    case IPMessageType::PROFILE_SUBMITTED_BY_DP:
+    {
+        const ProfileSubmittedByDPMessage * message = static_cast<ProfileSubmittedByDPMessage *>(data);
+        description += " " + message->workload_name + "!" + message->profile_name + " " + message->profile;
+        break;
+    }
+    default:
+        break;
+    }
+
+    return description;
+}
+
+/**
+ * @brief A protocol reader which records the messages it produces instead of sending them
+ */
+template <typename Reader>
+class RecordingProtocolReader : public Reader
+{
+public:
+    /**
+     * @brief Builds a RecordingProtocolReader
+     * @param[in] context The BatsimContext
+     */
+    explicit RecordingProtocolReader(BatsimContext * context) : Reader(context) {}
+
+    /**
+     * @brief Records a message instead of sending it
+     * @param[in] when The date at which the message should be sent
+     * @param[in] destination_mailbox The destination mailbox
+     * @param[in] type The message type
+     * @param[in] data The message data
+     * @param[in] detached Whether the send should be detached
+     */
+    void send_message(double when, const string & destination_mailbox, IPMessageType type,
+                      void * data = nullptr, bool detached = false) const
+    {
+        (void) detached;
+        messages.push_back(test_wrapper_describe_message(when, destination_mailbox, type, data));
+
+        // The message owns its data
+        IPMessage * message = new IPMessage;
+        message->type = type;
+        message->data = data;
+        delete message;
+    }
+
+    mutable vector<string> messages; //!< The descriptions of the recorded messages
+};
+
+void test_wrapper_prepare_context(BatsimContext & context, ProtocolValidation validation)
+{
+    context.redis_enabled = false;
+    context.submission_sched_enabled = true;
+    context.protocol_validation = validation;
+}
+
+vector<string> test_wrapper_read_json(const string & message, ProtocolValidation validation = ProtocolValidation::AUDIT)
+{
+    BatsimContext context;
+    test_wrapper_prepare_context(context, validation);
+
+    RecordingProtocolReader<JsonProtocolReader> reader(&context);
+    reader.parse_and_apply_message(message);
+    return reader.messages;
+}
+
+vector<string> test_wrapper_read_msgpack(const string & json_message)
+{
+    rapidjson::Document doc;
+    doc.Parse(json_message.c_str());
+    xbt_assert(!doc.HasParseError(), "Invalid test input '%s'", json_message.c_str());
+
+    string encoded;
+    MsgpackWriter writer(encoded);
+    doc.Accept(writer);
+
+    BatsimContext context;
+    test_wrapper_prepare_context(context, ProtocolValidation::AUDIT);
+
+    RecordingProtocolReader<MsgpackProtocolReader> reader(&context);
+    reader.parse_and_apply_message(encoded);
+    return reader.messages;
+}
+
+void test_wrapper_check_messages(const vector<string> & messages, const vector<string> & expected, const string & input)
+{
+    xbt_assert(messages.size() == expected.size(), "Reading '%s' produced %zu messages instead of %zu",
+               input.c_str(), messages.size(), expected.size());
+    for (unsigned int i = 0; i < messages.size(); ++i)
+    {
+        xbt_assert(messages[i] == expected[i], "Message %u read from '%s' is '%s' instead of '%s'",
+                   i, input.c_str(), messages[i].c_str(), expected[i].c_str());
+    }
+}
+
+bool test_wrapper_aborts(const function<void()> & function)
+{
+    fflush(stdout);
+    fflush(stderr);
+
+    pid_t pid = fork();
+    xbt_assert(pid != -1, "Cannot fork");
+    if (pid == 0)
+    {
+        // The failure messages of the child are not shown
+        FILE * devnull = freopen("/dev/null", "w", stderr);
+        (void) devnull;
+        function();
+        _exit(0);
+    }
+
+    int status = 0;
+    xbt_assert(waitpid(pid, &status, 0) == pid, "Cannot wait for the child process");
+    return WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT;
+}
+
+void test_protocol_reader()
+{
+    // Several events, with 'now' given before the events
+    const string now_first = R"({"now":15.0,"events":[)"
+        R"({"timestamp":10.0,"type":"CALL_ME_LATER","data":{"timestamp":20.5}},)"
+        R"({"timestamp":12.0,"type":"NOTIFY","data":{"type":"submission_finished"}},)"
+        R"({"timestamp":15.0,"type":"NOTIFY","data":{"type":"continue_submission"}}]})";
+    const vector<string> expected = {
+        "10.000000 server SCHED_CALL_ME_LATER 20.500000",
+        "12.000000 server END_DYNAMIC_SUBMIT",
+        "15.000000 server CONTINUE_DYNAMIC_SUBMIT",
+        "15.000000 server SCHED_READY"
+    };
+    test_wrapper_check_messages(test_wrapper_read_json(now_first), expected, now_first);
+    test_wrapper_check_messages(test_wrapper_read_msgpack(now_first), expected, now_first);
+
+    // The same events, with 'now' given after the events and ignored keys around them
+    const string now_last = R"({"events":[)"
+        R"({"timestamp":10.0,"type":"CALL_ME_LATER","data":{"timestamp":20.5}},)"
+        R"({"timestamp":12.0,"type":"NOTIFY","data":{"type":"submission_finished"}},)"
+        R"({"timestamp":15.0,"type":"NOTIFY","data":{"type":"continue_submission"}}],)"
+        R"("ignored":{"a":[1,{"b":[]}],"events":2},"now":15})";
+    test_wrapper_check_messages(test_wrapper_read_json(now_last), expected, now_last);
+    test_wrapper_check_messages(test_wrapper_read_msgpack(now_last), expected, now_last);
+
+    // Nested job, profile and mapping objects
+    const string nested = R"({"now":30.0,"events":[)"
+        R"({"timestamp":30.0,"type":"SUBMIT_PROFILE","data":{"workload_name":"dyn","profile_name":"p0","profile":{"type":"delay","delay":5}}},)"
+        R"({"timestamp":30.0,"type":"SUBMIT_JOB","data":{"job_id":"dyn!1",)"
+            R"("job":{"id":"dyn!1","subtime":30,"res":4,"profile":"p1","walltime":100},)"
+            R"("profile":{"type":"parallel_homogeneous","cpu":1e6,"com":0}}},)"
+        R"({"timestamp":30.0,"type":"EXECUTE_JOB","data":{"job_id":"dyn!1","alloc":"2-3",)"
+            R"("mapping":{"0":"0","1":1,"2":"1","3":"0"}}}]})";
+    const vector<string> expected_nested = {
+        R"(30.000000 server PROFILE_SUBMITTED_BY_DP dyn!p0 {"type":"delay","delay":5})",
+        R"(30.000000 server JOB_SUBMITTED_BY_DP dyn!1 {"id":"dyn!1","subtime":30,"res":4,"profile":"p1","walltime":100} {"type":"parallel_homogeneous","cpu":1000000.0,"com":0})",
+        "30.000000 server SCHED_EXECUTE_JOB dyn!1 on 2-3 mapping=0,1,1,0",
+        "30.000000 server SCHED_READY"
+    };
+    test_wrapper_check_messages(test_wrapper_read_json(nested), expected_nested, nested);
+    test_wrapper_check_messages(test_wrapper_read_msgpack(nested), expected_nested, nested);
+
+    // Malformed messages
+    xbt_assert(!test_wrapper_aborts([&now_first]() { test_wrapper_read_json(now_first); }),
+               "Reading the valid message '%s' failed", now_first.c_str());
+    const vector<string> malformed = {
+        "",
+        "not json",
+        R"([{"now":1.0,"events":[]}])",
+        R"({"now":1.0,"events":[)",
+        R"({"now":1.0,"events":[]} {})",
+        R"({"events":[]})",
+        R"({"now":1.0})",
+        R"({"now":"1.0","events":[]})",
+        R"({"now":1.0,"events":{}})",
+        R"({"now":1.0,"events":[1]})",
+        R"({"now":1.0,"events":[[]]})",
+        R"({"now":1.0,"events":[{"timestamp":2.0,"type":"NOTIFY","data":{"type":"submission_finished"}}]})",
+        R"({"events":[{"timestamp":2.0,"type":"NOTIFY","data":{"type":"submission_finished"}}],"now":1.0})",
+        R"({"now":1.0,"events":[{"timestamp":1.0,"type":"UNKNOWN","data":{}}]})",
+        R"({"now":1.0,"events":[{"timestamp":1.0,"type":"CALL_ME_LATER"}]})"
+    };
+    for (const string & message : malformed)
+    {
+        xbt_assert(test_wrapper_aborts([&message]() { test_wrapper_read_json(message); }),
+                   "Reading the malformed message '%s' did not fail", message.c_str());
+    }
+}
+
+string test_wrapper_execute_job_message(const string & mapping)
+{
+    return R"({"now":30.0,"events":[)"
+        R"({"timestamp":30.0,"type":"SUBMIT_JOB","data":{"job_id":"dyn!1",)"
+            R"("job":{"id":"dyn!1","subtime":30,"res":4,"profile":"p1"},"profile":{"type":"delay","delay":5}}},)"
+        R"({"timestamp":30.0,"type":"EXECUTE_JOB","data":{"job_id":"dyn!1","alloc":"2-3","mapping":)" +
+        mapping + "}}]}";
+}
+
+void test_trusted_allocation_mapping()
+{
+    // Trusted and audited schedulers get the same allocation from a valid mapping
+    const string valid = test_wrapper_execute_job_message(R"({"0":"0","1":1,"2":"1","3":"0"})");
+    const vector<string> audited = test_wrapper_read_json(valid, ProtocolValidation::AUDIT);
+    test_wrapper_check_messages(test_wrapper_read_json(valid, ProtocolValidation::TRUSTED), audited, valid);
+    xbt_assert(audited[1] == "30.000000 server SCHED_EXECUTE_JOB dyn!1 on 2-3 mapping=0,1,1,0",
+               "Unexpected allocation '%s'", audited[1].c_str());
+
+    // Wrong executors or resources are detected, even for trusted schedulers
+    const vector<string> invalid_mappings = {
+        R"({"1":0,"2":1,"3":0,"4":1})", // executors should start at 0
+        R"({"0":0,"-1":1})",
+        R"({"0":0,"one":1})",
+        R"({"0":0,"1":2})", // only 2 resources are allocated
+        R"({"0":0,"1":-1})",
+        R"({"0":0,"1":"2"})",
+        R"({"0":0,"1":"a"})",
+        R"({"0":0,"1":1.5})",
+        R"({"0":0,"1":"99999999999"})"
+    };
+    for (const string & mapping : invalid_mappings)
+    {
+        const string message = test_wrapper_execute_job_message(mapping);
+        for (ProtocolValidation validation : {ProtocolValidation::AUDIT, ProtocolValidation::TRUSTED})
+        {
+            xbt_assert(test_wrapper_aborts([&message, validation]() { test_wrapper_read_json(message, validation); }),
+                       "The invalid mapping '%s' has been accepted (validation=%s)",
+                       mapping.c_str(), protocol_validation_to_string(validation).c_str());
+        }
+    }
+}
+
+void test_execute_jobs_reading()
+{
+    // Several jobs started by one event, with and without mapping
+    const string execute_jobs = R"({"now":30.0,"events":[)"
+        R"({"timestamp":30.0,"type":"SUBMIT_JOB","data":{"job_id":"dyn!1",)"
+            R"("job":{"id":"dyn!1","subtime":30,"res":4,"profile":"p1"},"profile":{"type":"delay","delay":5}}},)"
+        R"({"timestamp":30.0,"type":"SUBMIT_JOB","data":{"job_id":"dyn!2",)"
+            R"("job":{"id":"dyn!2","subtime":30,"res":1,"profile":"p1"}}},)"
+        R"({"timestamp":30.0,"type":"EXECUTE_JOBS","data":{"jobs":[)"
+            R"({"job_id":"dyn!1","alloc":"2-3","mapping":{"0":"0","1":"0","2":"1","3":"1"}},)"
+            R"({"job_id":"dyn!2","alloc":"0"}]}}]})";
+    const vector<string> expected = {
+        R"(30.000000 server JOB_SUBMITTED_BY_DP dyn!1 {"id":"dyn!1","subtime":30,"res":4,"profile":"p1"} {"type":"delay","delay":5})",
+        R"(30.000000 server JOB_SUBMITTED_BY_DP dyn!2 {"id":"dyn!2","subtime":30,"res":1,"profile":"p1"} )",
+        "30.000000 server SCHED_EXECUTE_JOBS [dyn!1 on 2-3 mapping=0,0,1,1] [dyn!2 on 0 mapping=0]",
+        "30.000000 server SCHED_READY"
+    };
+    test_wrapper_check_messages(test_wrapper_read_json(execute_jobs), expected, execute_jobs);
+    test_wrapper_check_messages(test_wrapper_read_json(execute_jobs, ProtocolValidation::TRUSTED), expected, execute_jobs);
+    test_wrapper_check_messages(test_wrapper_read_msgpack(execute_jobs), expected, execute_jobs);
+
+    // Malformed EXECUTE_JOBS events
+    const vector<string> malformed = {
+        R"({"now":1.0,"events":[{"timestamp":1.0,"type":"EXECUTE_JOBS","data":{}}]})",
+        R"({"now":1.0,"events":[{"timestamp":1.0,"type":"EXECUTE_JOBS","data":{"jobs":[]}}]})",
+        R"({"now":1.0,"events":[{"timestamp":1.0,"type":"EXECUTE_JOBS","data":{"jobs":{}}}]})",
+        R"({"now":1.0,"events":[{"timestamp":1.0,"type":"EXECUTE_JOBS","data":{"jobs":[{"job_id":3,"alloc":"0"}]}}]})",
+        R"({"now":1.0,"events":[{"timestamp":1.0,"type":"EXECUTE_JOBS","data":{"jobs":[{"job_id":"dyn!1"}]}}]})"
+    };
+    for (const string & message : malformed)
+    {
+        xbt_assert(test_wrapper_aborts([&message]() { test_wrapper_read_json(message); }),
+                   "Reading the malformed message '%s' did not fail", message.c_str());
+    }
+}
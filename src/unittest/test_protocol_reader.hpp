@@ -0,0 +1,9 @@
+#pragma once
+
+#include <functional>
+
+bool test_wrapper_aborts(const std::function<void()> & function);
+
+void test_protocol_reader();
+void test_trusted_allocation_mapping();
+void test_execute_jobs_reading();
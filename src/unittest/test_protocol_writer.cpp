@@ -0,0 +1,414 @@
+#include "test_protocol_writer.hpp"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <simgrid/msg.h>
+#include <xbt.h>
+
+#include <rapidjson/document.h>
+
+#include "../context.hpp"
+#include "../ipp.hpp"
+#include "../job_submitter.hpp"
+#include "../jobs.hpp"
+#include "../machine_range.hpp"
+#include "../machines.hpp"
+#include "../msgpack.hpp"
+#include "../protocol.hpp"
+#include "../server.hpp"
+#include "../workload.hpp"
+
+using namespace std;
+
+void test_wrapper_prepare_writer_context(BatsimContext & context)
+{
+    context.redis_enabled = false;
+    context.submission_forward_profiles = false;
+    context.submission_batch_by_timestamp = false;
+    context.protocol_decimal_places = -1;
+    context.protocol_compact_resources = false;
+}
+
+string test_wrapper_message_string(const ProtocolMessage & message)
+{
+    return string(message.data, message.size);
+}
+
+void test_wrapper_check_msgpack_message(const ProtocolMessage & message, const string & expected_json)
+{
+    rapidjson::Document decoded;
+    MsgpackReader reader(message.data, message.size);
+    decoded.Populate(reader);
+    xbt_assert(!reader.has_parse_error(), "Could not decode MessagePack message: %s", reader.parse_error().c_str());
+
+    rapidjson::Document expected;
+    expected.Parse(expected_json.c_str());
+    xbt_assert(decoded == expected, "MessagePack message does not match '%s'", expected_json.c_str());
+}
+
+/**
+ * @brief Appends jobs submitted at the same date, whose batch is closed by another event then by a date change
+ * @param[in,out] writer The protocol writer
+ * @return The message
+ */
+ProtocolMessage test_wrapper_write_submissions(AbstractProtocolWriter & writer)
+{
+    const string delay = R"({"type":"delay","delay":10})";
+    const string other_delay = R"({"type":"delay","delay":20})";
+
+    writer.append_job_submitted(JobIdentifier("w0", 1), "p", R"({"id":"w0!1","res":1,"profile":"p"})", delay, 10);
+    writer.append_job_submitted(JobIdentifier("w0", 2), "p", R"({"id":"w0!2","res":2,"profile":"p"})", delay, 10);
+    writer.append_job_submitted(JobIdentifier("w1", 1), "p", R"({"id":"w1!1","res":1,"profile":"p"})", other_delay, 10);
+    writer.append_job_submitted(JobIdentifier("w0", 3), "q", R"({"id":"w0!3","res":1,"profile":"q"})", other_delay, 10);
+    writer.append_requested_call(10);
+    writer.append_job_submitted(JobIdentifier("w0", 4), "p", R"({"id":"w0!4","res":1,"profile":"p"})", delay, 10);
+    writer.append_job_submitted(JobIdentifier("w0", 5), "p", R"({"id":"w0!5","res":1,"profile":"p"})", delay, 15);
+    return writer.generate_current_message(15);
+}
+
+void test_deferred_events()
+{
+    BatsimContext context;
+    test_wrapper_prepare_writer_context(context);
+    context.protocol_deferred_events = {"JOB_COMPLETED", "REQUESTED_CALL"};
+
+    JsonProtocolWriter writer(&context);
+    context.proto_writer = &writer;
+
+    ServerData data;
+    data.context = &context;
+    data.nb_submitters = 1;
+    data.nb_submitters_finished = 1;
+    data.nb_running_jobs = 1;
+
+    // Deferred events are held back while another job is running
+    writer.append_job_completed(JobIdentifier("w0", 1), "SUCCESS", "COMPLETED_SUCCESSFULLY", "", "0", 0, 10);
+    writer.append_requested_call(10);
+    xbt_assert(!writer.is_empty() && !writer.has_triggering_events(), "Deferred events should not trigger a call");
+    xbt_assert(!scheduler_should_be_called(&data), "Deferred events have been sent while a job is running");
+
+    // They are held back as long as a simulated process can wake the server up
+    data.nb_running_jobs = 0;
+    int ServerData::* activities[] = {&ServerData::nb_switching_machines, &ServerData::nb_waiters,
+                                      &ServerData::nb_killers};
+    for (int ServerData::* activity : activities)
+    {
+        data.*activity = 1;
+        xbt_assert(!scheduler_should_be_called(&data), "Deferred events have been sent while the simulation can progress");
+        data.*activity = 0;
+    }
+
+    // Unfinished submitters do not hold them back: a submitter either sleeps until its next submission date,
+    // or waits for the completion of a job it submitted, which the scheduler may only start once called
+    data.nb_submitters_finished = 0;
+    xbt_assert(scheduler_should_be_called(&data), "Deferred events are held back by a sleeping submitter");
+    ServerData::Submitter workflow_submitter;
+    workflow_submitter.mailbox = "test_deferred_workflow_submitter";
+    workflow_submitter.should_be_called_back = true;
+    data.submitters[workflow_submitter.mailbox] = &workflow_submitter;
+    data.origin_of_jobs[JobIdentifier("w0", 1)] = &workflow_submitter;
+    xbt_assert(scheduler_should_be_called(&data), "Deferred events are held back by a submitter waiting for a callback");
+    data.origin_of_jobs.clear();
+    data.submitters.clear();
+    data.nb_submitters_finished = 1;
+
+    // They are flushed when only the scheduler can make the simulation progress...
+    xbt_assert(scheduler_should_be_called(&data), "Deferred events have not been flushed, the simulation would hang");
+
+    // ...but only if the scheduler can be called
+    data.sched_ready = false;
+    xbt_assert(!scheduler_should_be_called(&data), "The scheduler has been called while it is not ready");
+    data.sched_ready = true;
+    data.end_of_simulation_sent = true;
+    xbt_assert(!scheduler_should_be_called(&data), "The scheduler has been called after SIMULATION_ENDS");
+    data.end_of_simulation_sent = false;
+
+    // A non-deferred event triggers a call at once, and the deferred events are sent along with it
+    data.nb_running_jobs = 1;
+    writer.append_job_submitted(JobIdentifier("w0", 2), "p", R"({"id":"w0!2","res":1,"profile":"p"})", "", 10);
+    xbt_assert(writer.has_triggering_events(), "A non-deferred event should trigger a call");
+    xbt_assert(scheduler_should_be_called(&data), "A non-deferred event has been held back");
+
+    const string expected = R"({"now":12.0,"events":[)"
+        R"({"timestamp":10.0,"type":"JOB_COMPLETED","data":{"job_id":"w0!1","status":"SUCCESS",)"
+            R"("job_state":"COMPLETED_SUCCESSFULLY","return_code":0,"kill_reason":"","alloc":"0"}},)"
+        R"({"timestamp":10.0,"type":"REQUESTED_CALL","data":{}},)"
+        R"({"timestamp":10.0,"type":"JOB_SUBMITTED","data":{"job_id":"w0!2","job":{"id":"w0!2","res":1,"profile":"p"}}}]})";
+    const string message = test_wrapper_message_string(writer.generate_current_message(12));
+    xbt_assert(message == expected, "Unexpected message '%s' instead of '%s'", message.c_str(), expected.c_str());
+
+    // Nothing is left once the message has been sent
+    writer.clear();
+    xbt_assert(writer.is_empty() && !writer.has_triggering_events(), "The writer has not been cleared");
+    xbt_assert(!scheduler_should_be_called(&data), "The scheduler has been called without events");
+    data.nb_running_jobs = 0;
+    xbt_assert(!scheduler_should_be_called(&data), "The scheduler has been called without events");
+
+    // Events which are not listed are never deferred
+    context.protocol_deferred_events.clear();
+    data.nb_running_jobs = 1;
+    writer.append_job_completed(JobIdentifier("w0", 2), "SUCCESS", "COMPLETED_SUCCESSFULLY", "", "0", 0, 20);
+    xbt_assert(scheduler_should_be_called(&data), "A JOB_COMPLETED event has been deferred without being listed");
+    writer.clear();
+    context.proto_writer = nullptr;
+}
+
+void test_job_submission_batching()
+{
+    BatsimContext context;
+    test_wrapper_prepare_writer_context(context);
+    context.submission_batch_by_timestamp = true;
+    context.submission_forward_profiles = true;
+
+    // Profiles are shared by the jobs of a batch, and are identified by WORKLOAD!PROFILE
+    const string expected = R"({"now":15.0,"events":[)"
+        R"({"timestamp":10.0,"type":"JOB_SUBMITTED","data":{"jobs":[)"
+            R"({"id":"w0!1","res":1,"profile":"p"},{"id":"w0!2","res":2,"profile":"p"},)"
+            R"({"id":"w1!1","res":1,"profile":"p"},{"id":"w0!3","res":1,"profile":"q"}],)"
+            R"("job_ids":["w0!1","w0!2","w1!1","w0!3"],)"
+            R"("profiles":{"w0!p":{"type":"delay","delay":10},"w0!q":{"type":"delay","delay":20},)"
+                R"("w1!p":{"type":"delay","delay":20}}}},)"
+        R"({"timestamp":10.0,"type":"REQUESTED_CALL","data":{}},)"
+        R"({"timestamp":10.0,"type":"JOB_SUBMITTED","data":{"jobs":[{"id":"w0!4","res":1,"profile":"p"}],)"
+            R"("job_ids":["w0!4"],"profiles":{"w0!p":{"type":"delay","delay":10}}}},)"
+        R"({"timestamp":15.0,"type":"JOB_SUBMITTED","data":{"jobs":[{"id":"w0!5","res":1,"profile":"p"}],)"
+            R"("job_ids":["w0!5"],"profiles":{"w0!p":{"type":"delay","delay":10}}}}]})";
+
+    JsonProtocolWriter writer(&context);
+    string message = test_wrapper_message_string(test_wrapper_write_submissions(writer));
+    xbt_assert(message == expected, "Unexpected message '%s' instead of '%s'", message.c_str(), expected.c_str());
+    xbt_assert(writer.nb_events() == 4, "Unexpected number of events (%d)", writer.nb_events());
+
+    // The batches are not kept from one message to the next one
+    writer.clear();
+    writer.append_job_submitted(JobIdentifier("w0", 6), "p", R"({"id":"w0!6","res":1,"profile":"p"})",
+                                R"({"type":"delay","delay":10})", 15);
+    message = test_wrapper_message_string(writer.generate_current_message(15));
+    const string expected_next = R"({"now":15.0,"events":[)"
+        R"({"timestamp":15.0,"type":"JOB_SUBMITTED","data":{"jobs":[{"id":"w0!6","res":1,"profile":"p"}],)"
+            R"("job_ids":["w0!6"],"profiles":{"w0!p":{"type":"delay","delay":10}}}}]})";
+    xbt_assert(message == expected_next, "Unexpected message '%s' instead of '%s'", message.c_str(), expected_next.c_str());
+
+    // The first message of a MsgpackProtocolWriter is JSON-encoded
+    MsgpackProtocolWriter msgpack_writer(&context);
+    msgpack_writer.clear();
+    test_wrapper_check_msgpack_message(test_wrapper_write_submissions(msgpack_writer), expected);
+
+    // Profiles are not forwarded unless requested
+    context.submission_forward_profiles = false;
+    const string expected_without_profiles = R"({"now":15.0,"events":[)"
+        R"({"timestamp":10.0,"type":"JOB_SUBMITTED","data":{"jobs":[)"
+            R"({"id":"w0!1","res":1,"profile":"p"},{"id":"w0!2","res":2,"profile":"p"},)"
+            R"({"id":"w1!1","res":1,"profile":"p"},{"id":"w0!3","res":1,"profile":"q"}],)"
+            R"("job_ids":["w0!1","w0!2","w1!1","w0!3"]}},)"
+        R"({"timestamp":10.0,"type":"REQUESTED_CALL","data":{}},)"
+        R"({"timestamp":10.0,"type":"JOB_SUBMITTED","data":{"jobs":[{"id":"w0!4","res":1,"profile":"p"}],"job_ids":["w0!4"]}},)"
+        R"({"timestamp":15.0,"type":"JOB_SUBMITTED","data":{"jobs":[{"id":"w0!5","res":1,"profile":"p"}],"job_ids":["w0!5"]}}]})";
+    JsonProtocolWriter writer_without_profiles(&context);
+    message = test_wrapper_message_string(test_wrapper_write_submissions(writer_without_profiles));
+    xbt_assert(message == expected_without_profiles, "Unexpected message '%s' instead of '%s'",
+               message.c_str(), expected_without_profiles.c_str());
+
+    // With redis, only the job identifiers are sent (even if profiles forwarding is enabled)
+    context.redis_enabled = true;
+    context.submission_forward_profiles = true;
+    const string expected_redis = R"({"now":15.0,"events":[)"
+        R"({"timestamp":10.0,"type":"JOB_SUBMITTED","data":{"job_ids":["w0!1","w0!2","w1!1","w0!3"]}},)"
+        R"({"timestamp":10.0,"type":"REQUESTED_CALL","data":{}},)"
+        R"({"timestamp":10.0,"type":"JOB_SUBMITTED","data":{"job_ids":["w0!4"]}},)"
+        R"({"timestamp":15.0,"type":"JOB_SUBMITTED","data":{"job_ids":["w0!5"]}}]})";
+    JsonProtocolWriter redis_writer(&context);
+    message = test_wrapper_message_string(test_wrapper_write_submissions(redis_writer));
+    xbt_assert(message == expected_redis, "Unexpected message '%s' instead of '%s'", message.c_str(), expected_redis.c_str());
+
+    MsgpackProtocolWriter msgpack_redis_writer(&context);
+    msgpack_redis_writer.clear();
+    test_wrapper_check_msgpack_message(test_wrapper_write_submissions(msgpack_redis_writer), expected_redis);
+}
+
+/**
+ * @brief Submits three jobs at the same date through a JobSubmissionSender and the server handlers
+ * @details The scheduler is called as soon as the server would call it.
+ * @param[in] batch_by_timestamp Whether the jobs submitted at the same date are batched
+ * @return The messages sent to the scheduler
+ */
+vector<string> test_wrapper_submit_through_server(bool batch_by_timestamp)
+{
+    BatsimContext context;
+    test_wrapper_prepare_writer_context(context);
+    context.submission_batch_by_timestamp = batch_by_timestamp;
+
+    JsonProtocolWriter writer(&context);
+    context.proto_writer = &writer;
+
+    Workload * workload = new Workload("test_submission_w0", "test_submission_w0.json");
+    for (int number = 1; number <= 3; ++number)
+    {
+        Job * job = new Job;
+        job->number = number;
+        job->profile = "p";
+        job->json_description = R"({"id":"test_submission_w0!)" + std::to_string(number) + R"(","res":1,"profile":"p"})";
+        workload->jobs->add_job(job);
+    }
+    context.workloads.insert_workload(workload->name, workload);
+
+    ServerData data;
+    data.context = &context;
+    data.nb_submitters = 1;
+    ServerData::Submitter submitter;
+    submitter.mailbox = "test_submission_w0_submitter";
+    submitter.should_be_called_back = false;
+    data.submitters[submitter.mailbox] = &submitter;
+
+    vector<string> scheduler_messages;
+    JobSubmissionSender sender(submitter.mailbox, batch_by_timestamp, [&](JobSubmittedMessage * message)
+    {
+        IPMessage * task_data = new IPMessage;
+        task_data->type = IPMessageType::JOB_SUBMITTED;
+        task_data->data = (void *) message;
+        handle_server_message(server_message_handlers(), &data, task_data);
+
+        if (scheduler_should_be_called(&data))
+        {
+            scheduler_messages.push_back(test_wrapper_message_string(writer.generate_current_message(0)));
+            writer.clear();
+        }
+    });
+    for (int number = 1; number <= 3; ++number)
+    {
+        sender.submit(JobIdentifier("test_submission_w0", number));
+    }
+    sender.flush();
+
+    xbt_assert(data.nb_submitted_jobs == 3, "Unexpected number of submitted jobs (%d)", data.nb_submitted_jobs);
+    context.proto_writer = nullptr;
+    return scheduler_messages;
+}
+
+void test_job_submission_through_server()
+{
+    // By default, the scheduler is called after each submission, even at the same date
+    vector<string> messages = test_wrapper_submit_through_server(false);
+    xbt_assert(messages.size() == 3, "Unbatched submissions should lead to one call per job (%zu)", messages.size());
+    for (int number = 1; number <= 3; ++number)
+    {
+        const string job_id = "test_submission_w0!" + std::to_string(number);
+        const string expected = R"({"now":0.0,"events":[)"
+            R"({"timestamp":0.0,"type":"JOB_SUBMITTED","data":{"job_id":")" + job_id + R"(",)"
+                R"("job":{"id":")" + job_id + R"(","res":1,"profile":"p"}}}]})";
+        xbt_assert(messages[number - 1] == expected, "Unexpected message '%s' instead of '%s'",
+                   messages[number - 1].c_str(), expected.c_str());
+    }
+
+    // Batched jobs of the same date arrive in one message, and lead to one scheduler call
+    messages = test_wrapper_submit_through_server(true);
+    xbt_assert(messages.size() == 1, "Same-date batched submissions should lead to one call (%zu)", messages.size());
+    const string expected = R"({"now":0.0,"events":[)"
+        R"({"timestamp":0.0,"type":"JOB_SUBMITTED","data":{"jobs":[)"
+            R"({"id":"test_submission_w0!1","res":1,"profile":"p"},{"id":"test_submission_w0!2","res":1,"profile":"p"},)"
+            R"({"id":"test_submission_w0!3","res":1,"profile":"p"}],)"
+            R"("job_ids":["test_submission_w0!1","test_submission_w0!2","test_submission_w0!3"]}}]})";
+    xbt_assert(messages[0] == expected, "Unexpected message '%s' instead of '%s'", messages[0].c_str(), expected.c_str());
+}
+
+void test_compact_resources()
+{
+    // Machines are sorted by name: big_1 big_2 login node1 node2 node3 node4
+    char platform_filename[] = "/tmp/batsim_platform_XXXXXX.xml";
+    int fd = mkstemps(platform_filename, 4);
+    xbt_assert(fd != -1, "Cannot create a temporary file");
+    close(fd);
+
+    ofstream platform_file(platform_filename);
+    platform_file << R"(<?xml version='1.0'?>
+<!DOCTYPE platform SYSTEM "http://simgrid.gforge.inria.fr/simgrid/simgrid.dtd">
+<platform version="4">
+  <AS id="AS0" routing="Full">
+    <host id="master_host" speed="1Gf"/>
+    <host id="node1" speed="1Gf"><prop id="role" value="compute"/></host>
+    <host id="node2" speed="1Gf"><prop id="role" value="compute"/></host>
+    <host id="node3" speed="2Gf"><prop id="role" value="gpu"/></host>
+    <host id="node4" speed="1Gf"><prop id="role" value="compute"/></host>
+    <host id="big_2" speed="4Gf"><prop id="memory" value="high"/></host>
+    <host id="big_1" speed="4Gf"><prop id="memory" value="high"/></host>
+    <host id="login" speed="1Gf"/>
+  </AS>
+</platform>
+)";
+    platform_file.close();
+
+    BatsimContext context;
+    test_wrapper_prepare_writer_context(context);
+    context.energy_used = false;
+    context.submission_sched_enabled = false;
+    context.config_file.Parse("{}");
+
+    MSG_create_environment(platform_filename);
+    unlink(platform_filename);
+    xbt_dynar_t hosts = MSG_hosts_as_dynar();
+    context.machines.create_machines(hosts, &context, "master_host", "pfs_host", "hpst_host", 0);
+    xbt_dynar_free(&hosts);
+
+    // Machines sharing their properties and name pattern are grouped, even if their ids are not contiguous
+    context.protocol_compact_resources = true;
+    JsonProtocolWriter compact_writer(&context);
+    compact_writer.append_simulation_begins(context.machines, context.workloads, context.config_file, false, 0);
+    const string compact = test_wrapper_message_string(compact_writer.generate_current_message(0));
+    const string expected = R"({"now":0.0,"events":[{"timestamp":0.0,"type":"SIMULATION_BEGINS","data":{)"
+        R"("nb_resources":7,"allow_time_sharing":false,"config":{},"resources_groups":[)"
+            R"({"ids":"0-1","name_pattern":"big_{}","name_offset":1,"state":"idle","properties":{"memory":"high"}},)"
+            R"({"ids":"2","name":"login","state":"idle","properties":{}},)"
+            R"({"ids":"3-4,6","name_pattern":"node{}","name_offset":-2,"state":"idle","properties":{"role":"compute"}},)"
+            R"({"ids":"5","name_pattern":"node{}","name_offset":-2,"state":"idle","properties":{"role":"gpu"}}],)"
+        R"("workloads":{}}}]})";
+    xbt_assert(compact == expected, "Unexpected message '%s' instead of '%s'", compact.c_str(), expected.c_str());
+
+    // Expanding the groups gives back the resources sent without compaction
+    context.protocol_compact_resources = false;
+    JsonProtocolWriter writer(&context);
+    writer.append_simulation_begins(context.machines, context.workloads, context.config_file, false, 0);
+    rapidjson::Document resources_doc;
+    resources_doc.Parse(test_wrapper_message_string(writer.generate_current_message(0)).c_str());
+    const rapidjson::Value & resources = resources_doc["events"][rapidjson::SizeType(0)]["data"]["resources_data"];
+
+    rapidjson::Document groups_doc;
+    groups_doc.Parse(compact.c_str());
+    const rapidjson::Value & groups = groups_doc["events"][rapidjson::SizeType(0)]["data"]["resources_groups"];
+
+    int nb_expanded_machines = 0;
+    for (rapidjson::SizeType i = 0; i < groups.Size(); ++i)
+    {
+        const rapidjson::Value & group = groups[i];
+        MachineRange ids = MachineRange::from_string_hyphen(group["ids"].GetString(), ",", "-");
+        for (auto it = ids.elements_begin(); it != ids.elements_end(); ++it)
+        {
+            const int id = *it;
+            string name;
+            if (group.HasMember("name_pattern"))
+            {
+                name = group["name_pattern"].GetString();
+                name.replace(name.find("{}"), 2, to_string(id + group["name_offset"].GetInt()));
+            }
+            else
+            {
+                name = group["name"].GetString();
+            }
+
+            const rapidjson::Value & resource = resources[(rapidjson::SizeType) id];
+            xbt_assert(resource["id"].GetInt() == id && name == resource["name"].GetString(),
+                       "Machine %d is named '%s' in the groups and '%s' in the resources",
+                       id, name.c_str(), resource["name"].GetString());
+            xbt_assert(group["state"] == resource["state"] && group["properties"] == resource["properties"],
+                       "Machine %d ('%s') has not the same state or properties in the groups and in the resources",
+                       id, name.c_str());
+            ++nb_expanded_machines;
+        }
+    }
+    xbt_assert(nb_expanded_machines == (int) resources.Size(), "The groups contain %d machines instead of %d",
+               nb_expanded_machines, (int) resources.Size());
+}
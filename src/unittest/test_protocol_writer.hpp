@@ -0,0 +1,6 @@
+#pragma once
+
+void test_deferred_events();
+void test_job_submission_batching();
+void test_job_submission_through_server();
+void test_compact_resources();
@@ -0,0 +1,62 @@
+#include "test_server.hpp"
+
+#include <map>
+
+#include <xbt.h>
+
+#include "../ipp.hpp"
+#include "../server.hpp"
+
+using namespace std;
+
+void test_server_message_dispatch()
+{
+    const ServerMessageHandlers & handlers = server_message_handlers();
+    xbt_assert(&handlers == &server_message_handlers(), "The handler table should only be built once");
+
+    // Each message type is handled by its own function, the other types are not handled
+    const map<IPMessageType, ServerMessageHandler> expected_handlers = {
+        {IPMessageType::JOB_SUBMITTED, server_on_job_submitted},
+        {IPMessageType::JOB_SUBMITTED_BY_DP, server_on_submit_job},
+        {IPMessageType::PROFILE_SUBMITTED_BY_DP, server_on_submit_profile},
+        {IPMessageType::JOB_COMPLETED, server_on_job_completed},
+        {IPMessageType::PSTATE_MODIFICATION, server_on_pstate_modification},
+        {IPMessageType::SCHED_EXECUTE_JOB, server_on_execute_job},
+        {IPMessageType::SCHED_EXECUTE_JOBS, server_on_execute_jobs},
+        {IPMessageType::SCHED_CHANGE_JOB_STATE, server_on_change_job_state},
+        {IPMessageType::TO_JOB_MSG, server_on_to_job_msg},
+        {IPMessageType::FROM_JOB_MSG, server_on_from_job_msg},
+        {IPMessageType::SCHED_REJECT_JOB, server_on_reject_job},
+        {IPMessageType::SCHED_KILL_JOB, server_on_kill_jobs},
+        {IPMessageType::SCHED_CALL_ME_LATER, server_on_call_me_later},
+        {IPMessageType::SCHED_TELL_ME_ENERGY, server_on_sched_tell_me_energy},
+        {IPMessageType::SCHED_WAIT_ANSWER, server_on_sched_wait_answer},
+        {IPMessageType::WAIT_QUERY, server_on_wait_query},
+        {IPMessageType::SCHED_READY, server_on_sched_ready},
+        {IPMessageType::WAITING_DONE, server_on_waiting_done},
+        {IPMessageType::KILLING_DONE, server_on_killing_done},
+        {IPMessageType::SUBMITTER_HELLO, server_on_submitter_hello},
+        {IPMessageType::SUBMITTER_BYE, server_on_submitter_bye},
+        {IPMessageType::SWITCHED_ON, server_on_switched},
+        {IPMessageType::SWITCHED_OFF, server_on_switched},
+        {IPMessageType::END_DYNAMIC_SUBMIT, server_on_end_dynamic_submit},
+        {IPMessageType::CONTINUE_DYNAMIC_SUBMIT, server_on_continue_dynamic_submit}
+    };
+    for (int type = 0; type < NB_IP_MESSAGE_TYPES; ++type)
+    {
+        IPMessageType message_type = static_cast<IPMessageType>(type);
+        auto expected = expected_handlers.find(message_type);
+        ServerMessageHandler expected_handler = (expected == expected_handlers.end()) ? nullptr : expected->second;
+        xbt_assert(handlers[type] == expected_handler, "Unexpected handler for message type %s",
+                   ip_message_type_to_string(message_type));
+    }
+
+    // A message is given to its handler
+    ServerData data;
+    data.sched_ready = false;
+    IPMessage * message = new IPMessage;
+    message->type = IPMessageType::SCHED_READY;
+    message->data = nullptr;
+    handle_server_message(handlers, &data, message);
+    xbt_assert(data.sched_ready, "The SCHED_READY message has not been handled");
+}
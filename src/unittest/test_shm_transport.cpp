@@ -0,0 +1,65 @@
+#include "test_shm_transport.hpp"
+
+#include <unistd.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <xbt.h>
+
+#include "../shm_transport.hpp"
+
+using namespace std;
+
+void test_shm_transport()
+{
+    // Both sides live in this process: messages must fit in the rings, which are small to test wrap-arounds
+    const string name = "/batsim_unittest_" + to_string(getpid());
+    const uint64_t capacity = 64;
+    SharedMemoryTransport transport(name, capacity);
+
+    batsim_shm_header * scheduler_side = batsim_shm_attach(name.c_str());
+    xbt_assert(scheduler_side != nullptr, "Cannot attach to shared memory object '%s'", name.c_str());
+
+    const vector<string> messages = {"{\"now\":0,\"events\":[]}", "", string(56, 'x'), string("\0\x01\xff", 3)};
+    for (int round = 0; round < 10; ++round)
+    {
+        for (const string & message : messages)
+        {
+            transport.send(message.data(), message.size());
+
+            uint64_t size;
+            int ret = batsim_shm_recv_size(scheduler_side, BATSIM_SHM_TO_SCHEDULER, &size);
+            xbt_assert(ret == 0 && size == message.size(), "Invalid message size received by the scheduler");
+            string received(size, '\0');
+            ret = batsim_shm_read(scheduler_side, BATSIM_SHM_TO_SCHEDULER, &received[0], size);
+            xbt_assert(ret == 0 && received == message, "Invalid message received by the scheduler");
+
+            ret = batsim_shm_send(scheduler_side, BATSIM_SHM_TO_BATSIM, received.data(), received.size());
+            xbt_assert(ret == 0, "The scheduler cannot send its reply");
+
+            string reply;
+            transport.recv(reply);
+            xbt_assert(reply == message, "Invalid reply received by Batsim");
+        }
+    }
+
+    // Sizes Batsim cannot allocate are rejected before reading the message
+    const unsigned char invalid_size[8] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+    int ret = batsim_shm_write(scheduler_side, BATSIM_SHM_TO_BATSIM, invalid_size, sizeof(invalid_size));
+    xbt_assert(ret == 0, "The scheduler cannot write the invalid size");
+    bool rejected = false;
+    try
+    {
+        string reply;
+        transport.recv(reply);
+    }
+    catch (const runtime_error &)
+    {
+        rejected = true;
+    }
+    xbt_assert(rejected, "A message of an invalid size has been accepted");
+
+    batsim_shm_detach(scheduler_side);
+}
@@ -0,0 +1,84 @@
+#include "test_telemetry.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <xbt.h>
+
+#include "../telemetry.hpp"
+
+using namespace std;
+
+void test_telemetry()
+{
+    xbt_assert(TelemetryEmitter::is_zmq_endpoint("tcp://*:28001"), "tcp://*:28001 should be a ZeroMQ endpoint");
+    xbt_assert(!TelemetryEmitter::is_zmq_endpoint("/tmp/telemetry.jsonl"), "/tmp/telemetry.jsonl should be a file");
+
+    char filename[] = "/tmp/batsim_telemetry_XXXXXX";
+    int fd = mkstemp(filename);
+    xbt_assert(fd != -1, "Cannot create a temporary file");
+    close(fd);
+
+    {
+        zmq::context_t zmq_context;
+        TelemetryEmitter emitter(filename, 0, zmq_context);
+        xbt_assert(emitter.is_due(), "Records should always be due with a null interval");
+
+        TelemetrySample sample;
+        sample.simulation_time = 42;
+        sample.nb_submitted_jobs = 10;
+        sample.nb_running_jobs = 3;
+        sample.nb_completed_jobs = 5;
+        sample.nb_processes = 7;
+        sample.writer_nb_events = 2;
+        sample.paje_buffered_bytes = 100;
+        sample.energy_buffered_bytes = 200;
+        sample.pstate_buffered_bytes = 300;
+        sample.machine_states_buffered_bytes = 400;
+        sample.background_pending_bytes = 5000000000LL;
+
+        emitter.count_message();
+        emitter.emit(sample);
+        emitter.count_message();
+        emitter.count_message();
+        emitter.emit(sample);
+    }
+
+    {
+        zmq::context_t zmq_context;
+        TelemetryEmitter emitter(filename, 3600, zmq_context);
+        xbt_assert(!emitter.is_due(), "Records should not be due before the interval has elapsed");
+    }
+
+    ifstream file(filename);
+    vector<string> lines;
+    string line;
+    while (getline(file, line))
+    {
+        lines.push_back(line);
+    }
+    unlink(filename);
+
+    xbt_assert(lines.size() == 2, "2 telemetry records were expected, got %zu", lines.size());
+    const vector<string> expected_fields = {"\"simulation_time\":42", "\"nb_submitted_jobs\":10", "\"nb_running_jobs\":3",
+                                            "\"nb_completed_jobs\":5", "\"nb_processes\":7", "\"writer_nb_events\":2",
+                                            "\"paje_buffered_bytes\":100", "\"energy_buffered_bytes\":200",
+                                            "\"pstate_buffered_bytes\":300", "\"machine_states_buffered_bytes\":400",
+                                            "\"background_pending_bytes\":5000000000"};
+    for (const string & record : lines)
+    {
+        xbt_assert(record.front() == '{' && record.back() == '}', "Invalid telemetry record '%s'", record.c_str());
+        for (const string & field : expected_fields)
+        {
+            xbt_assert(record.find(field) != string::npos, "Field %s is missing from telemetry record '%s'",
+                       field.c_str(), record.c_str());
+        }
+    }
+    xbt_assert(lines[0].find("\"nb_messages\":1,") != string::npos, "Invalid message count in '%s'", lines[0].c_str());
+    xbt_assert(lines[1].find("\"nb_messages\":3,") != string::npos, "Invalid message count in '%s'", lines[1].c_str());
+}
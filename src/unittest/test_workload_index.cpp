@@ -0,0 +1,66 @@
+#include "test_workload_index.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <string>
+
+#include <xbt.h>
+
+#include <rapidjson/reader.h>
+
+#include "../workload.hpp"
+
+using namespace std;
+using namespace rapidjson;
+
+void test_workload_index()
+{
+    const string content = R"({
+  "nb_res": 4,
+  "jobs": [
+    {"id": 1, "subtime": 10, "res": 4, "profile": "a", "extra": {"id": 99, "subtime": [1, 2]}},
+    {"id": "w!2", "subtime": 0.5, "res": 1, "profile": "b"},
+    {"subtime": 3, "id": 3, "res": 1, "profile": "b"}
+  ],
+  "profiles": {"a": {"type": "delay", "delay": 5}, "b": {"type": "delay", "delay": 1}}
+})";
+
+    char filename[] = "/tmp/batsim_workload_XXXXXX";
+    int fd = mkstemp(filename);
+    xbt_assert(fd != -1, "Cannot create a temporary file");
+    xbt_assert(write(fd, content.data(), content.size()) == (ssize_t) content.size(), "Cannot write the temporary file");
+    close(fd);
+
+    FILE * file = fopen(filename, "rb");
+    char read_buffer[16]; // Smaller than the file, so that positions span several buffer refills
+    FileReadStream stream(file, read_buffer, sizeof(read_buffer));
+    WorkloadIndexHandler handler(stream, "test");
+    Reader reader;
+    xbt_assert(!reader.Parse(stream, handler).IsError(), "The workload could not be parsed");
+    fclose(file);
+    unlink(filename);
+    handler.finish();
+
+    xbt_assert(handler.nb_res() == 4, "Invalid nb_res %d", handler.nb_res());
+    xbt_assert(content.substr(handler.profiles_offset(), handler.profiles_size()) ==
+               R"({"a": {"type": "delay", "delay": 5}, "b": {"type": "delay", "delay": 1}})",
+               "Invalid profiles location");
+
+    const vector<LazyJob> & jobs = handler.jobs();
+    xbt_assert(jobs.size() == 3, "3 jobs were expected, got %zu", jobs.size());
+
+    const int expected_numbers[] = {1, 2, 3};
+    const double expected_submission_times[] = {10, 0.5, 3};
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        xbt_assert(jobs[i].number == expected_numbers[i], "Invalid number %d for job %zu", jobs[i].number, i);
+        xbt_assert(jobs[i].submission_time == expected_submission_times[i],
+                   "Invalid submission time %g for job %zu", jobs[i].submission_time, i);
+
+        const string job_json = content.substr(jobs[i].offset, jobs[i].size);
+        xbt_assert(job_json.front() == '{' && job_json.back() == '}' && job_json.find("\"res\"") != string::npos,
+                   "Invalid location of job %zu: '%s'", i, job_json.c_str());
+    }
+}
@@ -5,13 +5,18 @@
 
 #include "workload.hpp"
 
+#include <algorithm>
+#include <climits>
+#include <cstdio>
 #include <fstream>
 #include <streambuf>
 
 #include <rapidjson/document.h>
+#include <rapidjson/error/en.h>
 
 #include <smpi/smpi.h>
 
+#include "binary_workload.hpp"
 #include "context.hpp"
 #include "jobs.hpp"
 #include "profiles.hpp"
@@ -37,9 +42,11 @@ Workload::~Workload()
 {
     delete jobs;
     delete profiles;
+    delete _binary_file;
 
     jobs = nullptr;
     profiles = nullptr;
+    _binary_file = nullptr;
 }
 
 void Workload::load_from_json(const std::string &json_filename, int &nb_machines)
@@ -81,13 +88,213 @@ void Workload::load_from_json(const std::string &json_filename, int &nb_machines
     XBT_INFO("Workload seems to be valid.");
 }
 
+void Workload::load_lazily_from_json(const std::string &json_filename, int &nb_machines)
+{
+    XBT_INFO("Indexing JSON workload '%s'...", json_filename.c_str());
+    string error_prefix = "Invalid JSON file '" + json_filename + "'";
+
+    // The jobs are located by a streaming pass, which does not keep the file content in memory
+    FILE * json_file = fopen(json_filename.c_str(), "rb");
+    xbt_assert(json_file != nullptr, "Cannot read file '%s'", json_filename.c_str());
+
+    char read_buffer[65536];
+    FileReadStream stream(json_file, read_buffer, sizeof(read_buffer));
+    WorkloadIndexHandler handler(stream, error_prefix);
+    Reader reader;
+    ParseResult result = reader.Parse(stream, handler);
+    fclose(json_file);
+
+    xbt_assert(!result.IsError(), "%s: could not be parsed (%s at offset %zu)", error_prefix.c_str(),
+               GetParseError_En(result.Code()), result.Offset());
+    handler.finish();
+
+    nb_machines = handler.nb_res();
+    xbt_assert(nb_machines > 0, "%s: the value of the 'nb_res' field is invalid (%d)",
+               error_prefix.c_str(), nb_machines);
+
+    // The profiles are small compared to the jobs: they are loaded as usual
+    _lazy_file.open(json_filename, ios::binary);
+    xbt_assert(_lazy_file.is_open(), "Cannot read file '%s'", json_filename.c_str());
+
+    string profiles_json = "{\"profiles\":";
+    size_t profiles_begin = profiles_json.size();
+    profiles_json.resize(profiles_begin + handler.profiles_size());
+    _lazy_file.seekg(handler.profiles_offset());
+    _lazy_file.read(&profiles_json[profiles_begin], handler.profiles_size());
+    xbt_assert(_lazy_file, "Cannot read the profiles of file '%s'", json_filename.c_str());
+    profiles_json += "}";
+
+    Document doc;
+    doc.Parse(profiles_json.c_str());
+    xbt_assert(!doc.HasParseError(), "%s: could not be parsed", error_prefix.c_str());
+    profiles->load_from_json(doc, json_filename);
+
+    for (const auto & mit : profiles->profiles())
+    {
+        if (mit.second->type == ProfileType::SMPI)
+        {
+            XBT_INFO("Workload '%s' contains SMPI profiles, which cannot be loaded lazily.",
+                     json_filename.c_str());
+            _lazy_file.close();
+            delete profiles;
+            profiles = new Profiles;
+            jobs->set_profiles(profiles);
+            load_from_json(json_filename, nb_machines);
+            return;
+        }
+    }
+
+    lazy_jobs = std::move(handler.jobs());
+    lazy_jobs.shrink_to_fit();
+
+    // Job numbers are checked now, as jobs are only added into Jobs when they are submitted
+    vector<int> job_numbers;
+    job_numbers.reserve(lazy_jobs.size());
+    for (const LazyJob & lazy_job : lazy_jobs)
+    {
+        job_numbers.push_back(lazy_job.number);
+    }
+    sort(job_numbers.begin(), job_numbers.end());
+    auto duplicate = adjacent_find(job_numbers.begin(), job_numbers.end());
+    xbt_assert(duplicate == job_numbers.end(), "%s: duplication of job id %d",
+               error_prefix.c_str(), *duplicate);
+
+    sort(lazy_jobs.begin(), lazy_jobs.end(),
+         [](const LazyJob & a, const LazyJob & b)
+         {
+             if (a.submission_time == b.submission_time)
+             {
+                 return a.number < b.number;
+             }
+             return a.submission_time < b.submission_time;
+         });
+    is_lazy = true;
+
+    XBT_INFO("JSON workload indexed sucessfully. Indexed %d jobs and read %d profiles.",
+             (int) lazy_jobs.size(), profiles->nb_profiles());
+    XBT_INFO("Checking workload validity...");
+    check_validity();
+    XBT_INFO("Workload seems to be valid (jobs are checked when they are submitted).");
+}
+
+void Workload::load_from_binary(const std::string &binary_filename, int &nb_machines, bool lazy)
+{
+    XBT_INFO("Loading binary workload '%s'...", binary_filename.c_str());
+    string error_prefix = "Invalid binary workload '" + binary_filename + "'";
+
+    _binary_file = new BinaryWorkloadFile(binary_filename);
+    const BinaryWorkloadHeader & header = _binary_file->header();
+
+    nb_machines = header.nb_res;
+    xbt_assert(nb_machines > 0, "%s: the value of the 'nb_res' field is invalid (%d)",
+               error_prefix.c_str(), nb_machines);
+
+    for (uint64_t i = 0; i < header.nb_profiles; ++i)
+    {
+        const BinaryProfileRecord & record = _binary_file->profile(i);
+        string profile_name(_binary_file->string_at(record.name_offset, record.name_size), record.name_size);
+        string description(_binary_file->string_at(record.description_offset, record.description_size),
+                           record.description_size);
+
+        Document doc;
+        doc.Parse(description.c_str());
+        xbt_assert(!doc.HasParseError(), "%s: the description of profile '%s' could not be parsed",
+                   error_prefix.c_str(), profile_name.c_str());
+        xbt_assert(!profiles->exists(profile_name), "%s: duplication of profile name '%s'",
+                   error_prefix.c_str(), profile_name.c_str());
+        profiles->add_profile(profile_name, Profile::from_json(profile_name, doc, error_prefix, true, binary_filename));
+    }
+
+    if (lazy)
+    {
+        // Records are already sorted by submission time then number: the submitter walks them in the mapped file
+        is_lazy = true;
+    }
+    else
+    {
+        for (uint64_t i = 0; i < header.nb_jobs; ++i)
+        {
+            jobs->add_job(job_from_binary_record(_binary_file->job(i)));
+        }
+    }
+
+    XBT_INFO("Binary workload loaded sucessfully. Read %d jobs and %d profiles.",
+             (int) header.nb_jobs, profiles->nb_profiles());
+    XBT_INFO("Checking workload validity...");
+    check_validity();
+    XBT_INFO("Workload seems to be valid.");
+}
+
+Job * Workload::job_from_binary_record(const BinaryJobRecord & record)
+{
+    xbt_assert(record.profile < _binary_file->header().nb_profiles,
+               "Invalid binary workload '%s': job %d has an invalid profile index %u",
+               file.c_str(), record.number, record.profile);
+    const BinaryProfileRecord & profile_record = _binary_file->profile(record.profile);
+
+    Job * j = new Job;
+    j->workload = this;
+    j->number = record.number;
+    j->starting_time = -1;
+    j->runtime = -1;
+    j->state = JobState::JOB_STATE_NOT_SUBMITTED;
+    j->consumed_energy = -1;
+    j->submission_time = record.submission_time;
+    j->walltime = record.walltime;
+    j->required_nb_res = record.required_nb_res;
+    j->profile.assign(_binary_file->string_at(profile_record.name_offset, profile_record.name_size),
+                      profile_record.name_size);
+
+    // The stored description contains every member but 'id', which depends on the workload name
+    string id_member = "{\"id\":\"" + name + "!" + to_string(record.number) + "\"";
+    j->json_description.reserve(id_member.size() + record.description_size + 2);
+    j->json_description = id_member;
+    if (record.description_size > 0)
+    {
+        j->json_description += ',';
+        j->json_description.append(_binary_file->string_at(record.description_offset, record.description_size),
+                                   record.description_size);
+    }
+    j->json_description += '}';
+
+    return j;
+}
+
+Job * Workload::materialize_job(const LazyJob & lazy_job)
+{
+    xbt_assert(is_lazy && _binary_file == nullptr, "Workload '%s' is not lazily loaded from a JSON file", name.c_str());
+
+    string job_json(lazy_job.size, '\0');
+    _lazy_file.seekg(lazy_job.offset);
+    _lazy_file.read(&job_json[0], lazy_job.size);
+    xbt_assert(_lazy_file, "Cannot read job %d from file '%s'", lazy_job.number, file.c_str());
+
+    Job * job = Job::from_json(job_json, this, "Invalid JSON file '" + file + "'");
+    xbt_assert(job->number == lazy_job.number && (double) job->submission_time == lazy_job.submission_time,
+               "Job %d of file '%s' does not match its index entry: has the file been modified?",
+               lazy_job.number, file.c_str());
+    check_job_validity(job);
+    jobs->add_job(job);
+
+    return job;
+}
+
+Job * Workload::materialize_binary_job(uint64_t index)
+{
+    xbt_assert(is_lazy && _binary_file != nullptr, "Workload '%s' is not lazily loaded from a binary file", name.c_str());
+
+    Job * job = job_from_binary_record(_binary_file->job(index));
+    check_job_validity(job);
+    jobs->add_job(job);
+    return job;
+}
+
 void Workload::register_smpi_applications()
 {
     XBT_INFO("Registering SMPI applications of workload '%s'...", name.c_str());
 
-    for (auto mit : jobs->jobs())
+    for (Job * job : jobs->jobs())
     {
-        Job * job = mit.second;
         Profile * profile = (*profiles)[job->profile];
 
         if (profile->type == ProfileType::SMPI)
@@ -127,27 +334,31 @@ void Workload::check_validity()
     // TODO: compute the constraint of the profile number of resources, to check if it match the jobs that use it
 
     // Let's check that the profile of each job exists
-    for (auto mit : jobs->jobs())
+    for (const Job * job : jobs->jobs())
     {
-        Job * job = mit.second;
-        xbt_assert(profiles->exists(job->profile),
-                   "Invalid job %d: the associated profile '%s' does not exist",
-                   job->number, job->profile.c_str());
+        check_job_validity(job);
+    }
+}
 
-        const Profile * profile = profiles->at(job->profile);
-        if (profile->type == ProfileType::MSG_PARALLEL)
-        {
-            MsgParallelProfileData * data = (MsgParallelProfileData *) profile->data;
-            (void) data; // Avoids a warning if assertions are ignored
-            xbt_assert(data->nb_res == job->required_nb_res,
-                       "Invalid job %d: the requested number of resources (%d) do NOT match"
-                       " the number of resources of the associated profile '%s' (%d)",
-                       job->number, job->required_nb_res, job->profile.c_str(), data->nb_res);
-        }
-        else if (profile->type == ProfileType::SEQUENCE)
-        {
-            // TODO: check if the number of resources matches a resource-constrained composed profile
-        }
+void Workload::check_job_validity(const Job * job)
+{
+    xbt_assert(profiles->exists(job->profile),
+               "Invalid job %d: the associated profile '%s' does not exist",
+               job->number, job->profile.c_str());
+
+    const Profile * profile = profiles->at(job->profile);
+    if (profile->type == ProfileType::MSG_PARALLEL)
+    {
+        MsgParallelProfileData * data = (MsgParallelProfileData *) profile->data;
+        (void) data; // Avoids a warning if assertions are ignored
+        xbt_assert(data->nb_res == job->required_nb_res,
+                   "Invalid job %d: the requested number of resources (%d) do NOT match"
+                   " the number of resources of the associated profile '%s' (%d)",
+                   job->number, job->required_nb_res, job->profile.c_str(), data->nb_res);
+    }
+    else if (profile->type == ProfileType::SEQUENCE)
+    {
+        // TODO: check if the number of resources matches a resource-constrained composed profile
     }
 }
 
@@ -161,6 +372,7 @@ Workloads::~Workloads()
         delete workload;
     }
     _workloads.clear();
+    _workloads_by_id.clear();
 }
 
 Workload *Workloads::operator[](const std::string &workload_name)
@@ -202,12 +414,16 @@ const Job *Workloads::job_at(const std::string &workload_name, int job_number) c
 
 Job *Workloads::job_at(const JobIdentifier &job_id)
 {
-    return at(job_id.workload_name)->jobs->at(job_id.job_number);
+    Workload * workload = find(job_id);
+    xbt_assert(workload != nullptr, "Workload '%s' does not exist", job_id.workload_name().c_str());
+    return workload->jobs->at(job_id.job_number);
 }
 
 const Job *Workloads::job_at(const JobIdentifier &job_id) const
 {
-    return at(job_id.workload_name)->jobs->at(job_id.job_number);
+    const Workload * workload = find(job_id);
+    xbt_assert(workload != nullptr, "Workload '%s' does not exist", job_id.workload_name().c_str());
+    return workload->jobs->at(job_id.job_number);
 }
 
 void Workloads::insert_workload(const std::string &workload_name, Workload *workload)
@@ -217,6 +433,13 @@ void Workloads::insert_workload(const std::string &workload_name, Workload *work
 
     workload->name = workload_name;
     _workloads[workload_name] = workload;
+
+    int workload_id = JobIdentifier::intern_workload_name(workload_name);
+    if (workload_id >= (int) _workloads_by_id.size())
+    {
+        _workloads_by_id.resize(workload_id + 1, nullptr);
+    }
+    _workloads_by_id[workload_id] = workload;
 }
 
 bool Workloads::exists(const std::string &workload_name) const
@@ -271,7 +494,24 @@ bool Workloads::job_exists(const std::string &workload_name, const int job_numbe
 
 bool Workloads::job_exists(const JobIdentifier &job_id)
 {
-    return job_exists(job_id.workload_name, job_id.job_number);
+    const Workload * workload = find(job_id);
+    if (workload == nullptr)
+    {
+        return false;
+    }
+
+    const Job * job = workload->jobs->find(job_id.job_number);
+    return job != nullptr && workload->profiles->exists(job->profile);
+}
+
+Workload *Workloads::find(const JobIdentifier &job_id) const
+{
+    if (job_id.workload_id < 0 || job_id.workload_id >= (int) _workloads_by_id.size())
+    {
+        return nullptr;
+    }
+
+    return _workloads_by_id[job_id.workload_id];
 }
 
 std::map<std::string, Workload *> &Workloads::workloads()
@@ -283,3 +523,227 @@ const std::map<std::string, Workload *> &Workloads::workloads() const
 {
     return _workloads;
 }
+
+
+WorkloadIndexHandler::WorkloadIndexHandler(const FileReadStream & stream, const std::string & error_prefix) :
+    _stream(stream),
+    _error_prefix(error_prefix)
+{
+}
+
+void WorkloadIndexHandler::finish()
+{
+    xbt_assert(_depth == 0, "%s: the workload is incomplete", _error_prefix.c_str());
+    xbt_assert(_nb_res_is_valid, "%s: the 'nb_res' field is missing or is not an integer", _error_prefix.c_str());
+    xbt_assert(_jobs_read, "%s: the 'jobs' array is missing", _error_prefix.c_str());
+    xbt_assert(_profiles_read, "%s: the 'profiles' object is missing", _error_prefix.c_str());
+}
+
+bool WorkloadIndexHandler::Null()
+{
+    return on_scalar(false, 0, false);
+}
+
+bool WorkloadIndexHandler::Bool(bool b)
+{
+    (void) b;
+    return on_scalar(false, 0, false);
+}
+
+bool WorkloadIndexHandler::Int(int i)
+{
+    return on_scalar(true, i, true);
+}
+
+bool WorkloadIndexHandler::Uint(unsigned u)
+{
+    return on_scalar(true, u, u <= INT_MAX);
+}
+
+bool WorkloadIndexHandler::Int64(int64_t i)
+{
+    return on_scalar(true, (double) i, false);
+}
+
+bool WorkloadIndexHandler::Uint64(uint64_t u)
+{
+    return on_scalar(true, (double) u, false);
+}
+
+bool WorkloadIndexHandler::Double(double d)
+{
+    return on_scalar(true, d, false);
+}
+
+bool WorkloadIndexHandler::RawNumber(const char * str, SizeType length, bool copy)
+{
+    (void) copy;
+    return on_scalar(true, std::stod(string(str, length)), false);
+}
+
+bool WorkloadIndexHandler::String(const char * str, SizeType length, bool copy)
+{
+    (void) copy;
+    if (_in_jobs && _depth == 3 && _job_key == JobKey::ID)
+    {
+        // The workload part of 'workload!number' identifiers is checked when the job is materialized
+        string job_id_str(str, length);
+        size_t separator = job_id_str.rfind('!');
+        char * end = nullptr;
+        long number = 0;
+        if (separator != string::npos)
+        {
+            number = strtol(job_id_str.c_str() + separator + 1, &end, 10);
+        }
+        xbt_assert(end != nullptr && *end == '\0' && end != job_id_str.c_str() + separator + 1,
+                   "%s: Invalid string job identifier '%s': should be formatted as two '!'-separated "
+                   "parts, the second one being an integral number. Example: 'some_text!42'.",
+                   _error_prefix.c_str(), job_id_str.c_str());
+
+        _job.number = (int) number;
+        _job_has_id = true;
+        return true;
+    }
+    return on_scalar(false, 0, false);
+}
+
+bool WorkloadIndexHandler::Key(const char * str, SizeType length, bool copy)
+{
+    (void) copy;
+    string key(str, length);
+    if (_depth == 1)
+    {
+        if (key == "nb_res")
+        {
+            _workload_key = WorkloadKey::NB_RES;
+        }
+        else if (key == "jobs")
+        {
+            _workload_key = WorkloadKey::JOBS;
+        }
+        else if (key == "profiles")
+        {
+            _workload_key = WorkloadKey::PROFILES;
+        }
+        else
+        {
+            _workload_key = WorkloadKey::OTHER;
+        }
+    }
+    else if (_in_jobs && _depth == 3)
+    {
+        if (key == "id")
+        {
+            _job_key = JobKey::ID;
+        }
+        else if (key == "subtime")
+        {
+            _job_key = JobKey::SUBTIME;
+        }
+        else
+        {
+            _job_key = JobKey::OTHER;
+        }
+    }
+    return true;
+}
+
+bool WorkloadIndexHandler::StartObject()
+{
+    // The reader calls StartObject right after having consumed the '{' character
+    if (_in_jobs && _depth == 2)
+    {
+        _job = LazyJob();
+        _job.offset = _stream.Tell() - 1;
+        _job_key = JobKey::OTHER;
+        _job_has_id = false;
+        _job_has_subtime = false;
+    }
+    else if (_depth == 1 && _workload_key == WorkloadKey::PROFILES)
+    {
+        _profiles_offset = _stream.Tell() - 1;
+    }
+
+    ++_depth;
+    return true;
+}
+
+bool WorkloadIndexHandler::EndObject(SizeType member_count)
+{
+    (void) member_count;
+    --_depth;
+
+    // The reader calls EndObject right after having consumed the '}' character
+    if (_in_jobs && _depth == 2)
+    {
+        xbt_assert(_job_has_id, "%s: one job has no 'id' field", _error_prefix.c_str());
+        xbt_assert(_job_has_subtime, "%s: job %d has no 'subtime' field", _error_prefix.c_str(), _job.number);
+
+        uint64_t size = _stream.Tell() - _job.offset;
+        xbt_assert(size <= UINT32_MAX, "%s: job %d is too large", _error_prefix.c_str(), _job.number);
+        _job.size = (uint32_t) size;
+        _jobs.push_back(_job);
+    }
+    else if (_depth == 1 && _workload_key == WorkloadKey::PROFILES)
+    {
+        _profiles_size = _stream.Tell() - _profiles_offset;
+        _profiles_read = true;
+    }
+    return true;
+}
+
+bool WorkloadIndexHandler::StartArray()
+{
+    xbt_assert(!(_in_jobs && _depth == 2), "%s: one job is not an object", _error_prefix.c_str());
+
+    if (_depth == 1 && _workload_key == WorkloadKey::JOBS)
+    {
+        _in_jobs = true;
+    }
+
+    ++_depth;
+    return true;
+}
+
+bool WorkloadIndexHandler::EndArray(SizeType element_count)
+{
+    (void) element_count;
+    --_depth;
+
+    if (_in_jobs && _depth == 1)
+    {
+        _in_jobs = false;
+        _jobs_read = true;
+    }
+    return true;
+}
+
+bool WorkloadIndexHandler::on_scalar(bool is_number, double number, bool is_int)
+{
+    if (_depth == 1 && _workload_key == WorkloadKey::NB_RES)
+    {
+        _nb_res_is_valid = is_int;
+        _nb_res = (int) number;
+    }
+    else if (_in_jobs && _depth == 2)
+    {
+        xbt_assert(false, "%s: one job is not an object", _error_prefix.c_str());
+    }
+    else if (_in_jobs && _depth == 3)
+    {
+        if (_job_key == JobKey::ID)
+        {
+            xbt_assert(is_int, "%s: one job id is neither a string nor an integer", _error_prefix.c_str());
+            _job.number = (int) number;
+            _job_has_id = true;
+        }
+        else if (_job_key == JobKey::SUBTIME)
+        {
+            xbt_assert(is_number, "%s: job %d has a non-number 'subtime' field",
+                       _error_prefix.c_str(), _job.number);
+            _job.submission_time = number;
+            _job_has_subtime = true;
+        }
+    }
+    return true;
+}
@@ -5,15 +5,151 @@
 
 #pragma once
 
+#include <cstdint>
+#include <fstream>
 #include <string>
 #include <map>
+#include <vector>
 
+#include <rapidjson/filereadstream.h>
+#include <rapidjson/reader.h>
+
+class BinaryWorkloadFile;
+struct BinaryJobRecord;
 class Jobs;
 struct Job;
 class Profiles;
 struct JobIdentifier;
 struct BatsimContext;
 
+/**
+ * @brief Locates a job whose description has not been read yet in its workload file
+ */
+struct LazyJob
+{
+    double submission_time; //!< The job submission time
+    int number; //!< The job number within its workload
+    uint64_t offset; //!< The position of the job JSON object in the workload file (in bytes)
+    uint32_t size; //!< The size of the job JSON object (in bytes)
+};
+
+/**
+ * @brief Indexes the jobs of a workload file from the SAX events of rapidjson::Reader
+ * @details The jobs are not built: only their submission time, number and location in the file
+ *          are kept, together with the 'nb_res' value and the location of the 'profiles' object.
+ */
+class WorkloadIndexHandler
+{
+public:
+    /**
+     * @brief Builds a WorkloadIndexHandler
+     * @param[in] stream The stream the reader parses, used to know where the JSON values are in the file
+     * @param[in] error_prefix The prefix to display when an error occurs
+     */
+    WorkloadIndexHandler(const rapidjson::FileReadStream & stream,
+                         const std::string & error_prefix);
+
+    /**
+     * @brief WorkloadIndexHandler cannot be copied.
+     * @param[in] other Another instance
+     */
+    WorkloadIndexHandler(const WorkloadIndexHandler & other) = delete;
+
+    /**
+     * @brief Checks that the workload has been entirely and correctly read
+     */
+    void finish();
+
+    /**
+     * @brief Returns the 'nb_res' value of the workload
+     * @return The 'nb_res' value of the workload
+     */
+    int nb_res() const { return _nb_res; }
+
+    /**
+     * @brief Returns the indexed jobs, in file order
+     * @return The indexed jobs, in file order
+     */
+    std::vector<LazyJob> & jobs() { return _jobs; }
+
+    /**
+     * @brief Returns the position of the 'profiles' object in the file (in bytes)
+     * @return The position of the 'profiles' object in the file (in bytes)
+     */
+    uint64_t profiles_offset() const { return _profiles_offset; }
+
+    /**
+     * @brief Returns the size of the 'profiles' object (in bytes)
+     * @return The size of the 'profiles' object (in bytes)
+     */
+    uint64_t profiles_size() const { return _profiles_size; }
+
+    // SAX events
+    bool Null(); //!< SAX event. @return true
+    bool Bool(bool b); //!< SAX event. @param[in] b The value. @return true
+    bool Int(int i); //!< SAX event. @param[in] i The value. @return true
+    bool Uint(unsigned u); //!< SAX event. @param[in] u The value. @return true
+    bool Int64(int64_t i); //!< SAX event. @param[in] i The value. @return true
+    bool Uint64(uint64_t u); //!< SAX event. @param[in] u The value. @return true
+    bool Double(double d); //!< SAX event. @param[in] d The value. @return true
+    bool RawNumber(const char * str, rapidjson::SizeType length, bool copy); //!< SAX event. @param[in] str The number string. @param[in] length The length of str. @param[in] copy Whether str should be copied. @return true
+    bool String(const char * str, rapidjson::SizeType length, bool copy); //!< SAX event. @param[in] str The string. @param[in] length The length of str. @param[in] copy Whether str should be copied. @return true
+    bool Key(const char * str, rapidjson::SizeType length, bool copy); //!< SAX event. @param[in] str The key. @param[in] length The length of str. @param[in] copy Whether str should be copied. @return true
+    bool StartObject(); //!< SAX event. @return true
+    bool EndObject(rapidjson::SizeType member_count); //!< SAX event. @param[in] member_count The number of members. @return true
+    bool StartArray(); //!< SAX event. @return true
+    bool EndArray(rapidjson::SizeType element_count); //!< SAX event. @param[in] element_count The number of elements. @return true
+
+private:
+    /**
+     * @brief Enumerates the keys of the workload object whose values are used
+     */
+    enum class WorkloadKey
+    {
+        NB_RES      //!< The 'nb_res' key
+        ,JOBS       //!< The 'jobs' key
+        ,PROFILES   //!< The 'profiles' key
+        ,OTHER      //!< Any other key (its value is ignored)
+    };
+
+    /**
+     * @brief Enumerates the keys of a job object whose values are used
+     */
+    enum class JobKey
+    {
+        ID          //!< The 'id' key
+        ,SUBTIME    //!< The 'subtime' key
+        ,OTHER      //!< Any other key (its value is ignored)
+    };
+
+    /**
+     * @brief Handles a scalar value
+     * @param[in] is_number Whether the value is a number
+     * @param[in] number The value (if is_number is true)
+     * @param[in] is_int Whether the value is a number which fits in an int
+     * @return true
+     */
+    bool on_scalar(bool is_number, double number, bool is_int);
+
+private:
+    const rapidjson::FileReadStream & _stream; //!< The stream the reader parses
+    std::string _error_prefix; //!< The prefix to display when an error occurs
+    int _depth = 0; //!< The number of objects and arrays the reader is in
+    WorkloadKey _workload_key = WorkloadKey::OTHER; //!< The current key of the workload object
+    JobKey _job_key = JobKey::OTHER; //!< The current key of the job object being read
+    int _nb_res = -1; //!< The 'nb_res' value
+    bool _nb_res_is_valid = false; //!< Whether 'nb_res' has been read and is an integer
+    bool _in_jobs = false; //!< Whether the reader is in the 'jobs' array
+    bool _jobs_read = false; //!< Whether the 'jobs' array has been read
+    bool _profiles_read = false; //!< Whether the 'profiles' object has been read
+    uint64_t _profiles_offset = 0; //!< The position of the 'profiles' object in the file
+    uint64_t _profiles_size = 0; //!< The size of the 'profiles' object
+    LazyJob _job; //!< The job being read
+    bool _job_has_id = false; //!< Whether the job being read has an 'id' field
+    bool _job_has_subtime = false; //!< Whether the job being read has a 'subtime' field
+    std::vector<LazyJob> _jobs; //!< The indexed jobs
+};
+
 /**
  * @brief A workload is simply some Jobs with their associated Profiles
  */
@@ -47,6 +183,52 @@ public:
     void load_from_json(const std::string & json_filename,
                         int & nb_machines);
 
+    /**
+     * @brief Lazily loads a static workload from a JSON filename
+     * @details Only the profiles are loaded. The jobs are indexed by a streaming pass over the file
+     *          (see lazy_jobs) and each of them is read when materialize_job is called.
+     *          Workloads which contain SMPI profiles are loaded by load_from_json instead, as their
+     *          applications must be registered before the simulation starts.
+     * @param[in] json_filename The name of the JSON file
+     * @param[out] nb_machines The number of machines described in the JSON file
+     */
+    void load_lazily_from_json(const std::string & json_filename,
+                               int & nb_machines);
+
+    /**
+     * @brief Loads a static workload from a binary workload file (see BinaryWorkloadFile)
+     * @details The file is mapped in memory and is not parsed: the profiles are built from their
+     *          JSON descriptions and the jobs from fixed-width records. In lazy mode, the jobs are
+     *          not indexed (the records are already sorted) and are only built when
+     *          materialize_binary_job is called.
+     * @param[in] binary_filename The name of the binary workload file
+     * @param[out] nb_machines The number of machines described in the file
+     * @param[in] lazy Whether the jobs should be built when they are submitted
+     */
+    void load_from_binary(const std::string & binary_filename,
+                          int & nb_machines,
+                          bool lazy);
+
+    /**
+     * @brief Reads a lazily loaded job from the workload file and adds it into the Jobs of the Workload
+     * @param[in] lazy_job The job location, taken from lazy_jobs
+     * @return The job, which now belongs to the Jobs of the Workload
+     */
+    Job * materialize_job(const LazyJob & lazy_job);
+
+    /**
+     * @brief Builds a job of a lazily loaded binary workload from its record and adds it into the Jobs of the Workload
+     * @param[in] index The index of the job record in the binary workload file (see binary_file)
+     * @return The job, which now belongs to the Jobs of the Workload
+     */
+    Job * materialize_binary_job(uint64_t index);
+
+    /**
+     * @brief Returns the mapped binary workload file the Workload has been loaded from
+     * @return The binary workload file, or nullptr if the Workload has not been loaded from one
+     */
+    const BinaryWorkloadFile * binary_file() const { return _binary_file; }
+
     /**
      * @brief Registers SMPI applications
      */
@@ -57,11 +239,31 @@ public:
      */
     void check_validity();
 
+    /**
+     * @brief Checks whether a job of the Workload is valid
+     * @param[in] job The job
+     */
+    void check_job_validity(const Job * job);
+
 public:
     std::string name; //!< The Workload name
     std::string file = ""; //!< The Workload file if it exists
     Jobs * jobs = nullptr; //!< The Jobs of the Workload
     Profiles * profiles = nullptr; //!< The Profiles associated to the Jobs of the Workload
+    bool is_lazy = false; //!< Whether the jobs of the Workload are read from its file on submission
+    std::vector<LazyJob> lazy_jobs; //!< The jobs yet to be read, sorted by submission time then number (if is_lazy, JSON workloads only)
+
+private:
+    /**
+     * @brief Builds a job from a record of the binary workload file
+     * @param[in] record The job record
+     * @return The new-allocated job
+     */
+    Job * job_from_binary_record(const BinaryJobRecord & record);
+
+private:
+    std::ifstream _lazy_file; //!< The workload file jobs are read from (if is_lazy)
+    BinaryWorkloadFile * _binary_file = nullptr; //!< The mapped binary workload file (if loaded from one)
 };
 
 
@@ -216,5 +418,13 @@ public:
     const std::map<std::string, Workload*> & workloads() const;
 
 private:
+    /**
+     * @brief Returns the Workload of a job, without comparing workload names
+     * @param[in] job_id The JobIdentifier
+     * @return The Workload of the job, or nullptr if it does not exist
+     */
+    Workload * find(const JobIdentifier & job_id) const;
+
     std::map<std::string, Workload*> _workloads; //!< Associates Workloads with their names
+    std::vector<Workload*> _workloads_by_id; //!< Associates Workloads with their interned names (see JobIdentifier::intern_workload_name)
 };
@@ -0,0 +1,125 @@
+/**
+ * @file fcfs_plugin.cpp
+ * @brief A First-Come, First-Served scheduler plugin, used to test the --scheduler-plugin option
+ * @details Jobs are started in their submission order, each on the first available resources.
+ *          A job waits until enough resources are available, and the jobs submitted after it wait too.
+ */
+
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "scheduler_plugin.hpp"
+
+/**
+ * @brief A First-Come, First-Served scheduler
+ */
+class FCFSScheduler : public SchedulerPlugin
+{
+public:
+    double take_decisions(double now,
+                          const std::vector<PluginEvent> & events,
+                          std::vector<PluginDecision> & decisions) override
+    {
+        for (const PluginEvent & event : events)
+        {
+            switch (event.type)
+            {
+                case PluginEventType::SIMULATION_BEGINS:
+                    _available.assign(event.nb_resources, true);
+                    break;
+                case PluginEventType::JOB_SUBMITTED:
+                    _queue.push_back(std::make_pair(event.job_id, event.nb_requested_resources));
+                    break;
+                case PluginEventType::JOB_COMPLETED:
+                    for (const std::pair<int, int> & interval : event.resources)
+                    {
+                        for (int resource = interval.first; resource <= interval.second; ++resource)
+                        {
+                            _available[resource] = true;
+                        }
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        while (!_queue.empty() && _queue.front().second <= nb_available_resources())
+        {
+            PluginDecision decision;
+            decision.type = PluginDecisionType::EXECUTE_JOB;
+            decision.timestamp = now;
+            decision.job_id = _queue.front().first;
+            allocate(_queue.front().second, decision.resources);
+            decisions.push_back(decision);
+
+            _queue.pop_front();
+        }
+
+        return now;
+    }
+
+private:
+    /**
+     * @brief Returns the number of resources which are not used by any job
+     */
+    int nb_available_resources() const
+    {
+        int nb_available = 0;
+        for (bool available : _available)
+        {
+            nb_available += available ? 1 : 0;
+        }
+        return nb_available;
+    }
+
+    /**
+     * @brief Allocates the first available resources
+     * @param[in] nb_resources The number of resources to allocate
+     * @param[out] resources The allocated resources
+     */
+    void allocate(int nb_resources, PluginResourceIntervals & resources)
+    {
+        for (int resource = 0; nb_resources > 0; ++resource)
+        {
+            if (_available[resource])
+            {
+                _available[resource] = false;
+                --nb_resources;
+
+                if (!resources.empty() && resources.back().second == resource - 1)
+                {
+                    resources.back().second = resource;
+                }
+                else
+                {
+                    resources.push_back(std::make_pair(resource, resource));
+                }
+            }
+        }
+    }
+
+private:
+    std::vector<bool> _available; //!< Whether each resource is available
+    std::deque<std::pair<std::string, int>> _queue; //!< The waiting jobs (identifier, number of requested resources)
+};
+
+extern "C"
+{
+    SchedulerPlugin * batsim_create_scheduler(int api_version, const char * configuration)
+    {
+        (void) configuration;
+        if (api_version != BATSIM_SCHEDULER_PLUGIN_API_VERSION)
+        {
+            return nullptr;
+        }
+        return new FCFSScheduler;
+    }
+
+    void batsim_destroy_scheduler(SchedulerPlugin * scheduler)
+    {
+        delete scheduler;
+    }
+}
@@ -101,6 +101,7 @@ def find_info_from_batsim_command(batsim_command):
 
     batparser.add_argument("--allow-time-sharing", action='store_true')
     batparser.add_argument("--batexec", action='store_true')
+    batparser.add_argument("--scheduler-plugin", type=str, default=None)
     batparser.add_argument("--pfs-host", type=str, default="pfs_host")
 
     batparser.add_argument("-h", "--help", action='store_true')
@@ -109,7 +110,8 @@ def find_info_from_batsim_command(batsim_command):
     try:
         batargs = batparser.parse_args(split_command[1:])
         is_batexec = False
-        if batargs.batexec:
+        if batargs.batexec or batargs.scheduler_plugin is not None:
+            # The scheduler is either absent or loaded into Batsim's process
             is_batexec = True
 
         return (batargs.socket_endpoint, is_batexec)